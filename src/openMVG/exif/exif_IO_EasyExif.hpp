@@ -9,6 +9,8 @@
 #ifndef OPENMVG_EXIF_EXIF_IO_EASYEXIF_HPP
 #define OPENMVG_EXIF_EXIF_IO_EASYEXIF_HPP
 
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <limits>
 #include <sstream>
@@ -74,25 +76,24 @@ class Exif_IO_EasyExif : public Exif_IO
     */
     bool open( const std::string & sFileName ) override
     {
-      // Read the file into a buffer
+      bHaveExifInfo_ = false;
       FILE *fp = fopen( sFileName.c_str(), "rb" );
       if ( !fp )
       {
         return false;
       }
-      fseek( fp, 0, SEEK_END );
-      unsigned long fsize = ftell( fp );
-      rewind( fp );
-      std::vector<unsigned char> buf( fsize );
-      if ( fread( &buf[0], 1, fsize, fp ) != fsize )
-      {
-        fclose( fp );
-        return false;
-      }
+      // Read only the EXIF segment (not the whole image file)
+      std::vector<unsigned char> buf;
+      const bool bExifSegment = readExifSegment( fp, buf );
       fclose( fp );
 
       // Parse EXIF
-      bHaveExifInfo_ = ( exifInfo_.parseFrom( &buf[0], fsize ) == PARSE_EXIF_SUCCESS );
+      if ( bExifSegment )
+      {
+        exifInfo_.clear();
+        bHaveExifInfo_ = ( exifInfo_.parseFromEXIFSegment(
+          &buf[0], static_cast<unsigned>( buf.size() ) ) == PARSE_EXIF_SUCCESS );
+      }
 
       return bHaveExifInfo_;
     }
@@ -310,6 +311,74 @@ class Exif_IO_EasyExif : public Exif_IO
 
   private:
 
+    /**
+    * @brief Read the EXIF segment of a JPEG file.
+    * The JPEG markers are browsed from the beginning of the file:
+    *  only the segment headers and the EXIF APP1 segment are read
+    *  (the other segments are skipped, the search stops at the image data).
+    * @param fp File opened in binary mode
+    * @param[out] buf EXIF segment (starting with "Exif\0\0")
+    * @retval true if an EXIF segment was found
+    */
+    static bool readExifSegment( FILE * fp, std::vector<unsigned char> & buf )
+    {
+      // All JPEG files start with 0xFFD8 (SOI marker)
+      unsigned char header[2];
+      if ( fread( header, 1, 2, fp ) != 2 || header[0] != 0xFF || header[1] != 0xD8 )
+      {
+        return false;
+      }
+      while ( true )
+      {
+        // Find the next marker (0xFF followed by the marker code, may be padded by 0xFF)
+        int c = fgetc( fp );
+        if ( c != 0xFF )
+        {
+          return false;
+        }
+        do
+        {
+          c = fgetc( fp );
+        } while ( c == 0xFF );
+        if ( c == EOF || c == 0xD9 || c == 0xDA ) // end of file, EOI or SOS (image data)
+        {
+          return false;
+        }
+        if ( c == 0x01 || ( c >= 0xD0 && c <= 0xD7 ) ) // markers without payload
+        {
+          continue;
+        }
+        // Segment length (big endian, including the length bytes)
+        if ( fread( header, 1, 2, fp ) != 2 )
+        {
+          return false;
+        }
+        const unsigned segment_length = ( header[0] << 8 ) | header[1];
+        if ( segment_length < 2 )
+        {
+          return false;
+        }
+        const unsigned payload_length = segment_length - 2;
+        if ( c == 0xE1 && payload_length >= 14 ) // APP1: EXIF or XMP
+        {
+          buf.resize( payload_length );
+          if ( fread( &buf[0], 1, payload_length, fp ) != payload_length )
+          {
+            return false;
+          }
+          if ( std::equal( buf.begin(), buf.begin() + 6, "Exif\0\0" ) )
+          {
+            return true;
+          }
+          // Not an EXIF segment (i.e. XMP), continue the search
+        }
+        else if ( fseek( fp, payload_length, SEEK_CUR ) != 0 )
+        {
+          return false;
+        }
+      }
+    }
+
     /// Internal data storing all exif data
     easyexif::EXIFInfo exifInfo_;
 
@@ -11,7 +11,9 @@
 #include "testing/testing.h"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
 
 using namespace std;
@@ -74,6 +76,34 @@ TEST(Matching, Exif_IO_easyexif_Read_GPS_Data)
   EXPECT_NEAR( 31, exif_io->getFocalLengthIn35mm(), 1e-2);
 }
 
+TEST(Matching, Exif_IO_easyexif_ReadData_XMP_Segment_First)
+{
+  // Insert a XMP APP1 segment before the EXIF APP1 segment
+  const std::string sImg_gps = std::string(THIS_SOURCE_DIR) + "/image_data/gps_tag.jpg";
+  std::ifstream in(sImg_gps, std::ios::binary);
+  const std::string jpeg((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  const std::string xmp = std::string("http://ns.adobe.com/xap/1.0/") + '\0' + "<x:xmpmeta/>";
+  const size_t segment_length = xmp.size() + 2;
+  const std::string sImg_xmp = "exif_xmp_first.jpg";
+  {
+    std::ofstream out(sImg_xmp, std::ios::binary);
+    out << jpeg.substr(0, 2) // SOI
+      << '\xFF' << '\xE1'
+      << static_cast<char>(segment_length >> 8) << static_cast<char>(segment_length & 0xFF)
+      << xmp << jpeg.substr(2);
+  }
+  std::unique_ptr<Exif_IO> exif_io ( new Exif_IO_EasyExif( sImg_xmp ) );
+
+  EXPECT_TRUE( exif_io->doesHaveExifInfo());
+  EXPECT_EQ( 13, exif_io->getWidth());
+  EXPECT_EQ( 23, exif_io->getHeight());
+  EXPECT_NEAR( 2.97, exif_io->getFocal(), 1e-2);
+  double val;
+  EXPECT_TRUE(exif_io->GPSLatitude(&val));
+  EXPECT_NEAR(47.5129, val, 1e-4);
+  EXPECT_TRUE( stlplus::file_delete(sImg_xmp) );
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -10,9 +10,11 @@
 #define OPENMVG_EXIF_SENSOR_WIDTH_PARSE_DATABASE_HPP
 
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <locale>
+#include <unordered_map>
 #include <vector>
 
 #include "datasheet.hpp"
@@ -53,60 +55,124 @@ bool parseDatabase( const std::string& sfileDatabase, std::vector<Datasheet>& ve
   }
 }
 
+// Camera maker of a model name: lower case first word
+// (Datasheet::operator== only matches models with the same maker)
+inline std::string getMaker( const std::string & sModel )
+{
+  std::string maker = sModel.substr( 0, sModel.find( ' ' ) );
+  std::transform(maker.begin(), maker.end(), maker.begin(), ::tolower);
+  return maker;
+}
+
+// Database entry indexes grouped by camera maker (in database order)
+using DatabaseMakerIndex = std::unordered_map<std::string, std::vector<size_t>>;
+
+// Index the database entries by camera maker
+inline DatabaseMakerIndex indexDatabase( const std::vector<Datasheet>& vec_database )
+{
+  DatabaseMakerIndex index;
+  for (size_t i = 0; i < vec_database.size(); ++i)
+  {
+    index[getMaker(vec_database[i].model_)].push_back(i);
+  }
+  return index;
+}
+
+// Look for a unique sub-match of the camera model name in the database
+inline bool getInfoExtendedLookup
+(
+  const std::string & sModel,
+  const std::vector<Datasheet>& vec_database,
+  Datasheet& datasheetContent
+)
+{
+  // Do check for contains name
+  std::string model_name_lc(sModel);
+  std::transform(model_name_lc.begin(), model_name_lc.end(), model_name_lc.begin(), ::tolower);
+  const Datasheet* best_datasheet = NULL;
+  for (const auto& cur_datasheet : vec_database)
+  {
+      // If the current datasheet model name contains the provided model name, keep it
+      std::string datasheet_model_name_lc(cur_datasheet.model_);
+      std::transform(datasheet_model_name_lc.begin(), datasheet_model_name_lc.end(), datasheet_model_name_lc.begin(), ::tolower);
+      if (NULL != ::strstr(datasheet_model_name_lc.c_str(), model_name_lc.c_str()))
+      {
+          if (!best_datasheet || (best_datasheet->sensorSize_ == cur_datasheet.sensorSize_))
+          {
+              best_datasheet = &cur_datasheet;
+          }
+          else
+          {
+              // Multiple matches with different sensor sizes, fail
+              best_datasheet = NULL;
+              break;
+          }
+      }
+  }
+
+  // If we found a match, use it
+  if (best_datasheet)
+  {
+      datasheetContent = *best_datasheet;
+      return true;
+  }
+  return false;
+}
+
 // Retrieve camera 'Datasheet' information for the given camera model model name
 //  iff it is found in the database
-bool getInfo
+inline bool getInfo
 (
   const std::string & sModel,
   const std::vector<Datasheet>& vec_database,
   Datasheet& datasheetContent,
-  bool bDoExtendedLookup // if no exact match on camera name, should we look for unique sub-match?
+  bool bDoExtendedLookup = false // if no exact match on camera name, should we look for unique sub-match?
 )
 {
-  bool existInDatabase = false;
-
   const Datasheet refDatasheet( sModel, -1. );
   std::vector<Datasheet>::const_iterator datasheet = std::find( vec_database.begin(), vec_database.end(), refDatasheet );
   if ( datasheet != vec_database.end() )
   {
     datasheetContent = *datasheet;
-    existInDatabase = true;
+    return true;
   }
   else if (!sModel.empty() && bDoExtendedLookup)
   {
-      // Do check for contains name
-      std::string model_name_lc(sModel);
-      std::transform(model_name_lc.begin(), model_name_lc.end(), model_name_lc.begin(), ::tolower);
-      const Datasheet* best_datasheet = NULL;
-      for (const auto& cur_datasheet : vec_database)
-      {
-          // If the current datasheet model name contains the provided model name, keep it
-          std::string datasheet_model_name_lc(cur_datasheet.model_);
-          std::transform(datasheet_model_name_lc.begin(), datasheet_model_name_lc.end(), datasheet_model_name_lc.begin(), ::tolower);
-          if (NULL != ::strstr(datasheet_model_name_lc.c_str(), model_name_lc.c_str()))
-          {
-              if (!best_datasheet || (best_datasheet->sensorSize_ == cur_datasheet.sensorSize_))
-              {
-                  best_datasheet = &cur_datasheet;
-              }
-              else
-              {
-                  // Multiple matches with different sensor sizes, fail
-                  best_datasheet = NULL;
-                  break;
-              }
-          }
-      }
+    return getInfoExtendedLookup(sModel, vec_database, datasheetContent);
+  }
+  return false;
+}
 
-      // If we found a match, use it
-      if (best_datasheet)
+// Retrieve camera 'Datasheet' information for the given camera model model name
+//  iff it is found in the database.
+// Same result as getInfo, but only the entries of the camera maker are compared.
+inline bool getInfo
+(
+  const std::string & sModel,
+  const std::vector<Datasheet>& vec_database,
+  const DatabaseMakerIndex & maker_index,
+  Datasheet& datasheetContent,
+  bool bDoExtendedLookup = false // if no exact match on camera name, should we look for unique sub-match?
+)
+{
+  const auto maker_it = maker_index.find(getMaker(sModel));
+  if (maker_it != maker_index.end())
+  {
+    const Datasheet refDatasheet( sModel, -1. );
+    for (const size_t i : maker_it->second)
+    {
+      if (vec_database[i] == refDatasheet)
       {
-          datasheetContent = *best_datasheet;
-          existInDatabase = true;
+        datasheetContent = vec_database[i];
+        return true;
       }
+    }
   }
-
-  return existInDatabase;
+  if (!sModel.empty() && bDoExtendedLookup)
+  {
+    return getInfoExtendedLookup(sModel, vec_database, datasheetContent);
+  }
+  return false;
 }
 
 #endif // OPENMVG_EXIF_SENSOR_WIDTH_PARSE_DATABASE_HPP
@@ -129,6 +129,36 @@ TEST(Matching, ParseDatabaseCanon_EOS_M)
   EXPECT_EQ( 22.3, datasheet.sensorSize_ );
 }
 
+TEST(Matching, ParseDatabaseMakerIndex)
+{
+  std::vector<Datasheet> vec_database;
+  const std::string sfileDatabase = stlplus::create_filespec( std::string(THIS_SOURCE_DIR), sDatabase );
+
+  EXPECT_TRUE( parseDatabase( sfileDatabase, vec_database ) );
+  const DatabaseMakerIndex maker_index = indexDatabase( vec_database );
+
+  // The indexed lookup must give the same datasheet as the exhaustive one
+  const std::vector<std::string> vec_model =
+  {
+    "Canon PowerShot SD900", "Canon EOS 550D", "Canon EOS M", "CANON EOS 5D Mark II",
+    "KODAK Z612 ZOOM DIGITAL CAMERA", "NIKON D800", "NotExistModel", "Canon", ""
+  };
+  for (const std::string & sModel : vec_model)
+  {
+    for (const bool bDoExtendedLookup : {false, true})
+    {
+      Datasheet datasheet, datasheet_index;
+      const bool bFound = getInfo( sModel, vec_database, datasheet, bDoExtendedLookup );
+      EXPECT_EQ( bFound, getInfo( sModel, vec_database, maker_index, datasheet_index, bDoExtendedLookup ) );
+      if (bFound)
+      {
+        EXPECT_EQ( datasheet.model_, datasheet_index.model_ );
+        EXPECT_EQ( datasheet.sensorSize_, datasheet_index.sensorSize_ );
+      }
+    }
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
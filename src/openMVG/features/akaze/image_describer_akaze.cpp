@@ -70,6 +70,25 @@ AKAZE_Image_describer_SURF::Describe_AKAZE_SURF
   return regions;
 }
 
+std::unique_ptr<AKAZE_Image_describer_SURF_UCHAR::Regions_type>
+AKAZE_Image_describer_SURF_UCHAR::Describe_AKAZE_SURF_UCHAR
+(
+  const image::Image<unsigned char>& image,
+  const image::Image<unsigned char>* mask
+)
+{
+  const auto float_regions = Describe_AKAZE_SURF(image, mask);
+
+  auto regions = std::unique_ptr<Regions_type>(new Regions_type);
+  regions->Features() = float_regions->Features();
+  regions->Descriptors().resize(float_regions->RegionCount());
+  for (size_t i = 0; i < float_regions->RegionCount(); ++i)
+  {
+    QuantizeUnitDescriptor(float_regions->Descriptors()[i], regions->Descriptors()[i]);
+  }
+  return regions;
+}
+
 std::unique_ptr<AKAZE_Image_describer_LIOP::Regions_type>
 AKAZE_Image_describer_LIOP::Describe_AKAZE_LIOP
 (
@@ -225,6 +244,9 @@ std::unique_ptr<AKAZE_Image_describer> AKAZE_Image_describer::create
   case AKAZE_MLDB:
     return std::unique_ptr<AKAZE_Image_describer>
         (new AKAZE_Image_describer_MLDB(params, orientation));
+  case AKAZE_MSURF_UCHAR:
+    return std::unique_ptr<AKAZE_Image_describer>
+        (new AKAZE_Image_describer_SURF_UCHAR(params, orientation));
   default:
     return {};
   }
@@ -23,7 +23,8 @@ enum EAKAZE_DESCRIPTOR
 {
   AKAZE_MSURF,
   AKAZE_LIOP,
-  AKAZE_MLDB
+  AKAZE_MLDB,
+  AKAZE_MSURF_UCHAR // M-SURF quantized on 8 bits
 };
 
 class AKAZE_Image_describer : public Image_describer
@@ -115,6 +116,38 @@ public:
   );
 };
 
+/// M-SURF descriptors quantized on 8 bits (4 times less memory and I/O than the float ones)
+class AKAZE_Image_describer_SURF_UCHAR : public AKAZE_Image_describer_SURF
+{
+public:
+
+  using Regions_type = AKAZE_Uchar_Regions;
+
+  AKAZE_Image_describer_SURF_UCHAR(
+    const Params& params = Params(),
+    bool bOrientation = true
+  )
+    :AKAZE_Image_describer_SURF(params, bOrientation) { }
+
+  std::unique_ptr<Regions> Describe(
+      const image::Image<unsigned char>& image,
+      const image::Image<unsigned char>* mask = nullptr
+  ) override
+  {
+    return Describe_AKAZE_SURF_UCHAR(image, mask);
+  }
+
+  std::unique_ptr<Regions> Allocate() const override
+  {
+    return std::unique_ptr<Regions_type>(new Regions_type);
+  }
+
+  std::unique_ptr<Regions_type> Describe_AKAZE_SURF_UCHAR(
+    const image::Image<unsigned char>& image,
+    const image::Image<unsigned char>* mask = nullptr
+  );
+};
+
 class AKAZE_Image_describer_LIOP : public AKAZE_Image_describer {
 public:
   using Regions_type = AKAZE_Liop_Regions;
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <iostream>
 #include <iterator>
 #include <fstream>
@@ -209,6 +210,24 @@ inline bool saveDescsToBinFile(
   return bOk;
 }
 
+/// Quantize a descriptor of unit L2 norm on 8 bits: q = clamp(256 * v + 128, 0, 255).
+/// The mapping is affine, so the L2 distance ratios are kept (up to the rounding and
+/// the saturation of the rare values outside of [-0.5, 0.5]).
+template <uint32_t N>
+inline void QuantizeUnitDescriptor
+(
+  const Descriptor<float, N> & desc,
+  Descriptor<unsigned char, N> & quantized_desc
+)
+{
+  for (uint32_t i = 0; i < N; ++i)
+  {
+    const float value = std::round(256.f * desc[i] + 128.f);
+    quantized_desc[i] =
+      static_cast<unsigned char>(std::min(255.f, std::max(0.f, value)));
+  }
+}
+
 } // namespace features
 } // namespace openMVG
 
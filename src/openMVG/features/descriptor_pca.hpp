@@ -0,0 +1,126 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_FEATURES_DESCRIPTOR_PCA_HPP
+#define OPENMVG_FEATURES_DESCRIPTOR_PCA_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <Eigen/Eigenvalues>
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+
+namespace openMVG {
+namespace features {
+
+/**
+ * Dimension reduction of descriptors by Principal Component Analysis:
+ * - a descriptor is centered and projected on the first principal axes,
+ * - the components are quantized on 8 bits with a single scale for all of them.
+ * The projection is orthogonal and the quantization affine, so the L2 distances
+ * (and the distance ratios) of the reduced descriptors approximate the ones of the
+ * input descriptors, and the reduced descriptors can be matched by the L2 matchers.
+ * The basis is trained once for a whole image collection.
+ */
+class Descriptor_PCA
+{
+public:
+
+  /**
+   * Train the basis.
+   *
+   * \param[in] descriptors    Training descriptors (one per row).
+   * \param[in] nb_components  Number of kept principal components.
+   *
+   * \return True if success.
+   */
+  bool Train
+  (
+    const Eigen::MatrixXf & descriptors,
+    int nb_components
+  )
+  {
+    const int dimension = static_cast<int>(descriptors.cols());
+    if (descriptors.rows() < 2 || nb_components < 1 || dimension < nb_components)
+      return false;
+
+    const Eigen::RowVectorXf mean = descriptors.colwise().mean();
+    const Eigen::MatrixXf centered = descriptors.rowwise() - mean;
+    const Eigen::MatrixXd covariance =
+      (centered.transpose() * centered).cast<double>() / static_cast<double>(descriptors.rows() - 1);
+
+    // The eigen values are sorted in increasing order
+    const Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(covariance);
+    if (solver.info() != Eigen::Success)
+      return false;
+    const Eigen::MatrixXf basis =
+      solver.eigenvectors().rightCols(nb_components).rowwise().reverse().transpose().cast<float>();
+
+    // Scale of the quantization: the 99.9th percentile of the absolute values of
+    //  the components is mapped to 127 (the rare larger values are saturated)
+    const Eigen::MatrixXf components = (centered * basis.transpose()).cwiseAbs();
+    float max_value = 0.f;
+    for (int c = 0; c < nb_components; ++c)
+    {
+      std::vector<float> values(components.col(c).data(), components.col(c).data() + components.rows());
+      const auto percentile = values.begin() + static_cast<size_t>(0.999 * (values.size() - 1));
+      std::nth_element(values.begin(), percentile, values.end());
+      max_value = std::max(max_value, *percentile);
+    }
+    if (max_value <= 0.f)
+      return false;
+
+    dimension_ = dimension;
+    nb_components_ = nb_components;
+    mean_.assign(mean.data(), mean.data() + dimension);
+    basis_.resize(static_cast<size_t>(nb_components) * dimension);
+    Eigen::Map<Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>
+      (basis_.data(), nb_components, dimension) = basis;
+    scale_ = 127.f / max_value;
+    return true;
+  }
+
+  /// Project and quantize a descriptor (nb_components values)
+  template <typename Scalar>
+  void Project(const Scalar * descriptor, unsigned char * reduced) const
+  {
+    const float * axis = basis_.data();
+    for (int c = 0; c < nb_components_; ++c, axis += dimension_)
+    {
+      float value = 0.f;
+      for (int i = 0; i < dimension_; ++i)
+        value += axis[i] * (static_cast<float>(descriptor[i]) - mean_[i]);
+      value = std::round(scale_ * value + 128.f);
+      reduced[c] = static_cast<unsigned char>(std::min(255.f, std::max(0.f, value)));
+    }
+  }
+
+  bool IsTrained() const { return nb_components_ > 0; }
+  int ComponentCount() const { return nb_components_; }
+  int Dimension() const { return dimension_; }
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(dimension_, nb_components_, mean_, basis_, scale_);
+  }
+
+private:
+  int dimension_ = 0;
+  int nb_components_ = 0;
+  std::vector<float> mean_;   // dimension values
+  std::vector<float> basis_;  // nb_components x dimension (row major principal axes)
+  float scale_ = 1.f;
+};
+
+} // namespace features
+} // namespace openMVG
+
+#endif // OPENMVG_FEATURES_DESCRIPTOR_PCA_HPP
@@ -8,12 +8,18 @@
 
 #include "openMVG/features/feature.hpp"
 #include "openMVG/features/descriptor.hpp"
+#include "openMVG/features/descriptor_pca.hpp"
+#include "openMVG/features/product_quantizer.hpp"
+#include "openMVG/features/regions_factory.hpp"
 
 #include "testing/testing.h"
 
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <random>
 #include <vector>
 
 using namespace openMVG;
@@ -129,6 +135,227 @@ TEST(descriptorIO, BINARY) {
   }
 }
 
+//Test the 8 bits quantization of unit descriptors
+TEST(descriptorIO, QUANTIZATION) {
+  Descriptor<float, 64> desc;
+  for (int j = 0; j < 64; ++j)
+    desc[j] = (j % 2 ? 1.f : -1.f) * j / 64.f / 8.f;
+  desc[0] = 0.7f;   // saturated
+  desc[1] = -0.7f;  // saturated
+  desc.normalize();
+
+  Descriptor<unsigned char, 64> quantized_desc;
+  QuantizeUnitDescriptor(desc, quantized_desc);
+  EXPECT_EQ(255, quantized_desc[0]);
+  EXPECT_EQ(0, quantized_desc[1]);
+  for (int j = 2; j < 64; ++j)
+    EXPECT_NEAR(desc[j], (quantized_desc[j] - 128.f) / 256.f, 0.5f / 256.f + 1e-6f);
+}
+
+//Test the binary regions file (keypoints and descriptors in a single file)
+TEST(regionsIO, BINARY_FILE) {
+  SIFT_Regions regions;
+  for (int i = 0; i < CARD; ++i)
+  {
+    regions.Features().emplace_back(i, i*2, i*3, i*4);
+    SIFT_Regions::DescriptorT desc;
+    for (int j = 0; j < 128; ++j)
+      desc[j] = static_cast<unsigned char>(i+j);
+    regions.Descriptors().push_back(desc);
+  }
+  EXPECT_TRUE(regions.Save("tempRegions.regions"));
+
+  SIFT_Regions regions_read;
+  EXPECT_TRUE(regions_read.Load("tempRegions.regions"));
+  EXPECT_EQ(CARD, regions_read.RegionCount());
+  for (int i = 0; i < CARD; ++i)
+  {
+    EXPECT_EQ(regions.Features()[i], regions_read.Features()[i]);
+    for (int j = 0; j < 128; ++j)
+      EXPECT_EQ(regions.Descriptors()[i][j], regions_read.Descriptors()[i][j]);
+  }
+
+  // The file cannot be read as another regions type
+  AKAZE_Float_Regions akaze_regions;
+  EXPECT_FALSE(akaze_regions.Load("tempRegions.regions"));
+
+  // Empty regions
+  EXPECT_TRUE(SIFT_Regions().Save("tempEmptyRegions.regions"));
+  EXPECT_TRUE(regions_read.Load("tempEmptyRegions.regions"));
+  EXPECT_EQ(0, regions_read.RegionCount());
+}
+
+TEST(regionsIO, CORRUPTED_BINARY_FILE) {
+  AKAZE_Binary_Regions regions;
+  for (int i = 0; i < CARD; ++i)
+  {
+    regions.Features().emplace_back(i, i*2, i*3, i*4);
+    AKAZE_Binary_Regions::DescriptorT desc;
+    desc.fill(static_cast<unsigned char>(i));
+    regions.Descriptors().push_back(desc);
+  }
+  EXPECT_TRUE(regions.Save("tempCorruptedRegions.regions"));
+  EXPECT_TRUE(AKAZE_Binary_Regions().Load("tempCorruptedRegions.regions"));
+
+  // Flip a byte of the last descriptor
+  {
+    std::fstream file("tempCorruptedRegions.regions",
+      std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(-1, std::ios::end);
+    const char value = static_cast<char>(file.get());
+    file.seekp(-1, std::ios::end);
+    file.put(value ^ 0x10);
+  }
+  EXPECT_FALSE(AKAZE_Binary_Regions().Load("tempCorruptedRegions.regions"));
+
+  // Non existing file
+  EXPECT_FALSE(AKAZE_Binary_Regions().Load("x.regions"));
+}
+
+// Descriptors scattered around some random centers (values in [0, 255])
+Eigen::MatrixXf ClusteredDescriptors(int nb_centers, int nb_per_center, int dimension, float noise)
+{
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<float> value_distribution(0.f, 255.f);
+  std::normal_distribution<float> noise_distribution(0.f, noise);
+  Eigen::MatrixXf descriptors(nb_centers * nb_per_center, dimension);
+  for (int c = 0; c < nb_centers; ++c)
+  {
+    Eigen::RowVectorXf center(dimension);
+    for (int j = 0; j < dimension; ++j)
+      center[j] = value_distribution(random_generator);
+    for (int i = 0; i < nb_per_center; ++i)
+      for (int j = 0; j < dimension; ++j)
+        descriptors(c * nb_per_center + i, j) = center[j] + noise_distribution(random_generator);
+  }
+  return descriptors;
+}
+
+//Test the PCA reduction: the descriptors spanning a few dimensions keep their distances
+TEST(descriptorCompression, PCA) {
+  const int dimension = 128, nb_rows = 2000;
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::normal_distribution<float> distribution(0.f, 1.f);
+  // 16 dimensional descriptors embedded in 128 dimensions
+  const Eigen::MatrixXf embedding = Eigen::MatrixXf::Random(16, dimension);
+  Eigen::MatrixXf coefficients(nb_rows, 16);
+  for (int i = 0; i < nb_rows; ++i)
+    for (int j = 0; j < 16; ++j)
+      coefficients(i, j) = 10.f * distribution(random_generator);
+  const Eigen::MatrixXf descriptors = (coefficients * embedding).array() + 100.f;
+
+  Descriptor_PCA pca;
+  EXPECT_FALSE(pca.IsTrained());
+  EXPECT_FALSE(pca.Train(descriptors, dimension + 1));
+  EXPECT_TRUE(pca.Train(descriptors, 32));
+  EXPECT_EQ(32, pca.ComponentCount());
+  EXPECT_EQ(dimension, pca.Dimension());
+
+  // The reduced distances are proportional to the input ones
+  std::vector<Descriptor<unsigned char, 32>> reduced(nb_rows);
+  for (int i = 0; i < nb_rows; ++i)
+  {
+    const Eigen::VectorXf descriptor = descriptors.row(i).transpose();
+    pca.Project(descriptor.data(), reduced[i].data());
+  }
+  const double scale = (reduced[0].cast<double>() - reduced[1].cast<double>()).norm()
+    / (descriptors.row(0) - descriptors.row(1)).norm();
+  for (int i = 2; i < 100; ++i)
+  {
+    const double distance = (descriptors.row(0) - descriptors.row(i)).norm();
+    const double reduced_distance = (reduced[0].cast<double>() - reduced[i].cast<double>()).norm();
+    EXPECT_NEAR(1.0, reduced_distance / (scale * distance), 0.1);
+  }
+}
+
+//Test the product quantization: encoding, decoding and the approximate distances
+TEST(descriptorCompression, PRODUCT_QUANTIZER) {
+  const int dimension = 128;
+  const Eigen::MatrixXf descriptors = ClusteredDescriptors(200, 20, dimension, 2.f);
+
+  Product_Quantizer quantizer;
+  EXPECT_FALSE(quantizer.IsTrained());
+  EXPECT_FALSE(quantizer.Train(descriptors, dimension + 1));
+  EXPECT_TRUE(quantizer.Train(descriptors, 16));
+  EXPECT_EQ(16, quantizer.SubspaceCount());
+  EXPECT_EQ(dimension, quantizer.Dimension());
+
+  std::vector<unsigned char> codes(descriptors.rows() * 16);
+  for (int i = 0; i < descriptors.rows(); ++i)
+  {
+    const Eigen::VectorXf descriptor = descriptors.row(i).transpose();
+    quantizer.Encode(descriptor.data(), &codes[i * 16]);
+  }
+
+  // The decoded descriptors are close to the input ones (the clusters are found)
+  Eigen::VectorXf decoded(dimension), decoded_other(dimension);
+  double mean_error = 0.0;
+  for (int i = 0; i < descriptors.rows(); ++i)
+  {
+    quantizer.Decode(&codes[i * 16], decoded.data());
+    mean_error += (decoded - descriptors.row(i).transpose()).norm() / descriptors.rows();
+  }
+  EXPECT_TRUE(mean_error < 2.f * std::sqrt(dimension));
+
+  // Asymmetric and symmetric distances
+  std::vector<float> table;
+  const Eigen::VectorXf query = descriptors.row(0).transpose();
+  quantizer.DistanceTable(query.data(), table);
+  quantizer.Decode(&codes[0], decoded.data());
+  for (int i = 0; i < 100; ++i)
+  {
+    quantizer.Decode(&codes[i * 16], decoded_other.data());
+    // Sums of float squared distances: relative tolerance
+    const float asymmetric_distance = (query - decoded_other).squaredNorm();
+    EXPECT_NEAR(asymmetric_distance,
+      quantizer.AsymmetricDistance(table.data(), &codes[i * 16]), 1e-5 * asymmetric_distance + 1e-1);
+    const float symmetric_distance = (decoded - decoded_other).squaredNorm();
+    EXPECT_NEAR(symmetric_distance,
+      quantizer.SymmetricDistance(&codes[0], &codes[i * 16]), 1e-5 * symmetric_distance + 1e-1);
+  }
+}
+
+//Test the product quantized regions: only the codes are stored, the codebook is shared
+TEST(regionsIO, PRODUCT_QUANTIZED_REGIONS) {
+  const Eigen::MatrixXf descriptors = ClusteredDescriptors(CARD, 20, 128, 2.f);
+  auto quantizer = std::make_shared<Product_Quantizer>();
+  EXPECT_TRUE(quantizer->Train(descriptors, 16));
+
+  PQ_Regions regions(quantizer);
+  for (int i = 0; i < CARD; ++i)
+  {
+    regions.Features().emplace_back(i, i*2, i*3, i*4);
+    const Eigen::VectorXf descriptor = descriptors.row(i * 20).transpose();
+    PQ_Regions::DescriptorT code;
+    quantizer->Encode(descriptor.data(), code.data());
+    regions.Descriptors().push_back(code);
+  }
+  EXPECT_FALSE(regions.IsScalar());
+  EXPECT_FALSE(regions.IsBinary());
+  EXPECT_EQ(16, regions.DescriptorLength());
+  EXPECT_TRUE(regions.Save("tempPQ.feat", "tempPQ.desc"));
+  EXPECT_TRUE(regions.Save("tempPQ.regions"));
+  EXPECT_EQ(CARD * 16, stlplus::file_size("tempPQ.desc") - sizeof(size_t));
+
+  // The loading regions share the codebook of the regions type
+  std::unique_ptr<Regions> regions_type(regions.EmptyClone());
+  for (const std::string & file : {"tempPQ.desc", "tempPQ.regions"})
+  {
+    std::unique_ptr<Regions> regions_read(regions_type->EmptyClone());
+    EXPECT_TRUE(file == "tempPQ.desc" ?
+      regions_read->Load("tempPQ.feat", file) : regions_read->Load(file));
+    EXPECT_EQ(CARD, regions_read->RegionCount());
+    EXPECT_EQ(quantizer.get(), static_cast<PQ_Regions*>(regions_read.get())->Quantizer().get());
+    for (int i = 0; i < CARD; ++i)
+    {
+      EXPECT_EQ(regions.Features()[i], static_cast<PQ_Regions*>(regions_read.get())->Features()[i]);
+      EXPECT_EQ(0.0, regions.SquaredDescriptorDistance(i, regions_read.get(), i));
+      EXPECT_EQ(quantizer->SymmetricDistance(regions.Descriptors()[0].data(), regions.Descriptors()[i].data()),
+        regions.SquaredDescriptorDistance(0, regions_read.get(), i));
+    }
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
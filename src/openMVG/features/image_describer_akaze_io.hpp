@@ -35,6 +35,9 @@ CEREAL_REGISTER_POLYMORPHIC_RELATION(openMVG::features::Image_describer, openMVG
 CEREAL_REGISTER_TYPE_WITH_NAME(openMVG::features::AKAZE_Image_describer_SURF, "AKAZE_Image_describer_SURF");
 CEREAL_REGISTER_POLYMORPHIC_RELATION(openMVG::features::Image_describer, openMVG::features::AKAZE_Image_describer_SURF)
 
+CEREAL_REGISTER_TYPE_WITH_NAME(openMVG::features::AKAZE_Image_describer_SURF_UCHAR, "AKAZE_Image_describer_SURF_UCHAR");
+CEREAL_REGISTER_POLYMORPHIC_RELATION(openMVG::features::Image_describer, openMVG::features::AKAZE_Image_describer_SURF_UCHAR)
+
 CEREAL_REGISTER_TYPE_WITH_NAME(openMVG::features::AKAZE_Image_describer_LIOP, "AKAZE_Image_describer_LIOP");
 CEREAL_REGISTER_POLYMORPHIC_RELATION(openMVG::features::Image_describer, openMVG::features::AKAZE_Image_describer_LIOP)
 
@@ -0,0 +1,225 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_FEATURES_IMAGE_DESCRIBER_COMPRESSED_HPP
+#define OPENMVG_FEATURES_IMAGE_DESCRIBER_COMPRESSED_HPP
+
+#include <memory>
+#include <vector>
+
+#include "openMVG/features/descriptor_pca.hpp"
+#include "openMVG/features/image_describer.hpp"
+#include "openMVG/features/product_quantizer.hpp"
+#include "openMVG/features/regions_factory.hpp"
+
+namespace openMVG {
+namespace features {
+
+namespace internal {
+
+template <typename RegionsT>
+bool Get_Regions_Data
+(
+  const Regions & regions,
+  std::vector<SIOPointFeature> * features,
+  Eigen::MatrixXf * descriptors
+)
+{
+  const RegionsT * regionsT = dynamic_cast<const RegionsT *>(&regions);
+  if (!regionsT)
+    return false;
+  if (features)
+    *features = regionsT->Features();
+  if (descriptors)
+  {
+    descriptors->resize(regionsT->RegionCount(), RegionsT::DescriptorT::static_size);
+    for (size_t i = 0; i < regionsT->RegionCount(); ++i)
+      descriptors->row(i) = regionsT->Descriptors()[i].template cast<float>().transpose();
+  }
+  return true;
+}
+
+} // namespace internal
+
+/**
+* @brief Copy the keypoints and the descriptors (as floats, one per row) of some scalar
+*  regions with SIOPointFeature keypoints (SIFT, AKAZE_FLOAT, AKAZE_LIOP).
+* @return False if the regions type is not supported.
+*/
+inline bool Get_SIO_Scalar_Regions_Data
+(
+  const Regions & regions,
+  std::vector<SIOPointFeature> * features,
+  Eigen::MatrixXf * descriptors
+)
+{
+  return internal::Get_Regions_Data<SIFT_Regions>(regions, features, descriptors)
+    || internal::Get_Regions_Data<AKAZE_Float_Regions>(regions, features, descriptors)
+    || internal::Get_Regions_Data<AKAZE_Uchar_Regions>(regions, features, descriptors)
+    || internal::Get_Regions_Data<AKAZE_Liop_Regions>(regions, features, descriptors);
+}
+
+/**
+* @brief Image describer that compresses the descriptors of another image describer
+*  with a model trained once for the whole image collection:
+*  - train the model on some descriptors of the wrapped describer (Train),
+*  - then describe the images: the regions are described by the wrapped describer
+*    and only their compressed descriptors are kept.
+*  The model is serialized with the describer (and with its regions type if the
+*  regions need it for matching).
+*/
+class Compressed_Image_describer : public Image_describer
+{
+public:
+  explicit Compressed_Image_describer
+  (
+    std::unique_ptr<Image_describer> image_describer = nullptr
+  ):Image_describer(), image_describer_(std::move(image_describer)) {}
+
+  bool Set_configuration_preset(EDESCRIBER_PRESET preset) override
+  {
+    return image_describer_->Set_configuration_preset(preset);
+  }
+
+  std::unique_ptr<Regions> Describe(
+    const image::Image<unsigned char>& image,
+    const image::Image<unsigned char>* mask = nullptr
+  ) override
+  {
+    const std::unique_ptr<Regions> regions = image_describer_->Describe(image, mask);
+    if (!regions)
+      return nullptr;
+    return Compress(*regions);
+  }
+
+  /**
+  @brief Train the compression model
+  @param descriptors Some descriptors computed by the wrapped describer (one per row)
+  @return True if success.
+  */
+  virtual bool Train(const Eigen::MatrixXf & descriptors) = 0;
+
+  /// Compress the regions computed by the wrapped describer (nullptr if not supported)
+  virtual std::unique_ptr<Regions> Compress(const Regions & regions) const = 0;
+
+  /// The describer of the full precision regions
+  Image_describer * Describer() const { return image_describer_.get(); }
+
+protected:
+  std::unique_ptr<Image_describer> image_describer_;
+};
+
+/// Descriptors reduced by PCA to 32 components on 8 bits (matched by the L2 matchers)
+class PCA_Image_describer : public Compressed_Image_describer
+{
+public:
+  using Regions_type = PCA_Regions;
+
+  explicit PCA_Image_describer
+  (
+    std::unique_ptr<Image_describer> image_describer = nullptr
+  ):Compressed_Image_describer(std::move(image_describer)) {}
+
+  bool Train(const Eigen::MatrixXf & descriptors) override
+  {
+    return pca_.Train(descriptors, Regions_type::DescriptorT::static_size);
+  }
+
+  std::unique_ptr<Regions> Compress(const Regions & regions) const override
+  {
+    std::vector<SIOPointFeature> features;
+    Eigen::MatrixXf descriptors;
+    if (!pca_.IsTrained() || !Get_SIO_Scalar_Regions_Data(regions, &features, &descriptors)
+        || descriptors.cols() != pca_.Dimension())
+      return nullptr;
+
+    std::unique_ptr<Regions_type> compressed_regions(new Regions_type);
+    compressed_regions->Features() = std::move(features);
+    compressed_regions->Descriptors().resize(descriptors.rows());
+    Eigen::VectorXf descriptor;
+    for (Eigen::Index i = 0; i < descriptors.rows(); ++i)
+    {
+      descriptor = descriptors.row(i).transpose();
+      pca_.Project(descriptor.data(), compressed_regions->Descriptors()[i].data());
+    }
+    return std::move(compressed_regions);
+  }
+
+  std::unique_ptr<Regions> Allocate() const override
+  {
+    return std::unique_ptr<Regions_type>(new Regions_type);
+  }
+
+  template<class Archive>
+  void serialize(Archive & ar);
+
+private:
+  Descriptor_PCA pca_;
+};
+
+/// Product quantized descriptors: 16 bytes codes (matched by the PRODUCT_QUANTIZATION_L2 matcher)
+class PQ_Image_describer : public Compressed_Image_describer
+{
+public:
+  using Regions_type = PQ_Regions;
+
+  explicit PQ_Image_describer
+  (
+    std::unique_ptr<Image_describer> image_describer = nullptr
+  ):Compressed_Image_describer(std::move(image_describer)),
+    quantizer_(std::make_shared<Product_Quantizer>()) {}
+
+  bool Train(const Eigen::MatrixXf & descriptors) override
+  {
+    // The previous codebook can be shared with some regions: train a new one
+    auto quantizer = std::make_shared<Product_Quantizer>();
+    if (!quantizer->Train(descriptors, Regions_type::DescriptorT::static_size))
+      return false;
+    quantizer_ = quantizer;
+    return true;
+  }
+
+  std::unique_ptr<Regions> Compress(const Regions & regions) const override
+  {
+    std::vector<SIOPointFeature> features;
+    Eigen::MatrixXf descriptors;
+    if (!quantizer_->IsTrained() || !Get_SIO_Scalar_Regions_Data(regions, &features, &descriptors)
+        || descriptors.cols() != quantizer_->Dimension())
+      return nullptr;
+
+    std::unique_ptr<Regions_type> compressed_regions(new Regions_type(quantizer_));
+    compressed_regions->Features() = std::move(features);
+    compressed_regions->Descriptors().resize(descriptors.rows());
+    Eigen::VectorXf descriptor;
+    for (Eigen::Index i = 0; i < descriptors.rows(); ++i)
+    {
+      descriptor = descriptors.row(i).transpose();
+      quantizer_->Encode(descriptor.data(), compressed_regions->Descriptors()[i].data());
+    }
+    return std::move(compressed_regions);
+  }
+
+  std::unique_ptr<Regions> Allocate() const override
+  {
+    return std::unique_ptr<Regions_type>(new Regions_type(quantizer_));
+  }
+
+  template<class Archive>
+  void save(Archive & ar) const;
+
+  template<class Archive>
+  void load(Archive & ar);
+
+private:
+  std::shared_ptr<const Product_Quantizer> quantizer_;
+};
+
+} // namespace features
+} // namespace openMVG
+
+#endif // OPENMVG_FEATURES_IMAGE_DESCRIBER_COMPRESSED_HPP
@@ -0,0 +1,50 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_FEATURES_IMAGE_DESCRIBER_COMPRESSED_IO_HPP
+#define OPENMVG_FEATURES_IMAGE_DESCRIBER_COMPRESSED_IO_HPP
+
+#include "openMVG/features/image_describer_compressed.hpp"
+
+#include <cereal/types/memory.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include <cereal/types/vector.hpp>
+
+template<class Archive>
+void openMVG::features::PCA_Image_describer::serialize(Archive & ar)
+{
+  ar(
+   cereal::make_nvp("image_describer", image_describer_),
+   cereal::make_nvp("pca", pca_));
+}
+
+template<class Archive>
+void openMVG::features::PQ_Image_describer::save(Archive & ar) const
+{
+  ar(
+   cereal::make_nvp("image_describer", image_describer_),
+   cereal::make_nvp("quantizer", *quantizer_));
+}
+
+template<class Archive>
+void openMVG::features::PQ_Image_describer::load(Archive & ar)
+{
+  auto quantizer = std::make_shared<Product_Quantizer>();
+  ar(
+   cereal::make_nvp("image_describer", image_describer_),
+   cereal::make_nvp("quantizer", *quantizer));
+  quantizer_ = quantizer;
+}
+
+CEREAL_REGISTER_TYPE_WITH_NAME(openMVG::features::PCA_Image_describer, "PCA_Image_describer");
+CEREAL_REGISTER_POLYMORPHIC_RELATION(openMVG::features::Image_describer, openMVG::features::PCA_Image_describer)
+
+CEREAL_REGISTER_TYPE_WITH_NAME(openMVG::features::PQ_Image_describer, "PQ_Image_describer");
+CEREAL_REGISTER_POLYMORPHIC_RELATION(openMVG::features::Image_describer, openMVG::features::PQ_Image_describer)
+
+#endif // OPENMVG_FEATURES_IMAGE_DESCRIBER_COMPRESSED_IO_HPP
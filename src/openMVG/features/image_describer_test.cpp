@@ -10,6 +10,7 @@
 #include <cereal/archives/json.hpp>
 
 #include "openMVG/features/image_describer_akaze_io.hpp"
+#include "openMVG/features/image_describer_compressed_io.hpp"
 #include "openMVG/features/sift/SIFT_Anatomy_Image_Describer_io.hpp"
 #include "openMVG/features/regions_factory_io.hpp"
 
@@ -18,6 +19,7 @@
 #include "testing/testing.h"
 
 #include <fstream>
+#include <random>
 
 using namespace openMVG;
 using namespace openMVG::features;
@@ -81,6 +83,14 @@ TEST(Image_describer_akaze_surf, IO)
   EXPECT_TRUE(SaveAndLoad(image_describer));
 }
 
+TEST(Image_describer_akaze_surf_uchar, IO)
+{
+  std::unique_ptr<Image_describer> image_describer = AKAZE_Image_describer::create
+    (AKAZE_Image_describer::Params(AKAZE::Params(), AKAZE_MSURF_UCHAR));
+
+  EXPECT_TRUE(SaveAndLoad(image_describer));
+}
+
 TEST(Image_describer_akaze_mldb, IO)
 {
   std::unique_ptr<Image_describer> image_describer = AKAZE_Image_describer::create
@@ -96,6 +106,80 @@ TEST(Image_describer_sift_anatomy, IO)
   EXPECT_TRUE(SaveAndLoad(image_describer));
 }
 
+// Random SIFT like descriptors to train the compression models
+Eigen::MatrixXf RandomDescriptors(int nb_descriptors)
+{
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<float> value_distribution(0.f, 255.f);
+  Eigen::MatrixXf descriptors(nb_descriptors, 128);
+  for (int i = 0; i < descriptors.size(); ++i)
+    descriptors.data()[i] = value_distribution(random_generator);
+  return descriptors;
+}
+
+TEST(Image_describer_sift_anatomy_pca, IO)
+{
+  std::unique_ptr<Image_describer> sift_describer(new SIFT_Anatomy_Image_describer(SIFT_Anatomy_Image_describer::Params()));
+  std::unique_ptr<PCA_Image_describer> pca_describer(new PCA_Image_describer(std::move(sift_describer)));
+  EXPECT_TRUE(pca_describer->Train(RandomDescriptors(1000)));
+
+  SIFT_Regions sift_regions;
+  sift_regions.Features().resize(1);
+  sift_regions.Descriptors().resize(1);
+  const Eigen::MatrixXf descriptor = RandomDescriptors(1);
+  for (int i = 0; i < 128; ++i)
+    sift_regions.Descriptors()[0][i] = static_cast<unsigned char>(descriptor(0, i));
+  const std::unique_ptr<Regions> pca_regions = pca_describer->Compress(sift_regions);
+  EXPECT_TRUE(pca_regions != nullptr);
+
+  // The basis is restored: the same descriptor is reduced to the same values
+  std::unique_ptr<Image_describer> image_describer(pca_describer.release());
+  EXPECT_TRUE(SaveAndLoad(image_describer));
+  const PCA_Image_describer * loaded_describer = dynamic_cast<PCA_Image_describer*>(image_describer.get());
+  EXPECT_TRUE(loaded_describer != nullptr);
+  EXPECT_TRUE(dynamic_cast<SIFT_Anatomy_Image_describer*>(loaded_describer->Describer()) != nullptr);
+  const std::unique_ptr<Regions> loaded_pca_regions = loaded_describer->Compress(sift_regions);
+  EXPECT_TRUE(loaded_pca_regions != nullptr);
+  EXPECT_EQ(32, loaded_pca_regions->DescriptorLength());
+  EXPECT_TRUE(
+    static_cast<PCA_Regions*>(pca_regions.get())->Descriptors()[0] ==
+    static_cast<PCA_Regions*>(loaded_pca_regions.get())->Descriptors()[0]);
+}
+
+TEST(Image_describer_sift_anatomy_pq, IO)
+{
+  std::unique_ptr<Image_describer> sift_describer(new SIFT_Anatomy_Image_describer(SIFT_Anatomy_Image_describer::Params()));
+  std::unique_ptr<PQ_Image_describer> pq_describer(new PQ_Image_describer(std::move(sift_describer)));
+  // Not trained: no codebook to compress with
+  EXPECT_TRUE(pq_describer->Compress(SIFT_Regions()) == nullptr);
+  EXPECT_TRUE(pq_describer->Train(RandomDescriptors(1000)));
+
+  SIFT_Regions sift_regions;
+  sift_regions.Features().resize(1);
+  sift_regions.Descriptors().resize(1);
+  const Eigen::MatrixXf descriptor = RandomDescriptors(1);
+  for (int i = 0; i < 128; ++i)
+    sift_regions.Descriptors()[0][i] = static_cast<unsigned char>(descriptor(0, i));
+  const std::unique_ptr<Regions> pq_regions = pq_describer->Compress(sift_regions);
+  EXPECT_TRUE(pq_regions != nullptr);
+
+  // The codebook is restored: the same descriptor is encoded by the same code
+  std::unique_ptr<Image_describer> image_describer(pq_describer.release());
+  EXPECT_TRUE(SaveAndLoad(image_describer));
+  const PQ_Image_describer * loaded_describer = dynamic_cast<PQ_Image_describer*>(image_describer.get());
+  EXPECT_TRUE(loaded_describer != nullptr);
+  const std::unique_ptr<Regions> loaded_pq_regions = loaded_describer->Compress(sift_regions);
+  EXPECT_TRUE(loaded_pq_regions != nullptr);
+  EXPECT_EQ(16, loaded_pq_regions->DescriptorLength());
+  EXPECT_TRUE(
+    static_cast<PQ_Regions*>(pq_regions.get())->Descriptors()[0] ==
+    static_cast<PQ_Regions*>(loaded_pq_regions.get())->Descriptors()[0]);
+  // The allocated regions share the codebook of the describer
+  const std::unique_ptr<Regions> allocated_regions = loaded_describer->Allocate();
+  EXPECT_TRUE(static_cast<PQ_Regions*>(allocated_regions.get())->Quantizer() ==
+    static_cast<PQ_Regions*>(loaded_pq_regions.get())->Quantizer());
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
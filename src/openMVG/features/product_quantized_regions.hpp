@@ -0,0 +1,172 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_FEATURES_PRODUCT_QUANTIZED_REGIONS_HPP
+#define OPENMVG_FEATURES_PRODUCT_QUANTIZED_REGIONS_HPP
+
+#include <memory>
+#include <typeinfo>
+
+#include "openMVG/features/regions.hpp"
+#include "openMVG/features/descriptor.hpp"
+#include "openMVG/features/product_quantizer.hpp"
+#include "openMVG/features/regions_file_io.hpp"
+
+namespace openMVG {
+namespace features {
+
+/// Specialization of the abstract Regions class to handle product quantized descriptors:
+/// each region stores only its M bytes code. The codebook (shared by all the regions
+/// of an image collection) is serialized with the regions type, so the regions files
+/// contain only the codes.
+template<typename FeatT, size_t M>
+class Product_Quantized_Regions : public Regions
+{
+public:
+
+  //-- Type alias
+  //--
+
+  /// Region type
+  using FeatureT = FeatT;
+  /// Region descriptor (code)
+  using DescriptorT = Descriptor<unsigned char, M>;
+
+  /// Container for multiple regions
+  using FeatsT = std::vector<FeatureT>;
+  /// Container for multiple regions description
+  using DescsT = std::vector<DescriptorT, Eigen::aligned_allocator<DescriptorT>>;
+
+  explicit Product_Quantized_Regions
+  (
+    std::shared_ptr<const Product_Quantizer> quantizer = std::make_shared<Product_Quantizer>()
+  ): quantizer_(quantizer)
+  {}
+
+  //-- Class functions
+  //--
+
+  // The codes cannot be compared with the L2 or the Hamming metric
+  bool IsScalar() const override {return false;}
+  bool IsBinary() const override {return false;}
+  std::string Type_id() const override {return typeid(unsigned char).name();}
+  size_t DescriptorLength() const override {return static_cast<size_t>(M);}
+
+  /// Read from files the regions and their corresponding codes.
+  bool Load(
+    const std::string& sfileNameFeats,
+    const std::string& sfileNameDescs) override
+  {
+    return loadFeatsFromFile(sfileNameFeats, vec_feats_)
+          & loadDescsFromBinFile(sfileNameDescs, vec_descs_);
+  }
+
+  /// Export in two separate files the regions and their corresponding codes.
+  bool Save(
+    const std::string& sfileNameFeats,
+    const std::string& sfileNameDescs) const override
+  {
+    return saveFeatsToFile(sfileNameFeats, vec_feats_)
+          & saveDescsToBinFile(sfileNameDescs, vec_descs_);
+  }
+
+  /// Read the regions and their codes from a binary regions file.
+  bool Load(const std::string& sfileNameRegions) override
+  {
+    return loadRegionsFromFile(sfileNameRegions, Type_id(), false, vec_feats_, vec_descs_);
+  }
+
+  /// Export the regions and their codes in a binary regions file.
+  bool Save(const std::string& sfileNameRegions) const override
+  {
+    return saveRegionsToFile(sfileNameRegions, Type_id(), false, vec_feats_, vec_descs_);
+  }
+
+  bool LoadFeatures(const std::string& sfileNameFeats) override
+  {
+    return loadFeatsFromFile(sfileNameFeats, vec_feats_);
+  }
+
+  PointFeatures GetRegionsPositions() const override
+  {
+    return PointFeatures(vec_feats_.begin(), vec_feats_.end());
+  }
+
+  Vec2 GetRegionPosition(size_t i) const override
+  {
+    return Vec2f(vec_feats_[i].coords()).cast<double>();
+  }
+
+  /// Return the number of defined regions
+  size_t RegionCount() const override {return vec_feats_.size();}
+
+  /// Mutable and non-mutable FeatureT getters.
+  inline FeatsT & Features() { return vec_feats_; }
+  inline const FeatsT & Features() const { return vec_feats_; }
+
+  /// Mutable and non-mutable DescriptorT (code) getters.
+  inline DescsT & Descriptors() { return vec_descs_; }
+  inline const DescsT & Descriptors() const { return vec_descs_; }
+
+  /// The codebook of the codes
+  const std::shared_ptr<const Product_Quantizer> & Quantizer() const { return quantizer_; }
+
+  const void * DescriptorRawData() const override { return &vec_descs_[0];}
+
+  template<class Archive>
+  void save(Archive & ar) const
+  {
+    ar(*quantizer_, vec_feats_, vec_descs_);
+  }
+
+  template<class Archive>
+  void load(Archive & ar)
+  {
+    // The codebook can be shared with some other regions: load a new one
+    auto quantizer = std::make_shared<Product_Quantizer>();
+    ar(*quantizer, vec_feats_, vec_descs_);
+    quantizer_ = quantizer;
+  }
+
+  Regions * EmptyClone() const override
+  {
+    return new Product_Quantized_Regions(quantizer_);
+  }
+
+  // Return the approximate squared L2 distance between two codes
+  double SquaredDescriptorDistance(size_t i, const Regions * regions, size_t j) const override
+  {
+    assert(i < vec_descs_.size());
+    assert(regions);
+    assert(j < regions->RegionCount());
+
+    const Product_Quantized_Regions<FeatT, M> * regionsT =
+      dynamic_cast<const Product_Quantized_Regions<FeatT, M> *>(regions);
+    return quantizer_->SymmetricDistance(vec_descs_[i].data(), regionsT->vec_descs_[j].data());
+  }
+
+  /// Add the Inth region to another Region container
+  void CopyRegion(size_t i, Regions * region_container) const override
+  {
+    assert(i < vec_feats_.size() && i < vec_descs_.size());
+    static_cast<Product_Quantized_Regions<FeatT, M> *>(region_container)->vec_feats_.push_back(vec_feats_[i]);
+    static_cast<Product_Quantized_Regions<FeatT, M> *>(region_container)->vec_descs_.push_back(vec_descs_[i]);
+  }
+
+private:
+  //--
+  //-- internal data
+  std::shared_ptr<const Product_Quantizer> quantizer_; // codebook (shared by the regions of a collection)
+  FeatsT vec_feats_; // region features
+  DescsT vec_descs_; // region codes
+};
+
+} // namespace features
+} // namespace openMVG
+
+#endif // OPENMVG_FEATURES_PRODUCT_QUANTIZED_REGIONS_HPP
@@ -0,0 +1,301 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_FEATURES_PRODUCT_QUANTIZER_HPP
+#define OPENMVG_FEATURES_PRODUCT_QUANTIZER_HPP
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+
+namespace openMVG {
+namespace features {
+
+/**
+ * Product quantizer of fixed length descriptors:
+ * - a descriptor is split in M sub-vectors,
+ * - each sub-vector is encoded by the index of its nearest centroid (8 bits),
+ * - the distance between a query and a code is computed asymmetrically
+ *   (ADC: the query is not quantized) from a distance table of M x 256 values.
+ * The codebook is trained once for a whole image collection, so that the codes of
+ * all the views can be compared.
+ * Reference: [1] "Product quantization for nearest neighbor search."
+ * Authors: Herve Jegou, Matthijs Douze, Cordelia Schmid.
+ * Date: 2011.
+ * Journal: IEEE Transactions on Pattern Analysis and Machine Intelligence.
+ */
+class Product_Quantizer
+{
+public:
+  static const int kMaxCentroids = 256;
+
+  /**
+   * Train the codebook (k-means of each sub-space).
+   *
+   * \param[in] descriptors       Training descriptors (one per row).
+   * \param[in] nb_subspaces      Number of sub-vectors (code length in bytes).
+   * \param[in] nb_iterations     Number of k-means iterations.
+   * \param[in] max_training_rows Maximal number of descriptors used for training
+   *  (a random subset is drawn if there are more).
+   *
+   * \return True if success.
+   */
+  bool Train
+  (
+    const Eigen::MatrixXf & descriptors,
+    int nb_subspaces,
+    int nb_iterations = 16,
+    int max_training_rows = 64 * kMaxCentroids
+  )
+  {
+    const int nb_rows = static_cast<int>(descriptors.rows());
+    const int dimension = static_cast<int>(descriptors.cols());
+    if (nb_rows < 1 || nb_subspaces < 1 || dimension < nb_subspaces)
+      return false;
+    dimension_ = dimension;
+    nb_subspaces_ = nb_subspaces;
+    nb_centroids_ = std::min(kMaxCentroids, nb_rows);
+
+    // Sub-vector boundaries
+    subspace_begin_.resize(nb_subspaces_ + 1);
+    for (int m = 0; m <= nb_subspaces_; ++m)
+      subspace_begin_[m] = m * dimension_ / nb_subspaces_;
+
+    // Training subset (deterministic)
+    std::vector<int> rows(nb_rows);
+    std::iota(rows.begin(), rows.end(), 0);
+    std::mt19937 random_generator(std::mt19937::default_seed);
+    std::shuffle(rows.begin(), rows.end(), random_generator);
+    if (nb_rows > max_training_rows)
+      rows.resize(max_training_rows);
+
+    // Row major copy of the training descriptors
+    std::vector<float> dataset(rows.size() * dimension_);
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+      Eigen::Map<Eigen::RowVectorXf>(&dataset[i * dimension_], dimension_) =
+        descriptors.row(rows[i]);
+    }
+
+    // Centroids are stored per sub-space: [m][centroid][sub-vector values]
+    centroids_.assign(static_cast<size_t>(nb_centroids_) * dimension_, 0.f);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int m = 0; m < nb_subspaces_; ++m)
+    {
+      TrainSubspace(dataset, m, nb_iterations);
+    }
+    return true;
+  }
+
+  /// Encode a descriptor (nb_subspaces codes)
+  template <typename Scalar>
+  void Encode(const Scalar * descriptor, unsigned char * code) const
+  {
+    for (int m = 0; m < nb_subspaces_; ++m)
+    {
+      code[m] = static_cast<unsigned char>(
+        NearestCentroid(m, descriptor + subspace_begin_[m]));
+    }
+  }
+
+  /// Decode a code (approximation of the encoded descriptor, dimension values)
+  void Decode(const unsigned char * code, float * descriptor) const
+  {
+    for (int m = 0; m < nb_subspaces_; ++m)
+    {
+      const float * centroid = Centroid(m, code[m]);
+      std::copy(centroid, centroid + SubspaceDimension(m), descriptor + subspace_begin_[m]);
+    }
+  }
+
+  /// Compute the ADC table of a query (nb_subspaces x kMaxCentroids squared distances)
+  template <typename Scalar>
+  void DistanceTable(const Scalar * query, std::vector<float> & table) const
+  {
+    table.resize(static_cast<size_t>(nb_subspaces_) * kMaxCentroids);
+    for (int m = 0; m < nb_subspaces_; ++m)
+    {
+      for (int k = 0; k < nb_centroids_; ++k)
+      {
+        table[m * kMaxCentroids + k] =
+          SquaredDistance(query + subspace_begin_[m], Centroid(m, k), SubspaceDimension(m));
+      }
+    }
+  }
+
+  /// Approximate squared distance between a query (from its ADC table) and a code
+  float AsymmetricDistance(const float * table, const unsigned char * code) const
+  {
+    float distance = 0.f;
+    for (int m = 0; m < nb_subspaces_; ++m, table += kMaxCentroids)
+      distance += table[code[m]];
+    return distance;
+  }
+
+  /// Approximate squared distance between two codes (distance of their centroids)
+  float SymmetricDistance(const unsigned char * code_a, const unsigned char * code_b) const
+  {
+    float distance = 0.f;
+    for (int m = 0; m < nb_subspaces_; ++m)
+    {
+      distance += SquaredDistance(Centroid(m, code_a[m]), Centroid(m, code_b[m]),
+        SubspaceDimension(m));
+    }
+    return distance;
+  }
+
+  bool IsTrained() const { return nb_centroids_ > 0; }
+  int SubspaceCount() const { return nb_subspaces_; }
+  int Dimension() const { return dimension_; }
+
+  template <class Archive>
+  void serialize(Archive & ar)
+  {
+    ar(dimension_, nb_subspaces_, nb_centroids_, subspace_begin_, centroids_);
+  }
+
+private:
+
+  int SubspaceDimension(int m) const
+  {
+    return subspace_begin_[m+1] - subspace_begin_[m];
+  }
+
+  const float * Centroid(int m, int k) const
+  {
+    return &centroids_[static_cast<size_t>(subspace_begin_[m]) * nb_centroids_
+      + k * SubspaceDimension(m)];
+  }
+
+  float * Centroid(int m, int k)
+  {
+    return const_cast<float*>(static_cast<const Product_Quantizer*>(this)->Centroid(m, k));
+  }
+
+  template <typename Scalar>
+  static float SquaredDistance(const Scalar * a, const float * b, int size)
+  {
+    float distance = 0.f;
+    for (int i = 0; i < size; ++i)
+    {
+      const float diff = static_cast<float>(a[i]) - b[i];
+      distance += diff * diff;
+    }
+    return distance;
+  }
+
+  template <typename Scalar>
+  int NearestCentroid(int m, const Scalar * sub_vector) const
+  {
+    const int sub_dimension = SubspaceDimension(m);
+    int best_centroid = 0;
+    float best_distance = std::numeric_limits<float>::max();
+    for (int k = 0; k < nb_centroids_; ++k)
+    {
+      const float distance = SquaredDistance(sub_vector, Centroid(m, k), sub_dimension);
+      if (distance < best_distance)
+      {
+        best_distance = distance;
+        best_centroid = k;
+      }
+    }
+    return best_centroid;
+  }
+
+  /// Lloyd k-means on the sub-vectors of a sub-space
+  void TrainSubspace
+  (
+    const std::vector<float> & dataset,
+    int m,
+    int nb_iterations
+  )
+  {
+    const int sub_dimension = SubspaceDimension(m);
+    const size_t nb_rows = dataset.size() / dimension_;
+    const auto sub_vector = [&](size_t row)
+    {
+      return &dataset[row * dimension_ + subspace_begin_[m]];
+    };
+
+    // k-means++ initialization: a row is drawn as a new centroid with a probability
+    //  proportional to its squared distance to the nearest chosen centroid
+    //  (the rows are shuffled: the first one is random)
+    std::mt19937 random_generator(m);
+    std::vector<float> min_distances(nb_rows, std::numeric_limits<float>::max());
+    size_t seed_row = 0;
+    for (int k = 0; k < nb_centroids_; ++k)
+    {
+      const float * src = sub_vector(seed_row);
+      std::copy(src, src + sub_dimension, Centroid(m, k));
+      double total_distance = 0.0;
+      for (size_t row = 0; row < nb_rows; ++row)
+      {
+        min_distances[row] = std::min(min_distances[row],
+          SquaredDistance(sub_vector(row), Centroid(m, k), sub_dimension));
+        total_distance += min_distances[row];
+      }
+      if (total_distance <= 0.0)
+      {
+        // All the rows are already centroids: duplicate the remaining ones
+        for (int l = k + 1; l < nb_centroids_; ++l)
+          std::copy(src, src + sub_dimension, Centroid(m, l));
+        break;
+      }
+      double threshold =
+        std::uniform_real_distribution<double>(0.0, total_distance)(random_generator);
+      for (seed_row = 0; seed_row + 1 < nb_rows; ++seed_row)
+      {
+        threshold -= min_distances[seed_row];
+        if (threshold < 0.0)
+          break;
+      }
+    }
+
+    std::vector<float> sums(static_cast<size_t>(nb_centroids_) * sub_dimension);
+    std::vector<int> counts(nb_centroids_);
+    for (int iter = 0; iter < nb_iterations; ++iter)
+    {
+      std::fill(sums.begin(), sums.end(), 0.f);
+      std::fill(counts.begin(), counts.end(), 0);
+      for (size_t row = 0; row < nb_rows; ++row)
+      {
+        const float * src = sub_vector(row);
+        const int k = NearestCentroid(m, src);
+        ++counts[k];
+        for (int i = 0; i < sub_dimension; ++i)
+          sums[k * sub_dimension + i] += src[i];
+      }
+      // Empty clusters keep their previous centroid
+      for (int k = 0; k < nb_centroids_; ++k)
+      {
+        if (counts[k] == 0)
+          continue;
+        float * centroid = Centroid(m, k);
+        for (int i = 0; i < sub_dimension; ++i)
+          centroid[i] = sums[k * sub_dimension + i] / counts[k];
+      }
+    }
+  }
+
+  int dimension_ = 0;
+  int nb_subspaces_ = 0;
+  int nb_centroids_ = 0;
+  std::vector<int> subspace_begin_;
+  std::vector<float> centroids_;
+};
+
+} // namespace features
+} // namespace openMVG
+
+#endif // OPENMVG_FEATURES_PRODUCT_QUANTIZER_HPP
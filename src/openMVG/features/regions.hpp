@@ -40,6 +40,17 @@ public:
   virtual bool LoadFeatures(
     const std::string& sfileNameFeats) = 0;
 
+  //--
+  // IO - one binary file for the regions and their descriptors
+  //  (memory mapped and checksummed, see regions_file_io.hpp)
+  //--
+
+  virtual bool Load(
+    const std::string& sfileNameRegions) = 0;
+
+  virtual bool Save(
+    const std::string& sfileNameRegions) const = 0;
+
   //--
   //- Basic description of a descriptor [Type, Length]
   //--
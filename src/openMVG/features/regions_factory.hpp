@@ -10,6 +10,7 @@
 #define OPENMVG_FEATURES_REGIONS_FACTORY_HPP
 
 #include "openMVG/features/binary_regions.hpp"
+#include "openMVG/features/product_quantized_regions.hpp"
 #include "openMVG/features/scalar_regions.hpp"
 
 namespace openMVG {
@@ -20,17 +21,27 @@ using SIFT_Regions = Scalar_Regions<SIOPointFeature, unsigned char, 128>;
 
 /// Define the AKAZE Keypoint (with a float descriptor)
 using AKAZE_Float_Regions = Scalar_Regions<SIOPointFeature, float, 64>;
+/// Define the AKAZE Float descriptor quantized on 8 bits (M-SURF)
+using AKAZE_Uchar_Regions = Scalar_Regions<SIOPointFeature, unsigned char, 64>;
 /// Define the AKAZE Keypoint (with a LIOP descriptor)
 using AKAZE_Liop_Regions = Scalar_Regions<SIOPointFeature, unsigned char, 144>;
 /// Define the AKAZE Keypoint (with a binary descriptor saved in an uchar array)
 using AKAZE_Binary_Regions = Binary_Regions<SIOPointFeature, 64>;
 
+/// Define the descriptors reduced by PCA (32 components quantized on 8 bits)
+using PCA_Regions = Scalar_Regions<SIOPointFeature, unsigned char, 32>;
+/// Define the product quantized descriptors (16 bytes codes)
+using PQ_Regions = Product_Quantized_Regions<SIOPointFeature, 16>;
+
 } // namespace features
 } // namespace openMVG
 
 EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_INITIALIZER_LIST(openMVG::features::SIFT_Regions)
 EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_INITIALIZER_LIST(openMVG::features::AKAZE_Float_Regions)
+EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_INITIALIZER_LIST(openMVG::features::AKAZE_Uchar_Regions)
 EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_INITIALIZER_LIST(openMVG::features::AKAZE_Liop_Regions)
 EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_INITIALIZER_LIST(openMVG::features::AKAZE_Binary_Regions)
+EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_INITIALIZER_LIST(openMVG::features::PCA_Regions)
+EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION_INITIALIZER_LIST(openMVG::features::PQ_Regions)
 
 #endif // OPENMVG_FEATURES_REGIONS_FACTORY_HPP
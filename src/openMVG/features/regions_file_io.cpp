@@ -0,0 +1,249 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/features/regions_file_io.hpp"
+
+#include <fstream>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <vector>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace openMVG {
+namespace features {
+
+namespace {
+
+const char kRegionsMagic[8] = {'O', 'M', 'V', 'G', '_', 'R', 'G', 'N'};
+const uint32_t kRegionsVersion = 1;
+const uint64_t kRegionsAlignment = 64;
+
+uint64_t align(uint64_t offset)
+{
+  return (offset + kRegionsAlignment - 1) / kRegionsAlignment * kRegionsAlignment;
+}
+
+/// Read only view of a whole file
+/// (memory mapped if possible, else read in a single block)
+class Mapped_File
+{
+public:
+  explicit Mapped_File(const std::string & filename)
+  {
+#if defined(_WIN32)
+    std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+    if (stream.is_open())
+    {
+      buffer_.resize(static_cast<size_t>(stream.tellg()));
+      stream.seekg(0);
+      if (stream.read(reinterpret_cast<char*>(buffer_.data()), buffer_.size()))
+      {
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+      }
+    }
+#else
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+      void * data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+      {
+        data_ = static_cast<const unsigned char*>(data);
+        size_ = static_cast<size_t>(st.st_size);
+      }
+    }
+    ::close(fd);
+#endif
+  }
+
+  ~Mapped_File()
+  {
+#if !defined(_WIN32)
+    if (data_)
+      ::munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+  }
+
+  Mapped_File(const Mapped_File &) = delete;
+  Mapped_File & operator=(const Mapped_File &) = delete;
+
+  const unsigned char * data() const { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  const unsigned char * data_ = nullptr;
+  size_t size_ = 0;
+#if defined(_WIN32)
+  std::vector<unsigned char> buffer_;
+#endif
+};
+
+/// Checksum of a header and of its arrays
+uint64_t FileChecksum
+(
+  Regions_File_Header header,
+  const void * features,
+  const void * descriptors
+)
+{
+  header.checksum = 0;
+  uint64_t checksum = RegionsChecksum(&header, sizeof(header));
+  checksum = RegionsChecksum(features, header.region_count * header.feature_size, checksum);
+  return RegionsChecksum(descriptors,
+    header.region_count * header.descriptor_length * header.descriptor_value_size, checksum);
+}
+
+} // namespace
+
+Regions_File_Header MakeRegionsFileHeader
+(
+  const std::string & type_id,
+  bool is_binary,
+  uint32_t feature_size,
+  uint32_t descriptor_length,
+  uint32_t descriptor_value_size
+)
+{
+  Regions_File_Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kRegionsMagic, sizeof(header.magic));
+  header.version = kRegionsVersion;
+  header.header_size = sizeof(Regions_File_Header);
+  std::strncpy(header.type_id, type_id.c_str(), sizeof(header.type_id) - 1);
+  header.feature_size = feature_size;
+  header.descriptor_length = descriptor_length;
+  header.descriptor_value_size = descriptor_value_size;
+  header.is_binary = is_binary ? 1 : 0;
+  return header;
+}
+
+uint64_t RegionsChecksum
+(
+  const void * data,
+  size_t size,
+  uint64_t seed
+)
+{
+  // Word based FNV like hashing (8 bytes per step)
+  const uint64_t prime = 0x100000001b3ULL;
+  const unsigned char * bytes = static_cast<const unsigned char*>(data);
+  uint64_t hash = seed;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+  {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * prime;
+    hash ^= hash >> 32;
+  }
+  for (; i < size; ++i)
+    hash = (hash ^ bytes[i]) * prime;
+  return hash;
+}
+
+bool WriteRegionsFile
+(
+  const std::string & sfileNameRegions,
+  Regions_File_Header header,
+  size_t region_count,
+  const void * features,
+  const void * descriptors
+)
+{
+  const uint64_t features_size = region_count * header.feature_size;
+  const uint64_t descriptors_size =
+    region_count * header.descriptor_length * header.descriptor_value_size;
+  header.region_count = region_count;
+  header.features_offset = align(sizeof(Regions_File_Header));
+  header.descriptors_offset = align(header.features_offset + features_size);
+  header.checksum = FileChecksum(header, features, descriptors);
+
+  std::ofstream file(sfileNameRegions.c_str(), std::ios::out | std::ios::binary);
+  if (!file.is_open())
+    return false;
+  const std::vector<char> padding(kRegionsAlignment, 0);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(padding.data(), header.features_offset - sizeof(header));
+  if (features_size > 0)
+    file.write(static_cast<const char*>(features), features_size);
+  file.write(padding.data(), header.descriptors_offset - header.features_offset - features_size);
+  if (descriptors_size > 0)
+    file.write(static_cast<const char*>(descriptors), descriptors_size);
+  const bool bOk = file.good();
+  file.close();
+  return bOk;
+}
+
+bool ReadRegionsFile
+(
+  const std::string & sfileNameRegions,
+  const Regions_File_Header & expected_header,
+  const std::function<bool(size_t, const unsigned char *, const unsigned char *)> & reader
+)
+{
+  const Mapped_File file(sfileNameRegions);
+  if (!file.data() || file.size() < sizeof(Regions_File_Header))
+    return false;
+
+  Regions_File_Header header;
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (std::memcmp(header.magic, kRegionsMagic, sizeof(header.magic)) != 0
+      || header.version != kRegionsVersion
+      || header.header_size != sizeof(Regions_File_Header))
+  {
+    std::cerr << "Invalid regions file: " << sfileNameRegions << std::endl;
+    return false;
+  }
+  if (std::strncmp(header.type_id, expected_header.type_id, sizeof(header.type_id)) != 0
+      || header.is_binary != expected_header.is_binary
+      || header.feature_size != expected_header.feature_size
+      || header.descriptor_length != expected_header.descriptor_length
+      || header.descriptor_value_size != expected_header.descriptor_value_size)
+  {
+    std::cerr << "The regions file does not match the expected regions type: "
+      << sfileNameRegions << std::endl;
+    return false;
+  }
+
+  // Check that the arrays fit in the file before looking at them
+  const uint64_t features_size = header.region_count * header.feature_size;
+  const uint64_t descriptors_size =
+    header.region_count * header.descriptor_length * header.descriptor_value_size;
+  if (header.feature_size == 0
+      || header.region_count > file.size() / header.feature_size
+      || header.features_offset < sizeof(Regions_File_Header)
+      || header.features_offset + features_size > header.descriptors_offset
+      || header.descriptors_offset > file.size()
+      || descriptors_size > file.size() - header.descriptors_offset)
+  {
+    std::cerr << "Truncated regions file: " << sfileNameRegions << std::endl;
+    return false;
+  }
+
+  const unsigned char * features = file.data() + header.features_offset;
+  const unsigned char * descriptors = file.data() + header.descriptors_offset;
+  if (FileChecksum(header, features, descriptors) != header.checksum)
+  {
+    std::cerr << "Corrupted regions file (invalid checksum): " << sfileNameRegions << std::endl;
+    return false;
+  }
+  return reader(header.region_count, features, descriptors);
+}
+
+} // namespace features
+} // namespace openMVG
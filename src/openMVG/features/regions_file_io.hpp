@@ -0,0 +1,208 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_FEATURES_REGIONS_FILE_IO_HPP
+#define OPENMVG_FEATURES_REGIONS_FILE_IO_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace openMVG {
+namespace features {
+
+/**
+* @brief Header of a binary regions file.
+* A regions file stores the regions of a view in a single file:
+* - the header,
+* - the keypoint array (one record of feature_size bytes per region),
+* - the descriptor array (descriptor_length values per region).
+* The arrays are 64 bytes aligned so that the file can be used from a memory mapping,
+* and the checksum (computed with a null checksum field) covers the header and the arrays.
+*/
+struct Regions_File_Header
+{
+  char magic[8];                    // "OMVG_RGN"
+  uint32_t version;
+  uint32_t header_size;             // sizeof(Regions_File_Header)
+  char type_id[16];                 // descriptor value type (Regions::Type_id())
+  uint64_t region_count;
+  uint32_t feature_size;            // keypoint record size (bytes)
+  uint32_t descriptor_length;       // number of values per descriptor
+  uint32_t descriptor_value_size;   // descriptor value size (bytes)
+  uint32_t is_binary;               // binary (1) or scalar (0) descriptors
+  uint64_t features_offset;
+  uint64_t descriptors_offset;
+  uint64_t checksum;
+};
+
+/// Fill a header describing the expected regions layout (counts, offsets and checksum are not set)
+Regions_File_Header MakeRegionsFileHeader
+(
+  const std::string & type_id,
+  bool is_binary,
+  uint32_t feature_size,
+  uint32_t descriptor_length,
+  uint32_t descriptor_value_size
+);
+
+/// Checksum of a memory block (64 bits, chained through the seed)
+uint64_t RegionsChecksum
+(
+  const void * data,
+  size_t size,
+  uint64_t seed = 0xcbf29ce484222325ULL
+);
+
+/// Write a regions file (the header counts, offsets and checksum are computed)
+bool WriteRegionsFile
+(
+  const std::string & sfileNameRegions,
+  Regions_File_Header header,
+  size_t region_count,
+  const void * features,
+  const void * descriptors
+);
+
+/// Map a regions file, check that its header matches the expected one and its checksum.
+/// The reader is called with the region count and the keypoint and descriptor arrays
+/// while the file is mapped.
+bool ReadRegionsFile
+(
+  const std::string & sfileNameRegions,
+  const Regions_File_Header & expected_header,
+  const std::function<bool(size_t, const unsigned char *, const unsigned char *)> & reader
+);
+
+// Archives used to store a keypoint as a flat record of floats (through its serialize method)
+struct Feature_Float_Writer
+{
+  std::vector<float> & buffer;
+  template <typename ... Args>
+  void operator()(const Args & ... args)
+  {
+    using expand = int[];
+    (void)expand{0, (buffer.push_back(static_cast<float>(args)), 0)...};
+  }
+};
+
+struct Feature_Float_Reader
+{
+  const unsigned char * data;
+  template <typename ... Args>
+  void operator()(Args & ... args)
+  {
+    using expand = int[];
+    (void)expand{0, (read(args), 0)...};
+  }
+private:
+  void read(float & value)
+  {
+    std::memcpy(&value, data, sizeof(float));
+    data += sizeof(float);
+  }
+};
+
+/// Keypoint record size (bytes) of a feature type
+template<typename FeatureT>
+uint32_t featureRecordSize()
+{
+  std::vector<float> buffer;
+  Feature_Float_Writer writer{buffer};
+  FeatureT feature;
+  feature.serialize(writer);
+  return static_cast<uint32_t>(buffer.size() * sizeof(float));
+}
+
+/// Write the regions and their descriptors to a binary regions file
+template<typename FeaturesT, typename DescriptorsT>
+bool saveRegionsToFile(
+  const std::string & sfileNameRegions,
+  const std::string & type_id,
+  bool is_binary,
+  const FeaturesT & vec_feats,
+  const DescriptorsT & vec_descs)
+{
+  using FeatureT = typename FeaturesT::value_type;
+  using DescriptorT = typename DescriptorsT::value_type;
+  using ValueT = typename DescriptorT::bin_type;
+  if (vec_feats.size() != vec_descs.size())
+    return false;
+
+  std::vector<float> features;
+  features.reserve(vec_feats.size() * featureRecordSize<FeatureT>() / sizeof(float));
+  Feature_Float_Writer writer{features};
+  for (FeatureT feature : vec_feats)
+    feature.serialize(writer);
+
+  // Pack the descriptors if the container adds some padding between them
+  const size_t descriptor_size = DescriptorT::static_size * sizeof(ValueT);
+  const void * descriptors = vec_descs.empty() ? nullptr : vec_descs[0].data();
+  std::vector<ValueT> packed_descriptors;
+  if (sizeof(DescriptorT) != descriptor_size)
+  {
+    packed_descriptors.resize(vec_descs.size() * DescriptorT::static_size);
+    for (size_t i = 0; i < vec_descs.size(); ++i)
+      std::memcpy(&packed_descriptors[i * DescriptorT::static_size], vec_descs[i].data(), descriptor_size);
+    descriptors = packed_descriptors.data();
+  }
+
+  const Regions_File_Header header = MakeRegionsFileHeader(
+    type_id, is_binary, featureRecordSize<FeatureT>(),
+    DescriptorT::static_size, sizeof(ValueT));
+  return WriteRegionsFile(sfileNameRegions, header, vec_feats.size(),
+    features.data(), descriptors);
+}
+
+/// Read the regions and their descriptors from a binary regions file
+template<typename FeaturesT, typename DescriptorsT>
+bool loadRegionsFromFile(
+  const std::string & sfileNameRegions,
+  const std::string & type_id,
+  bool is_binary,
+  FeaturesT & vec_feats,
+  DescriptorsT & vec_descs)
+{
+  using FeatureT = typename FeaturesT::value_type;
+  using DescriptorT = typename DescriptorsT::value_type;
+  using ValueT = typename DescriptorT::bin_type;
+
+  vec_feats.clear();
+  vec_descs.clear();
+  const Regions_File_Header header = MakeRegionsFileHeader(
+    type_id, is_binary, featureRecordSize<FeatureT>(),
+    DescriptorT::static_size, sizeof(ValueT));
+  return ReadRegionsFile(sfileNameRegions, header,
+    [&](size_t region_count, const unsigned char * features, const unsigned char * descriptors)
+    {
+      vec_feats.resize(region_count);
+      Feature_Float_Reader reader{features};
+      for (FeatureT & feature : vec_feats)
+        feature.serialize(reader);
+
+      const size_t descriptor_size = DescriptorT::static_size * sizeof(ValueT);
+      vec_descs.resize(region_count);
+      if (region_count > 0 && sizeof(DescriptorT) == descriptor_size)
+      {
+        std::memcpy(vec_descs[0].data(), descriptors, region_count * descriptor_size);
+      }
+      else
+      {
+        for (size_t i = 0; i < region_count; ++i)
+          std::memcpy(vec_descs[i].data(), descriptors + i * descriptor_size, descriptor_size);
+      }
+      return true;
+    });
+}
+
+} // namespace features
+} // namespace openMVG
+
+#endif // OPENMVG_FEATURES_REGIONS_FILE_IO_HPP
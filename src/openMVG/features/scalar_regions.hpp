@@ -13,6 +13,7 @@
 
 #include "openMVG/features/regions.hpp"
 #include "openMVG/features/descriptor.hpp"
+#include "openMVG/features/regions_file_io.hpp"
 #include "openMVG/matching/metric.hpp"
 
 namespace openMVG {
@@ -63,6 +64,18 @@ public:
           & saveDescsToBinFile(sfileNameDescs, vec_descs_);
   }
 
+  /// Read the regions and their descriptors from a binary regions file.
+  bool Load(const std::string& sfileNameRegions) override
+  {
+    return loadRegionsFromFile(sfileNameRegions, Type_id(), false, vec_feats_, vec_descs_);
+  }
+
+  /// Export the regions and their descriptors in a binary regions file.
+  bool Save(const std::string& sfileNameRegions) const override
+  {
+    return saveRegionsToFile(sfileNameRegions, Type_id(), false, vec_feats_, vec_descs_);
+  }
+
   bool LoadFeatures(const std::string& sfileNameFeats) override
   {
     return loadFeatsFromFile(sfileNameFeats, vec_feats_);
@@ -0,0 +1,163 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_IMAGE_IMAGE_CACHE_HPP
+#define OPENMVG_IMAGE_IMAGE_CACHE_HPP
+
+#include "openMVG/image/image_container.hpp"
+#include "openMVG/image/image_io.hpp"
+
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace openMVG
+{
+namespace image
+{
+
+/**
+* @brief Thread safe cache of decoded images (indexed by their filename).
+* - the cache memory is bounded: the least recently used images are released first,
+* - an image returned by the cache stays valid while it is used (shared pointer),
+* - an image requested concurrently by several threads is decoded only once.
+*/
+template <typename PixelT>
+class Image_Cache
+{
+public:
+
+  using ImagePtr = std::shared_ptr<const Image<PixelT>>;
+
+  /**
+  * @brief Constructor
+  * @param max_memory_size Memory budget of the cached images (in bytes)
+  */
+  explicit Image_Cache( const size_t max_memory_size )
+    : max_memory_size_( max_memory_size ),
+      memory_size_( 0 )
+  {
+  }
+
+  /**
+  * @brief Get a decoded image
+  * @param filename Path of the image
+  * @return The image (nullptr if the image cannot be read)
+  */
+  ImagePtr get( const std::string & filename )
+  {
+    std::promise<ImagePtr> promise;
+    std::shared_future<ImagePtr> future;
+    bool b_load = false;
+    {
+      std::lock_guard<std::mutex> lock( mutex_ );
+      const auto it = cache_.find( filename );
+      if ( it != cache_.end() )
+      {
+        // Move the image in front of the LRU list
+        lru_.splice( lru_.begin(), lru_, it->second.lru_it );
+        future = it->second.image;
+      }
+      else
+      {
+        future = promise.get_future().share();
+        lru_.push_front( filename );
+        cache_[filename] = {future, lru_.begin(), 0};
+        b_load = true;
+      }
+    }
+
+    if ( b_load )
+    {
+      // Decode the image outside of the lock
+      std::shared_ptr<Image<PixelT>> image = std::make_shared<Image<PixelT>>();
+      if ( !ReadImage( filename.c_str(), image.get() ) )
+      {
+        image.reset();
+      }
+      promise.set_value( image );
+
+      std::lock_guard<std::mutex> lock( mutex_ );
+      const auto it = cache_.find( filename );
+      if ( it != cache_.end() )
+      {
+        if ( image )
+        {
+          it->second.memory_size =
+            static_cast<size_t>( image->Width() ) * image->Height() * sizeof( PixelT );
+          memory_size_ += it->second.memory_size;
+        }
+        else // Invalid image, the next request will try to read it again
+        {
+          lru_.erase( it->second.lru_it );
+          cache_.erase( it );
+        }
+      }
+      prune();
+    }
+    return future.get();
+  }
+
+  /// Memory used by the cached images (in bytes)
+  size_t memory_size() const
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return memory_size_;
+  }
+
+  /// Number of cached images
+  size_t size() const
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return cache_.size();
+  }
+
+  /// Release all the cached images
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    cache_.clear();
+    lru_.clear();
+    memory_size_ = 0;
+  }
+
+private:
+
+  /// Release the least recently used images (the most recent image is kept)
+  void prune()
+  {
+    while ( memory_size_ > max_memory_size_ && lru_.size() > 1 )
+    {
+      const auto it = cache_.find( lru_.back() );
+      memory_size_ -= it->second.memory_size;
+      cache_.erase( it );
+      lru_.pop_back();
+    }
+  }
+
+  struct Cache_Entry
+  {
+    std::shared_future<ImagePtr> image;
+    std::list<std::string>::iterator lru_it;
+    size_t memory_size; // 0 while the image is being decoded
+  };
+
+  mutable std::mutex mutex_;
+  const size_t max_memory_size_;
+  size_t memory_size_;
+  std::map<std::string, Cache_Entry> cache_;
+  std::list<std::string> lru_; // Most recently used image first
+};
+
+} // namespace image
+} // namespace openMVG
+
+#endif // OPENMVG_IMAGE_IMAGE_CACHE_HPP
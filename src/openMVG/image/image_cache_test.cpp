@@ -0,0 +1,90 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/image/image_cache.hpp"
+
+#include "testing/testing.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace openMVG;
+using namespace openMVG::image;
+
+TEST(Image_Cache, LRU)
+{
+  // Three 10x10 images, the cache can store two of them
+  const std::vector<std::string> filenames =
+    {"image_cache_0.pgm", "image_cache_1.pgm", "image_cache_2.pgm"};
+  for (size_t i = 0; i < filenames.size(); ++i)
+  {
+    Image<unsigned char> image(10, 10, true, static_cast<unsigned char>(i));
+    EXPECT_TRUE(WriteImage(filenames[i].c_str(), image));
+  }
+  Image_Cache<unsigned char> cache(2 * 10 * 10);
+
+  const Image_Cache<unsigned char>::ImagePtr image_0 = cache.get(filenames[0]);
+  EXPECT_TRUE(image_0 != nullptr);
+  EXPECT_EQ(0, (*image_0)(5, 5));
+  // A cached image is not decoded again
+  EXPECT_EQ(image_0.get(), cache.get(filenames[0]).get());
+  EXPECT_EQ(1, cache.size());
+
+  EXPECT_EQ(1, (*cache.get(filenames[1]))(5, 5));
+  EXPECT_EQ(image_0.get(), cache.get(filenames[0]).get());
+  EXPECT_EQ(200, cache.memory_size());
+
+  // The least recently used image (1) is released
+  EXPECT_EQ(2, (*cache.get(filenames[2]))(5, 5));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(200, cache.memory_size());
+  EXPECT_EQ(image_0.get(), cache.get(filenames[0]).get());
+
+  // An image in use stays valid when it is released by the cache
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(0, (*image_0)(5, 5));
+
+  // Invalid image
+  EXPECT_TRUE(cache.get("image_cache_missing.pgm") == nullptr);
+  EXPECT_EQ(0, cache.size());
+
+  for (const std::string & filename : filenames)
+  {
+    EXPECT_EQ(0, std::remove(filename.c_str()));
+  }
+}
+
+TEST(Image_Cache, Concurrent_Access)
+{
+  const std::string filename = "image_cache_concurrent.pgm";
+  EXPECT_TRUE(WriteImage(filename.c_str(), Image<unsigned char>(10, 10, true, 7)));
+  Image_Cache<unsigned char> cache(1000);
+
+  // All the threads must share the same decoded image
+  const int request_count = 64;
+  std::vector<const Image<unsigned char> *> images(request_count);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for
+#endif
+  for (int i = 0; i < request_count; ++i)
+  {
+    images[i] = cache.get(filename).get();
+  }
+  for (const Image<unsigned char> * image : images)
+  {
+    EXPECT_EQ(images[0], image);
+  }
+  EXPECT_EQ(7, (*images[0])(2, 2));
+  EXPECT_EQ(0, std::remove(filename.c_str()));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -0,0 +1,461 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_MATCHING_MATCHER_HNSW_HPP
+#define OPENMVG_MATCHING_MATCHER_HNSW_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "openMVG/matching/matcher_type.hpp"
+#include "openMVG/matching/matching_interface.hpp"
+#include "openMVG/matching/metric.hpp"
+
+namespace openMVG {
+namespace matching {
+
+/**
+ * Approximate nearest neighbor search with a Hierarchical Navigable Small World graph.
+ * - the graph is built once from the dataset (in parallel),
+ * - the queries are answered in parallel by a greedy search from the top layer,
+ *   followed by a best first search of ef_search candidates on the base layer.
+ * Reference: [1] "Efficient and robust approximate nearest neighbor search using
+ *  Hierarchical Navigable Small World graphs."
+ * Authors: Yu. A. Malkov, D. A. Yashunin.
+ * Date: 2016.
+ * Journal: IEEE Transactions on Pattern Analysis and Machine Intelligence.
+ */
+// By default compute square(L2 distance).
+template < typename Scalar = float, typename Metric = L2<Scalar> >
+class ArrayMatcher_HNSW : public ArrayMatcher<Scalar, Metric>
+{
+  public:
+  using DistanceType = typename Metric::ResultType;
+
+  explicit ArrayMatcher_HNSW(const HNSW_Params & params = HNSW_Params())
+    :params_(params)
+  {
+    params_.M = std::max(2, params_.M);
+  }
+  virtual ~ArrayMatcher_HNSW() = default;
+
+  /// Change the size of the candidate list used for the queries
+  void SetEfSearch(int ef_search) { params_.ef_search = ef_search; }
+
+  /**
+   * Build the matching structure
+   *
+   * \param[in] dataset   Input data.
+   * \param[in] nbRows    The number of component.
+   * \param[in] dimension Length of the data contained in the dataset.
+   *
+   * \return True if success.
+   */
+  bool Build
+  (
+    const Scalar * dataset,
+    int nbRows,
+    int dimension
+  ) override
+  {
+    dataset_ = nullptr;
+    links_.clear();
+    if (nbRows < 1 || dimension < 1)
+      return false;
+    dataset_ = dataset;
+    nb_rows_ = nbRows;
+    dimension_ = dimension;
+
+    // Draw the node levels (exponentially decaying probability)
+    std::mt19937 random_generator(std::mt19937::default_seed);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    const double level_factor = 1.0 / std::log(static_cast<double>(params_.M));
+    links_.resize(nb_rows_);
+    for (auto & node_links : links_)
+    {
+      const int level = static_cast<int>(
+        -std::log(std::max(distribution(random_generator), 1e-12)) * level_factor);
+      node_links.resize(level + 1);
+    }
+    node_mutexes_.reset(new std::mutex[nb_rows_]);
+
+    // Insert the nodes: the first one is the initial entry point
+    entry_point_ = 0;
+    max_level_ = Level(0);
+    b_building_ = true;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel
+#endif
+    {
+      Search_Buffers buffers(nb_rows_);
+#ifdef OPENMVG_USE_OPENMP
+      #pragma omp for schedule(dynamic, 64)
+#endif
+      for (int i = 1; i < nb_rows_; ++i)
+      {
+        Insert(i, buffers);
+      }
+    }
+    b_building_ = false;
+    return true;
+  };
+
+  /**
+   * Search the nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array.
+   * \param[out]  indice    The indice of array in the dataset that.
+   *  have been computed as the nearest array.
+   * \param[out]  distance  The distance between the two arrays.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbour
+  (
+    const Scalar * query,
+    int * indice,
+    DistanceType * distance
+  ) override
+  {
+    IndMatches vec_index;
+    std::vector<DistanceType> vec_distance;
+    if (!SearchNeighbours(query, 1, &vec_index, &vec_distance, 1))
+      return false;
+    indice[0] = vec_index[0].j_;
+    distance[0] = vec_distance[0];
+    return true;
+  }
+
+  /**
+   * Search the N nearest Neighbor of the scalar array query.
+   *
+   * \param[in]   query     The query array.
+   * \param[in]   nbQuery   The number of query rows.
+   * \param[out]  indices   The corresponding (query, neighbor) indices.
+   * \param[out]  distances The distances between the matched arrays.
+   * \param[in]  NN        The number of maximal neighbor that will be searched.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbours
+  (
+    const Scalar * query, int nbQuery,
+    IndMatches * pvec_indices,
+    std::vector<DistanceType> * pvec_distances,
+    size_t NN
+  ) override
+  {
+    if (!dataset_ || NN > static_cast<size_t>(nb_rows_) || nbQuery < 1)
+    {
+      return false;
+    }
+
+    pvec_distances->resize(nbQuery * NN);
+    pvec_indices->resize(nbQuery * NN);
+
+    const size_t ef = std::max(NN, static_cast<size_t>(params_.ef_search));
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel
+#endif
+    {
+      Search_Buffers buffers(nb_rows_);
+      std::vector<Candidate> neighbors;
+#ifdef OPENMVG_USE_OPENMP
+      #pragma omp for schedule(dynamic, 64)
+#endif
+      for (int queryIndex = 0; queryIndex < nbQuery; ++queryIndex)
+      {
+        const Scalar * queryPtr = query + static_cast<size_t>(queryIndex) * dimension_;
+        const int entry_point = GreedySearch(queryPtr, entry_point_, max_level_, 1, buffers);
+        SearchLayer(queryPtr, entry_point, 0, ef, buffers, neighbors);
+
+        // neighbors are sorted by increasing distance
+        for (size_t i = 0; i < NN; ++i)
+        {
+          const bool b_valid = i < neighbors.size();
+          (*pvec_distances)[queryIndex * NN + i] =
+            b_valid ? neighbors[i].first : std::numeric_limits<DistanceType>::max();
+          (*pvec_indices)[queryIndex * NN + i] =
+            IndMatch(queryIndex, b_valid ? neighbors[i].second : neighbors[0].second);
+        }
+      }
+    }
+    return true;
+  };
+
+private:
+
+  using Candidate = std::pair<DistanceType, int>; // (distance, node)
+
+  /// Per thread search data
+  struct Search_Buffers
+  {
+    explicit Search_Buffers(int nb_nodes) : visited(nb_nodes, 0) {}
+    std::vector<uint32_t> visited; // visit tag of the nodes
+    uint32_t tag = 0;
+    std::vector<int> links;
+  };
+
+  int Level(int node) const
+  {
+    return static_cast<int>(links_[node].size()) - 1;
+  }
+
+  size_t MaxLinks(int level) const
+  {
+    return static_cast<size_t>(level == 0 ? 2 * params_.M : params_.M);
+  }
+
+  DistanceType Distance(const Scalar * query, int node) const
+  {
+    return metric_(query, dataset_ + static_cast<size_t>(node) * dimension_, dimension_);
+  }
+
+  DistanceType Distance(int node_a, int node_b) const
+  {
+    return Distance(dataset_ + static_cast<size_t>(node_a) * dimension_, node_b);
+  }
+
+  /// Copy the links of a node (locked while the graph is built)
+  void GetLinks(int node, int level, std::vector<int> & links) const
+  {
+    if (b_building_)
+    {
+      std::lock_guard<std::mutex> lock(node_mutexes_[node]);
+      links = links_[node][level];
+    }
+    else
+    {
+      links = links_[node][level];
+    }
+  }
+
+  /// Greedy descent from the top level to the target level (one candidate per level)
+  int GreedySearch
+  (
+    const Scalar * query,
+    int entry_point,
+    int top_level,
+    int target_level,
+    Search_Buffers & buffers
+  ) const
+  {
+    int current = entry_point;
+    DistanceType current_distance = Distance(query, current);
+    for (int level = top_level; level >= target_level; --level)
+    {
+      bool b_changed = true;
+      while (b_changed)
+      {
+        b_changed = false;
+        GetLinks(current, level, buffers.links);
+        for (const int neighbor : buffers.links)
+        {
+          const DistanceType distance = Distance(query, neighbor);
+          if (distance < current_distance)
+          {
+            current_distance = distance;
+            current = neighbor;
+            b_changed = true;
+          }
+        }
+      }
+    }
+    return current;
+  }
+
+  /// Best first search of the ef nearest nodes on a level (result sorted by increasing distance)
+  void SearchLayer
+  (
+    const Scalar * query,
+    int entry_point,
+    int level,
+    size_t ef,
+    Search_Buffers & buffers,
+    std::vector<Candidate> & result
+  ) const
+  {
+    if (++buffers.tag == 0) // tag overflow, reset the visited nodes
+    {
+      std::fill(buffers.visited.begin(), buffers.visited.end(), 0);
+      buffers.tag = 1;
+    }
+
+    // candidates to expand (closest first) and best found nodes (farthest first)
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    std::priority_queue<Candidate> best;
+    const Candidate entry(Distance(query, entry_point), entry_point);
+    candidates.push(entry);
+    best.push(entry);
+    buffers.visited[entry_point] = buffers.tag;
+
+    while (!candidates.empty())
+    {
+      const Candidate current = candidates.top();
+      if (current.first > best.top().first && best.size() >= ef)
+        break;
+      candidates.pop();
+
+      GetLinks(current.second, level, buffers.links);
+      for (const int neighbor : buffers.links)
+      {
+        if (buffers.visited[neighbor] == buffers.tag)
+          continue;
+        buffers.visited[neighbor] = buffers.tag;
+        const DistanceType distance = Distance(query, neighbor);
+        if (best.size() < ef || distance < best.top().first)
+        {
+          candidates.emplace(distance, neighbor);
+          best.emplace(distance, neighbor);
+          if (best.size() > ef)
+            best.pop();
+        }
+      }
+    }
+
+    result.resize(best.size());
+    for (size_t i = best.size(); i > 0; --i)
+    {
+      result[i - 1] = best.top();
+      best.pop();
+    }
+  }
+
+  /// Keep at most max_links diverse neighbors of a node among some candidates sorted by
+  ///  increasing distance: a candidate is kept if it is closer to the node than to any
+  ///  already kept neighbor (the node itself is never kept).
+  void SelectNeighbors
+  (
+    int node,
+    const std::vector<Candidate> & candidates,
+    size_t max_links,
+    std::vector<int> & neighbors
+  ) const
+  {
+    neighbors.clear();
+    for (const Candidate & candidate : candidates)
+    {
+      if (neighbors.size() >= max_links)
+        break;
+      if (candidate.second == node)
+        continue;
+      bool b_keep = true;
+      for (const int neighbor : neighbors)
+      {
+        if (Distance(candidate.second, neighbor) < candidate.first)
+        {
+          b_keep = false;
+          break;
+        }
+      }
+      if (b_keep)
+        neighbors.push_back(candidate.second);
+    }
+  }
+
+  /// Reduce the links of a node to at most max_links diverse neighbors
+  ///  (the node mutex must be locked)
+  void ShrinkLinks(int node, size_t max_links, std::vector<int> & links) const
+  {
+    std::vector<Candidate> candidates;
+    candidates.reserve(links.size());
+    for (const int link : links)
+      candidates.emplace_back(Distance(link, node), link);
+    std::sort(candidates.begin(), candidates.end());
+    std::vector<int> kept_links;
+    SelectNeighbors(node, candidates, max_links, kept_links);
+    links.swap(kept_links);
+  }
+
+  /// Add a link to a node if it is not already present (the node mutex must be locked)
+  static bool AddLink(std::vector<int> & links, int link)
+  {
+    if (std::find(links.begin(), links.end(), link) != links.end())
+      return false;
+    links.push_back(link);
+    return true;
+  }
+
+  /// Add a node to the graph
+  void Insert(int node, Search_Buffers & buffers)
+  {
+    const Scalar * query = dataset_ + static_cast<size_t>(node) * dimension_;
+    const int level = Level(node);
+
+    // A node above the current top level becomes the entry point
+    // (the global lock is kept during its insertion)
+    std::unique_lock<std::mutex> global_lock(global_mutex_);
+    const int top_level = max_level_;
+    int entry_point = entry_point_;
+    if (level <= top_level)
+      global_lock.unlock();
+
+    if (top_level > level)
+      entry_point = GreedySearch(query, entry_point, top_level, level + 1, buffers);
+
+    std::vector<Candidate> candidates;
+    std::vector<int> neighbors;
+    for (int l = std::min(level, top_level); l >= 0; --l)
+    {
+      SearchLayer(query, entry_point, l, params_.ef_construction, buffers, candidates);
+      SelectNeighbors(node, candidates, static_cast<size_t>(params_.M), neighbors);
+      {
+        // Other threads may already have added reverse links to this node on this level:
+        //  merge them with the selected neighbors
+        std::lock_guard<std::mutex> lock(node_mutexes_[node]);
+        std::vector<int> & node_links = links_[node][l];
+        for (const int neighbor : neighbors)
+          AddLink(node_links, neighbor);
+        if (node_links.size() > MaxLinks(l))
+          ShrinkLinks(node, MaxLinks(l), node_links);
+      }
+      // Add the reverse links (shrink the neighbor lists that are full)
+      for (const int neighbor : neighbors)
+      {
+        std::lock_guard<std::mutex> lock(node_mutexes_[neighbor]);
+        std::vector<int> & neighbor_links = links_[neighbor][l];
+        if (AddLink(neighbor_links, node) && neighbor_links.size() > MaxLinks(l))
+          ShrinkLinks(neighbor, MaxLinks(l), neighbor_links);
+      }
+      entry_point = candidates.front().second;
+    }
+
+    if (level > top_level)
+    {
+      entry_point_ = node;
+      max_level_ = level;
+    }
+  }
+
+  HNSW_Params params_;
+  Metric metric_;
+  const Scalar * dataset_ = nullptr;
+  int nb_rows_ = 0;
+  int dimension_ = 0;
+  /// links_[node][level]: neighbors of a node on a level
+  std::vector<std::vector<std::vector<int>>> links_;
+  std::unique_ptr<std::mutex[]> node_mutexes_;
+  std::mutex global_mutex_;
+  int entry_point_ = 0;
+  int max_level_ = 0;
+  bool b_building_ = false;
+};
+
+}  // namespace matching
+}  // namespace openMVG
+
+#endif  // OPENMVG_MATCHING_MATCHER_HNSW_HPP
@@ -0,0 +1,231 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_MATCHING_MATCHER_PRODUCT_QUANTIZATION_HPP
+#define OPENMVG_MATCHING_MATCHER_PRODUCT_QUANTIZATION_HPP
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "openMVG/features/product_quantizer.hpp"
+#include "openMVG/matching/matching_interface.hpp"
+#include "openMVG/matching/metric.hpp"
+
+namespace openMVG {
+namespace matching {
+
+/**
+ * Nearest neighbor search on product quantized descriptors (codes).
+ * The database is a set of codes of a collection codebook (not copied: the codes must
+ * outlive the matcher, as for the brute force matcher). A query is compared to all
+ * the codes with the asymmetric distance (ADC), from its table of M x 256 distances
+ * to the centroids:
+ * - a full precision query gives the asymmetric distance of [1],
+ * - a query given by its code is decoded first (its table is then the one of its
+ *   centroids: the distance approximates both descriptors).
+ * The full precision descriptors are never needed, the distances are squared L2.
+ * Reference: [1] "Product quantization for nearest neighbor search."
+ * Authors: Herve Jegou, Matthijs Douze, Cordelia Schmid.
+ * Date: 2011.
+ * Journal: IEEE Transactions on Pattern Analysis and Machine Intelligence.
+ */
+class ArrayMatcher_Product_Quantization : public ArrayMatcher<unsigned char, L2<float>>
+{
+  public:
+  using DistanceType = float;
+
+  explicit ArrayMatcher_Product_Quantization
+  (
+    std::shared_ptr<const features::Product_Quantizer> quantizer = nullptr
+  ):quantizer_(quantizer)
+  {}
+  virtual ~ArrayMatcher_Product_Quantization() = default;
+
+  /**
+   * Build the matching structure
+   *
+   * \param[in] dataset   Input codes.
+   * \param[in] nbRows    The number of codes.
+   * \param[in] dimension Length of a code (number of sub-vectors of the codebook).
+   *
+   * \return True if success.
+   */
+  bool Build
+  (
+    const unsigned char * dataset,
+    int nbRows,
+    int dimension
+  ) override
+  {
+    codes_ = nullptr;
+    nb_rows_ = 0;
+    if (!quantizer_ || !quantizer_->IsTrained() || nbRows < 1
+        || dimension != quantizer_->SubspaceCount())
+      return false;
+    codes_ = dataset;
+    nb_rows_ = nbRows;
+    return true;
+  }
+
+  /**
+   * Search the nearest Neighbor of the query code.
+   *
+   * \param[in]   query     The query code.
+   * \param[out]  indice    The indice of the code in the dataset that
+   *  have been computed as the nearest one.
+   * \param[out]  distance  The distance between the two descriptors.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbour
+  (
+    const unsigned char * query,
+    int * indice,
+    DistanceType * distance
+  ) override
+  {
+    IndMatches vec_index;
+    std::vector<DistanceType> vec_distance;
+    if (!SearchNeighbours(query, 1, &vec_index, &vec_distance, 1))
+      return false;
+    indice[0] = vec_index[0].j_;
+    distance[0] = vec_distance[0];
+    return true;
+  }
+
+  /**
+   * Search the N nearest Neighbor of the query codes.
+   *
+   * \param[in]   query     The query codes.
+   * \param[in]   nbQuery   The number of query codes.
+   * \param[out]  indices   The corresponding (query, neighbor) indices.
+   * \param[out]  distances The distances between the matched descriptors.
+   * \param[in]  NN        The number of maximal neighbor that will be searched.
+   *
+   * \return True if success.
+   */
+  bool SearchNeighbours
+  (
+    const unsigned char * query, int nbQuery,
+    IndMatches * pvec_indices,
+    std::vector<DistanceType> * pvec_distances,
+    size_t NN
+  ) override
+  {
+    return Search(nbQuery, pvec_indices, pvec_distances, NN,
+      [&](int queryIndex, std::vector<float> & descriptor, std::vector<float> & table)
+      {
+        descriptor.resize(quantizer_->Dimension());
+        quantizer_->Decode(query + static_cast<size_t>(queryIndex) * quantizer_->SubspaceCount(),
+          descriptor.data());
+        quantizer_->DistanceTable(descriptor.data(), table);
+      });
+  }
+
+  /**
+   * Search the N nearest Neighbor of full precision query descriptors.
+   *
+   * \param[in]   query     The query descriptors (codebook dimension values each).
+   * \param[in]   nbQuery   The number of query descriptors.
+   * \param[out]  indices   The corresponding (query, neighbor) indices.
+   * \param[out]  distances The distances between the matched descriptors.
+   * \param[in]  NN        The number of maximal neighbor that will be searched.
+   *
+   * \return True if success.
+   */
+  template <typename Scalar>
+  bool SearchNeighbours_ADC
+  (
+    const Scalar * query, int nbQuery,
+    IndMatches * pvec_indices,
+    std::vector<DistanceType> * pvec_distances,
+    size_t NN
+  )
+  {
+    return Search(nbQuery, pvec_indices, pvec_distances, NN,
+      [&](int queryIndex, std::vector<float> &, std::vector<float> & table)
+      {
+        quantizer_->DistanceTable(
+          query + static_cast<size_t>(queryIndex) * quantizer_->Dimension(), table);
+      });
+  }
+
+private:
+
+  /// Scan all the codes for each query (its distance table is given by compute_table)
+  template <typename TableFunctor>
+  bool Search
+  (
+    int nbQuery,
+    IndMatches * pvec_indices,
+    std::vector<DistanceType> * pvec_distances,
+    size_t NN,
+    const TableFunctor & compute_table
+  ) const
+  {
+    if (!codes_ || NN > static_cast<size_t>(nb_rows_) || nbQuery < 1)
+    {
+      return false;
+    }
+
+    pvec_distances->resize(nbQuery * NN);
+    pvec_indices->resize(nbQuery * NN);
+
+    const int code_size = quantizer_->SubspaceCount();
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel
+#endif
+    {
+      std::vector<float> descriptor, table;
+      // Sorted (distance, index) neighbors
+      std::vector<std::pair<DistanceType, int>> neighbors;
+      neighbors.reserve(NN + 1);
+#ifdef OPENMVG_USE_OPENMP
+      #pragma omp for schedule(dynamic, 64)
+#endif
+      for (int queryIndex = 0; queryIndex < nbQuery; ++queryIndex)
+      {
+        compute_table(queryIndex, descriptor, table);
+
+        neighbors.clear();
+        const unsigned char * code = codes_;
+        for (int i = 0; i < nb_rows_; ++i, code += code_size)
+        {
+          const DistanceType distance = quantizer_->AsymmetricDistance(table.data(), code);
+          if (neighbors.size() < NN || distance < neighbors.back().first)
+          {
+            const auto it = std::upper_bound(neighbors.begin(), neighbors.end(),
+              std::make_pair(distance, i));
+            neighbors.insert(it, std::make_pair(distance, i));
+            if (neighbors.size() > NN)
+              neighbors.pop_back();
+          }
+        }
+
+        for (size_t i = 0; i < NN; ++i)
+        {
+          (*pvec_distances)[queryIndex * NN + i] = neighbors[i].first;
+          (*pvec_indices)[queryIndex * NN + i] = IndMatch(queryIndex, neighbors[i].second);
+        }
+      }
+    }
+    return true;
+  }
+
+  std::shared_ptr<const features::Product_Quantizer> quantizer_;
+  const unsigned char * codes_ = nullptr; // nb_rows x nb_subspaces codes
+  int nb_rows_ = 0;
+};
+
+}  // namespace matching
+}  // namespace openMVG
+
+#endif  // OPENMVG_MATCHING_MATCHER_PRODUCT_QUANTIZATION_HPP
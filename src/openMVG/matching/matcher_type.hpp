@@ -17,7 +17,20 @@ enum EMatcherType : unsigned char
   BRUTE_FORCE_L2,
   ANN_L2,
   CASCADE_HASHING_L2,
-  BRUTE_FORCE_HAMMING
+  BRUTE_FORCE_HAMMING,
+  HNSW_L2,
+  PRODUCT_QUANTIZATION_L2 // ADC on the product quantized regions (PQ_Regions)
+};
+
+/// Parameters of the HNSW_L2 matcher graph
+struct HNSW_Params
+{
+  /// Number of links per node on the upper layers (2*M on the base layer)
+  int M = 16;
+  /// Size of the candidate list used while building the graph
+  int ef_construction = 100;
+  /// Size of the candidate list used for the queries (>= number of searched neighbors)
+  int ef_search = 64;
 };
 
 } // namespace matching
@@ -10,7 +10,9 @@
 
 #include "openMVG/matching/matcher_brute_force.hpp"
 #include "openMVG/matching/matcher_cascade_hashing.hpp"
+#include "openMVG/matching/matcher_hnsw.hpp"
 #include "openMVG/matching/matcher_kdtree_flann.hpp"
+#include "openMVG/matching/matcher_product_quantization.hpp"
 
 #include "openMVG/numeric/eigen_alias_definition.hpp"
 
@@ -18,6 +20,7 @@
 #include "testing/testing.h"
 
 #include <iostream>
+#include <random>
 using namespace std;
 
 using namespace openMVG;
@@ -150,6 +153,160 @@ TEST(Matching, Cascade_Hashing_Simple_EmptyArrays)
   EXPECT_FALSE( matcher.SearchNeighbour(nullptr, &nIndice, &fDistance) );
 }
 
+TEST(Matching, ArrayMatcher_HNSW_Simple_EmptyArrays)
+{
+  ArrayMatcher_HNSW<float> matcher;
+  EXPECT_FALSE( matcher.Build(nullptr, 0, 4) );
+
+  int nIndice = -1;
+  float fDistance = -1.0f;
+  EXPECT_FALSE( matcher.SearchNeighbour(nullptr, &nIndice, &fDistance) );
+}
+
+TEST(Matching, ArrayMatcher_HNSW_NN)
+{
+  // Random dataset and queries
+  const int nb_rows = 5000, nb_queries = 1000, dimension = 16;
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<float> value_distribution(0.f, 1.f);
+  std::vector<float> dataset(nb_rows * dimension), queries(nb_queries * dimension);
+  for (float & value : dataset)
+    value = value_distribution(random_generator);
+  for (float & value : queries)
+    value = value_distribution(random_generator);
+
+  ArrayMatcher_HNSW<float> matcher;
+  EXPECT_TRUE( matcher.Build(&dataset[0], nb_rows, dimension) );
+  ArrayMatcherBruteForce<float> matcher_brute_force;
+  EXPECT_TRUE( matcher_brute_force.Build(&dataset[0], nb_rows, dimension) );
+
+  IndMatches vec_nIndice, vec_nIndice_brute_force;
+  vector<float> vec_Distance, vec_Distance_brute_force;
+  EXPECT_TRUE( matcher.SearchNeighbours(&queries[0], nb_queries, &vec_nIndice, &vec_Distance, 2) );
+  EXPECT_TRUE( matcher_brute_force.SearchNeighbours(&queries[0], nb_queries,
+    &vec_nIndice_brute_force, &vec_Distance_brute_force, 2) );
+  EXPECT_EQ( 2 * nb_queries, vec_nIndice.size());
+
+  // Most of the nearest neighbors are found
+  int nb_found = 0;
+  for (int i = 0; i < nb_queries; ++i)
+  {
+    EXPECT_EQ( i, vec_nIndice[2*i].i_ );
+    if (vec_nIndice[2*i].j_ == vec_nIndice_brute_force[2*i].j_)
+    {
+      ++nb_found;
+      EXPECT_NEAR( vec_Distance_brute_force[2*i], vec_Distance[2*i], 1e-6 );
+    }
+    EXPECT_TRUE( vec_Distance[2*i] <= vec_Distance[2*i+1] );
+  }
+  EXPECT_TRUE( nb_found > 0.95 * nb_queries );
+
+  // A larger search list improves the recall
+  matcher.SetEfSearch(256);
+  EXPECT_TRUE( matcher.SearchNeighbours(&queries[0], nb_queries, &vec_nIndice, &vec_Distance, 2) );
+  int nb_found_ef = 0;
+  for (int i = 0; i < nb_queries; ++i)
+  {
+    if (vec_nIndice[2*i].j_ == vec_nIndice_brute_force[2*i].j_)
+      ++nb_found_ef;
+  }
+  EXPECT_TRUE( nb_found_ef >= nb_found );
+}
+
+TEST(Matching, ArrayMatcher_Product_Quantization_Simple_EmptyArrays)
+{
+  // No codebook
+  ArrayMatcher_Product_Quantization matcher;
+  EXPECT_FALSE( matcher.Build(nullptr, 0, 16) );
+
+  // Untrained codebook
+  ArrayMatcher_Product_Quantization matcher_untrained(
+    std::make_shared<features::Product_Quantizer>());
+  EXPECT_FALSE( matcher_untrained.Build(nullptr, 0, 16) );
+
+  int nIndice = -1;
+  float fDistance = -1.0f;
+  EXPECT_FALSE( matcher.SearchNeighbour(nullptr, &nIndice, &fDistance) );
+}
+
+TEST(Matching, ArrayMatcher_Product_Quantization_NN)
+{
+  // Dataset of descriptors scattered around some centers,
+  //  the queries are some other descriptors of the same clusters
+  const int nb_centers = 100, nb_per_center = 10, dimension = 128, code_size = 16;
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<float> value_distribution(0.f, 255.f);
+  std::normal_distribution<float> noise_distribution(0.f, 2.f);
+  Eigen::MatrixXf dataset(nb_centers * nb_per_center, dimension), queries(nb_centers, dimension);
+  for (int c = 0; c < nb_centers; ++c)
+  {
+    Eigen::RowVectorXf center(dimension);
+    for (int j = 0; j < dimension; ++j)
+      center[j] = value_distribution(random_generator);
+    for (int i = 0; i < nb_per_center; ++i)
+      for (int j = 0; j < dimension; ++j)
+        dataset(c * nb_per_center + i, j) = center[j] + noise_distribution(random_generator);
+    for (int j = 0; j < dimension; ++j)
+      queries(c, j) = center[j] + noise_distribution(random_generator);
+  }
+
+  // Collection codebook
+  auto quantizer = std::make_shared<features::Product_Quantizer>();
+  EXPECT_TRUE( quantizer->Train(dataset, code_size) );
+  std::vector<unsigned char> codes(dataset.rows() * code_size), query_codes(nb_centers * code_size);
+  for (int i = 0; i < dataset.rows(); ++i)
+  {
+    const Eigen::VectorXf descriptor = dataset.row(i).transpose();
+    quantizer->Encode(descriptor.data(), &codes[i * code_size]);
+  }
+  for (int i = 0; i < nb_centers; ++i)
+  {
+    const Eigen::VectorXf descriptor = queries.row(i).transpose();
+    quantizer->Encode(descriptor.data(), &query_codes[i * code_size]);
+  }
+
+  ArrayMatcher_Product_Quantization matcher(quantizer);
+  EXPECT_FALSE( matcher.Build(&codes[0], dataset.rows(), code_size + 1) );
+  EXPECT_TRUE( matcher.Build(&codes[0], dataset.rows(), code_size) );
+
+  // Query by codes and by full precision descriptors (ADC)
+  const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> queries_row_major = queries;
+  IndMatches vec_nIndice, vec_nIndice_adc;
+  vector<float> vec_Distance, vec_Distance_adc;
+  EXPECT_TRUE( matcher.SearchNeighbours(&query_codes[0], nb_centers, &vec_nIndice, &vec_Distance, 2) );
+  EXPECT_TRUE( matcher.SearchNeighbours_ADC(queries_row_major.data(), nb_centers,
+    &vec_nIndice_adc, &vec_Distance_adc, 2) );
+  EXPECT_EQ( 2 * nb_centers, vec_nIndice.size());
+  EXPECT_EQ( 2 * nb_centers, vec_nIndice_adc.size());
+
+  // The two nearest neighbors are in the cluster of the query
+  for (int i = 0; i < nb_centers; ++i)
+  {
+    for (int k = 0; k < 2; ++k)
+    {
+      EXPECT_EQ( i, vec_nIndice[2*i+k].i_ );
+      EXPECT_EQ( i, vec_nIndice[2*i+k].j_ / nb_per_center );
+      EXPECT_EQ( i, vec_nIndice_adc[2*i+k].i_ );
+      EXPECT_EQ( i, vec_nIndice_adc[2*i+k].j_ / nb_per_center );
+    }
+    EXPECT_TRUE( vec_Distance[2*i] <= vec_Distance[2*i+1] );
+    EXPECT_TRUE( vec_Distance_adc[2*i] <= vec_Distance_adc[2*i+1] );
+
+    // The asymmetric distance is the one to the decoded descriptor
+    Eigen::VectorXf decoded(dimension);
+    quantizer->Decode(&codes[vec_nIndice_adc[2*i].j_ * code_size], decoded.data());
+    const float distance = (queries.row(i).transpose() - decoded).squaredNorm();
+    EXPECT_NEAR( distance, vec_Distance_adc[2*i], 1e-5 * distance + 1e-1 );
+  }
+
+  // Single neighbor search
+  int nIndice = -1;
+  float fDistance = -1.0f;
+  EXPECT_TRUE( matcher.SearchNeighbour(&query_codes[0], &nIndice, &fDistance) );
+  EXPECT_EQ( vec_nIndice[0].j_, nIndice );
+  EXPECT_NEAR( vec_Distance[0], fDistance, 1e-6 );
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -7,9 +7,12 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "openMVG/matching/regions_matcher.hpp"
+#include "openMVG/features/regions_factory.hpp"
 #include "openMVG/matching/matcher_brute_force.hpp"
 #include "openMVG/matching/matcher_cascade_hashing.hpp"
+#include "openMVG/matching/matcher_hnsw.hpp"
 #include "openMVG/matching/matcher_kdtree_flann.hpp"
+#include "openMVG/matching/matcher_product_quantization.hpp"
 #include "openMVG/matching/metric.hpp"
 #include "openMVG/matching/metric_hamming.hpp"
 
@@ -53,15 +56,32 @@ Matcher_Regions_Database::Matcher_Regions_Database():
 Matcher_Regions_Database::Matcher_Regions_Database
 (
   matching::EMatcherType eMatcherType,
-  const features::Regions & database_regions // database
+  const features::Regions & database_regions, // database
+  const HNSW_Params & hnsw_params
 ):
   eMatcherType_(eMatcherType)
 {
+  // The product quantized regions are matched from their codes only
+  if (const auto * pq_regions = dynamic_cast<const features::PQ_Regions *>(&database_regions))
+  {
+    if (eMatcherType != PRODUCT_QUANTIZATION_L2)
+    {
+      std::cerr << "The product quantized regions can only be matched with PRODUCT_QUANTIZATION_L2" << std::endl;
+      return;
+    }
+    using MatcherT = ArrayMatcher_Product_Quantization;
+    matching_interface_.reset(
+      new matching::RegionsMatcherT<MatcherT>(database_regions, true, pq_regions->Quantizer()));
+    return;
+  }
+
   // Handle invalid request
   if (database_regions.IsScalar() && eMatcherType == BRUTE_FORCE_HAMMING)
     return;
   if (database_regions.IsBinary() && eMatcherType != BRUTE_FORCE_HAMMING)
     return;
+  if (eMatcherType == PRODUCT_QUANTIZATION_L2)
+    return;
 
   // Switch regions type ID, matcher & Metric: initialize the Matcher interface
   if (database_regions.IsScalar())
@@ -85,6 +105,14 @@ Matcher_Regions_Database::Matcher_Regions_Database
           matching_interface_.reset(new matching::RegionsMatcherT<MatcherT>(database_regions, true));
         }
         break;
+        case HNSW_L2:
+        {
+          using MetricT = L2<unsigned char>;
+          using MatcherT = ArrayMatcher_HNSW<unsigned char, MetricT>;
+          matching_interface_.reset(
+            new matching::RegionsMatcherT<MatcherT>(database_regions, true, hnsw_params));
+        }
+        break;
         case CASCADE_HASHING_L2:
         {
           using MetricT = L2<unsigned char>;
@@ -115,6 +143,14 @@ Matcher_Regions_Database::Matcher_Regions_Database
           matching_interface_.reset(new matching::RegionsMatcherT<MatcherT>(database_regions, true));
         }
         break;
+        case HNSW_L2:
+        {
+          using MetricT = L2<float>;
+          using MatcherT = ArrayMatcher_HNSW<float, MetricT>;
+          matching_interface_.reset(
+            new matching::RegionsMatcherT<MatcherT>(database_regions, true, hnsw_params));
+        }
+        break;
         case CASCADE_HASHING_L2:
         {
           using MetricT = L2<float>;
@@ -145,6 +181,14 @@ Matcher_Regions_Database::Matcher_Regions_Database
           matching_interface_.reset(new matching::RegionsMatcherT<MatcherT>(database_regions, true));
         }
         break;
+        case HNSW_L2:
+        {
+          using MetricT = L2<double>;
+          using MatcherT = ArrayMatcher_HNSW<double, MetricT>;
+          matching_interface_.reset(
+            new matching::RegionsMatcherT<MatcherT>(database_regions, true, hnsw_params));
+        }
+        break;
         case CASCADE_HASHING_L2:
         {
           std::cerr << "Not implemented" << std::endl;
@@ -67,11 +67,13 @@ class Matcher_Regions_Database
 
   /**
    * @brief Initialize the retrieval database
+   * (hnsw_params is used only by the HNSW_L2 matcher type)
    */
   Matcher_Regions_Database
   (
     matching::EMatcherType eMatcherType,
-    const features::Regions & database_regions // database
+    const features::Regions & database_regions, // database
+    const HNSW_Params & hnsw_params = HNSW_Params()
   );
 
   /// Find corresponding points between the query regions and the database one
@@ -118,6 +120,24 @@ public:
     matcher_.Build(tab, regions_->RegionCount(), regions_->DescriptorLength());
   }
 
+  /**
+   * @brief Init the matcher with some reference regions and the matcher parameters.
+   */
+  template <typename MatcherParamsT>
+  RegionsMatcherT
+  (
+    const features::Regions& regions,
+    bool b_squared_metric,
+    const MatcherParamsT & matcher_params
+  ) : matcher_(matcher_params), regions_(&regions), b_squared_metric_(b_squared_metric)
+  {
+    if (regions_->RegionCount() == 0)
+      return;
+
+    const Scalar * tab = reinterpret_cast<const Scalar *>(regions_->DescriptorRawData());
+    matcher_.Build(tab, regions_->RegionCount(), regions_->DescriptorLength());
+  }
+
   void Init_database
   (
     const features::Regions& regions
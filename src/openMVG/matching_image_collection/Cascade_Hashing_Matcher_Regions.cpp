@@ -241,7 +241,8 @@ void Cascade_Hashing_Matcher_Regions::Match
   if (!regions_provider)
     return;
 
-  if (regions_provider->IsBinary())
+  // Only the scalar descriptors can be hashed (not the binary ones or the product quantized codes)
+  if (!regions_provider->IsScalar())
     return;
 
   if (regions_provider->Type_id() == typeid(unsigned char).name())
@@ -31,8 +31,9 @@ struct GeometricFilter_FMatrix_AC
 {
   GeometricFilter_FMatrix_AC(
     double dPrecision = std::numeric_limits<double>::infinity(),
-    size_t iteration = 1024)
-    : m_dPrecision(dPrecision), m_stIteration(iteration), m_F(Mat3::Identity()),
+    size_t iteration = 1024,
+    robust::ACRANSAC_SAMPLING sampling = robust::ACRANSAC_SAMPLING::UNIFORM)
+    : m_dPrecision(dPrecision), m_stIteration(iteration), m_sampling(sampling), m_F(Mat3::Identity()),
       m_dPrecision_robust(std::numeric_limits<double>::infinity()){}
 
   /// Robust fitting of the FUNDAMENTAL matrix
@@ -56,8 +57,14 @@ struct GeometricFilter_FMatrix_AC
     // Get corresponding point regions arrays
     //--
 
+    // The progressive sampling draws the best putative matches first
+    const matching::IndMatches putative_matches =
+      (m_sampling == robust::ACRANSAC_SAMPLING::PROGRESSIVE) ?
+        SortMatchesByDescriptorDistance(pairIndex, vec_PutativeMatches, regions_provider) :
+        vec_PutativeMatches;
+
     Mat xI,xJ;
-    MatchesPairToMat(pairIndex, vec_PutativeMatches, sfm_data, regions_provider, xI, xJ);
+    MatchesPairToMat(pairIndex, putative_matches, sfm_data, regions_provider, xI, xJ);
 
     //--
     // Robust estimation
@@ -80,14 +87,15 @@ struct GeometricFilter_FMatrix_AC
     const double upper_bound_precision = Square(m_dPrecision);
     std::vector<uint32_t> vec_inliers;
     const std::pair<double,double> ACRansacOut =
-      ACRANSAC(kernel, vec_inliers, m_stIteration, &m_F, upper_bound_precision);
+      ACRANSAC(kernel, vec_inliers, m_stIteration, &m_F, upper_bound_precision,
+        false, m_sampling);
 
     if (vec_inliers.size() > KernelType::MINIMUM_SAMPLES *2.5)  {
       m_dPrecision_robust = ACRansacOut.first;
       // update geometric_inliers
       geometric_inliers.reserve(vec_inliers.size());
       for (const uint32_t & index : vec_inliers) {
-        geometric_inliers.push_back( vec_PutativeMatches[index] );
+        geometric_inliers.push_back( putative_matches[index] );
       }
       return true;
     }
@@ -143,6 +151,7 @@ struct GeometricFilter_FMatrix_AC
 
   double m_dPrecision;  //upper_bound precision used for robust estimation
   size_t m_stIteration; //maximal number of iteration for robust estimation
+  robust::ACRANSAC_SAMPLING m_sampling; //minimal samples drawing strategy
   //
   //-- Stored data
   Mat3 m_F;
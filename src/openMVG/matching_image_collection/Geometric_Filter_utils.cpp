@@ -16,6 +16,9 @@
 #include "openMVG/sfm/pipelines/sfm_features_provider.hpp"
 #include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
 
+#include <algorithm>
+#include <utility>
+
 namespace openMVG {
 namespace matching_image_collection {
 
@@ -118,5 +121,42 @@ void MatchesPairToMat
     x_I, x_J);
 }
 
+matching::IndMatches SortMatchesByDescriptorDistance
+(
+  const Pair pairIndex,
+  const matching::IndMatches & putativeMatches,
+  const std::shared_ptr<sfm::Regions_Provider> & regions_provider
+)
+{
+  const std::shared_ptr<features::Regions>
+    regions_I = regions_provider->get(pairIndex.first),
+    regions_J = regions_provider->get(pairIndex.second);
+
+  std::vector<std::pair<double, uint32_t>> distances(putativeMatches.size());
+  for (size_t i = 0; i < putativeMatches.size(); ++i)
+  {
+    distances[i] = {regions_I->SquaredDescriptorDistance(
+      putativeMatches[i].i_, regions_J.get(), putativeMatches[i].j_), i};
+  }
+  std::sort(distances.begin(), distances.end());
+
+  matching::IndMatches sortedMatches;
+  sortedMatches.reserve(putativeMatches.size());
+  for (const auto & distance_it : distances)
+    sortedMatches.push_back(putativeMatches[distance_it.second]);
+  return sortedMatches;
+}
+
+matching::IndMatches SortMatchesByDescriptorDistance
+(
+  const Pair pairIndex,
+  const matching::IndMatches & putativeMatches,
+  const std::shared_ptr<sfm::Features_Provider> & features_provider
+)
+{
+  // No descriptor is available
+  return putativeMatches;
+}
+
 } //namespace matching_image_collection
 } // namespace openMVG
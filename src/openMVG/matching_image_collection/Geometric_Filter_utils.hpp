@@ -82,6 +82,32 @@ void MatchesPairToMat
   Mat & x_J
 );
 
+/**
+* @brief Sort the putative matches of a pair by increasing descriptor distance
+*  (i.e. the best matches first, as expected by the progressive sampling)
+* @param[in] pairIndex Pair of the putative matches
+* @param[in] putativeMatches Matches of the 'pairIndex' pair
+* @param[in] regions_provider Interface that provides the features descriptors
+* @return The sorted putative matches
+*/
+matching::IndMatches SortMatchesByDescriptorDistance
+(
+  const Pair pairIndex,
+  const matching::IndMatches & putativeMatches,
+  const std::shared_ptr<sfm::Regions_Provider> & regions_provider
+);
+
+/**
+* @brief Features_Provider interface variant: no descriptor is available so
+*  the putative matches order is kept
+*/
+matching::IndMatches SortMatchesByDescriptorDistance
+(
+  const Pair pairIndex,
+  const matching::IndMatches & putativeMatches,
+  const std::shared_ptr<sfm::Features_Provider> & features_provider
+);
+
 } //namespace matching_image_collection
 } // namespace openMVG
 
@@ -35,8 +35,9 @@ struct GeometricFilter_HMatrix_AC
 {
   GeometricFilter_HMatrix_AC(
     double dPrecision = std::numeric_limits<double>::infinity(),
-    size_t iteration = 1024)
-    : m_dPrecision(dPrecision), m_stIteration(iteration), m_H(Mat3::Identity()),
+    size_t iteration = 1024,
+    robust::ACRANSAC_SAMPLING sampling = robust::ACRANSAC_SAMPLING::UNIFORM)
+    : m_dPrecision(dPrecision), m_stIteration(iteration), m_sampling(sampling), m_H(Mat3::Identity()),
       m_dPrecision_robust(std::numeric_limits<double>::infinity()){}
 
   /// Robust fitting of the HOMOGRAPHY matrix
@@ -60,8 +61,14 @@ struct GeometricFilter_HMatrix_AC
     // Get corresponding point regions arrays
     //--
 
+    // The progressive sampling draws the best putative matches first
+    const matching::IndMatches putative_matches =
+      (m_sampling == robust::ACRANSAC_SAMPLING::PROGRESSIVE) ?
+        SortMatchesByDescriptorDistance(pairIndex, vec_PutativeMatches, regions_provider) :
+        vec_PutativeMatches;
+
     Mat xI,xJ;
-    MatchesPairToMat(pairIndex, vec_PutativeMatches, sfm_data, regions_provider, xI, xJ);
+    MatchesPairToMat(pairIndex, putative_matches, sfm_data, regions_provider, xI, xJ);
 
     //--
     // Robust estimation
@@ -84,14 +91,15 @@ struct GeometricFilter_HMatrix_AC
     const double upper_bound_precision = Square(m_dPrecision);
     std::vector<uint32_t> vec_inliers;
     const std::pair<double,double> ACRansacOut =
-      ACRANSAC(kernel, vec_inliers, m_stIteration, &m_H, upper_bound_precision);
+      ACRANSAC(kernel, vec_inliers, m_stIteration, &m_H, upper_bound_precision,
+        false, m_sampling);
 
     if (vec_inliers.size() > KernelType::MINIMUM_SAMPLES *2.5)  {
       m_dPrecision_robust = ACRansacOut.first;
       // update geometric_inliers
       geometric_inliers.reserve(vec_inliers.size());
       for (const uint32_t & index : vec_inliers) {
-        geometric_inliers.push_back( vec_PutativeMatches[index] );
+        geometric_inliers.push_back( putative_matches[index] );
       }
       return true;
     }
@@ -189,6 +197,7 @@ struct GeometricFilter_HMatrix_AC
 
   double m_dPrecision;  //upper_bound precision used for robust estimation
   size_t m_stIteration; //maximal number of iteration for robust estimation
+  robust::ACRANSAC_SAMPLING m_sampling; //minimal samples drawing strategy
   //
   //-- Stored data
   Mat3 m_H;
@@ -13,6 +13,12 @@
 
 #include "third_party/progress/progress.hpp"
 
+#include <algorithm>
+
+#ifdef OPENMVG_USE_OPENMP
+#include <omp.h>
+#endif
+
 namespace openMVG {
 namespace matching_image_collection {
 
@@ -20,8 +26,9 @@ using namespace openMVG::matching;
 using namespace openMVG::features;
 
 Matcher_Regions::Matcher_Regions(
-  float distRatio, EMatcherType eMatcherType)
-  :Matcher(), f_dist_ratio_(distRatio), eMatcherType_(eMatcherType)
+  float distRatio, EMatcherType eMatcherType, const HNSW_Params & hnsw_params)
+  :Matcher(), f_dist_ratio_(distRatio), eMatcherType_(eMatcherType),
+  hnsw_params_(hnsw_params)
 {
 }
 
@@ -36,8 +43,12 @@ void Matcher_Regions::Match(
     my_progress_bar = &C_Progress::dummy();
 #ifdef OPENMVG_USE_OPENMP
   std::cout << "Using the OPENMP thread interface" << std::endl;
-  const bool b_multithreaded_pair_search = (eMatcherType_ == CASCADE_HASHING_L2);
-  // -> set to true for CASCADE_HASHING_L2, since OpenMP instructions are not used in this matcher
+  const int nb_threads = omp_get_max_threads();
+  // The brute force matchers run their own threads, the pairs are matched one by one for them
+  const bool b_multithreaded_pair_search =
+    (eMatcherType_ != BRUTE_FORCE_L2 && eMatcherType_ != BRUTE_FORCE_HAMMING);
+#else
+  const int nb_threads = 1;
 #endif
 
   my_progress_bar->restart(pairs.size(), "\n- Matching -\n");
@@ -49,31 +60,64 @@ void Matcher_Regions::Match(
   {
     map_Pairs[pair_idx.first].push_back(pair_idx.second);
   }
-
-  // Perform matching between all the pairs
-  for (const auto & pairs : map_Pairs)
+  const std::vector<std::pair<IndexT, std::vector<IndexT>>> vec_Pairs(map_Pairs.cbegin(), map_Pairs.cend());
+
+  // Perform matching between all the pairs.
+  // The images are processed by windows (to bound the number of databases kept in memory):
+  // - the databases of the window images are built in parallel,
+  // - all the pairs of the window are matched in parallel (so that images with few
+  //    pairs, as in video mode, still use all the threads),
+  // - each thread stores its matches in its own buffer, gathered at the end of the window.
+  const size_t window_size = 2 * nb_threads;
+  std::vector<std::vector<std::pair<Pair, IndMatches>>> thread_matches(nb_threads);
+  for (size_t window_start = 0; window_start < vec_Pairs.size(); window_start += window_size)
   {
     if (my_progress_bar->hasBeenCanceled())
-      continue;
-    const IndexT I = pairs.first;
-    const auto & indexToCompare = pairs.second;
+      break;
+    const size_t window_end = std::min(vec_Pairs.size(), window_start + window_size);
+    const int window_image_count = static_cast<int>(window_end - window_start);
 
-    const std::shared_ptr<features::Regions> regionsI = regions_provider->get(I);
-    if (regionsI->RegionCount() == 0)
+    // Initialize the matching interfaces
+    std::vector<std::shared_ptr<features::Regions>> window_regions(window_image_count);
+    std::vector<std::unique_ptr<matching::Matcher_Regions_Database>> window_matchers(window_image_count);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < window_image_count; ++i)
     {
-      (*my_progress_bar) += indexToCompare.size();
-      continue;
+      const auto & image_pairs = vec_Pairs[window_start + i];
+      window_regions[i] = regions_provider->get(image_pairs.first);
+      if (window_regions[i]->RegionCount() == 0)
+      {
+        (*my_progress_bar) += image_pairs.second.size();
+        continue;
+      }
+      window_matchers[i].reset(
+        new matching::Matcher_Regions_Database(eMatcherType_, *window_regions[i].get(), hnsw_params_));
     }
 
-    // Initialize the matching interface
-    matching::Matcher_Regions_Database matcher(eMatcherType_, *regionsI.get());
+    // List the pairs (I local index, J) of the window
+    std::vector<std::pair<int, IndexT>> window_pairs;
+    for (int i = 0; i < window_image_count; ++i)
+    {
+      if (window_matchers[i])
+      {
+        for (const IndexT J : vec_Pairs[window_start + i].second)
+          window_pairs.emplace_back(i, J);
+      }
+    }
 
 #ifdef OPENMVG_USE_OPENMP
     #pragma omp parallel for schedule(dynamic) if (b_multithreaded_pair_search)
 #endif
-    for (int j = 0; j < (int)indexToCompare.size(); ++j)
+    for (int p = 0; p < (int)window_pairs.size(); ++p)
     {
-      const IndexT J = indexToCompare[j];
+      if (my_progress_bar->hasBeenCanceled())
+        continue;
+      const int i = window_pairs[p].first;
+      const IndexT I = vec_Pairs[window_start + i].first;
+      const IndexT J = window_pairs[p].second;
+      const std::shared_ptr<features::Regions> & regionsI = window_regions[i];
 
       const std::shared_ptr<features::Regions> regionsJ = regions_provider->get(J);
       if (regionsJ->RegionCount() == 0
@@ -84,19 +128,29 @@ void Matcher_Regions::Match(
       }
 
       IndMatches vec_putatives_matches;
-      matcher.Match(f_dist_ratio_, *regionsJ.get(), vec_putatives_matches);
+      window_matchers[i]->Match(f_dist_ratio_, *regionsJ.get(), vec_putatives_matches);
 
+      if (!vec_putatives_matches.empty())
+      {
 #ifdef OPENMVG_USE_OPENMP
-  #pragma omp critical
+        const int thread_id = omp_get_thread_num();
+#else
+        const int thread_id = 0;
 #endif
-      {
-        if (!vec_putatives_matches.empty())
-        {
-          map_PutativesMatches.insert( { {I,J}, std::move(vec_putatives_matches) } );
-        }
+        thread_matches[thread_id].emplace_back(Pair(I,J), std::move(vec_putatives_matches));
       }
       ++(*my_progress_bar);
     }
+
+    // Gather the matches of the window
+    for (auto & matches : thread_matches)
+    {
+      for (auto & pair_matches : matches)
+      {
+        map_PutativesMatches.insert(std::move(pair_matches));
+      }
+      matches.clear();
+    }
   }
 }
 
@@ -32,7 +32,8 @@ class Matcher_Regions : public Matcher
   Matcher_Regions
   (
     float dist_ratio,
-    matching::EMatcherType eMatcherType
+    matching::EMatcherType eMatcherType,
+    const matching::HNSW_Params & hnsw_params = matching::HNSW_Params()
   );
 
   /// Find corresponding points between some pair of view Ids
@@ -50,6 +51,8 @@ class Matcher_Regions : public Matcher
   float f_dist_ratio_;
   // Matcher Type
   matching::EMatcherType eMatcherType_;
+  // Parameters of the HNSW_L2 matcher
+  matching::HNSW_Params hnsw_params_;
 };
 
 } // namespace matching_image_collection
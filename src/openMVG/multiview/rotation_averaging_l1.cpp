@@ -364,7 +364,10 @@ inline void FillErrorMatrix(
   const Matrix3x3Arr& Rs,
   Vec & b)
 {
-  for (size_t r = 0; r < RelRs.size(); ++r) {
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for
+#endif
+  for (int r = 0; r < static_cast<int>(RelRs.size()); ++r) {
     const RelativeRotation& relR = RelRs[r];
     const Matrix3x3& Ri = Rs[relR.i];
     const Matrix3x3& Rj = Rs[relR.j];
@@ -382,11 +385,14 @@ inline void CorrectMatrix(
   const uint32_t nMainViewID,
   Matrix3x3Arr& Rs)
 {
-  for (size_t r = 0; r < Rs.size(); ++r) {
-    if (r == nMainViewID)
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for
+#endif
+  for (int r = 0; r < static_cast<int>(Rs.size()); ++r) {
+    if (r == static_cast<int>(nMainViewID))
       continue;
     Matrix3x3& Ri = Rs[r];
-    const uint32_t i = (r<nMainViewID ? r : r-1);
+    const uint32_t i = (r < static_cast<int>(nMainViewID) ? r : r-1);
     const openMVG::Vec3 eRid = openMVG::Vec3(x.block<3,1>(3*i,0));
     const Mat3 eRi;
     ceres::AngleAxisToRotationMatrix((const double*)eRid.data(), (double*)eRi.data());
@@ -411,18 +417,34 @@ bool SolveL1RA
   // init x with 0 that corresponds to trusting completely the initial Ri guess
   Vec x(Vec::Zero(n)), b(m);
 
+  // The mapping matrix does not change between the iterations:
+  //  the solver (and its matrix factorization) is built once,
+  //  and each solve is warm started from the previous dual variables.
+  L1Solver<sMat >::Options options;
+  options.warm_start = true;
+  L1Solver<sMat > l1_solver(options, A);
+  if (!l1_solver.Status())
+  {
+    std::cerr << "Cannot compute the L1 solver matrix factorization." << std::endl;
+    return false;
+  }
+
   // Current error and the previous one
   double e = std::numeric_limits<double>::max(), ep;
   unsigned iter = 0;
+  int admm_iterations = 0;
+  double solve_time = 0.0;
   // L1RA iterate optimization till the desired precision is reached
   do {
     // compute errors for each relative rotation
     FillErrorMatrix(RelRs, Rs, b);
 
     // solve the linear system using l1 norm
-    L1Solver<sMat >::Options options;
-    L1Solver<sMat > l1_solver(options, A);
+    // (x = 0 corresponds to trusting completely the current Ri guess)
+    x.setZero();
     l1_solver.Solve(b, &x);
+    admm_iterations += l1_solver.GetSummary().num_iterations;
+    solve_time += l1_solver.GetSummary().solve_time;
 
     ep = e; e = x.norm();
     if (ep < e)
@@ -431,7 +453,10 @@ bool SolveL1RA
     CorrectMatrix(x, nMainViewID, Rs);
   } while (++iter < 32 && e > 1e-5 && (ep-e)/e > 1e-2);
 
-  std::cout << "L1RA Converged in " << iter << " iterations." << std::endl;
+  std::cout << "L1RA Converged in " << iter << " iterations"
+    << " (" << admm_iterations << " ADMM iterations,"
+    << " factorization: " << l1_solver.GetSummary().factorization_time << "s,"
+    << " solve: " << solve_time << "s)." << std::endl;
 
   return true;
 }
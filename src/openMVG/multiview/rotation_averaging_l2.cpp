@@ -15,6 +15,10 @@
 #include <ceres/ceres.h>
 #include <ceres/rotation.h>
 
+#include <Eigen/IterativeLinearSolvers>
+
+#include <random>
+
 #ifdef _MSC_VER
 #pragma warning( once : 4267 ) //warning C4267: 'argument' : conversion from 'size_t' to 'const int', possible loss of data
 #endif
@@ -53,6 +57,85 @@ Mat3 ClosestSVDRotationMatrix
   return rot_mat;
 }
 
+// Build the sparse (3 * m) x (3 * n) action matrix A:
+// => wij * (R_j - R_{i,j} * R_i) = 0
+// => m = #R_{i,j} => the number of relative rotations.
+// => n => the number of view (camera)
+static sMat RotationActionMatrix
+(
+  size_t nCamera,
+  const RelativeRotations& vec_relativeRot
+)
+{
+  const size_t nRotationEstimation = vec_relativeRot.size();
+  //--
+  // Setup the Action Matrix
+  //--
+  std::vector<Eigen::Triplet<double> > tripletList;
+  tripletList.reserve(nRotationEstimation*12); // 3*3 + 3
+  //-- Encode constraint (6.62 Martinec Thesis page 100):
+  sMat::Index cpt = 0;
+  for (const auto & iter : vec_relativeRot)
+  {
+    //-- Encode weight * ( rj - Rij * ri ) = 0
+    const sMat::Index i = iter.i;
+    const sMat::Index j = iter.j;
+
+    // A.block<3,3>(3 * cpt, 3 * i) = - Rij * weight;
+    tripletList.emplace_back(3 * cpt, 3 * i, - iter.Rij(0,0) * iter.weight);
+    tripletList.emplace_back(3 * cpt, 3 * i + 1, - iter.Rij(0,1) * iter.weight);
+    tripletList.emplace_back(3 * cpt, 3 * i + 2, - iter.Rij(0,2) * iter.weight);
+    tripletList.emplace_back(3 * cpt + 1, 3 * i, - iter.Rij(1,0) * iter.weight);
+    tripletList.emplace_back(3 * cpt + 1, 3 * i + 1, - iter.Rij(1,1) * iter.weight);
+    tripletList.emplace_back(3 * cpt + 1, 3 * i + 2, - iter.Rij(1,2) * iter.weight);
+    tripletList.emplace_back(3 * cpt + 2, 3 * i, - iter.Rij(2,0) * iter.weight);
+    tripletList.emplace_back(3 * cpt + 2, 3 * i + 1, - iter.Rij(2,1) * iter.weight);
+    tripletList.emplace_back(3 * cpt + 2, 3 * i + 2, - iter.Rij(2,2) * iter.weight);
+
+    // A.block<3,3>(3 * cpt, 3 * j) = Id * weight;
+    tripletList.emplace_back(3 * cpt, 3 * j, iter.weight);
+    tripletList.emplace_back(3 * cpt + 1, 3 * j + 1, iter.weight);
+    tripletList.emplace_back(3 * cpt + 2, 3 * j + 2, iter.weight);
+    ++cpt;
+  }
+
+  sMat A(nRotationEstimation*3, 3*nCamera);
+  A.setFromTriplets(tripletList.begin(), tripletList.end());
+  return A;
+}
+
+// Build the global rotations from the 3 vectors spanning the nullspace of A
+//  - From solution of SVD get back column and reconstruct Rotation matrix
+//  - Enforce the orthogonality constraint
+//     (approximate rotation in the Frobenius norm using SVD).
+static void NullspaceToRotations
+(
+  size_t nCamera,
+  const Vec & NullspaceVector0,
+  const Vec & NullspaceVector1,
+  const Vec & NullspaceVector2,
+  std::vector<Mat3> & global_rotations
+)
+{
+  global_rotations.clear();
+  global_rotations.reserve(nCamera);
+  for (size_t i=0; i < nCamera; ++i)
+  {
+    Mat3 Rotation;
+    Rotation << NullspaceVector0.segment(3 * i, 3),
+                NullspaceVector1.segment(3 * i, 3),
+                NullspaceVector2.segment(3 * i, 3);
+
+    //-- Compute the closest SVD rotation matrix
+    global_rotations.emplace_back(ClosestSVDRotationMatrix(Rotation));
+  }
+  // Force R0 to be Identity
+  const Mat3 R0T = global_rotations[0].transpose();
+  for (size_t i = 0; i < nCamera; ++i) {
+    global_rotations[i] *= R0T;
+  }
+}
+
 // <eigenvalue, eigenvector> pair comparator
 bool compare_first_abs(std::pair<double, Vec> const &x, std::pair<double, Vec> const &y)
 {
@@ -96,46 +179,10 @@ bool L2RotationAveraging
   std::vector<Mat3> & global_rotations
 )
 {
-  const size_t nRotationEstimation = vec_relativeRot.size();
-  //--
-  // Setup the Action Matrix
-  //--
-  std::vector<Eigen::Triplet<double> > tripletList;
-  tripletList.reserve(nRotationEstimation*12); // 3*3 + 3
-  //-- Encode constraint (6.62 Martinec Thesis page 100):
-  sMat::Index cpt = 0;
-  for (const auto & iter : vec_relativeRot)
-  {
-    //-- Encode weight * ( rj - Rij * ri ) = 0
-    const sMat::Index i = iter.i;
-    const sMat::Index j = iter.j;
-
-    // A.block<3,3>(3 * cpt, 3 * i) = - Rij * weight;
-    tripletList.emplace_back(3 * cpt, 3 * i, - iter.Rij(0,0) * iter.weight);
-    tripletList.emplace_back(3 * cpt, 3 * i + 1, - iter.Rij(0,1) * iter.weight);
-    tripletList.emplace_back(3 * cpt, 3 * i + 2, - iter.Rij(0,2) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 1, 3 * i, - iter.Rij(1,0) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 1, 3 * i + 1, - iter.Rij(1,1) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 1, 3 * i + 2, - iter.Rij(1,2) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 2, 3 * i, - iter.Rij(2,0) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 2, 3 * i + 1, - iter.Rij(2,1) * iter.weight);
-    tripletList.emplace_back(3 * cpt + 2, 3 * i + 2, - iter.Rij(2,2) * iter.weight);
-
-    // A.block<3,3>(3 * cpt, 3 * j) = Id * weight;
-    tripletList.emplace_back(3 * cpt, 3 * j, iter.weight);
-    tripletList.emplace_back(3 * cpt + 1, 3 * j + 1, iter.weight);
-    tripletList.emplace_back(3 * cpt + 2, 3 * j + 2, iter.weight);
-    ++cpt;
-  }
-
   // nCamera * 3 because each columns have 3 elements.
   Mat AtA(3*nCamera,3*nCamera);
   {
-    sMat A(nRotationEstimation*3, 3*nCamera);
-    A.setFromTriplets(tripletList.begin(), tripletList.end());
-    tripletList.clear();
-    tripletList.shrink_to_fit();
-
+    const sMat A = RotationActionMatrix(nCamera, vec_relativeRot);
     const sMat AtAsparse = A.transpose() * A;
     AtA = Mat(AtAsparse); // convert to dense
   }
@@ -157,34 +204,127 @@ bool L2RotationAveraging
     }
     std::stable_sort(eigs.begin(), eigs.end(), &compare_first_abs);
 
-    const Vec & NullspaceVector0 = eigs[0].second;
-    const Vec & NullspaceVector1 = eigs[1].second;
-    const Vec & NullspaceVector2 = eigs[2].second;
-
     //--
     // Search the closest matrix :
-    //  - From solution of SVD get back column and reconstruct Rotation matrix
-    //  - Enforce the orthogonality constraint
-    //     (approximate rotation in the Frobenius norm using SVD).
     //--
-    global_rotations.clear();
-    global_rotations.reserve(nCamera);
-    for (size_t i=0; i < nCamera; ++i)
-    {
-      Mat3 Rotation;
-      Rotation << NullspaceVector0.segment(3 * i, 3),
-                  NullspaceVector1.segment(3 * i, 3),
-                  NullspaceVector2.segment(3 * i, 3);
+    NullspaceToRotations(nCamera,
+      eigs[0].second, eigs[1].second, eigs[2].second,
+      global_rotations);
+  }
+  return true;
+}
+
+//-- Solve the Global Rotation matrix registration for each camera given a list
+//    of relative orientation using matrix parametrization
+//    [1] formula 6.62 page 100. Sparse formulation.
+//
+// The 3 eigen vectors of AtA associated to the smallest eigen values are
+//  computed by block inverse iteration:
+//  - V_{k+1} = orth((AtA + shift * Id)^-1 V_k) (Conjugate Gradient solves),
+//  - Rayleigh-Ritz projection of AtA on V_{k+1}.
+// The sparse matrix-vector products run in parallel (row major storage).
+//
+bool L2RotationAveraging_Sparse
+(
+  size_t nCamera,
+  const RelativeRotations& vec_relativeRot,
+  // Output
+  std::vector<Mat3> & global_rotations
+)
+{
+  if (nCamera == 0 || vec_relativeRot.empty())
+  {
+    return false;
+  }
+
+  const Mat::Index nUnknown = 3 * nCamera;
+  sRMat AtA;
+  {
+    const sMat A = RotationActionMatrix(nCamera, vec_relativeRot);
+    AtA = A.transpose() * A;
+  }
+
+  // Scale of the problem (mean of the diagonal)
+  double mean_diagonal = 0.0;
+  for (Mat::Index i = 0; i < nUnknown; ++i)
+  {
+    mean_diagonal += AtA.coeff(i, i);
+  }
+  mean_diagonal /= nUnknown;
+  if (mean_diagonal <= 0.0)
+  {
+    return false;
+  }
+
+  // A tiny diagonal shift makes the matrix positive definite without
+  //  changing its eigen vectors.
+  const double shift = 1e-8 * mean_diagonal;
+  sRMat AtA_shifted = AtA;
+  for (Mat::Index i = 0; i < nUnknown; ++i)
+  {
+    AtA_shifted.coeffRef(i, i) += shift;
+  }
+
+  Eigen::ConjugateGradient<sRMat, Eigen::Lower|Eigen::Upper> cg;
+  cg.setTolerance(1e-12);
+  cg.compute(AtA_shifted);
+  if (cg.info() != Eigen::Success)
+  {
+    return false;
+  }
+
+  // Random (but repeatable) initial subspace
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  Mat V(nUnknown, 3);
+  for (Mat::Index i = 0; i < V.size(); ++i)
+  {
+    V.data()[i] = distribution(random_generator);
+  }
 
-      //-- Compute the closest SVD rotation matrix
-      global_rotations.emplace_back(ClosestSVDRotationMatrix(Rotation));
+  const Mat thin_identity = Mat::Identity(nUnknown, 3);
+  Vec3 ritz_values = Vec3::Zero();
+  bool bConverged = false;
+  const int max_iteration = 100;
+  for (int iter = 0; iter < max_iteration && !bConverged; ++iter)
+  {
+    // Inverse iteration (warm started with the expected solution)
+    Mat W;
+    if (iter == 0)
+    {
+      W = cg.solve(V);
     }
-    // Force R0 to be Identity
-    const Mat3 R0T = global_rotations[0].transpose();
-    for (size_t i = 0; i < nCamera; ++i) {
-      global_rotations[i] *= R0T;
+    else
+    {
+      const Mat guess = V * (ritz_values.array() + shift).inverse().matrix().asDiagonal();
+      W = cg.solveWithGuess(V, guess);
     }
+
+    // Orthonormalization
+    const Eigen::HouseholderQR<Mat> qr(W);
+    V = qr.householderQ() * thin_identity;
+
+    // Rayleigh-Ritz projection
+    Mat AV = AtA * V;
+    const Mat3 H = V.transpose() * AV;
+    const Eigen::SelfAdjointEigenSolver<Mat3> es(H);
+    if (es.info() != Eigen::Success)
+    {
+      return false;
+    }
+    V = V * es.eigenvectors();
+    AV = AV * es.eigenvectors();
+    ritz_values = es.eigenvalues().cwiseAbs();
+
+    // Check the eigen pairs residual
+    const double residual = (AV - V * es.eigenvalues().asDiagonal()).norm();
+    bConverged = residual < 1e-10 * mean_diagonal;
   }
+
+  //--
+  // Search the closest matrix :
+  //--
+  NullspaceToRotations(nCamera, V.col(0), V.col(1), V.col(2), global_rotations);
   return true;
 }
 
@@ -317,6 +457,83 @@ bool L2RotationAveraging_Refine
   return summary.IsSolutionUsable();
 }
 
+bool L2RotationAveraging_Refine_Chordal
+(
+  const RelativeRotations & vec_relativeRot,
+  std::vector<openMVG::Mat3> & vec_ApprRotMatrix,
+  const unsigned int max_iteration
+)
+{
+  if (vec_relativeRot.size() == 0 ||vec_ApprRotMatrix.size() == 0 ) {
+    std::cout << "Skip nonlinear rotation optimization, no sufficient data provided " << std::endl;
+    return false;
+  }
+
+  const size_t nCamera = vec_ApprRotMatrix.size();
+  const Mat3 R0 = vec_ApprRotMatrix[0];
+
+  // List the relative rotations linked to each camera
+  std::vector<std::vector<size_t>> camera_edges(nCamera);
+  for (size_t ii = 0; ii < vec_relativeRot.size(); ++ii)
+  {
+    camera_edges[vec_relativeRot[ii].i].push_back(ii);
+    camera_edges[vec_relativeRot[ii].j].push_back(ii);
+  }
+
+  const double robust_loss_width = 0.03; // 2° error along one axis (perhaps a bit too strict)
+
+  std::vector<openMVG::Mat3> vec_updatedRotMatrix(nCamera);
+  std::vector<double> vec_update(nCamera);
+  for (unsigned int iter = 0; iter < max_iteration; ++iter)
+  {
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int c = 0; c < static_cast<int>(nCamera); ++c)
+    {
+      if (camera_edges[c].empty())
+      {
+        vec_updatedRotMatrix[c] = vec_ApprRotMatrix[c];
+        vec_update[c] = 0.0;
+        continue;
+      }
+      // Weighted sum of the rotations predicted by the neighbors
+      Mat3 sum_rotation = Mat3::Zero();
+      for (const size_t ii : camera_edges[c])
+      {
+        const RelativeRotation & rel = vec_relativeRot[ii];
+        // Rj = Rij * Ri
+        const Mat3 prediction = (rel.j == static_cast<IndexT>(c)) ?
+          Mat3(rel.Rij * vec_ApprRotMatrix[rel.i]) :
+          Mat3(rel.Rij.transpose() * vec_ApprRotMatrix[rel.j]);
+        // Approximate angular residual from the chordal distance
+        const double angular_error =
+          (vec_ApprRotMatrix[c] - prediction).norm() / std::sqrt(2.0);
+        // IRLS weight of the SoftL1 loss
+        const double weight = rel.weight * rel.weight /
+          std::sqrt(1.0 + std::pow(angular_error / robust_loss_width, 2));
+        sum_rotation += weight * prediction;
+      }
+      vec_updatedRotMatrix[c] = ClosestSVDRotationMatrix(sum_rotation);
+      vec_update[c] = (vec_updatedRotMatrix[c] - vec_ApprRotMatrix[c]).norm();
+    }
+    vec_ApprRotMatrix.swap(vec_updatedRotMatrix);
+
+    if (*std::max_element(vec_update.begin(), vec_update.end()) < 1e-10)
+    {
+      break;
+    }
+  }
+
+  // Restore the initial gauge (R0 is kept unchanged)
+  const Mat3 gauge = vec_ApprRotMatrix[0].transpose() * R0;
+  for (size_t i = 0; i < nCamera; ++i)
+  {
+    vec_ApprRotMatrix[i] *= gauge;
+  }
+  return true;
+}
+
 } // namespace l2
 } // namespace rotation_averaging
 } // namespace openMVG
@@ -63,11 +63,33 @@ bool L2RotationAveraging( size_t nCamera,
   // Output
   std::vector<Mat3> & vec_ApprRotMatrix);
 
+//-- Solve the same problem as L2RotationAveraging but without forming a
+//    dense normal matrix. The 3 eigen vectors associated to the smallest
+//    eigen values of the sparse AtA matrix are found by a block inverse
+//    iteration (Conjugate Gradient solves + Rayleigh-Ritz projection).
+//    Memory is linear in the number of relative rotations.
+//- nCamera:               The number of camera to solve
+//- vec_rotationEstimate:  The relative rotation i->j
+//- vec_ApprRotMatrix:     The output global rotation
+bool L2RotationAveraging_Sparse( size_t nCamera,
+  const RelativeRotations& vec_relativeRot,
+  // Output
+  std::vector<Mat3> & vec_ApprRotMatrix);
+
 // None linear refinement of the rotation using an angle-axis representation
 bool L2RotationAveraging_Refine(
   const RelativeRotations & vec_relativeRot,
   std::vector<openMVG::Mat3> & vec_ApprRotMatrix);
 
+// Refinement of the rotation by robust chordal averaging:
+//  each global rotation is updated (in parallel) to the closest rotation of
+//  the weighted mean of the rotations predicted by its neighbors.
+//  Weights are updated at each iteration (IRLS) to mimic a SoftL1 loss.
+bool L2RotationAveraging_Refine_Chordal(
+  const RelativeRotations & vec_relativeRot,
+  std::vector<openMVG::Mat3> & vec_ApprRotMatrix,
+  const unsigned int max_iteration = 100);
+
 } // namespace l2
 } // namespace rotation_averaging
 } // namespace openMVG
@@ -160,6 +160,88 @@ TEST ( rotation_averaging, RefineRotationsL2_CompleteGraph)
   }
 }
 
+// Test over a loop of cameras (sparse solver)
+TEST ( rotation_averaging, RotationLeastSquare_Sparse_CompleteGraph)
+{
+  //-- Setup a circular camera rig
+  const int iNviews = 5;
+  const NViewDataSet d = NRealisticCamerasRing(iNviews, 5,
+    nViewDatasetConfigurator(1,1,0,0,5,0)); // Suppose a camera with Unit matrix as K
+
+  //Link each camera to the two next ones
+  RelativeRotations vec_relativeRotEstimate;
+  for (size_t i = 0; i < iNviews; ++i)
+  {
+    const size_t index0 = i;
+    const size_t index1 = (i+1)%iNviews;
+    const size_t index2 = (i+2)%iNviews;
+
+    Mat3 Rrel;
+    Vec3 trel;
+    RelativeCameraMotion(d._R[index0], d._t[index0], d._R[index1], d._t[index1], &Rrel, &trel);
+    vec_relativeRotEstimate.push_back(RelativeRotation(index0, index1, Rrel, 1));
+
+    RelativeCameraMotion(d._R[index1], d._t[index1], d._R[index2], d._t[index2], &Rrel, &trel);
+    vec_relativeRotEstimate.push_back(RelativeRotation(index1, index2, Rrel, 1));
+
+    RelativeCameraMotion(d._R[index0], d._t[index0], d._R[index2], d._t[index2], &Rrel, &trel);
+    vec_relativeRotEstimate.push_back(RelativeRotation(index0, index2, Rrel, 1));
+  }
+
+  //- Solve the global rotation estimation problem with the dense and the sparse solvers:
+  std::vector<Mat3> vec_globalR_dense, vec_globalR;
+  EXPECT_TRUE(L2RotationAveraging(iNviews, vec_relativeRotEstimate, vec_globalR_dense));
+  EXPECT_TRUE(L2RotationAveraging_Sparse(iNviews, vec_relativeRotEstimate, vec_globalR));
+  EXPECT_EQ(iNviews, vec_globalR.size());
+
+  // Check that both solvers agree (R0 is forced to Identity in both cases)
+  for (size_t i = 0; i < iNviews; ++i)
+  {
+    EXPECT_NEAR(0.0, FrobeniusDistance(vec_globalR_dense[i], vec_globalR[i]), 1e-8);
+  }
+
+  // Check that each global rotations is near the true ones (up to the gauge)
+  for (size_t i = 0; i < iNviews; ++i)
+  {
+    EXPECT_NEAR(0.0, FrobeniusDistance(d._R[i], Mat3(vec_globalR[i] * d._R[0])), 1e-8);
+  }
+}
+
+// Test over a loop of cameras with noisy relative rotations (chordal refinement)
+TEST ( rotation_averaging, RefineRotationsL2_Chordal_Noisy)
+{
+  //-- Setup a circular camera rig
+  const int iNviews = 8;
+  const NViewDataSet d = NRealisticCamerasRing(iNviews, 5,
+    nViewDatasetConfigurator(1,1,0,0,5,0)); // Suppose a camera with Unit matrix as K
+
+  //Link each camera to the two next ones (with a bit of noise)
+  RelativeRotations vec_relativeRotEstimate;
+  for (size_t i = 0; i < iNviews; ++i)
+  {
+    for (const size_t offset : {1, 2})
+    {
+      const size_t index0 = i;
+      const size_t index1 = (i+offset)%iNviews;
+      Mat3 Rrel;
+      Vec3 trel;
+      RelativeCameraMotion(d._R[index0], d._t[index0], d._R[index1], d._t[index1], &Rrel, &trel);
+      Rrel = RotationAroundX(D2R(0.1 * ((i % 3) - 1.0))) * Rrel;
+      vec_relativeRotEstimate.push_back(RelativeRotation(index0, index1, Rrel, 1));
+    }
+  }
+
+  std::vector<Mat3> vec_globalR;
+  EXPECT_TRUE(L2RotationAveraging_Sparse(iNviews, vec_relativeRotEstimate, vec_globalR));
+  EXPECT_TRUE(L2RotationAveraging_Refine_Chordal(vec_relativeRotEstimate, vec_globalR));
+
+  // Check that each global rotations is near the true ones (up to the gauge)
+  for (size_t i = 0; i < iNviews; ++i)
+  {
+    EXPECT_NEAR(0.0, FrobeniusDistance(d._R[i], Mat3(vec_globalR[i] * d._R[0])), 1e-2);
+  }
+}
+
 TEST ( rotation_averaging, RefineRotationsAvgL1IRLS_SimpleTriplet)
 {
   using namespace std;
@@ -59,13 +59,16 @@ namespace openMVG
 void FivePointsRelativePose( const Mat2X &x1, const Mat2X &x2,
                              std::vector<Mat3> *E );
 
+/// Polynomial of degree 3 in x, y, z (coefficients in the monomial basis below)
+using Vec20 = Eigen::Matrix<double, 20, 1>;
+
 /**
 * @brief Compute the nullspace of the linear constraints given by the matches.
 * @param x1 Match position in first camera
 * @param x2 Match position in second camera
 * @return Nullspace (homography) that maps x1 points to x2 points
 */
-Mat FivePointsNullspaceBasis( const Mat2X &x1, const Mat2X &x2 );
+Eigen::Matrix<double, 9, 4> FivePointsNullspaceBasis( const Mat2X &x1, const Mat2X &x2 );
 
 /**
 * @brief Multiply two polynomials of degree 1.
@@ -85,7 +88,7 @@ Mat FivePointsNullspaceBasis( const Mat2X &x1, const Mat2X &x2 );
 * @note Ordering is defined as follow :
 * [xxx xxy xyy yyy xxz xyz yyz xzz yzz zzz xx xy yy xz yz zz x y z 1]
 */
-Vec o1( const Vec &a, const Vec &b );
+Vec20 o1( const Vec20 &a, const Vec20 &b );
 
 /**
 * @brief Multiply two polynomials of degree 2
@@ -95,14 +98,17 @@ Vec o1( const Vec &a, const Vec &b );
 * @note Ordering is defined as follow :
 * [xxx xxy xyy yyy xxz xyz yyz xzz yzz zzz xx xy yy xz yz zz x y z 1]
 */
-Vec o2( const Vec &a, const Vec &b );
+Vec20 o2( const Vec20 &a, const Vec20 &b );
 
 /**
 * Builds the polynomial constraint matrix M.
 * @param E_basis Basis essential matrix
 * @return polynomial constraint associated to the essential matrix
 */
-Mat FivePointsPolynomialConstraints( const Mat &E_basis );
+Eigen::Matrix<double, 10, 20> FivePointsPolynomialConstraints
+(
+  const Eigen::Matrix<double, 9, 4> &E_basis
+);
 
 // In the following code, polynomials are expressed as vectors containing
 // their coeficients in the basis of monomials:
@@ -52,7 +52,7 @@ void SevenPointSolver::Solve
     using Mat9 = Eigen::Matrix<double, 9, 9>;
     // In the minimal solution use fixed sized matrix to let Eigen and the
     //  compiler doing the maximum of optimization.
-    Mat9 epipolar_constraint = Mat::Zero(9,9);
+    Mat9 epipolar_constraint = Mat9::Zero();
     EncodeEpipolarEquation(x1, x2, &epipolar_constraint);
     // Find the two F matrices in the nullspace of epipolar_constraint.
     Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, 9, 9>> solver
@@ -121,7 +121,7 @@ void EightPointSolver::Solve
     using Mat9 = Eigen::Matrix<double, 9, 9>;
     // In the minimal solution use fixed sized matrix to let Eigen and the
     //  compiler doing the maximum of optimization.
-    Mat9 epipolar_constraint = Mat::Zero(9,9);
+    Mat9 epipolar_constraint = Mat9::Zero();
     EncodeEpipolarEquation(x1, x2, &epipolar_constraint);
     Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, 9, 9>> solver
       (epipolar_constraint.transpose() * epipolar_constraint);
@@ -187,6 +187,68 @@ double EpipolarDistanceError::Error
   return Square(F_x.dot(y.homogeneous())) /  F_x.head<2>().squaredNorm();
 }
 
+// The batch versions use the same operation order as the single correspondence
+// versions, so both give the same residual values.
+
+void SampsonError::Errors
+(
+  const Mat3 &F,
+  const Eigen::Ref<const MatX2> &x,
+  const Eigen::Ref<const MatX2> &y,
+  double *errors
+)
+{
+  const auto x0 = x.col(0).array(), x1 = x.col(1).array();
+  const auto y0 = y.col(0).array(), y1 = y.col(1).array();
+  const auto F_x0 = F(0,0) * x0 + F(0,1) * x1 + F(0,2);
+  const auto F_x1 = F(1,0) * x0 + F(1,1) * x1 + F(1,2);
+  const auto F_x2 = F(2,0) * x0 + F(2,1) * x1 + F(2,2);
+  const auto Ft_y0 = F(0,0) * y0 + F(1,0) * y1 + F(2,0);
+  const auto Ft_y1 = F(0,1) * y0 + F(1,1) * y1 + F(2,1);
+  Eigen::Map<Eigen::ArrayXd>(errors, x.rows()) =
+    (y0 * F_x0 + y1 * F_x1 + F_x2).square()
+    / ((F_x0.square() + F_x1.square()) + (Ft_y0.square() + Ft_y1.square()));
+}
+
+void SymmetricEpipolarDistanceError::Errors
+(
+  const Mat3 &F,
+  const Eigen::Ref<const MatX2> &x,
+  const Eigen::Ref<const MatX2> &y,
+  double *errors
+)
+{
+  const auto x0 = x.col(0).array(), x1 = x.col(1).array();
+  const auto y0 = y.col(0).array(), y1 = y.col(1).array();
+  const auto F_x0 = F(0,0) * x0 + F(0,1) * x1 + F(0,2);
+  const auto F_x1 = F(1,0) * x0 + F(1,1) * x1 + F(1,2);
+  const auto F_x2 = F(2,0) * x0 + F(2,1) * x1 + F(2,2);
+  const auto Ft_y0 = F(0,0) * y0 + F(1,0) * y1 + F(2,0);
+  const auto Ft_y1 = F(0,1) * y0 + F(1,1) * y1 + F(2,1);
+  Eigen::Map<Eigen::ArrayXd>(errors, x.rows()) =
+    (y0 * F_x0 + y1 * F_x1 + F_x2).square()
+    * ((F_x0.square() + F_x1.square()).inverse()
+      + (Ft_y0.square() + Ft_y1.square()).inverse())
+    / 4.0;
+}
+
+void EpipolarDistanceError::Errors
+(
+  const Mat3 &F,
+  const Eigen::Ref<const MatX2> &x,
+  const Eigen::Ref<const MatX2> &y,
+  double *errors
+)
+{
+  const auto x0 = x.col(0).array(), x1 = x.col(1).array();
+  const auto F_x0 = F(0,0) * x0 + F(0,1) * x1 + F(0,2);
+  const auto F_x1 = F(1,0) * x0 + F(1,1) * x1 + F(1,2);
+  const auto F_x2 = F(2,0) * x0 + F(2,1) * x1 + F(2,2);
+  Eigen::Map<Eigen::ArrayXd>(errors, x.rows()) =
+    (F_x0 * y.col(0).array() + F_x1 * y.col(1).array() + F_x2).square()
+    / (F_x0.square() + F_x1.square());
+}
+
 }  // namespace kernel
 }  // namespace fundamental
 }  // namespace openMVG
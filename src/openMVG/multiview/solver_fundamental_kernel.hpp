@@ -92,16 +92,26 @@ inline void EncodeEpipolarEquation(const TMatX &x1, const TMatX &x2, TMatA *A) {
 }
 
 /// Compute SampsonError related to the Fundamental matrix and 2 correspondences
+/// The Errors functions evaluate the residuals of all the correspondences at once:
+///  the points are stored by coordinate arrays (x.col(0) abscissae, x.col(1) ordinates)
+///  in order to let the compiler vectorize the computation. A range of
+///  correspondences is evaluated by passing the corresponding rows (middleRows).
 struct SampsonError {
   static double Error(const Mat3 &F, const Vec2 &x, const Vec2 &y);
+  static void Errors(const Mat3 &F, const Eigen::Ref<const MatX2> &x,
+    const Eigen::Ref<const MatX2> &y, double *errors);
 };
 
 struct SymmetricEpipolarDistanceError {
   static double Error(const Mat3 &F, const Vec2 &x, const Vec2 &y);
+  static void Errors(const Mat3 &F, const Eigen::Ref<const MatX2> &x,
+    const Eigen::Ref<const MatX2> &y, double *errors);
 };
 
 struct EpipolarDistanceError {
   static double Error(const Mat3 &F, const Vec2 &x, const Vec2 &y);
+  static void Errors(const Mat3 &F, const Eigen::Ref<const MatX2> &x,
+    const Eigen::Ref<const MatX2> &y, double *errors);
 };
 
 //-- Kernel solver for the 8pt Fundamental Matrix Estimation
@@ -31,10 +31,13 @@
 #include "openMVG/multiview/solver_fundamental_kernel.hpp"
 #include "openMVG/numeric/extract_columns.hpp"
 #include "openMVG/numeric/numeric.h"
+#include "openMVG/robust_estimation/robust_estimator_ACRansac.hpp"
+#include "openMVG/robust_estimation/robust_estimator_ACRansacKernelAdaptator.hpp"
 
 #include "testing/testing.h"
 
 #include <numeric>
+#include <random>
 
 using namespace openMVG;
 using namespace std;
@@ -141,6 +144,101 @@ TEST(EightPointTest_Normalized, EasyCase) {
   EXPECT_TRUE(ExpectKernelProperties<Kernel>(x1, x2));
 }
 
+// The batch residual evaluation must give the same values as the
+//  correspondence by correspondence evaluation
+template<typename ErrorT>
+bool ExpectBatchErrors(const Mat3 & F, const Mat & x1, const Mat & x2)
+{
+  const MatX2 x1_soa = x1.transpose(), x2_soa = x2.transpose();
+  std::vector<double> errors(x1.cols());
+  ErrorT::Errors(F, x1_soa, x2_soa, errors.data());
+  for (Mat::Index i = 0; i < x1.cols(); ++i)
+  {
+    if (errors[i] != ErrorT::Error(F, x1.col(i), x2.col(i)))
+      return false;
+  }
+  return true;
+}
+
+TEST(FundamentalErrors, Batch) {
+  Mat3 F;
+  F << 1e-6, -2e-5,  3e-3,
+       4e-5,  1e-6, -2e-2,
+      -5e-3,  2e-2,  1.0;
+  const Mat x1 = Mat::Random(2, 101) * 500.0, x2 = Mat::Random(2, 101) * 500.0;
+  using namespace fundamental::kernel;
+  EXPECT_TRUE(ExpectBatchErrors<SampsonError>(F, x1, x2));
+  EXPECT_TRUE(ExpectBatchErrors<SymmetricEpipolarDistanceError>(F, x1, x2));
+  EXPECT_TRUE(ExpectBatchErrors<EpipolarDistanceError>(F, x1, x2));
+}
+
+// Epipolar distance error that counts its point by point and batch evaluations
+struct CountingEpipolarDistanceError
+{
+  static double Error(const Mat3 &F, const Vec2 &x, const Vec2 &y)
+  {
+    ++error_count;
+    return fundamental::kernel::EpipolarDistanceError::Error(F, x, y);
+  }
+  static void Errors(const Mat3 &F, const Eigen::Ref<const MatX2> &x,
+    const Eigen::Ref<const MatX2> &y, double *errors)
+  {
+    ++batch_count;
+    fundamental::kernel::EpipolarDistanceError::Errors(F, x, y, errors);
+  }
+  static int error_count, batch_count;
+};
+int CountingEpipolarDistanceError::error_count = 0;
+int CountingEpipolarDistanceError::batch_count = 0;
+
+// The default geometric filtering setting (quantified NFA with an upper bound)
+//  must evaluate the residuals with the batch functor
+TEST(FundamentalErrors, ACRANSAC_Quantified_Batch) {
+  const int n_inliers = 300, n_outliers = 100;
+  const Mat3 K = (Mat3() << 1000, 0, 500, 0, 1000, 500, 0, 0, 1).finished();
+  Mat34 P1, P2;
+  P_From_KRt(K, Mat3::Identity(), Vec3::Zero(), &P1);
+  P_From_KRt(K, RotationAroundY(0.1), Vec3(-1.0, 0.1, 0.0), &P2);
+
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> coordinate(-1.0, 1.0), pixel(0.0, 1000.0);
+  Mat x1(2, n_inliers + n_outliers), x2(2, n_inliers + n_outliers);
+  for (int i = 0; i < n_inliers; ++i)
+  {
+    const Vec3 X(coordinate(random_generator), coordinate(random_generator),
+      5.0 + coordinate(random_generator));
+    x1.col(i) = Project(P1, X);
+    x2.col(i) = Project(P2, X);
+  }
+  for (int i = n_inliers; i < n_inliers + n_outliers; ++i)
+  {
+    x1.col(i) << pixel(random_generator), pixel(random_generator);
+    x2.col(i) << pixel(random_generator), pixel(random_generator);
+  }
+
+  using KernelType =
+    robust::ACKernelAdaptor<
+      fundamental::kernel::SevenPointSolver,
+      CountingEpipolarDistanceError,
+      UnnormalizerT,
+      Mat3>;
+  const KernelType kernel(x1, 1000, 1000, x2, 1000, 1000, true);
+
+  std::vector<uint32_t> vec_inliers;
+  Mat3 F;
+  robust::ACRANSAC(kernel, vec_inliers, 1024, &F, Square(4.0));
+
+  EXPECT_TRUE(vec_inliers.size() >= n_inliers);
+  EXPECT_TRUE(CountingEpipolarDistanceError::batch_count > 0);
+  EXPECT_EQ(0, CountingEpipolarDistanceError::error_count);
+
+  // A range evaluation gives the same residuals as the point by point one
+  std::vector<double> errors(64);
+  kernel.Errors(F, 100, 164, errors.data());
+  for (int i = 0; i < 64; ++i)
+    EXPECT_EQ(kernel.Error(100 + i, F), errors[i]);
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -60,6 +60,19 @@ struct AsymmetricError {
   static double Error(const Mat &H, const Vec2 &x, const Vec2 &y) {
     return (y - Vec3( H * x.homogeneous()).hnormalized() ).squaredNorm();
   }
+
+  // Batch evaluation: the points are stored by coordinate arrays
+  //  (x.col(0) abscissae, x.col(1) ordinates).
+  static void Errors(const Mat3 &H, const Eigen::Ref<const MatX2> &x,
+    const Eigen::Ref<const MatX2> &y, double *errors) {
+    const auto x0 = x.col(0).array(), x1 = x.col(1).array();
+    const auto H_x0 = H(0,0) * x0 + H(0,1) * x1 + H(0,2);
+    const auto H_x1 = H(1,0) * x0 + H(1,1) * x1 + H(1,2);
+    const auto H_x2 = H(2,0) * x0 + H(2,1) * x1 + H(2,2);
+    Eigen::Map<Eigen::ArrayXd>(errors, x.rows()) =
+      (y.col(0).array() - H_x0 / H_x2).square()
+      + (y.col(1).array() - H_x1 / H_x2).square();
+  }
 };
 
 // Kernel that works on original data point
@@ -114,6 +114,20 @@ TEST(HomographyKernelTest, Fitting_Normalized) {
   }
 }
 
+TEST(HomographyKernelTest, AsymmetricError_Batch) {
+  Mat3 H;
+  H << 1, -2,  3,
+       4,  5, -6,
+      -7,  8,  1;
+  const Mat x = Mat::Random(2, 101) * 10.0, y = Mat::Random(2, 101) * 10.0;
+  const MatX2 x_soa = x.transpose(), y_soa = y.transpose();
+  vector<double> errors(x.cols());
+  homography::kernel::AsymmetricError::Errors(H, x_soa, y_soa, errors.data());
+  // Same values as the correspondence by correspondence evaluation
+  for (Mat::Index i = 0; i < x.cols(); ++i)
+    EXPECT_EQ(homography::kernel::AsymmetricError::Error(H, x.col(i), y.col(i)), errors[i]);
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
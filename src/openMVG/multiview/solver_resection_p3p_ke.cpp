@@ -15,7 +15,6 @@
 #include <array>
 #include <cmath>
 #include <complex>
-#include <tuple>
 
 using namespace openMVG;
 
@@ -30,7 +29,7 @@ namespace euclidean_resection {
 *
 * @param[in] bearing_vectors 3x3 matrix with UNITARY feature vectors (each column is a vector)
 * @param[in] X_observations  3x3 matrix with corresponding 3D world points (each column is a point)
-* @param[in] rotation_translation_solutions vector that will contain the solutions (up to 4 solutions)
+* @param[out] models vector where the [R|t] solutions are appended (up to 4 solutions)
 *
 * @return true if at least one solution is found, false if no solution was found
 *
@@ -39,7 +38,7 @@ bool computePoses
 (
   const Mat & bearing_vectors,
   const Mat & X_observations,
-  std::vector<std::tuple<Mat3, Vec3>> & rotation_translation_solutions
+  std::vector<Mat34> * models
 )
 {
   //world point vectors
@@ -118,6 +117,7 @@ bool computePoses
 
   const Vec3 b3p = b3 * (delta / k3b3);
 
+  bool found = false;
   for (const auto ctheta1p : s) {
     if (std::abs(ctheta1p) > 1)
       continue;
@@ -134,10 +134,16 @@ bool computePoses
 
     const Mat3 R = (Ck1nl * C13) * Cb1k3tzT;
     const Vec3 rp3 = R.transpose() * w3; // R' * p3
-    rotation_translation_solutions.emplace_back(R.transpose(), (b3p * stheta1p) - rp3);
+    Mat34 P;
+    P_From_KRt( Mat3::Identity(),          // intrinsics
+                R.transpose(),             // rotation
+                (b3p * stheta1p) - rp3,    // translation
+                &P);
+    models->push_back(P);
+    found = true;
   }
 
-  return !rotation_translation_solutions.empty();
+  return found;
 }
 
 void P3PSolver_Ke::Solve
@@ -147,18 +153,7 @@ void P3PSolver_Ke::Solve
   std::vector<Mat34> * models
 )
 {
-  std::vector<std::tuple<Mat3, Vec3>> rotation_translation_solutions;
-  if (computePoses(bearing_vectors, X, rotation_translation_solutions))
-  {
-    for (const auto & rot_trans_it : rotation_translation_solutions) {
-      Mat34 P;
-      P_From_KRt( Mat3::Identity(),          // intrinsics
-                  std::get<0>(rot_trans_it), // rotation
-                  std::get<1>(rot_trans_it), // translation
-                  &P);
-      models->push_back(P);
-    }
-  }
+  computePoses(bearing_vectors, X, models);
 }
 
 double P3PSolver_Ke::Error
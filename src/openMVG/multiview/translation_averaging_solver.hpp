@@ -66,6 +66,32 @@ solve_translations_problem_softl1
   const double d_l1_loss_threshold = 0.01
 );
 
+/**
+* @brief Registration of relative translations to global translations. It solves the problem of [2]
+*  (t_j = R_ij t_i + s_k t_ij, with s_k >= 1 for each group of relative motions) by minimizing
+*  the sum of the residual norms (L1) with Iteratively Reweighted Least Squares.
+*  Each iteration solves a sparse linear system with a (multithreaded) Conjugate Gradient,
+*  so the memory is linear in the number of relative translations.
+*  All relative motions must be 1 connected component and the pose indexes must be in [0, #poses[.
+*
+* @param[in] vec_initial_estimates group of relative motion information
+*             Each group will have its own optimized scale
+* @param[in,out] translations found global camera translations.
+*             If it is already sized to #poses, it is used as initial guess (warm start),
+*             once the camera centers are moved so that the pose 0 is at the origin.
+* @param[in] max_iterations maximal number of IRLS iterations
+* @param[in] function_tolerance stop when the relative decrease of the L1 cost is under this value
+* @return True if the registration can be solved
+*/
+bool
+solve_translations_problem_l1_irls
+(
+  const std::vector<openMVG::RelativeInfo_Vec > & vec_initial_estimates,
+  std::vector<Eigen::Vector3d> & translations,
+  const int max_iterations = 100,
+  const double function_tolerance = 1e-5
+);
+
 } // namespace openMVG
 
 #endif // OPENMVG_MULTIVIEW_TRANSLATION_AVERAGING_SOLVER_HPP
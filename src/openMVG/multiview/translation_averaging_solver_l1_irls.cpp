@@ -0,0 +1,325 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2015 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/multiview/translation_averaging_common.hpp"
+#include "openMVG/multiview/translation_averaging_solver.hpp"
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/system/timer.hpp"
+#include "openMVG/types.hpp"
+
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/SparseCore>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <vector>
+
+namespace openMVG {
+
+namespace {
+
+// Flattened view of one relative motion: t_j = R_ij t_i + s_k * t_ij
+struct RelativeTranslationObservation
+{
+  unsigned int i, j, group;
+  Mat3 R_ij;
+  Vec3 t_ij;
+};
+
+// residual = t_j - R_ij t_i - s_k * t_ij
+inline Vec3 RelativeTranslationResidual
+(
+  const RelativeTranslationObservation & obs,
+  const Eigen::VectorXd & translations,
+  const std::vector<double> & scales
+)
+{
+  return translations.segment<3>(3 * obs.j)
+    - obs.R_ij * translations.segment<3>(3 * obs.i)
+    - scales[obs.group] * obs.t_ij;
+}
+
+} // namespace
+
+bool
+solve_translations_problem_l1_irls
+(
+  const std::vector<openMVG::RelativeInfo_Vec> & vec_relative_group_estimates,
+  std::vector<Eigen::Vector3d> & translations,
+  const int max_iterations,
+  const double function_tolerance
+)
+{
+  openMVG::system::Timer timer;
+
+  //-- Count:
+  //- #poses are used by the relative position estimates
+  //- #relative estimates we will use
+  std::set<unsigned int> count_set;
+  std::vector<RelativeTranslationObservation> observations;
+  unsigned int group_idx = 0;
+  for (const openMVG::RelativeInfo_Vec & iter : vec_relative_group_estimates)
+  {
+    for (const relativeInfo & info : iter)
+    {
+      count_set.insert(info.first.first);
+      count_set.insert(info.first.second);
+      observations.push_back({
+        static_cast<unsigned int>(info.first.first),
+        static_cast<unsigned int>(info.first.second),
+        group_idx,
+        info.second.first,
+        info.second.second});
+    }
+    ++group_idx; // One scale per relative_motion group
+  }
+  const IndexT nb_poses = count_set.size();
+  const unsigned int nb_scales = vec_relative_group_estimates.size();
+  const int nb_observations = static_cast<int>(observations.size());
+
+  if (nb_poses < 2 || observations.empty() ||
+      *count_set.rbegin() != nb_poses - 1)
+  {
+    std::cerr << "Translation averaging (L1 IRLS): "
+      << "the pose indexes must be contiguous in [0, #poses[." << std::endl;
+    return false;
+  }
+
+  //--
+  // Unknowns: x = [t_0, ..., t_{n-1}, s_0, ..., s_{k-1}]
+  //  - t_0 is fixed to (0,0,0) to remove the gauge freedom,
+  //  - the group scales are constrained to s_k >= 1
+  //    (the trivial solution is translations = {0,...,0}).
+  //  Since the problem is linear, the constraint is handled by an active set:
+  //  a scale that goes under 1 is clamped and moved to the right hand side.
+  //--
+  const int nb_unknowns = 3 * nb_poses + nb_scales;
+  const int scale_offset = 3 * nb_poses;
+
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(nb_unknowns);
+  std::vector<double> scales(nb_scales, 1.0);
+  std::vector<bool> is_scale_clamped(nb_scales, true);
+
+  // Warm start: use the provided translations and estimate the group scales
+  bool b_warm_start = (translations.size() == nb_poses);
+  if (b_warm_start)
+  {
+    // Move the camera centers so that the pose 0 is at the origin:
+    //  c_i -> c_i - c_0 gives t_i -> t_i + R_i c_0 = t_i - R_i R_0^T t_0.
+    // The rotations relative to the pose 0 (R_i R_0^T) are chained from
+    //  the relative rotations along a spanning tree of the pose graph.
+    std::vector<Mat3> rotations_from_0(nb_poses);
+    std::vector<bool> is_rotation_known(nb_poses, false);
+    rotations_from_0[0] = Mat3::Identity();
+    is_rotation_known[0] = true;
+    IndexT nb_known_rotations = 1;
+    bool b_update = true;
+    while (b_update && nb_known_rotations < nb_poses)
+    {
+      b_update = false;
+      for (const RelativeTranslationObservation & obs : observations)
+      {
+        if (is_rotation_known[obs.i] == is_rotation_known[obs.j])
+          continue;
+        if (is_rotation_known[obs.i])
+          rotations_from_0[obs.j] = obs.R_ij * rotations_from_0[obs.i];
+        else
+          rotations_from_0[obs.i] = obs.R_ij.transpose() * rotations_from_0[obs.j];
+        is_rotation_known[obs.i] = is_rotation_known[obs.j] = true;
+        ++nb_known_rotations;
+        b_update = true;
+      }
+    }
+    if (nb_known_rotations == nb_poses)
+    {
+      for (IndexT i = 0; i < nb_poses; ++i)
+        x.segment<3>(3 * i) = translations[i] - rotations_from_0[i] * translations[0];
+    }
+    else
+    {
+      std::cerr << "Translation averaging (L1 IRLS): "
+        << "the pose graph is not connected, the warm start is ignored." << std::endl;
+      b_warm_start = false;
+    }
+  }
+
+  std::vector<double> residual_norms(nb_observations, 0.0);
+  std::vector<double> weights(nb_observations, 1.0);
+  // Weights are bounded to avoid division by zero for the inlier residuals
+  // (and to keep the normal equations well conditioned for the CG solver)
+  double mean_relative_translation_norm = 0.0;
+  for (const RelativeTranslationObservation & obs : observations)
+    mean_relative_translation_norm += obs.t_ij.norm();
+  mean_relative_translation_norm /= nb_observations;
+  const double delta = 1e-6 * std::max(1.0, mean_relative_translation_norm);
+
+  // Compute for each group the best scale given the current translations
+  // and update the active set of the clamped scales.
+  const auto update_scales = [&]()
+  {
+    std::vector<double> numerator(nb_scales, 0.0), denominator(nb_scales, 0.0);
+    for (int k = 0; k < nb_observations; ++k)
+    {
+      const RelativeTranslationObservation & obs = observations[k];
+      const Vec3 rotated_diff = x.segment<3>(3 * obs.j) - obs.R_ij * x.segment<3>(3 * obs.i);
+      numerator[obs.group] += weights[k] * obs.t_ij.dot(rotated_diff);
+      denominator[obs.group] += weights[k] * obs.t_ij.squaredNorm();
+    }
+    for (unsigned int k = 0; k < nb_scales; ++k)
+    {
+      const double best_scale =
+        (denominator[k] > 0.0) ? numerator[k] / denominator[k] : 1.0;
+      is_scale_clamped[k] = (best_scale <= 1.0);
+      scales[k] = is_scale_clamped[k] ? 1.0 : best_scale;
+      x(scale_offset + k) = scales[k];
+    }
+  };
+
+  if (b_warm_start)
+    update_scales();
+
+  // Row major storage to get a multithreaded sparse matrix * vector product
+  Eigen::ConjugateGradient<sRMat, Eigen::Lower|Eigen::Upper> solver;
+  solver.setTolerance(1e-6);
+
+  double previous_cost = std::numeric_limits<double>::max();
+  int iteration = 0;
+  for (; iteration < max_iterations; ++iteration)
+  {
+    //-- Build the weighted linear system A x = b
+    std::vector<Eigen::Triplet<double>> triplets;
+    triplets.reserve(nb_observations * 15 + 3 + nb_scales);
+    Eigen::VectorXd b = Eigen::VectorXd::Zero(3 * nb_observations + 3 + nb_scales);
+    int row = 0;
+    for (int k = 0; k < nb_observations; ++k)
+    {
+      const RelativeTranslationObservation & obs = observations[k];
+      const double sqrt_w = std::sqrt(weights[k]);
+      for (int l = 0; l < 3; ++l, ++row)
+      {
+        if (obs.j != 0)
+          triplets.emplace_back(row, 3 * obs.j + l, sqrt_w);
+        if (obs.i != 0)
+          for (int c = 0; c < 3; ++c)
+            triplets.emplace_back(row, 3 * obs.i + c, - sqrt_w * obs.R_ij(l, c));
+        if (is_scale_clamped[obs.group])
+          b(row) = sqrt_w * obs.t_ij(l);
+        else
+          triplets.emplace_back(row, scale_offset + obs.group, - sqrt_w * obs.t_ij(l));
+      }
+    }
+    // The fixed unknowns (t_0 and the clamped scales) only appear in their own row
+    for (int l = 0; l < 3; ++l, ++row)
+      triplets.emplace_back(row, l, 1.0);
+    for (unsigned int k = 0; k < nb_scales; ++k)
+    {
+      if (is_scale_clamped[k])
+      {
+        triplets.emplace_back(row, scale_offset + k, 1.0);
+        b(row++) = 1.0;
+      }
+    }
+    sRMat A(row, nb_unknowns);
+    b.conservativeResize(row);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+    triplets.clear();
+    triplets.shrink_to_fit();
+
+    const sRMat AtA = A.transpose() * A;
+    const Eigen::VectorXd Atb = A.transpose() * b;
+
+    //-- Solve the normal equations, starting from the previous solution
+    solver.compute(AtA);
+    if (solver.info() != Eigen::Success)
+    {
+      std::cerr << "Translation averaging (L1 IRLS): "
+        << "cannot setup the linear solver." << std::endl;
+      return false;
+    }
+    x = solver.solveWithGuess(Atb, x);
+    if (solver.info() == Eigen::NumericalIssue)
+    {
+      std::cerr << "Translation averaging (L1 IRLS): "
+        << "the linear system is not positive definite." << std::endl;
+      return false;
+    }
+    for (unsigned int k = 0; k < nb_scales; ++k)
+    {
+      if (is_scale_clamped[k])
+        x(scale_offset + k) = 1.0;
+      scales[k] = x(scale_offset + k);
+    }
+
+    //-- Update the L1 weights from the current residuals
+    #ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int k = 0; k < nb_observations; ++k)
+    {
+      residual_norms[k] = RelativeTranslationResidual(observations[k], x, scales).norm();
+      weights[k] = 1.0 / std::max(residual_norms[k], delta);
+    }
+
+    // Enforce s_k >= 1 and release the scales that want to grow
+    update_scales();
+
+    // Stop when the L1 cost does not decrease anymore
+    double cost = 0.0;
+    for (const double r : residual_norms)
+      cost += r;
+    if (iteration > 0 && previous_cost - cost <= function_tolerance * previous_cost)
+    {
+      ++iteration;
+      break;
+    }
+    previous_cost = cost;
+  }
+
+  // Residuals of the final solution
+  #ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for
+  #endif
+  for (int k = 0; k < nb_observations; ++k)
+  {
+    residual_norms[k] = RelativeTranslationResidual(observations[k], x, scales).norm();
+  }
+  std::vector<double> sorted_residuals = residual_norms;
+  std::sort(sorted_residuals.begin(), sorted_residuals.end());
+  double residual_sum = 0.0;
+  for (const double r : sorted_residuals)
+    residual_sum += r;
+
+  std::cout
+    << "Translation averaging (L1 IRLS):\n"
+    << " #poses: " << nb_poses
+    << ", #relative translations: " << nb_observations
+    << ", #scales: " << nb_scales << "\n"
+    << " warm start: " << (b_warm_start ? "yes" : "no")
+    << ", #iterations: " << iteration
+    << ", timing (s): " << timer.elapsed() << "\n"
+    << " residuals (mean, median, max): "
+    << residual_sum / nb_observations << ", "
+    << sorted_residuals[nb_observations / 2] << ", "
+    << sorted_residuals.back() << std::endl;
+
+  if (!x.allFinite())
+    return false;
+
+  // Fill the global translations array
+  translations.resize(nb_poses);
+  for (IndexT i = 0; i < nb_poses; ++i)
+  {
+    translations[i] = x.segment<3>(3 * i);
+  }
+  return true;
+}
+
+} // namespace openMVG
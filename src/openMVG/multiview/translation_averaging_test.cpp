@@ -207,6 +207,111 @@ TEST(translation_averaging, globalTi_from_tijs_l2_chordal) {
   }
 }
 
+TEST(translation_averaging, globalTi_from_tijs_Triplets_l1_irls) {
+
+  const int focal = 1000;
+  const int principal_Point = 500;
+  //-- Setup a circular camera rig or "cardioid".
+  const int iNviews = 12;
+  const int iNbPoints = 6;
+
+  const bool bCardiod = true;
+  const bool bRelative_Translation_PerTriplet = true;
+  std::vector<RelativeInfo_Vec > vec_relative_estimates;
+
+  const NViewDataSet d =
+    Setup_RelativeTranslations_AndNviewDataset
+    (
+      vec_relative_estimates,
+      focal, principal_Point, iNviews, iNbPoints,
+      bCardiod, bRelative_Translation_PerTriplet
+    );
+
+  // Solve the translation averaging problem:
+  std::vector<Vec3> vec_translations;
+  EXPECT_TRUE(solve_translations_problem_l1_irls(
+    vec_relative_estimates, vec_translations));
+
+  EXPECT_EQ(iNviews, vec_translations.size());
+
+  // Check accuracy of the found translations
+  for (unsigned i = 0; i < iNviews; ++i)
+  {
+    const Vec3 t = vec_translations[i];
+    const Mat3 & Ri = d._R[i];
+    const Vec3 C_computed = - Ri.transpose() * t;
+
+    const Vec3 C_GT = d._C[i] - d._C[0];
+
+    //-- Check that found camera position is equal to GT value
+    if (i==0)  {
+      EXPECT_MATRIX_NEAR(C_computed, C_GT, 1e-6);
+    }
+    else  {
+     EXPECT_NEAR(0.0, DistanceLInfinity(C_computed.normalized(), C_GT.normalized()), 1e-6);
+    }
+  }
+
+  // Solve again from the found solution (warm start)
+  EXPECT_TRUE(solve_translations_problem_l1_irls(
+    vec_relative_estimates, vec_translations));
+  for (unsigned i = 1; i < iNviews; ++i)
+  {
+    const Vec3 C_computed = - d._R[i].transpose() * vec_translations[i];
+    const Vec3 C_GT = d._C[i] - d._C[0];
+    EXPECT_NEAR(0.0, DistanceLInfinity(C_computed.normalized(), C_GT.normalized()), 1e-6);
+  }
+
+  // Warm start from translations whose pose 0 is not at the origin:
+  //  the initial guess must be the same scene, with the camera 0 at the origin
+  for (unsigned i = 0; i < iNviews; ++i)
+    vec_translations[i] = - d._R[i] * (2.0 * d._C[i]);
+  EXPECT_TRUE(solve_translations_problem_l1_irls(
+    vec_relative_estimates, vec_translations, 0));
+  for (unsigned i = 0; i < iNviews; ++i)
+  {
+    const Vec3 C_computed = - d._R[i].transpose() * vec_translations[i];
+    const Vec3 C_GT = 2.0 * (d._C[i] - d._C[0]);
+    EXPECT_MATRIX_NEAR(C_computed, C_GT, 1e-8);
+  }
+}
+
+TEST(translation_averaging, globalTi_from_tijs_l1_irls) {
+
+  const int focal = 1000;
+  const int principal_Point = 500;
+  //-- Setup a circular camera rig or "cardiod".
+  const int iNviews = 12;
+  const int iNbPoints = 6;
+
+  const bool bCardiod = true;
+  const bool bRelative_Translation_PerTriplet = false;
+  std::vector<RelativeInfo_Vec > vec_relative_estimates;
+
+  const NViewDataSet d =
+    Setup_RelativeTranslations_AndNviewDataset
+    (
+      vec_relative_estimates,
+      focal, principal_Point, iNviews, iNbPoints,
+      bCardiod, bRelative_Translation_PerTriplet
+    );
+
+  // Solve the translation averaging problem:
+  std::vector<Vec3> vec_translations;
+  EXPECT_TRUE(solve_translations_problem_l1_irls(
+    vec_relative_estimates, vec_translations));
+
+  EXPECT_EQ(iNviews, vec_translations.size());
+
+  // Check accuracy of the found translations
+  for (unsigned i = 1; i < iNviews; ++i)
+  {
+    const Vec3 C_computed = - d._R[i].transpose() * vec_translations[i];
+    const Vec3 C_GT = d._C[i] - d._C[0];
+    EXPECT_NEAR(0.0, DistanceLInfinity(C_computed.normalized(), C_GT.normalized()), 1e-6);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -127,6 +127,9 @@ namespace openMVG
   /// 4xN matrix using double internal format
   using Mat4X = Eigen::Matrix<double, 4, Eigen::Dynamic>;
 
+  /// Nx2 matrix using double internal format
+  using MatX2 = Eigen::Matrix<double, Eigen::Dynamic, 2>;
+
   /// 9xN matrix using double internal format
   using MatX9 = Eigen::Matrix<double, Eigen::Dynamic, 9>;
 
@@ -20,6 +20,7 @@
 
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <string>
 
@@ -50,6 +51,21 @@ inline void Compute
   linear_solver->compute(spd_mat.sparseView());
 }
 
+// Storage used for the matrix-vector products of the solver. Eigen runs the
+// sparse matrix * dense vector products in parallel (OpenMP) only for row
+// major sparse matrices.
+template <typename MatrixType>
+struct Product_Matrix
+{
+  using type = MatrixType;
+};
+
+template <>
+struct Product_Matrix<Eigen::SparseMatrix<double>>
+{
+  using type = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+};
+
 }  // namespace l1_solver_internal
 
 // A L1 norm approximation solver. This class will attempt to solve the
@@ -67,7 +83,9 @@ inline void Compute
 // few number of iterations, but can spend many iterations subsequently refining
 // the solution to obtain the global optimum. The speed improvements are because
 // the matrix A only needs to be factorized (by Cholesky decomposition) once, as
-// opposed to every iteration.
+// opposed to every iteration. The factorization is also kept for all the
+// subsequent Solve calls, so a solver instance can be reused for a sequence of
+// problems sharing the same matrix A (optionally warm started).
 //
 // This implementation is based off of the code found at:
 //   https://web.stanford.edu/~boyd/papers/admm/least_abs_deviations/lad.html
@@ -83,6 +101,22 @@ class L1Solver {
 
     double absolute_tolerance = 1e-4;
     double relative_tolerance = 1e-2;
+
+    // If true, Solve starts from the provided solution and from the dual
+    // variable of the previous Solve call (if any).
+    bool warm_start = false;
+  };
+
+  // Convergence and timing statistics.
+  struct Summary {
+    // Factorization time of the normal matrix (in seconds).
+    double factorization_time = 0.0;
+    // Statistics of the last Solve call.
+    int num_iterations = 0;
+    bool converged = false;
+    double primal_residual = 0.0;
+    double dual_residual = 0.0;
+    double solve_time = 0.0; // in seconds
   };
 
   L1Solver
@@ -90,12 +124,15 @@ class L1Solver {
     const Options& options,
     const MatrixType& mat
   )
-  : options_(options), a_(mat)
+  : options_(options), a_(mat), a_t_(mat.transpose())
   {
+    const auto start = std::chrono::steady_clock::now();
     // Analyze the sparsity pattern once. Only the values of the entries will be
     // changed with each iteration.
-    const MatrixType spd_mat = a_.transpose() * a_;
+    const MatrixType spd_mat = mat.transpose() * mat;
     l1_solver_internal::Compute(spd_mat, &linear_solver_);
+    summary_.factorization_time = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
   }
 
   void SetMaxIterations
@@ -111,6 +148,11 @@ class L1Solver {
     return linear_solver_.info() == Eigen::Success;
   }
 
+  const Summary & GetSummary() const
+  {
+    return summary_;
+  }
+
   // Solves ||Ax - b||_1 for the optimal L1 solution given an initial guess for
   // x. To solve this we introduce an auxiliary variable y such that the
   // solution to:
@@ -131,10 +173,27 @@ class L1Solver {
       return false;
     }
 
+    const auto start = std::chrono::steady_clock::now();
+    summary_.num_iterations = 0;
+    summary_.converged = false;
+
     Eigen::VectorXd& x = *solution;
-    Eigen::VectorXd z(a_.rows()), u(a_.rows());
-    z.setZero();
-    u.setZero();
+    Eigen::VectorXd z(a_.rows());
+    const bool b_warm_start = options_.warm_start && x.size() == a_.cols();
+    if (b_warm_start)
+    {
+      z.noalias() = a_ * x;
+      z -= rhs;
+    }
+    else
+    {
+      z.setZero();
+    }
+    Eigen::VectorXd & u = u_;
+    if (!b_warm_start || u.size() != a_.rows())
+    {
+      u.setZero(a_.rows());
+    }
 
     Eigen::VectorXd a_times_x(a_.rows()), z_old(z.size()), ax_hat(a_.rows());
     // Precompute some convergence terms.
@@ -147,7 +206,7 @@ class L1Solver {
     for (int i = 0; i < options_.max_num_iterations; ++i)
     {
       // Update x.
-      x.noalias() = linear_solver_.solve(a_.transpose() * (rhs + z - u));
+      x.noalias() = linear_solver_.solve(a_t_ * (rhs + z - u));
       a_times_x.noalias() = a_ * x;
       ax_hat.noalias() = options_.alpha * a_times_x;
       ax_hat.noalias() += (1.0 - options_.alpha) * (z + rhs);
@@ -162,7 +221,7 @@ class L1Solver {
       // Compute the convergence terms.
       const double r_norm = (a_times_x - z - rhs).norm();
       const double s_norm =
-        (-options_.rho * a_.transpose() * (z - z_old)).norm();
+        (-options_.rho * (a_t_ * (z - z_old))).norm();
       const double max_norm =
         std::max({a_times_x.norm(), z.norm(), rhs_norm});
       const double primal_eps =
@@ -170,7 +229,7 @@ class L1Solver {
       const double dual_eps =
         dual_abs_tolerance_eps +
         options_.relative_tolerance *
-          (options_.rho * a_.transpose() * u).norm();
+          (options_.rho * (a_t_ * u)).norm();
 
       // Log the result to the screen.
       // std::ostringstream os;
@@ -181,20 +240,34 @@ class L1Solver {
       //   << "Dual eps: " << dual_eps << std::endl;
       // std::cout << os.str() << std::endl;
 
+      summary_.num_iterations = i + 1;
+      summary_.primal_residual = r_norm;
+      summary_.dual_residual = s_norm;
+
       // Determine if the minimizer has converged.
       if (r_norm < primal_eps && s_norm < dual_eps)
       {
-        return true;
+        summary_.converged = true;
+        break;
       }
     }
-    return false;
+    summary_.solve_time = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+    return summary_.converged;
   }
 
  private:
   Options options_;
+  Summary summary_;
 
+  using Product_MatrixT = typename l1_solver_internal::Product_Matrix<MatrixType>::type;
   // Matrix A where || Ax - b ||_1 is the problem we are solving.
-  MatrixType a_;
+  Product_MatrixT a_;
+  // Transpose of A (stored to ease the matrix-vector products).
+  Product_MatrixT a_t_;
+
+  // Scaled dual variable (kept for warm starting the next solve).
+  Eigen::VectorXd u_;
 
   // Cholesky linear solver.
 #ifdef EIGEN_MPL2_ONLY
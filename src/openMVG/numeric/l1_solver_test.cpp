@@ -60,6 +60,62 @@ TEST(L1Solver_ADMM, Decoding)
   }
 }
 
+TEST(L1Solver_ADMM, Decoding_Sparse_WarmStart)
+{
+  const double dTolerance = 1e-8;
+  // source length
+  const unsigned int N = 256;
+  // codeword length
+  const unsigned int M = 4*N;
+  // number of perturbations
+  const unsigned int T (0.2f*M);
+  // sparse coding matrix
+  const Eigen::SparseMatrix<double> G = Eigen::MatrixXd::Random(M,N).sparseView();
+  // source word
+  const Eigen::VectorXd x = Eigen::VectorXd::Random(N);
+  // code word
+  const Eigen::VectorXd y = G*x;
+  // channel: perturb T randomly chosen entries
+  Eigen::VectorXd observation = y;
+  const Eigen::VectorXd pertubations = Eigen::VectorXd::Random(T);
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<int> distribution(0, observation.size()-1);
+  for (unsigned int i = 0; i < T; ++i) {
+    observation(distribution(generator)) = pertubations(i);
+  }
+
+  // Recover the code word
+  L1Solver<Eigen::SparseMatrix<double>>::Options options;
+  options.absolute_tolerance = dTolerance;
+  options.relative_tolerance = dTolerance;
+  options.warm_start = true;
+  L1Solver<Eigen::SparseMatrix<double>> l1_solver(options, G);
+  EXPECT_TRUE(l1_solver.Status());
+
+  // recover (The initial noisy guess)
+  const Eigen::MatrixXd Gd(G);
+  Eigen::VectorXd solution = (Gd.transpose()*Gd).inverse()*Gd.transpose()*observation;
+  EXPECT_TRUE(l1_solver.Solve(observation, &solution));
+  const int cold_iterations = l1_solver.GetSummary().num_iterations;
+  EXPECT_TRUE(l1_solver.GetSummary().converged);
+
+  // Check the solution
+  Eigen::VectorXd residuals = G * solution - y;
+  for (unsigned int i = 0; i < residuals.size(); ++i) {
+    EXPECT_NEAR(residuals(i), 0.0, dTolerance);
+  }
+
+  // Solve again the same problem (the factorization is reused),
+  // the warm started solve must converge faster.
+  EXPECT_TRUE(l1_solver.Solve(observation, &solution));
+  CHECK(l1_solver.GetSummary().num_iterations < cold_iterations);
+  residuals = G * solution - y;
+  for (unsigned int i = 0; i < residuals.size(); ++i) {
+    EXPECT_NEAR(residuals(i), 0.0, dTolerance);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
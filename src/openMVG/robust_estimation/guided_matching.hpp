@@ -10,7 +10,9 @@
 #define OPENMVG_ROBUST_ESTIMATION_GUIDED_MATCHING_HPP
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include "openMVG/cameras/Camera_Intrinsics.hpp"
@@ -390,6 +392,226 @@ void GuidedMatching_Fundamental_Fast(
   }
 }
 
+/// Index of the points of an image along the pencil of its epipolar lines.
+/// Query an epipolar line in order to list only the points that can lie in
+/// the band of half-width maxDist around it:
+/// - finite epipole: points are sorted by their angle around the epipole and
+///   grouped in rings of increasing radius (the angular tolerance of a ring is
+///   derived from its inner radius: a point at radius r lies at r.|sin(dAngle)|
+///   from the line),
+/// - epipole at infinity: the epipolar lines are parallel, the points are
+///   sorted by their offset along the common normal of the lines.
+class Epipolar_Band_Index
+{
+public:
+  Epipolar_Band_Index
+  (
+    const Vec3 & epipole, // Epipole (homogeneous coordinates)
+    const std::vector<Vec2> & points,
+    const double maxDist // Half-width of the tested band (pixels)
+  ):
+    maxDist_(maxDist)
+  {
+    bFinite_epipole_ =
+      std::abs(epipole(2)) > 1e-8 * epipole.head<2>().norm();
+    if (bFinite_epipole_)
+    {
+      epipole_ = epipole.hnormalized();
+    }
+    else
+    {
+      // Common normal of the parallel epipolar lines
+      epipole_ = Vec2(-epipole(1), epipole(0)).normalized();
+    }
+
+    // Compute the key and the ring of each point
+    std::vector<std::pair<unsigned int, Key>> ring_keys(points.size());
+    unsigned int nb_rings = 1;
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+      unsigned int ring = 0;
+      double key;
+      if (bFinite_epipole_)
+      {
+        const Vec2 d = points[i] - epipole_;
+        key = fold_angle(std::atan2(d(1), d(0)));
+        // Ring k > 0 covers the radius range [maxDist.2^k, maxDist.2^(k+1)[
+        const double r = d.norm() / std::max(maxDist_, 1e-6);
+        if (r >= 2.)
+          ring = static_cast<unsigned int>(std::log2(r));
+      }
+      else
+      {
+        key = epipole_.dot(points[i]);
+      }
+      ring_keys[i] = {ring, {key, static_cast<IndexT>(i)}};
+      nb_rings = std::max(nb_rings, ring + 1);
+    }
+    std::sort(ring_keys.begin(), ring_keys.end());
+
+    keys_.reserve(points.size());
+    rings_.resize(nb_rings + 1, 0);
+    for (const auto & ring_key : ring_keys)
+    {
+      keys_.push_back(ring_key.second);
+      ++rings_[ring_key.first + 1];
+    }
+    for (size_t i = 1; i < rings_.size(); ++i)
+      rings_[i] += rings_[i-1];
+  }
+
+  /// Call functor(point_index) for every point that can lie at less than
+  /// maxDist from the line (false positives must be rejected by the caller)
+  template<typename FunctorT>
+  void query(const Vec3 & line, FunctorT & functor) const
+  {
+    if (bFinite_epipole_)
+    {
+      if (line.head<2>().squaredNorm() == 0.0)
+        return;
+      // Direction angle of the line
+      const double angle = fold_angle(std::atan2(line(0), -line(1)));
+      for (size_t ring = 0; ring + 1 < rings_.size(); ++ring)
+      {
+        const auto begin = keys_.cbegin() + rings_[ring];
+        const auto end = keys_.cbegin() + rings_[ring + 1];
+        if (begin == end)
+          continue;
+        if (ring == 0) // Points close to the epipole can lie on any line
+        {
+          visit(begin, end, functor);
+          continue;
+        }
+        const double tolerance = std::asin(1.0 / std::pow(2.0, ring));
+        const double low = angle - tolerance, high = angle + tolerance;
+        visit_range(begin, end, std::max(low, 0.0), std::min(high, M_PI), functor);
+        // Wrap around the [0, PI[ angle range
+        if (low < 0.0)
+          visit_range(begin, end, low + M_PI, M_PI, functor);
+        if (high > M_PI)
+          visit_range(begin, end, 0.0, high - M_PI, functor);
+      }
+    }
+    else
+    {
+      // Offset of the line along the common normal: n.x = -c / (n.(a,b))
+      const double scale = epipole_.dot(line.head<2>());
+      if (scale == 0.0)
+        return;
+      const double offset = -line(2) / scale;
+      // Absorb the deviation of the line from the common direction
+      const double tolerance = maxDist_ * line.head<2>().norm() / std::abs(scale);
+      visit_range(keys_.cbegin(), keys_.cend(),
+        offset - tolerance, offset + tolerance, functor);
+    }
+  }
+
+private:
+  using Key = std::pair<double, IndexT>; // (angle or offset, point index)
+  using Key_iterator = std::vector<Key>::const_iterator;
+
+  static inline double fold_angle(double angle)
+  {
+    // A line through the epipole is defined by an angle in [0, PI[
+    if (angle < 0.0) angle += M_PI;
+    if (angle >= M_PI) angle -= M_PI;
+    return angle;
+  }
+
+  template<typename FunctorT>
+  static inline void visit(Key_iterator begin, Key_iterator end, FunctorT & functor)
+  {
+    for (Key_iterator it = begin; it != end; ++it)
+      functor(it->second);
+  }
+
+  template<typename FunctorT>
+  static inline void visit_range
+  (
+    Key_iterator begin, Key_iterator end,
+    const double low, const double high,
+    FunctorT & functor
+  )
+  {
+    if (low > high)
+      return;
+    const Key_iterator first = std::lower_bound(begin, end,
+      Key(low, 0));
+    const Key_iterator last = std::upper_bound(first, end,
+      Key(high, std::numeric_limits<IndexT>::max()));
+    visit(first, last, functor);
+  }
+
+  bool bFinite_epipole_;
+  Vec2 epipole_; // Epipole (finite) or common normal of the epipolar lines
+  double maxDist_;
+  std::vector<Key> keys_; // Sorted keys (by ring)
+  std::vector<size_t> rings_; // Ring ranges in keys_
+};
+
+/// Guided Matching (features + descriptors with distance ratio):
+/// Index the right points along the epipolar lines (see Epipolar_Band_Index)
+/// so each left point is compared only to the right points that lie in a thin
+/// band around its epipolar line.
+///   Keep the best corresponding points for the given model under the
+///   user specified distance ratio.
+/// ErrorArg must be (or bound from above) the squared distance to the
+/// epipolar line in the right image (i.e. EpipolarDistanceError).
+template<
+  typename ErrorArg> // The metric to compute distance to the model
+void GuidedMatching_Fundamental_Epipolar_Index(
+  const Mat3 & FMat,    // The fundamental matrix
+  const Vec3 & epipole2,// Epipole2 (camera center1 in image plane2)
+  const cameras::IntrinsicBase * camL, // Optional camera (in order to undistord on the fly feature positions, can be nullptr)
+  const features::Regions & lRegions,  // regions (point features & corresponding descriptors)
+  const cameras::IntrinsicBase * camR, // Optional camera (in order to undistord on the fly feature positions, can be nullptr)
+  const features::Regions & rRegions,  // regions (point features & corresponding descriptors)
+  double errorTh,       // Maximal authorized error threshold (consider it's a square threshold)
+  double distRatio,     // Maximal authorized distance ratio
+  matching::IndMatches & vec_corresponding_index) // Ouput corresponding index
+{
+  // Looking for the corresponding points that have to satisfy:
+  //   1. a geometric distance below the provided Threshold
+  //   2. a distance ratio between descriptors of valid geometric correspondencess
+
+  // Build region positions arrays (in order to un-distord on-demand point position once)
+  std::vector<Vec2>
+    lRegionsPos(lRegions.RegionCount()),
+    rRegionsPos(rRegions.RegionCount());
+  for (size_t i = 0; i < lRegions.RegionCount(); ++i) {
+    lRegionsPos[i] = camL ? camL->get_ud_pixel(lRegions.GetRegionPosition(i)) : lRegions.GetRegionPosition(i);
+  }
+  for (size_t i = 0; i < rRegions.RegionCount(); ++i) {
+    rRegionsPos[i] = camR ? camR->get_ud_pixel(rRegions.GetRegionPosition(i)) : rRegions.GetRegionPosition(i);
+  }
+
+  const Epipolar_Band_Index index(epipole2, rRegionsPos, std::sqrt(errorTh));
+
+  for (size_t i = 0; i < lRegions.RegionCount(); ++i) {
+
+    distanceRatio<double> dR;
+    // Compare only the right points that lie in the epipolar band
+    auto test_candidate = [&](const IndexT j)
+    {
+      // Reject the false positives of the index by the exact geometric error
+      if (ErrorArg::Error(FMat, lRegionsPos[i], rRegionsPos[j]) < errorTh) {
+        // Update the corresponding points & distance (if required)
+        dR.update(j, lRegions.SquaredDescriptorDistance(i, &rRegions, j));
+      }
+    };
+    index.query(FMat * lRegionsPos[i].homogeneous(), test_candidate);
+
+    // Add correspondence only iff the distance ratio is valid
+    if (dR.isValid(distRatio))  {
+      // save the best corresponding index
+      vec_corresponding_index.push_back(matching::IndMatch(i,dR.idx));
+    }
+  }
+
+  // Remove duplicates (when multiple points at same position exist)
+  matching::IndMatch::getDeduplicated(vec_corresponding_index);
+}
+
 } // namespace geometry_aware
 } // namespace openMVG
 
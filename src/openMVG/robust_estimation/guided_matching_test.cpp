@@ -0,0 +1,114 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "openMVG/features/regions_factory.hpp"
+#include "openMVG/geometry/pose3.hpp"
+#include "openMVG/multiview/projection.hpp"
+#include "openMVG/multiview/solver_fundamental_kernel.hpp"
+#include "openMVG/robust_estimation/guided_matching.hpp"
+
+#include "testing/testing.h"
+
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::features;
+using namespace openMVG::geometry;
+using namespace openMVG::geometry_aware;
+using namespace openMVG::matching;
+
+// Project random 3D points in two views.
+// Descriptors are drawn from a small set of values, so some left points have
+// several similar candidates and the distance ratio test matters.
+void SyntheticPair
+(
+  const Pinhole_Intrinsic & cam,
+  const Pose3 & poseL,
+  const Pose3 & poseR,
+  SIFT_Regions & regionsL,
+  SIFT_Regions & regionsR
+)
+{
+  std::mt19937 random_generator(42);
+  std::uniform_real_distribution<double> dist_xy(-5.0, 5.0), dist_z(8.0, 20.0);
+  std::uniform_int_distribution<int> dist_desc(0, 7), dist_noise(0, 3);
+  std::uniform_real_distribution<double> dist_px(-0.4, 0.4);
+
+  for (int i = 0; i < 2000; ++i)
+  {
+    const Vec3 X(dist_xy(random_generator), dist_xy(random_generator), dist_z(random_generator));
+    const Vec3 XL = poseL(X), XR = poseR(X);
+    if (XL(2) <= 0 || XR(2) <= 0)
+      continue;
+    const Vec2 xL = cam.project(poseL, X), xR = cam.project(poseR, X);
+    SIFT_Regions::DescriptorT desc;
+    const int value = dist_desc(random_generator) * 16;
+    for (int k = 0; k < SIFT_Regions::DescriptorT::static_size; ++k)
+      desc[k] = value + dist_noise(random_generator);
+    regionsL.Features().emplace_back(xL(0), xL(1), 1.f, 0.f);
+    regionsL.Descriptors().push_back(desc);
+    regionsR.Features().emplace_back(
+      xR(0) + dist_px(random_generator), xR(1) + dist_px(random_generator), 1.f, 0.f);
+    regionsR.Descriptors().push_back(desc);
+  }
+}
+
+// The epipolar index must give the same result as the exhaustive search
+bool CheckEpipolarIndex(const Pose3 & poseL, const Pose3 & poseR)
+{
+  const Pinhole_Intrinsic cam(1000, 800, 900, 500, 400);
+  SIFT_Regions regionsL, regionsR;
+  SyntheticPair(cam, poseL, poseR, regionsL, regionsR);
+
+  const Mat34
+    P_L = cam.get_projective_equivalent(poseL),
+    P_R = cam.get_projective_equivalent(poseR);
+  const Mat3 F = F_from_P(P_L, P_R);
+  const Vec3 epipole2 = P_R * poseL.center().homogeneous();
+  const double threshold = 2.0;
+
+  IndMatches exhaustive_matches, index_matches;
+  GuidedMatching<Mat3, fundamental::kernel::EpipolarDistanceError>(
+    F, &cam, regionsL, &cam, regionsR,
+    Square(threshold), Square(0.8), exhaustive_matches);
+  GuidedMatching_Fundamental_Epipolar_Index<fundamental::kernel::EpipolarDistanceError>(
+    F, epipole2, &cam, regionsL, &cam, regionsR,
+    Square(threshold), Square(0.8), index_matches);
+
+  std::cout << "#matches: " << index_matches.size() << std::endl;
+  return !index_matches.empty() && exhaustive_matches == index_matches;
+}
+
+TEST(GuidedMatching, EpipolarIndex_Generic)
+{
+  const Pose3 poseL(Mat3::Identity(), Vec3::Zero());
+  const Pose3 poseR(RotationAroundY(0.2) * RotationAroundX(0.05), Vec3(1.5, 0.2, -0.3));
+  EXPECT_TRUE(CheckEpipolarIndex(poseL, poseR));
+}
+
+TEST(GuidedMatching, EpipolarIndex_EpipoleInImage)
+{
+  // Forward motion
+  const Pose3 poseL(Mat3::Identity(), Vec3::Zero());
+  const Pose3 poseR(RotationAroundY(0.02), Vec3(0.1, -0.1, 2.0));
+  EXPECT_TRUE(CheckEpipolarIndex(poseL, poseR));
+}
+
+TEST(GuidedMatching, EpipolarIndex_EpipoleAtInfinity)
+{
+  // Sideway motion (parallel epipolar lines)
+  const Pose3 poseL(Mat3::Identity(), Vec3::Zero());
+  const Pose3 poseR(Mat3::Identity(), Vec3(1.0, 0.0, 0.0));
+  EXPECT_TRUE(CheckEpipolarIndex(poseL, poseR));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -99,6 +99,90 @@ bool UniformSample
   return true;
 }
 
+/**
+* Progressive sampling (PROSAC) [1]:
+* The data are expected to be sorted by decreasing quality
+*  (i.e. the putative matches sorted by their descriptor distance).
+* The samples are drawn from a set of the top ranked data that grows with the
+*  number of draws: the first hypotheses are built from the most reliable data
+*  and the sampling becomes uniform on all the data after T_N draws.
+*
+* [1] Ondrej Chum and Jiri Matas.
+*  Matching with PROSAC - Progressive Sample Consensus. CVPR 2005.
+*/
+class ProgressiveSampler
+{
+public:
+  /**
+  * \param[in] num_samples   The size of a sample.
+  * \param[in] total_samples The number of available samples.
+  * \param[in] T_N           The number of draws after which the sampling is uniform.
+  */
+  ProgressiveSampler
+  (
+    const uint32_t num_samples,
+    const uint32_t total_samples,
+    const uint32_t T_N
+  ):
+    num_samples_(num_samples),
+    total_samples_(total_samples),
+    t_(0),
+    n_(num_samples),
+    T_n_(T_N),
+    T_n_prime_(1)
+  {
+    for (uint32_t i = 0; i < num_samples_; ++i)
+    {
+      T_n_ *= static_cast<double>(n_ - i) / (total_samples_ - i);
+    }
+  }
+
+  /**
+  * Draw the next sample.
+  *
+  * \param[in] random_generator The random number generator.
+  * \param[out] samples         num_samples of numbers in [0, total_samples).
+  */
+  template <class RandomGeneratorT, typename SamplingType>
+  void Sample
+  (
+    RandomGeneratorT &random_generator,
+    std::vector<SamplingType> *samples
+  )
+  {
+    ++t_;
+    // Grow the set of the top ranked data.
+    // Note: T'_n is not rounded up as in [1] (at least one draw per set size),
+    //  so the sampling is uniform after T_N draws even if T_N < total_samples.
+    while (t_ >= T_n_prime_ && n_ < total_samples_)
+    {
+      const double T_n_next = T_n_ * (n_ + 1) / (n_ + 1 - num_samples_);
+      T_n_prime_ += T_n_next - T_n_;
+      T_n_ = T_n_next;
+      ++n_;
+    }
+
+    if (T_n_prime_ < t_)
+    {
+      // Draw the whole sample among the n_ top ranked data
+      UniformSample(num_samples_, n_, random_generator, samples);
+    }
+    else
+    {
+      // The sample contains the n_th data and some data of the top ranked set
+      UniformSample(num_samples_ - 1, n_ - 1, random_generator, samples);
+      samples->push_back(static_cast<SamplingType>(n_ - 1));
+    }
+  }
+
+private:
+  const uint32_t num_samples_;
+  const uint32_t total_samples_;
+  uint32_t t_; // Number of drawn samples
+  uint32_t n_; // Size of the top ranked data set
+  double T_n_; // Average number of samples drawn from the n_ top ranked data
+  double T_n_prime_; // Number of draws after which the set grows
+};
 
 } // namespace robust
 } // namespace openMVG
@@ -10,6 +10,7 @@
 
 #include "testing/testing.h"
 
+#include <algorithm>
 #include <numeric>
 #include <set>
 
@@ -45,6 +46,29 @@ TEST(UniformSampleTestInAVectorOfUniqueElements, NoRepetions) {
   }
 }
 
+// Assert that the progressive sampling draws unique indices among a set of
+//  top ranked data that grows up to all the data
+TEST(ProgressiveSample, GrowingSet) {
+
+  const uint32_t total = 500, num_samples = 7, T_N = 1000;
+  ProgressiveSampler sampler(num_samples, total, T_N);
+
+  std::vector<uint32_t> samples;
+  uint32_t max_index = 0;
+  for (uint32_t t = 0; t < 2 * T_N; ++t) {
+    sampler.Sample(random_generator, &samples);
+    const std::set<uint32_t> myset(samples.begin(), samples.end());
+    CHECK_EQUAL(num_samples, myset.size());
+    CHECK(*myset.rbegin() < total);
+    if (t == 0) {
+      // The first sample is drawn from the best data
+      CHECK(*myset.rbegin() < 2 * num_samples);
+    }
+    max_index = std::max(max_index, *myset.rbegin());
+  }
+  CHECK_EQUAL(total - 1, max_index);
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -38,11 +38,13 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <limits>
 #include <numeric>
 #include <random>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -114,6 +116,21 @@ static void makelogcombi
   makelogcombi_k(k, n, vec_logc_k, vec_log10);
 }
 
+/// Tell if a kernel provides a residual evaluation by range of data:
+///  void Errors(const Model &, uint32_t begin, uint32_t end, double * errors) const
+template <typename Kernel>
+class HasBlockErrors
+{
+  template <typename T>
+  static auto test(int) -> decltype(
+    std::declval<const T &>().Errors(std::declval<const typename T::Model &>(),
+      uint32_t(0), uint32_t(0), std::declval<double *>()), std::true_type());
+  template <typename T>
+  static std::false_type test(...);
+public:
+  using type = decltype(test<Kernel>(0));
+};
+
 template <typename Kernel>
 class NFA_Interface
 {
@@ -139,11 +156,60 @@ public:
     // Precompute log combi
     m_loge0 = log10((double)Kernel::MAX_MODELS * (kernel.NumSamples() - Kernel::MINIMUM_SAMPLES));
     makelogcombi(Kernel::MINIMUM_SAMPLES, kernel.NumSamples(), m_logc_k, m_logc_n);
+
+    if (m_bquantified_nfa_evaluation)
+    {
+      // Lower bound of the NFA of a model with at most k inliers:
+      // every inlier is assumed to have the smallest quantified residual.
+      double logalpha_min = std::numeric_limits<double>::infinity();
+      for (const double residual :
+        Histogram<double>(0.0, m_max_threshold, m_nBins).GetXbinsValue())
+      {
+        if (residual > std::numeric_limits<float>::epsilon())
+        {
+          logalpha_min = m_kernel.logalpha0()
+            + m_kernel.multError() * log10(residual
+            + std::numeric_limits<float>::epsilon());
+          break;
+        }
+      }
+      const uint32_t n = kernel.NumSamples();
+      m_nfa_lower_bound.assign(n + 1, std::numeric_limits<double>::infinity());
+      for (uint32_t k = Kernel::MINIMUM_SAMPLES + 1; k <= n; ++k)
+      {
+        const double nfa = m_loge0
+          + logalpha_min * (double)(k - Kernel::MINIMUM_SAMPLES)
+          + m_logc_n[k]
+          + m_logc_k[k];
+        m_nfa_lower_bound[k] = std::min(m_nfa_lower_bound[k - 1], nfa);
+      }
+    }
   };
 
   std::vector<double> & residuals()
   { return m_residuals;}
 
+  /**
+   * @brief Compute the residual errors of a model.
+   * In the quantified NFA evaluation mode, the residuals are evaluated by
+   *  blocks and the evaluation stops as soon as the model cannot reach a NFA
+   *  lower than nfa_bound (bail-out): even if all the remaining data were
+   *  inliers with the smallest quantified residual.
+   * A block is evaluated by the kernel Errors(model, begin, end, errors)
+   *  function if it exists (the model is prepared once per block),
+   *  else point by point with Error(index, model).
+   *
+   * @param[in] model The model to evaluate
+   * @param[in] nfa_bound The NFA the model must beat (i.e. the best NFA so far)
+   *
+   * @return false if the evaluation was stopped (the model cannot beat nfa_bound).
+   */
+  bool ComputeResiduals
+  (
+    const typename Kernel::Model & model,
+    const double nfa_bound
+  );
+
   /**
    * @brief Evaluation of the NFA (Number of False Alarm)
    *  for the given residual distribution.
@@ -168,15 +234,67 @@ public:
 
 private:
 
+  /// Compute the residuals of the data in [begin, end) with the kernel block evaluation
+  void ComputeBlockResiduals
+  (
+    const typename Kernel::Model & model,
+    const uint32_t begin,
+    const uint32_t end,
+    std::true_type
+  )
+  {
+    m_kernel.Errors(model, begin, end, m_residuals.data() + begin);
+  }
+
+  /// Compute the residuals of the data in [begin, end) one by one
+  void ComputeBlockResiduals
+  (
+    const typename Kernel::Model & model,
+    const uint32_t begin,
+    const uint32_t end,
+    std::false_type
+  )
+  {
+    for (uint32_t index = begin; index < end; ++index)
+      m_residuals[index] = m_kernel.Error(index, model);
+  }
+
+  /// Number of bins of the quantified NFA evaluation
+  static const int m_nBins = 20;
+
   /// residual array
   std::vector<double> m_residuals;
   /// [residual,index] array -> used in the exhaustive nfa computation mode
   std::vector<std::pair<double,uint32_t>> m_sorted_residuals;
+  /// Residual buckets (start index in m_sorted_residuals) -> exhaustive nfa computation mode
+  std::vector<uint32_t> m_bucket_begin;
+
+  /// Bucket of a residual value in the exhaustive nfa computation mode:
+  ///  the bit pattern of the non negative doubles is ordered as the values,
+  ///  the bucket is given by the exponent and the two highest mantissa bits.
+  static uint32_t ResidualBucket(const double residual)
+  {
+    if (!(residual > 0.0))
+      return 0;
+    uint64_t bits;
+    std::memcpy(&bits, &residual, sizeof(double));
+    return static_cast<uint32_t>(bits >> 50);
+  }
+  /// Smallest residual value of a bucket
+  static double BucketResidual(const uint32_t bucket)
+  {
+    const uint64_t bits = static_cast<uint64_t>(bucket) << 50;
+    double residual;
+    std::memcpy(&residual, &bits, sizeof(double));
+    return residual;
+  }
 
   /// Combinatorial log
   std::vector<float> m_logc_n, m_logc_k;
   /// A-Contrario Epsilon 0 value
   double m_loge0;
+  /// Lower bound of the NFA wrt. the maximal number of inliers (quantified mode)
+  std::vector<double> m_nfa_lower_bound;
 
   /// Kernel (model estimation interface)
   const Kernel & m_kernel;
@@ -186,6 +304,40 @@ private:
   const double m_max_threshold;
 };
 
+template <typename Kernel>
+bool
+NFA_Interface<Kernel>::ComputeResiduals
+(
+  const typename Kernel::Model & model,
+  const double nfa_bound
+)
+{
+  if (!m_bquantified_nfa_evaluation
+      || nfa_bound == std::numeric_limits<double>::infinity())
+  {
+    m_kernel.Errors(model, m_residuals);
+    return true;
+  }
+
+  const uint32_t n = m_kernel.NumSamples();
+  const uint32_t block_size = 64;
+  uint32_t outlier_count = 0;
+  for (uint32_t begin = 0; begin < n; begin += block_size)
+  {
+    const uint32_t end = std::min(n, begin + block_size);
+    ComputeBlockResiduals(model, begin, end, typename HasBlockErrors<Kernel>::type());
+    for (uint32_t index = begin; index < end; ++index)
+    {
+      if (!(m_residuals[index] <= m_max_threshold))
+        ++outlier_count;
+    }
+    // Best reachable NFA if all the remaining data are inliers
+    if (m_nfa_lower_bound[n - outlier_count] >= nfa_bound)
+      return false;
+  }
+  return true;
+}
+
 template <typename Kernel>
 bool
 NFA_Interface<Kernel>::ComputeNFA_and_inliers
@@ -208,7 +360,7 @@ NFA_Interface<Kernel>::ComputeNFA_and_inliers
     // This version avoid:
     //   - to sort explicitly the residual error array,
     //   - to compute the NFA for every sample of the datum.
-    const int nBins = 20;
+    const int nBins = m_nBins;
     Histogram<double> histo(0.0f, m_max_threshold, nBins);
     histo.Add(m_residuals.begin(), m_residuals.end());
 
@@ -255,41 +407,123 @@ NFA_Interface<Kernel>::ComputeNFA_and_inliers
   }
   else // exhaustive computation
   {
-    // Residuals sorting (ascending order while keeping original point indexes)
+    // The NFA is evaluated for the residuals sorted in ascending order.
+    // In order to avoid sorting the whole residual array for every model:
+    // - the residuals are dispatched in buckets of increasing values (linear time),
+    // - a lower bound of the NFA inside each bucket is computed from the
+    //   smallest value of the bucket,
+    // - only the buckets that can contain a NFA better than the one of the
+    //   model (and than the given nfa_threshold) are sorted.
+    // The found NFA and inliers are the same as with a complete sort.
+    const uint32_t n = m_kernel.NumSamples();
+    uint32_t valid_count = 0;
+    uint32_t min_bucket = std::numeric_limits<uint32_t>::max(), max_bucket = 0;
+    for (const double residual : m_residuals)
     {
-      m_sorted_residuals.clear();
-      m_sorted_residuals.reserve(m_kernel.NumSamples());
-      for (uint32_t i = 0; i < m_kernel.NumSamples(); ++i)
+      if (residual <= m_max_threshold)
       {
-        m_sorted_residuals.emplace_back(m_residuals[i], i);
+        const uint32_t bucket = ResidualBucket(residual);
+        min_bucket = std::min(min_bucket, bucket);
+        max_bucket = std::max(max_bucket, bucket);
+        ++valid_count;
       }
-      std::sort(m_sorted_residuals.begin(), m_sorted_residuals.end());
     }
+    if (valid_count <= Kernel::MINIMUM_SAMPLES)
+      return false;
 
-    // Find best NFA and its index wrt square error threshold in m_sorted_residuals.
-    using nfa_indexT = std::pair<double, uint32_t>;
-    nfa_indexT current_best_nfa(std::numeric_limits<double>::infinity(), Kernel::MINIMUM_SAMPLES);
-    const size_t n = m_kernel.NumSamples();
-    for (size_t k = Kernel::MINIMUM_SAMPLES + 1;
-        k <= n && m_sorted_residuals[k-1].first <= m_max_threshold;
-        ++k) // Compute the NFA for all k in [minimal_sample+1,n]
+    // Counting sort of the residuals by bucket
+    const uint32_t bucket_count = max_bucket - min_bucket + 1;
+    m_bucket_begin.assign(bucket_count + 1, 0);
+    for (const double residual : m_residuals)
+    {
+      if (residual <= m_max_threshold)
+        ++m_bucket_begin[ResidualBucket(residual) - min_bucket + 1];
+    }
+    std::partial_sum(m_bucket_begin.begin(), m_bucket_begin.end(), m_bucket_begin.begin());
+    {
+      std::vector<uint32_t> bucket_fill(m_bucket_begin.begin(), m_bucket_begin.end() - 1);
+      m_sorted_residuals.resize(valid_count);
+      for (uint32_t i = 0; i < n; ++i)
+      {
+        if (m_residuals[i] <= m_max_threshold)
+          m_sorted_residuals[bucket_fill[ResidualBucket(m_residuals[i]) - min_bucket]++] =
+            {m_residuals[i], i};
+      }
+    }
+
+    const auto logalpha = [&](const double residual)
     {
-      const double logalpha = m_kernel.logalpha0()
-        + m_kernel.multError() * log10(m_sorted_residuals[k-1].first
+      return m_kernel.logalpha0()
+        + m_kernel.multError() * log10(residual
         + std::numeric_limits<float>::epsilon());
-      const nfa_indexT current_nfa( m_loge0
+    };
+    const auto nfa = [&](const double logalpha, const uint32_t k)
+    {
+      return m_loge0
         + logalpha * (double)(k - Kernel::MINIMUM_SAMPLES)
         + m_logc_n[k]
-        + m_logc_k[k], k);
+        + m_logc_k[k];
+    };
+
+    // NFA lower bound of every bucket and an upper bound of the best NFA
+    std::vector<double> bucket_lower_bound(bucket_count,
+      std::numeric_limits<double>::infinity());
+    double best_nfa_upper_bound = std::numeric_limits<double>::infinity();
+    for (uint32_t bucket = 0; bucket < bucket_count; ++bucket)
+    {
+      const uint32_t k_end = m_bucket_begin[bucket + 1];
+      if (k_end <= Kernel::MINIMUM_SAMPLES || k_end == m_bucket_begin[bucket])
+        continue;
+      const uint32_t k_begin = std::max<uint32_t>(m_bucket_begin[bucket] + 1,
+        Kernel::MINIMUM_SAMPLES + 1);
+      const double bucket_logalpha = logalpha(BucketResidual(bucket + min_bucket));
+      for (uint32_t k = k_begin; k <= k_end; ++k)
+        bucket_lower_bound[bucket] =
+          std::min(bucket_lower_bound[bucket], nfa(bucket_logalpha, k));
+      // The k_end-th residual is lower than the smallest value of the next bucket
+      const double next_bucket_residual = BucketResidual(bucket + min_bucket + 1);
+      if (std::isfinite(next_bucket_residual))
+        best_nfa_upper_bound =
+          std::min(best_nfa_upper_bound, nfa(logalpha(next_bucket_residual), k_end));
+    }
 
-      if (current_nfa.first < current_best_nfa.first)
-        current_best_nfa = current_nfa;
+    // Find best NFA and its index wrt square error threshold in m_sorted_residuals.
+    using nfa_indexT = std::pair<double, uint32_t>;
+    nfa_indexT current_best_nfa(std::numeric_limits<double>::infinity(), Kernel::MINIMUM_SAMPLES);
+    std::vector<bool> bucket_sorted(bucket_count, false);
+    for (uint32_t bucket = 0; bucket < bucket_count; ++bucket)
+    {
+      if (!(bucket_lower_bound[bucket] <= best_nfa_upper_bound
+            && bucket_lower_bound[bucket] < nfa_threshold.first))
+        continue;
+      const uint32_t k_begin = std::max<uint32_t>(m_bucket_begin[bucket] + 1,
+        Kernel::MINIMUM_SAMPLES + 1);
+      const uint32_t k_end = m_bucket_begin[bucket + 1];
+      std::sort(m_sorted_residuals.begin() + m_bucket_begin[bucket],
+                m_sorted_residuals.begin() + k_end);
+      bucket_sorted[bucket] = true;
+      for (uint32_t k = k_begin; k <= k_end; ++k)
+      {
+        const nfa_indexT current_nfa(nfa(logalpha(m_sorted_residuals[k-1].first), k), k);
+        if (current_nfa.first < current_best_nfa.first)
+          current_best_nfa = current_nfa;
+      }
     }
 
     // If the current NFA is better than the previous
     // - update the sample inlier index list.
     if (current_best_nfa.first < nfa_threshold.first)
     {
+      // Sort the remaining buckets of the inliers
+      for (uint32_t bucket = 0;
+        bucket < bucket_count && m_bucket_begin[bucket] < current_best_nfa.second;
+        ++bucket)
+      {
+        if (!bucket_sorted[bucket])
+          std::sort(m_sorted_residuals.begin() + m_bucket_begin[bucket],
+                    m_sorted_residuals.begin() + m_bucket_begin[bucket + 1]);
+      }
+
       nfa_threshold.first = current_best_nfa.first;
       nfa_threshold.second = m_sorted_residuals[current_best_nfa.second-1].first;
 
@@ -305,6 +539,14 @@ NFA_Interface<Kernel>::ComputeNFA_and_inliers
 }
 }  // namespace acransac_nfa_internal
 
+/// Minimal samples drawing strategy of ACRANSAC
+enum class ACRANSAC_SAMPLING
+{
+  UNIFORM,    // Uniform sampling of all the data
+  PROGRESSIVE // PROSAC: the data are expected to be sorted by decreasing quality
+              //  and the samples are first drawn among the best data
+};
+
 /**
  * @brief ACRANSAC routine (ErrorThreshold, NFA)
  * If an upper bound of the threshold is provided:
@@ -318,6 +560,10 @@ NFA_Interface<Kernel>::ComputeNFA_and_inliers
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision (squared error)
  * @param[in] bVerbose display console log
+ * @param[in] sampling minimal samples drawing strategy
+ *
+ * If an upper bound of the threshold is provided, the residual evaluation of
+ *  a model is stopped as soon as it cannot beat the best NFA found so far.
  *
  * @return (errorMax, minNFA)
  */
@@ -329,7 +575,8 @@ std::pair<double, double> ACRANSAC
   const unsigned int num_max_iteration = 1024,
   typename Kernel::Model * model = nullptr,
   double precision = std::numeric_limits<double>::infinity(),
-  bool bVerbose = false
+  bool bVerbose = false,
+  const ACRANSAC_SAMPLING sampling = ACRANSAC_SAMPLING::UNIFORM
 )
 {
   vec_inliers.clear();
@@ -376,19 +623,29 @@ std::pair<double, double> ACRANSAC
   //--
   // Random number generation
   std::mt19937 random_generator(std::mt19937::default_seed);
+  // Progressive sampling (used until the local optimization starts):
+  //  the sampling is uniform on all the data at the end of the iteration budget
+  bool bProgressive_sampling = (sampling == ACRANSAC_SAMPLING::PROGRESSIVE);
+  ProgressiveSampler progressive_sampler(sizeSample, nData, nIter);
+
+  // Model hypotheses (the storage is reused from one iteration to the next)
+  std::vector<typename Kernel::Model> vec_models;
+  vec_models.reserve(Kernel::MAX_MODELS);
 
   //--
   // Main estimation loop.
   for (unsigned int iter = 0; iter < nIter && iter < num_max_iteration; ++iter)
   {
     // Get random samples
-    if (bACRansacMode)
+    if (bProgressive_sampling)
+      progressive_sampler.Sample(random_generator, &vec_sample);
+    else if (bACRansacMode)
       UniformSample(sizeSample, random_generator, &vec_index, &vec_sample);
     else
       UniformSample(sizeSample, nData, random_generator, &vec_sample);
 
     // Fit model(s). Can find up to Kernel::MAX_MODELS solution(s)
-    std::vector<typename Kernel::Model> vec_models;
+    vec_models.clear();
     kernel.Fit(vec_sample, &vec_models);
 
     // Evaluate model(s)
@@ -396,7 +653,9 @@ std::pair<double, double> ACRANSAC
     for (const auto& model_it : vec_models)
     {
       // Compute residual values
-      kernel.Errors(model_it, nfa_interface.residuals());
+      // (skip the model as soon as it cannot beat the best NFA found so far)
+      if (!nfa_interface.ComputeResiduals(model_it, minNFA))
+        continue;
 
       if (!bACRansacMode)
       {
@@ -462,6 +721,7 @@ std::pair<double, double> ACRANSAC
       {
         // ACRANSAC optimization: draw samples among best set of inliers so far
         vec_index = vec_inliers;
+        bProgressive_sampling = false;
         if (nIterReserve) {
             // reduce the number of iteration
             // next iterations will be dedicated to local optimization
@@ -28,6 +28,8 @@
 //  by the generic ACRANSAC routine.
 //
 
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "openMVG/multiview/conditioning.hpp"
@@ -36,6 +38,61 @@
 namespace openMVG {
 namespace robust{
 
+namespace internal {
+
+/// Tell if an error functor provides a batch residual evaluation:
+///  static void Errors(const Model &, const Eigen::Ref<const MatX2> & x1,
+///    const Eigen::Ref<const MatX2> & x2, double * errors)
+template <typename ErrorT, typename ModelT>
+class HasBatchErrors
+{
+  template <typename T>
+  static auto test(int) -> decltype(
+    T::Errors(std::declval<const ModelT &>(),
+              std::declval<const MatX2 &>(), std::declval<const MatX2 &>(),
+              std::declval<double *>()), std::true_type());
+  template <typename T>
+  static std::false_type test(...);
+public:
+  using type = decltype(test<ErrorT>(0));
+};
+
+/// Evaluate the residuals of the correspondences in [begin, end) with the
+///  batch functor (the points are stored by coordinate arrays: x1_soa = x1.transpose())
+template <typename ErrorT, typename ModelT>
+void TwoViewErrors
+(
+  const ModelT & model,
+  const Mat & x1, const Mat & x2,
+  const MatX2 & x1_soa, const MatX2 & x2_soa,
+  uint32_t begin, uint32_t end,
+  double * errors,
+  std::true_type
+)
+{
+  ErrorT::Errors(model,
+    x1_soa.middleRows(begin, end - begin), x2_soa.middleRows(begin, end - begin),
+    errors);
+}
+
+/// Evaluate the residuals of the correspondences in [begin, end) one by one
+template <typename ErrorT, typename ModelT>
+void TwoViewErrors
+(
+  const ModelT & model,
+  const Mat & x1, const Mat & x2,
+  const MatX2 & x1_soa, const MatX2 & x2_soa,
+  uint32_t begin, uint32_t end,
+  double * errors,
+  std::false_type
+)
+{
+  for (uint32_t sample = begin; sample < end; ++sample)
+    *errors++ = ErrorT::Error(model, x1.col(sample), x2.col(sample));
+}
+
+} // namespace internal
+
 /// Two view Kernel adapter for the A contrario model estimator
 /// Handle data normalization and compute the corresponding logalpha 0
 ///  that depends of the error model (point to line, or point to point)
@@ -64,6 +121,11 @@ public:
 
     NormalizePoints(x1, &x1_, &N1_, w1, h1);
     NormalizePoints(x2, &x2_, &N2_, w2, h2);
+    if (HasBatchErrors::value)
+    {
+      x1_soa_ = x1_.transpose();
+      x2_soa_ = x2_.transpose();
+    }
 
     // LogAlpha0 is used to make error data scale invariant
     if (bPointToLine)  {
@@ -94,8 +156,20 @@ public:
   void Errors(const Model & model, std::vector<double> & vec_errors) const
   {
     vec_errors.resize(x1_.cols());
-    for (uint32_t sample = 0; sample < x1_.cols(); ++sample)
-      vec_errors[sample] = ErrorT::Error(model, x1_.col(sample), x2_.col(sample));
+    Errors(model, 0, x1_.cols(), vec_errors.data());
+  }
+
+  /// Residuals of the samples in [begin, end)
+  void Errors
+  (
+    const Model & model,
+    uint32_t begin,
+    uint32_t end,
+    double * errors
+  ) const
+  {
+    internal::TwoViewErrors<ErrorT>(model, x1_, x2_, x1_soa_, x2_soa_,
+      begin, end, errors, HasBatchErrors());
   }
 
   size_t NumSamples() const {
@@ -116,7 +190,10 @@ public:
   double unormalizeError(double val) const {return sqrt(val) / N2_(0,0);}
 
 private:
+  using HasBatchErrors = typename internal::HasBatchErrors<ErrorT, Model>::type;
+
   Mat x1_, x2_;       // Normalized input data
+  MatX2 x1_soa_, x2_soa_; // Normalized input data by coordinate arrays (batch evaluation)
   Mat3 N1_, N2_;      // Matrix used to normalize data
   double logalpha0_; // Alpha0 is used to make the error adaptive to the image size
   bool bPointToLine_;// Store if error model is pointToLine or point to point
@@ -167,8 +244,20 @@ public:
   void Errors(const Model & model, std::vector<double> & vec_errors) const
   {
     vec_errors.resize(x2d_.cols());
-    for (uint32_t sample = 0; sample < x2d_.cols(); ++sample)
-      vec_errors[sample] = ErrorT::Error(model, x2d_.col(sample), x3D_.col(sample));
+    Errors(model, 0, x2d_.cols(), vec_errors.data());
+  }
+
+  /// Residuals of the samples in [begin, end)
+  void Errors
+  (
+    const Model & model,
+    uint32_t begin,
+    uint32_t end,
+    double * errors
+  ) const
+  {
+    for (uint32_t sample = begin; sample < end; ++sample)
+      *errors++ = ErrorT::Error(model, x2d_.col(sample), x3D_.col(sample));
   }
 
   size_t NumSamples() const { return x2d_.cols(); }
@@ -239,8 +328,20 @@ public:
   void Errors(const Model & model, std::vector<double> & vec_errors) const
   {
     vec_errors.resize(x2d_.cols());
-    for (uint32_t sample = 0; sample < x2d_.cols(); ++sample)
-      vec_errors[sample] = ErrorT::Error(model, x2d_.col(sample), x3D_.col(sample));
+    Errors(model, 0, x2d_.cols(), vec_errors.data());
+  }
+
+  /// Residuals of the samples in [begin, end)
+  void Errors
+  (
+    const Model & model,
+    uint32_t begin,
+    uint32_t end,
+    double * errors
+  ) const
+  {
+    for (uint32_t sample = begin; sample < end; ++sample)
+      *errors++ = ErrorT::Error(model, x2d_.col(sample), x3D_.col(sample));
   }
 
   size_t NumSamples() const { return x2d_.cols(); }
@@ -282,14 +383,20 @@ public:
     const Mat3 & K1, const Mat3 & K2
   ):x1_(x1), x2_(x2),
     N1_(Mat3::Identity()), N2_(Mat3::Identity()), logalpha0_(0.0),
-    K1_(K1), K2_(K2)
+    K1_(K1), K2_(K2),
+    K1_inv_(K1.inverse()), K2_inv_t_(K2.inverse().transpose())
   {
     assert(2 == x1_.rows());
     assert(x1_.rows() == x2_.rows());
     assert(x1_.cols() == x2_.cols());
 
-    x1k_ = (K1_.inverse() * x1_.colwise().homogeneous()).colwise().hnormalized();
-    x2k_ = (K2_.inverse() * x2_.colwise().homogeneous()).colwise().hnormalized();
+    x1k_ = (K1_inv_ * x1_.colwise().homogeneous()).colwise().hnormalized();
+    x2k_ = (K2_inv_t_.transpose() * x2_.colwise().homogeneous()).colwise().hnormalized();
+    if (HasBatchErrors::value)
+    {
+      x1_soa_ = x1_.transpose();
+      x2_soa_ = x2_.transpose();
+    }
 
     //Point to line probability (line is the epipolar line)
     const double D = std::hypot(w2, h2); // diameter
@@ -307,18 +414,27 @@ public:
   }
 
   double Error(uint32_t sample, const Model &model) const {
-    Mat3 F;
-    FundamentalFromEssential(model, K1_, K2_, &F);
-    return ErrorT::Error(F, this->x1_.col(sample), this->x2_.col(sample));
+    return ErrorT::Error(Fundamental(model), this->x1_.col(sample), this->x2_.col(sample));
   }
 
   void Errors(const Model & model, std::vector<double> & vec_errors) const
   {
-    Mat3 F;
-    FundamentalFromEssential(model, K1_, K2_, &F);
     vec_errors.resize(x1_.cols());
-    for (uint32_t sample = 0; sample < x1_.cols(); ++sample)
-      vec_errors[sample] = ErrorT::Error(F, this->x1_.col(sample), this->x2_.col(sample));
+    Errors(model, 0, x1_.cols(), vec_errors.data());
+  }
+
+  /// Residuals of the samples in [begin, end)
+  /// (the fundamental matrix is computed once for the whole range)
+  void Errors
+  (
+    const Model & model,
+    uint32_t begin,
+    uint32_t end,
+    double * errors
+  ) const
+  {
+    internal::TwoViewErrors<ErrorT>(Fundamental(model), x1_, x2_, x1_soa_, x2_soa_,
+      begin, end, errors, HasBatchErrors());
   }
 
   size_t NumSamples() const { return x1_.cols(); }
@@ -330,10 +446,17 @@ public:
   double unormalizeError(double val) const { return val; }
 
 private:
+  using HasBatchErrors = typename internal::HasBatchErrors<ErrorT, Mat3>::type;
+
+  /// Fundamental matrix of an essential matrix: F = K2^-T * E * K1^-1
+  Mat3 Fundamental(const Model & E) const { return K2_inv_t_ * E * K1_inv_; }
+
   Mat x1_, x2_, x1k_, x2k_; // image point and camera plane point.
+  MatX2 x1_soa_, x2_soa_; // image point by coordinate arrays (batch evaluation)
   Mat3 N1_, N2_;      // Matrix used to normalize data
   double logalpha0_; // Alpha0 is used to make the error adaptive to the image size
   Mat3 K1_, K2_;      // Intrinsic camera parameter
+  Mat3 K1_inv_, K2_inv_t_; // K1^-1 and K2^-T (fundamental matrix computation)
 };
 
 /// Two view Kernel adapter for the A contrario model estimator.
@@ -375,8 +498,20 @@ public:
   void Errors(const Model & model, std::vector<double> & vec_errors) const
   {
     vec_errors.resize(x1_.cols());
-    for (uint32_t sample = 0; sample < x1_.cols(); ++sample)
-      vec_errors[sample] = Square(ErrorT::Error(model, x1_.col(sample), x2_.col(sample)));
+    Errors(model, 0, x1_.cols(), vec_errors.data());
+  }
+
+  /// Residuals of the samples in [begin, end)
+  void Errors
+  (
+    const Model & model,
+    uint32_t begin,
+    uint32_t end,
+    double * errors
+  ) const
+  {
+    for (uint32_t sample = begin; sample < end; ++sample)
+      *errors++ = Square(ErrorT::Error(model, x1_.col(sample), x2_.col(sample)));
   }
 
   size_t NumSamples() const {
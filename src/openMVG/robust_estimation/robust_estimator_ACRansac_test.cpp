@@ -14,6 +14,7 @@
 #include "testing/testing.h"
 #include "third_party/vectorGraphics/svgDrawer.hpp"
 
+#include <algorithm>
 #include <iterator>
 #include <random>
 
@@ -206,6 +207,52 @@ TEST(RansacLineFitter, RealisticCase) {
   EXPECT_NEAR(GTModel(1), line[1], 1e-9);
 }
 
+// Same as RealisticCase with an upper bound of the threshold
+//  (the model residual evaluation can bail-out)
+//  and a progressive sampling of the data sorted by quality (inliers first).
+TEST(RansacLineFitter, RealisticCase_ProgressiveSampling) {
+
+  constexpr int NbPoints = 100;
+  constexpr int NbOutliers = 70;
+  Mat2X xy(2, NbPoints);
+
+  Vec2 GTModel; // y = 6.3 x + (-2.0)
+  GTModel <<  -2.0, 6.3;
+
+  // The first points are the most reliable ones:
+  // most of the outliers are at the end of the list
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::normal_distribution<> d(0, 0.1); // Inliers noise
+  std::uniform_real_distribution<> d_outlier(20.0, 100.0); // Distance of the outliers to the line
+  std::vector<uint32_t> vec_gt_inliers;
+  for (int i = 0; i < NbPoints; ++i) {
+    const Vec2 x(i, static_cast<double>(i)*GTModel[1] + GTModel[0]);
+    if (i >= NbPoints - NbOutliers + 5 || i % 10 == 9)
+      xy.col(i) = x + Vec2(0.0, d_outlier(random_generator));
+    else {
+      xy.col(i) = x + Vec2(0.0, d(random_generator));
+      vec_gt_inliers.push_back(i);
+    }
+  }
+  ACRANSACOneViewKernel<LineSolver, pointToLineError, Vec2> lineKernel(xy, 100, 650);
+
+  for (const ACRANSAC_SAMPLING sampling :
+    {ACRANSAC_SAMPLING::UNIFORM, ACRANSAC_SAMPLING::PROGRESSIVE})
+  {
+    std::vector<uint32_t> vec_inliers;
+    Vec2 line;
+    ACRANSAC(lineKernel, vec_inliers, 300, &line, 1.0, false, sampling);
+
+    // The inliers are found (up to the quantified threshold)
+    std::sort(vec_inliers.begin(), vec_inliers.end());
+    CHECK(vec_inliers.size() >= 0.9 * vec_gt_inliers.size());
+    CHECK(std::includes(vec_gt_inliers.begin(), vec_gt_inliers.end(),
+      vec_inliers.begin(), vec_inliers.end()));
+    EXPECT_NEAR(GTModel(0), line[0], 0.5);
+    EXPECT_NEAR(GTModel(1), line[1], 0.05);
+  }
+}
+
 // Generate nbPoints along a line and add gaussian noise.
 // Move some point in the dataset to create outlier contamined data
 void generateLine(Mat & points, size_t nbPoints, int W, int H, float noise, float outlierRatio)
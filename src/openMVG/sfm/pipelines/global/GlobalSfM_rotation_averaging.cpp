@@ -84,17 +84,34 @@ bool GlobalSfM_Rotation_AveragingSolver::Run(
   switch (eRotationAveragingMethod)
   {
     case ROTATION_AVERAGING_L2:
+    case ROTATION_AVERAGING_L2_SPARSE:
     {
-      //- Solve the global rotation estimation problem:
-      bSuccess = rotation_averaging::l2::L2RotationAveraging(
-        reindexForward.size(),
-        relativeRotations,
-        vec_globalR);
-      //- Non linear refinement of the global rotations
-      if (bSuccess)
-        bSuccess = rotation_averaging::l2::L2RotationAveraging_Refine(
+      if (eRotationAveragingMethod == ROTATION_AVERAGING_L2)
+      {
+        //- Solve the global rotation estimation problem:
+        bSuccess = rotation_averaging::l2::L2RotationAveraging(
+          reindexForward.size(),
+          relativeRotations,
+          vec_globalR);
+        //- Non linear refinement of the global rotations
+        if (bSuccess)
+          bSuccess = rotation_averaging::l2::L2RotationAveraging_Refine(
+            relativeRotations,
+            vec_globalR);
+      }
+      else
+      {
+        //- Solve the global rotation estimation problem (sparse eigen solver):
+        bSuccess = rotation_averaging::l2::L2RotationAveraging_Sparse(
+          reindexForward.size(),
           relativeRotations,
           vec_globalR);
+        //- Parallel chordal refinement of the global rotations
+        if (bSuccess)
+          bSuccess = rotation_averaging::l2::L2RotationAveraging_Refine_Chordal(
+            relativeRotations,
+            vec_globalR);
+      }
 
       // save kept pairs (restore original pose indices using the backward reindexing)
       for (RelativeRotations::iterator iter = relativeRotations.begin();  iter != relativeRotations.end(); ++iter)
@@ -17,7 +17,8 @@ namespace sfm {
 enum ERotationAveragingMethod
 {
   ROTATION_AVERAGING_L1 = 1,
-  ROTATION_AVERAGING_L2 = 2
+  ROTATION_AVERAGING_L2 = 2,
+  ROTATION_AVERAGING_L2_SPARSE = 3 // L2 with sparse eigen solver & chordal refinement
 };
 
 enum ERelativeRotationInferenceMethod
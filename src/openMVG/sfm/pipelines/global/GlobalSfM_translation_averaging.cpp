@@ -31,6 +31,8 @@
 #include "openMVG/stl/stl.hpp"
 #include "openMVG/system/timer.hpp"
 
+#include <algorithm>
+#include <numeric>
 #include <vector>
 
 namespace openMVG{
@@ -221,6 +223,39 @@ bool GlobalSfM_Translation_AveragingSolver::Translation_averaging(
       }
       break;
 
+      case TRANSLATION_AVERAGING_L1_IRLS:
+      {
+        std::vector<Vec3> vec_translations;
+        if (!solve_translations_problem_l1_irls(
+          vec_relative_motion_cpy, vec_translations))
+        {
+          std::cerr << "Compute global translations: failed" << std::endl;
+          return false;
+        }
+
+        const double timeLP_translation = timerLP_translation.elapsed();
+        //-- Export triplet statistics:
+        {
+          std::ostringstream os;
+          os << "-------------------------------" << "\n"
+            << "-- #relative estimates: " << vec_relative_motion_cpy.size() << ".\n"
+            << " timing (s): " << timeLP_translation << ".\n"
+            << "-------------------------------" << "\n";
+          std::cout << os.str() << std::endl;
+        }
+
+        // A valid solution was found:
+        // - Update the view poses according the found camera translations
+        for (size_t i = 0; i < iNview; ++i)
+        {
+          const Vec3 & t = vec_translations[i];
+          const IndexT pose_id = reindex_backward[i];
+          const Mat3 & Ri = map_globalR.at(pose_id);
+          sfm_data.poses[pose_id] = Pose3(Ri, -Ri.transpose()*t);
+        }
+      }
+      break;
+
       case TRANSLATION_AVERAGING_L2_DISTANCE_CHORDAL:
       {
         std::vector<int> vec_edges;
@@ -376,8 +411,10 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
       map_tripletIds_perEdge[{triplet.j, triplet.k}].push_back(i);
     }
 
-    //-- precompute the visibility count per triplets (sum of their 2 view matches)
-    Hash_Map<IndexT, IndexT> map_tracksPerTriplets;
+    //-- Index the pairwise matches by pose edge
+    //  (a pose edge can be supported by many view pairs if poses are shared)
+    //  so each triplet job only visits the matches of its 3 edges.
+    Hash_Map<myEdge, std::vector<const PairWiseMatches::value_type*>> map_matches_perEdge;
     for (const auto & match_iterator : matches_provider->pairWise_matches_)
     {
       const Pair pair = match_iterator.first;
@@ -386,24 +423,57 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
       if (v1->id_pose != v2->id_pose)
       {
         // Consider the pair iff it is supported by 2 different pose id
-        const myEdge edge(v1->id_pose,v2->id_pose);
+        const myEdge edge(
+          std::min(v1->id_pose, v2->id_pose),
+          std::max(v1->id_pose, v2->id_pose));
         if (map_tripletIds_perEdge.count(edge) != 0)
+          map_matches_perEdge[edge].push_back(&match_iterator);
+      }
+    }
+
+    //-- precompute the visibility count per triplets (sum of their 2 view matches)
+    std::vector<uint32_t> vec_tracksPerTriplets(vec_triplets.size(), 0);
+    #ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int i = 0; i < static_cast<int>(vec_triplets.size()); ++i)
+    {
+      const graph::Triplet & triplet = vec_triplets[i];
+      for (const myEdge & edge :
+        {myEdge(triplet.i, triplet.j), myEdge(triplet.i, triplet.k), myEdge(triplet.j, triplet.k)})
+      {
+        const auto it_edge_matches = map_matches_perEdge.find(edge);
+        if (it_edge_matches != map_matches_perEdge.end())
         {
-          const auto & edge_tripletIds = map_tripletIds_perEdge.at(edge);
-          for (const auto & triplet_id : edge_tripletIds)
-          {
-            if (map_tracksPerTriplets.count(triplet_id) == 0)
-              map_tracksPerTriplets[triplet_id] = match_iterator.second.size();
-            else
-              map_tracksPerTriplets[triplet_id] += match_iterator.second.size();
-          }
+          for (const auto * matches : it_edge_matches->second)
+            vec_tracksPerTriplets[i] += matches->second.size();
         }
       }
     }
+
     // Collect edges that are covered by the triplets
     std::vector<myEdge> vec_edges;
     std::transform(map_tripletIds_perEdge.begin(), map_tripletIds_perEdge.end(), std::back_inserter(vec_edges), stl::RetrieveKey());
 
+    // Balance the workload of the dynamic scheduling:
+    //  start with the edges that are supported by the largest triplets
+    {
+      std::vector<uint32_t> vec_edge_load(vec_edges.size(), 0);
+      for (size_t i = 0; i < vec_edges.size(); ++i)
+      {
+        for (const uint32_t triplet_index : map_tripletIds_perEdge.at(vec_edges[i]))
+          vec_edge_load[i] = std::max(vec_edge_load[i], vec_tracksPerTriplets[triplet_index]);
+      }
+      std::vector<uint32_t> vec_edge_order(vec_edges.size());
+      std::iota(vec_edge_order.begin(), vec_edge_order.end(), 0);
+      std::stable_sort(vec_edge_order.begin(), vec_edge_order.end(),
+        [&](uint32_t a, uint32_t b) { return vec_edge_load[a] > vec_edge_load[b]; });
+      std::vector<myEdge> vec_edges_sorted(vec_edges.size());
+      for (size_t i = 0; i < vec_edge_order.size(); ++i)
+        vec_edges_sorted[i] = vec_edges[vec_edge_order[i]];
+      vec_edges.swap(vec_edges_sorted);
+    }
+
     openMVG::sfm::MutexSet<myEdge> m_mutexSet;
 
     C_Progress_display my_progress_bar(
@@ -434,7 +504,7 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
         std::vector<uint32_t> vec_commonTracksPerTriplets;
         for (const uint32_t triplet_index : vec_possibleTripletIndexes)
         {
-          vec_commonTracksPerTriplets.push_back(map_tracksPerTriplets[triplet_index]);
+          vec_commonTracksPerTriplets.push_back(vec_tracksPerTriplets[triplet_index]);
         }
 
         using namespace stl::indexed_sort;
@@ -470,11 +540,24 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
 
           const std::string sOutDirectory = "./";
 
+          // List shared correspondences (pairs) between the triplet poses
+          PairWiseMatches map_triplet_matches;
+          for (const myEdge & triplet_edge :
+            {myEdge(triplet.i, triplet.j), myEdge(triplet.i, triplet.k), myEdge(triplet.j, triplet.k)})
+          {
+            const auto it_edge_matches = map_matches_perEdge.find(triplet_edge);
+            if (it_edge_matches != map_matches_perEdge.end())
+            {
+              for (const auto * matches : it_edge_matches->second)
+                map_triplet_matches.insert(*matches);
+            }
+          }
+
           const bool bTriplet_estimation = Estimate_T_triplet(
               sfm_data,
               map_globalR,
               features_provider,
-              matches_provider,
+              map_triplet_matches,
               triplet,
               vec_tis,
               dPrecision,
@@ -533,15 +616,18 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
 
               initial_estimates[thread_id].emplace_back(triplet_relative_motion);
 
-              #ifdef OPENMVG_USE_OPENMP
-                #pragma omp critical
-              #endif
+              // Add inliers as valid pairwise matches
+              //  (the inliers are sorted to walk the tracks only once)
+              PairWiseMatches triplet_inlier_matches;
               {
-                // Add inliers as valid pairwise matches
-                for (const uint32_t & inlier_it : vec_inliers)
+                std::vector<uint32_t> vec_inliers_sorted = vec_inliers;
+                std::sort(vec_inliers_sorted.begin(), vec_inliers_sorted.end());
+                tracks::STLMAPTracks::const_iterator it_tracks = pose_triplet_tracks.begin();
+                uint32_t track_index = 0;
+                for (const uint32_t & inlier_it : vec_inliers_sorted)
                 {
-                  tracks::STLMAPTracks::const_iterator it_tracks = pose_triplet_tracks.begin();
-                  std::advance(it_tracks, inlier_it);
+                  std::advance(it_tracks, inlier_it - track_index);
+                  track_index = inlier_it;
                   const tracks::submapTrack & track = it_tracks->second;
 
                   // create pairwise matches from the inlier track
@@ -550,13 +636,24 @@ void GlobalSfM_Translation_AveragingSolver::ComputePutativeTranslation_EdgesCove
                   std::advance(iter_J, 1);
                   while (iter_J != track.end())
                   { // matches(pair(view_id(I), view_id(J))) <= IndMatch(feat_id(I), feat_id(J))
-                    newpairMatches[{iter_I->first, iter_J->first}]
+                    triplet_inlier_matches[{iter_I->first, iter_J->first}]
                      .emplace_back(iter_I->second, iter_J->second);
                     ++iter_I;
                     ++iter_J;
                   }
                 }
               }
+              #ifdef OPENMVG_USE_OPENMP
+                #pragma omp critical
+              #endif
+              {
+                for (auto & inlier_matches : triplet_inlier_matches)
+                {
+                  IndMatches & matches = newpairMatches[inlier_matches.first];
+                  matches.insert(matches.end(),
+                    inlier_matches.second.begin(), inlier_matches.second.end());
+                }
+              }
             }
             // Since a relative translation have been found for the edge: vec_edges[k],
             //  we break and start to estimate the translations for some other edges.
@@ -589,7 +686,7 @@ bool GlobalSfM_Translation_AveragingSolver::Estimate_T_triplet
   const sfm::SfM_Data & sfm_data,
   const Hash_Map<IndexT, Mat3> & map_globalR,
   const sfm::Features_Provider * features_provider,
-  const sfm::Matches_Provider * matches_provider,
+  const matching::PairWiseMatches & map_triplet_matches,
   const graph::Triplet & poses_id,
   std::vector<Vec3> & vec_tis,
   double & dPrecision, // UpperBound of the precision found by the AContrario estimator
@@ -598,24 +695,6 @@ bool GlobalSfM_Translation_AveragingSolver::Estimate_T_triplet
   const std::string & sOutDirectory
 ) const
 {
-  // List matches that belong to the triplet of poses
-  PairWiseMatches map_triplet_matches;
-  const std::set<IndexT> set_pose_ids = {poses_id.i, poses_id.j, poses_id.k};
-  // List shared correspondences (pairs) between poses
-  for (const auto & match_iterator : matches_provider->pairWise_matches_)
-  {
-    const Pair & pair = match_iterator.first;
-    const View * v1 = sfm_data.GetViews().at(pair.first).get();
-    const View * v2 = sfm_data.GetViews().at(pair.second).get();
-    if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-        (v1->id_pose != v2->id_pose)
-        && set_pose_ids.count(v1->id_pose)
-        && set_pose_ids.count(v2->id_pose))
-    {
-      map_triplet_matches.insert( match_iterator );
-    }
-  }
-
   openMVG::tracks::TracksBuilder tracksBuilder;
   tracksBuilder.Build(map_triplet_matches);
   tracksBuilder.Filter(3);
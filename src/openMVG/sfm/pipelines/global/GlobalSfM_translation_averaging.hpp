@@ -28,7 +28,8 @@ enum ETranslationAveragingMethod
 {
   TRANSLATION_AVERAGING_L1 = 1,
   TRANSLATION_AVERAGING_L2_DISTANCE_CHORDAL = 2,
-  TRANSLATION_AVERAGING_SOFTL1 = 3
+  TRANSLATION_AVERAGING_SOFTL1 = 3,
+  TRANSLATION_AVERAGING_L1_IRLS = 4
 };
 
 struct SfM_Data;
@@ -76,11 +77,12 @@ private:
     matching::PairWiseMatches & newpairMatches);
 
   // Robust estimation and refinement of triplet of translations
+  // (map_triplet_matches: the view pair matches shared by the triplet poses)
   bool Estimate_T_triplet(
     const sfm::SfM_Data & sfm_data,
     const Hash_Map<IndexT, Mat3> & map_globalR,
     const sfm::Features_Provider * features_provider,
-    const sfm::Matches_Provider * matches_provider,
+    const matching::PairWiseMatches & map_triplet_matches,
     const graph::Triplet & poses_id,
     std::vector<Vec3> & vec_tis,
     double & dPrecision, // UpperBound of the precision found by the AContrario estimator
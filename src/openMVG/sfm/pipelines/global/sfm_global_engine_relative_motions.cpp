@@ -417,7 +417,9 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Adjust()
 {
   // Refine sfm_scene (in a 3 iteration process (free the parameters regarding their incertainty order)):
 
-  Bundle_Adjustment_Ceres bundle_adjustment_obj;
+  Bundle_Adjustment_Ceres::BA_Ceres_options ba_options;
+  ba_options.iterative_schur_threshold_ = iterative_schur_threshold_;
+  Bundle_Adjustment_Ceres bundle_adjustment_obj(ba_options);
   // - refine only Structure and translations
   bool b_BA_Status = bundle_adjustment_obj.Adjust
     (
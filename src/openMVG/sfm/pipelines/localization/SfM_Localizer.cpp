@@ -85,7 +85,8 @@ namespace sfm {
                                     resection_data.max_iteration,
                                     &P,
                                     dPrecision,
-                                    true);
+                                    true,
+                                    resection_data.sampling);
         // Update the upper bound precision of the model found by AC-RANSAC
         resection_data.error_max = ACRansacOut.first;
       }
@@ -116,7 +117,8 @@ namespace sfm {
                                     resection_data.max_iteration,
                                     &P,
                                     dPrecision,
-                                    true);
+                                    true,
+                                    resection_data.sampling);
         // Update the upper bound precision of the model found by AC-RANSAC
         resection_data.error_max = ACRansacOut.first;
       }
@@ -147,7 +149,8 @@ namespace sfm {
                                     resection_data.max_iteration,
                                     &P,
                                     dPrecision,
-                                    true);
+                                    true,
+                                    resection_data.sampling);
         // Update the upper bound precision of the model found by AC-RANSAC
         resection_data.error_max = ACRansacOut.first;
       }
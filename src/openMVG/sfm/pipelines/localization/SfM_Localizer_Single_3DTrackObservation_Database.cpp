@@ -9,19 +9,42 @@
 #include "openMVG/sfm/pipelines/localization/SfM_Localizer_Single_3DTrackObservation_Database.hpp"
 
 #include "openMVG/cameras/Camera_Intrinsics.hpp"
+#include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "openMVG/geometry/frustum.hpp"
 #include "openMVG/matching/indMatch.hpp"
 #include "openMVG/matching/regions_matcher.hpp"
 #include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
 using namespace openMVG::matching;
 
 namespace openMVG {
 namespace sfm {
 
+  struct SfM_Localization_Single_3DTrackObservation_Database::Local_Database
+  {
+    /// Scene views described by the database (sorted by id)
+    std::vector<IndexT> view_ids;
+    /// Association of a local descriptor to a landmark_observations_descriptors_ index
+    std::vector<uint32_t> descriptor_ids;
+    std::unique_ptr<features::Regions> descriptors;
+    std::unique_ptr<matching::Matcher_Regions_Database> matching_interface;
+  };
+
   SfM_Localization_Single_3DTrackObservation_Database::
-  SfM_Localization_Single_3DTrackObservation_Database():
+  SfM_Localization_Single_3DTrackObservation_Database
+  (
+    matching::EMatcherType matcher_type,
+    const matching::HNSW_Params & hnsw_params
+  ):
     SfM_Localizer(),
+    matcher_type_(matcher_type),
+    hnsw_params_(hnsw_params),
     sfm_data_(nullptr),
     matching_interface_(nullptr)
   {}
@@ -55,14 +78,19 @@ namespace sfm {
           // copy the feature/descriptor to landmark_observations_descriptors
           const std::shared_ptr<features::Regions> view_regions = regions_provider.get(observation.first);
           view_regions->CopyRegion(observation.second.id_feat, landmark_observations_descriptors_.get());
-          // link this descriptor to the track Id
+          // link this descriptor to the view Id and to the track Id
+          view_to_descriptor_ids_[observation.first].push_back(index_to_landmark_id_.size());
           index_to_landmark_id_.push_back(landmark.first);
         }
       }
     }
+    // The scene dependent caches are rebuilt on demand
+    frustum_filter_.reset();
+    local_database_.reset();
     std::cout << "Init retrieval database ... " << std::endl;
     matching_interface_.reset(new
-      matching::Matcher_Regions_Database(matching::ANN_L2, *landmark_observations_descriptors_));
+      matching::Matcher_Regions_Database(
+        matcher_type_, *landmark_observations_descriptors_, hnsw_params_));
     std::cout << "Retrieval database initialized with:\n"
       << "#landmarks: " << sfm_data.GetLandmarks().size() << "\n"
       << "#descriptors: " << landmark_observations_descriptors_->RegionCount() << std::endl;
@@ -94,20 +122,264 @@ namespace sfm {
       return false;
     }
 
+    return Resection(
+      solver_type, image_size, optional_intrinsics, query_regions,
+      vec_putative_matches, nullptr, pose, resection_data_ptr);
+  }
+
+  bool
+  SfM_Localization_Single_3DTrackObservation_Database::Localize
+  (
+    const resection::SolverType & solver_type,
+    const Pair & image_size,
+    const cameras::IntrinsicBase * optional_intrinsics,
+    const features::Regions & query_regions,
+    const Localization_Prior & prior,
+    geometry::Pose3 & pose,
+    Image_Localizer_Match_Data * resection_data_ptr
+  ) const
+  {
+    if (sfm_data_ == nullptr || matching_interface_ == nullptr)
+    {
+      return false;
+    }
+
+    const std::shared_ptr<Local_Database> local_database =
+      Get_Local_Database(Neighbor_Views(optional_intrinsics, prior));
+    if (local_database)
+    {
+      matching::IndMatches vec_putative_matches;
+      if (local_database->matching_interface->Match(0.8, query_regions, vec_putative_matches)
+          && Resection(
+            solver_type, image_size, optional_intrinsics, query_regions,
+            vec_putative_matches, &local_database->descriptor_ids, pose, resection_data_ptr))
+      {
+        return true;
+      }
+      std::cout << "Localization with the local database failed, "
+        << "use the global database." << std::endl;
+    }
+
+    return Localize(
+      solver_type, image_size, optional_intrinsics, query_regions, pose, resection_data_ptr);
+  }
+
+  std::shared_ptr<SfM_Localization_Single_3DTrackObservation_Database::Local_Database>
+  SfM_Localization_Single_3DTrackObservation_Database::Get_Local_Database
+  (
+    const std::vector<IndexT> & neighbor_views
+  ) const
+  {
+    // Keep only the views that have some landmark descriptors
+    std::vector<IndexT> view_ids;
+    view_ids.reserve(neighbor_views.size());
+    for (const IndexT view_id : neighbor_views)
+    {
+      if (view_to_descriptor_ids_.count(view_id))
+        view_ids.push_back(view_id);
+    }
+    if (view_ids.empty())
+    {
+      return nullptr;
+    }
+    std::sort(view_ids.begin(), view_ids.end());
+
+    std::lock_guard<std::mutex> lock(local_database_mutex_);
+    if (local_database_ && local_database_->view_ids == view_ids)
+    {
+      return local_database_;
+    }
+
+    // Build a local database with the observation descriptors of the neighbor views
+    std::shared_ptr<Local_Database> local_database = std::make_shared<Local_Database>();
+    for (const IndexT view_id : view_ids)
+    {
+      const std::vector<uint32_t> & view_descriptor_ids = view_to_descriptor_ids_.at(view_id);
+      local_database->descriptor_ids.insert(local_database->descriptor_ids.end(),
+        view_descriptor_ids.begin(), view_descriptor_ids.end());
+    }
+    local_database->descriptors.reset(landmark_observations_descriptors_->EmptyClone());
+    for (const uint32_t descriptor_id : local_database->descriptor_ids)
+    {
+      landmark_observations_descriptors_->CopyRegion(
+        descriptor_id, local_database->descriptors.get());
+    }
+    local_database->matching_interface.reset(new matching::Matcher_Regions_Database(
+      matcher_type_, *local_database->descriptors, hnsw_params_));
+    local_database->view_ids = std::move(view_ids);
+
+    std::cout << "Local retrieval database with:\n"
+      << "#views: " << local_database->view_ids.size() << "\n"
+      << "#descriptors: " << local_database->descriptors->RegionCount() << std::endl;
+
+    local_database_ = local_database;
+    return local_database;
+  }
+
+  const Frustum_Filter &
+  SfM_Localization_Single_3DTrackObservation_Database::Get_Frustum_Filter() const
+  {
+    // The frustums are only needed by the pose prior: build them on first use
+    std::lock_guard<std::mutex> lock(frustum_filter_mutex_);
+    if (!frustum_filter_)
+    {
+      frustum_filter_.reset(new Frustum_Filter(*sfm_data_));
+    }
+    return *frustum_filter_;
+  }
+
+  std::vector<IndexT>
+  SfM_Localization_Single_3DTrackObservation_Database::Neighbor_Views
+  (
+    const cameras::IntrinsicBase * optional_intrinsics,
+    const Localization_Prior & prior
+  ) const
+  {
+    std::vector<IndexT> neighbor_views;
+    if (prior.max_neighbor_views == 0)
+    {
+      return neighbor_views;
+    }
+
+    // Use the view graph: the prior view and the views sharing the most landmarks with it
+    if (prior.view_id != UndefinedIndexT
+        && view_to_descriptor_ids_.count(prior.view_id))
+    {
+      Hash_Map<IndexT, uint32_t> covisibility; // view id, #shared landmarks
+      for (const uint32_t descriptor_id : view_to_descriptor_ids_.at(prior.view_id))
+      {
+        const Landmark & landmark =
+          sfm_data_->GetLandmarks().at(index_to_landmark_id_[descriptor_id]);
+        for (const auto & observation : landmark.obs)
+        {
+          if (observation.first != prior.view_id)
+            ++covisibility[observation.first];
+        }
+      }
+      std::vector<std::pair<uint32_t, IndexT>> covisible_views;
+      covisible_views.reserve(covisibility.size());
+      for (const auto & covisible_view : covisibility)
+      {
+        covisible_views.emplace_back(covisible_view.second, covisible_view.first);
+      }
+      const size_t count = std::min(
+        covisible_views.size(), static_cast<size_t>(prior.max_neighbor_views - 1));
+      std::partial_sort(covisible_views.begin(), covisible_views.begin() + count,
+        covisible_views.end(), std::greater<std::pair<uint32_t, IndexT>>());
+
+      neighbor_views.push_back(prior.view_id);
+      for (size_t i = 0; i < count; ++i)
+      {
+        neighbor_views.push_back(covisible_views[i].second);
+      }
+    }
+
+    // Use the pose prior: the closest views looking in a similar direction,
+    //  restricted to the ones intersecting the query frustum if its intrinsic is known
+    if (prior.b_use_pose)
+    {
+      const Vec3 prior_direction = prior.pose.rotation().row(2).transpose();
+      std::vector<std::pair<double, IndexT>> candidates;
+      for (const auto & view_descriptors : view_to_descriptor_ids_)
+      {
+        const View * view = sfm_data_->GetViews().at(view_descriptors.first).get();
+        if (!sfm_data_->IsPoseAndIntrinsicDefined(view))
+          continue;
+        const geometry::Pose3 view_pose = sfm_data_->GetPoseOrDie(view);
+        if (view_pose.rotation().row(2).dot(prior_direction) <= 0.0)
+          continue;
+        candidates.emplace_back(
+          (view_pose.center() - prior.pose.center()).squaredNorm(), view->id_view);
+      }
+      // Keep a shortlist larger than the requested count to leave room for the frustum test
+      const size_t count = std::min(
+        candidates.size(), static_cast<size_t>(prior.max_neighbor_views) * 4);
+      std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+
+      std::vector<IndexT> candidate_views(count);
+      for (size_t i = 0; i < count; ++i)
+      {
+        candidate_views[i] = candidates[i].second;
+      }
+
+      if (optional_intrinsics && cameras::isPinhole(optional_intrinsics->getType()))
+      {
+        const cameras::Pinhole_Intrinsic * cam =
+          dynamic_cast<const cameras::Pinhole_Intrinsic*>(optional_intrinsics);
+        if (cam != nullptr)
+        {
+          const geometry::Frustum query_frustum(
+            cam->w(), cam->h(), cam->K(),
+            prior.pose.rotation(), prior.pose.center());
+          const std::vector<IndexT> visible_views =
+            Get_Frustum_Filter().getFrustumIntersections(query_frustum, candidate_views);
+          if (!visible_views.empty())
+            candidate_views = visible_views;
+        }
+      }
+      if (candidate_views.size() > prior.max_neighbor_views)
+      {
+        candidate_views.resize(prior.max_neighbor_views);
+      }
+
+      for (const IndexT view_id : candidate_views)
+      {
+        if (std::find(neighbor_views.begin(), neighbor_views.end(), view_id)
+            == neighbor_views.end())
+          neighbor_views.push_back(view_id);
+      }
+    }
+    return neighbor_views;
+  }
+
+  bool
+  SfM_Localization_Single_3DTrackObservation_Database::Resection
+  (
+    const resection::SolverType & solver_type,
+    const Pair & image_size,
+    const cameras::IntrinsicBase * optional_intrinsics,
+    const features::Regions & query_regions,
+    const matching::IndMatches & vec_putative_matches,
+    const std::vector<uint32_t> * descriptor_ids,
+    geometry::Pose3 & pose,
+    Image_Localizer_Match_Data * resection_data_ptr
+  ) const
+  {
     std::cout << "#3D2d putative correspondences: " << vec_putative_matches.size() << std::endl;
     // Init the 3D-2d correspondences array
     Image_Localizer_Match_Data resection_data;
     if (resection_data_ptr)
     {
       resection_data.error_max = resection_data_ptr->error_max;
+      resection_data.sampling = resection_data_ptr->sampling;
     }
+    // Order of the correspondences:
+    //  the progressive sampling draws the best putative matches first
+    std::vector<std::pair<double, uint32_t>> match_order(vec_putative_matches.size());
+    for (size_t i = 0; i < vec_putative_matches.size(); ++i)
+    {
+      double distance = 0.0;
+      if (resection_data.sampling == robust::ACRANSAC_SAMPLING::PROGRESSIVE)
+      {
+        const IndexT descriptor_id = descriptor_ids ?
+          (*descriptor_ids)[vec_putative_matches[i].i_] : vec_putative_matches[i].i_;
+        distance = landmark_observations_descriptors_->SquaredDescriptorDistance(
+          descriptor_id, &query_regions, vec_putative_matches[i].j_);
+      }
+      match_order[i] = {distance, i};
+    }
+    std::sort(match_order.begin(), match_order.end());
+
     resection_data.pt3D.resize(3, vec_putative_matches.size());
     resection_data.pt2D.resize(2, vec_putative_matches.size());
     Mat2X pt2D_original(2, vec_putative_matches.size());
     for (size_t i = 0; i < vec_putative_matches.size(); ++i)
     {
-      resection_data.pt3D.col(i) = sfm_data_->GetLandmarks().at(index_to_landmark_id_[vec_putative_matches[i].i_]).X;
-      resection_data.pt2D.col(i) = query_regions.GetRegionPosition(vec_putative_matches[i].j_);
+      const matching::IndMatch & match = vec_putative_matches[match_order[i].second];
+      const IndexT descriptor_id = descriptor_ids ?
+        (*descriptor_ids)[match.i_] : match.i_;
+      resection_data.pt3D.col(i) = sfm_data_->GetLandmarks().at(index_to_landmark_id_[descriptor_id]).X;
+      resection_data.pt2D.col(i) = query_regions.GetRegionPosition(match.j_);
       pt2D_original.col(i) = resection_data.pt2D.col(i);
       // Handle image distortion if intrinsic is known (to ease the resection)
       if (optional_intrinsics && optional_intrinsics->have_disto())
@@ -9,14 +9,19 @@
 #ifndef OPENMVG_SFM_PIPELINES_LOCALIZATION_SFM_LOCALIZER_STO_DB_HPP
 #define OPENMVG_SFM_PIPELINES_LOCALIZATION_SFM_LOCALIZER_STO_DB_HPP
 
+#include <memory>
+#include <mutex>
 #include <vector>
 
+#include "openMVG/geometry/pose3.hpp"
+#include "openMVG/matching/indMatch.hpp"
+#include "openMVG/matching/matcher_type.hpp"
 #include "openMVG/sfm/pipelines/localization/SfM_Localizer.hpp"
+#include "openMVG/sfm/sfm_data_filters_frustum.hpp"
 #include "openMVG/types.hpp"
 
 namespace openMVG { namespace cameras { struct IntrinsicBase; } }
 namespace openMVG { namespace features { class Regions; } }
-namespace openMVG { namespace geometry { class Pose3; } }
 namespace openMVG { namespace matching { class Matcher_Regions_Database; } }
 namespace openMVG { namespace sfm { struct Regions_Provider; } }
 namespace openMVG { namespace sfm { struct SfM_Data; } }
@@ -24,6 +29,22 @@ namespace openMVG { namespace sfm { struct SfM_Data; } }
 namespace openMVG {
 namespace sfm {
 
+/// Optional localization hint used to restrict the 2D-3D search to a
+///  neighborhood of the scene:
+/// - a view of the scene known to be close to the query (i.e. last localized frame),
+/// - and/or an approximate pose of the query camera.
+struct Localization_Prior
+{
+  /// Id of a scene view that is close to the query (UndefinedIndexT if unknown)
+  IndexT view_id = UndefinedIndexT;
+  /// Tell if the pose prior must be used
+  bool b_use_pose = false;
+  /// Approximate pose of the query camera
+  geometry::Pose3 pose;
+  /// Maximal number of scene views used to build the local database
+  uint32_t max_neighbor_views = 20;
+};
+
 // Implementation of a naive method:
 // - init the database of descriptor from the structure and the observations.
 // - create a large array with all the used descriptors and init a Matcher with it
@@ -34,7 +55,18 @@ class SfM_Localization_Single_3DTrackObservation_Database : public SfM_Localizer
 {
 public:
 
-  SfM_Localization_Single_3DTrackObservation_Database();
+  /**
+  * @brief Localizer constructor
+  *
+  * @param[in] matcher_type the 2D-3D descriptor matcher (ANN_L2, HNSW_L2 or
+  *  PRODUCT_QUANTIZATION_L2 for product quantized regions)
+  * @param[in] hnsw_params the graph parameters of the HNSW_L2 matcher
+  */
+  explicit SfM_Localization_Single_3DTrackObservation_Database
+  (
+    matching::EMatcherType matcher_type = matching::ANN_L2,
+    const matching::HNSW_Params & hnsw_params = matching::HNSW_Params()
+  );
 
   /**
   * @brief Build the retrieval database (3D points descriptors)
@@ -70,13 +102,87 @@ public:
     Image_Localizer_Match_Data * resection_data_ptr = nullptr
   ) const override;
 
+  /**
+  * @brief Try to localize an image by matching it only against the landmarks
+  *  visible from the scene views neighboring the provided prior
+  *  (view graph covisibility and/or frustum intersection).
+  *  If the local search fails, the global database search is used.
+  *  The local database of the last neighbor views is kept and reused
+  *  (consecutive frames of a sequence often share the same neighbor views).
+  *
+  * @param[in] solver_type the type of absolute pose solver to use
+  * @param[in] image_size the w,h image size
+  * @param[in] optional_intrinsics camera intrinsic if known (else nullptr)
+  * @param[in] query_regions the image regions (type must be the same as the database)
+  * @param[in] prior the localization prior (view id and/or pose)
+  * @param[out] pose found pose
+  * @param[out] resection_data matching data (2D-3D and inliers; optional)
+  * @return True if a putative pose has been estimated
+  */
+  bool Localize
+  (
+    const resection::SolverType & solver_type,
+    const Pair & image_size,
+    const cameras::IntrinsicBase * optional_intrinsics,
+    const features::Regions & query_regions,
+    const Localization_Prior & prior,
+    geometry::Pose3 & pose,
+    Image_Localizer_Match_Data * resection_data_ptr = nullptr
+  ) const;
+
 private:
+
+  /// List the scene views that are close to the localization prior
+  std::vector<IndexT> Neighbor_Views
+  (
+    const cameras::IntrinsicBase * optional_intrinsics,
+    const Localization_Prior & prior
+  ) const;
+
+  /// Descriptor database restricted to the observations of some scene views
+  struct Local_Database;
+
+  /// Return the local database of some views (reuse the last one if possible)
+  std::shared_ptr<Local_Database> Get_Local_Database
+  (
+    const std::vector<IndexT> & neighbor_views
+  ) const;
+
+  /// Return the scene view frustums (computed on the first call)
+  const Frustum_Filter & Get_Frustum_Filter() const;
+
+  /// Robust pose estimation from putative matches between the query regions
+  ///  and some database descriptors (descriptor_ids maps the matches
+  ///  database indexes to the landmark_observations_descriptors_ indexes)
+  bool Resection
+  (
+    const resection::SolverType & solver_type,
+    const Pair & image_size,
+    const cameras::IntrinsicBase * optional_intrinsics,
+    const features::Regions & query_regions,
+    const matching::IndMatches & putative_matches,
+    const std::vector<uint32_t> * descriptor_ids,
+    geometry::Pose3 & pose,
+    Image_Localizer_Match_Data * resection_data_ptr
+  ) const;
+
+  /// Descriptor matcher used for the retrieval database
+  matching::EMatcherType matcher_type_;
+  matching::HNSW_Params hnsw_params_;
   // Reference to the scene
   const SfM_Data * sfm_data_;
   /// Association of a regions to a landmark observation
   std::unique_ptr<features::Regions> landmark_observations_descriptors_;
   /// Association of a track observation to a track Id (used for retrieval)
   std::vector<IndexT> index_to_landmark_id_;
+  /// Association of a view Id to its observation descriptors (used for local retrieval)
+  Hash_Map<IndexT, std::vector<uint32_t>> view_to_descriptor_ids_;
+  /// Frustum of the scene views (used to find the views seen by a pose prior)
+  mutable std::unique_ptr<Frustum_Filter> frustum_filter_;
+  mutable std::mutex frustum_filter_mutex_;
+  /// Last used local database
+  mutable std::shared_ptr<Local_Database> local_database_;
+  mutable std::mutex local_database_mutex_;
   /// A matching interface to find matches between 2D descriptor matches
   ///  and 3D points observation descriptors
   std::shared_ptr<matching::Matcher_Regions_Database> matching_interface_;
@@ -0,0 +1,190 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2015 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a synthetic scene where each landmark is described in a single view
+//   (its "home" view) and observed without descriptor in the next view
+// - Localize the first view of the scene with and without a localization prior
+// - Assert that:
+//   - without prior, all the landmarks are candidates for the 2D-3D matching,
+//   - with a view or a pose prior, only the landmarks described by the
+//     neighbor views are used,
+//   - the pose is found in all cases.
+//-----------------
+
+#include "openMVG/sfm/pipelines/pipelines_test.hpp"
+#include "openMVG/features/regions_factory.hpp"
+#include "openMVG/sfm/sfm.hpp"
+
+#include "testing/testing.h"
+
+#include <memory>
+#include <random>
+#include <set>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::features;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+// Regions provider filled from a synthetic dataset:
+//  - the feature i of each view is the projection of the landmark i,
+//  - each landmark gets a unique random SIFT like descriptor.
+struct Synthetic_Regions_Provider : public Regions_Provider
+{
+  void load
+  (
+    const NViewDataSet & synthetic_data
+  )
+  {
+    region_type_.reset(new SIFT_Regions);
+
+    std::mt19937 random_generator(std::mt19937::default_seed);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::vector<SIFT_Regions::DescriptorT> descriptors(synthetic_data._X.cols());
+    for (auto & descriptor : descriptors)
+    {
+      for (uint32_t k = 0; k < SIFT_Regions::DescriptorT::static_size; ++k)
+        descriptor[k] = static_cast<unsigned char>(distribution(random_generator));
+    }
+
+    for (size_t j = 0; j < synthetic_data._n; ++j)
+    {
+      std::shared_ptr<SIFT_Regions> regions = std::make_shared<SIFT_Regions>();
+      for (Mat2X::Index i = 0; i < synthetic_data._x[j].cols(); ++i)
+      {
+        const Vec2 pt = synthetic_data._x[j].col(i);
+        regions->Features().emplace_back(pt(0), pt(1));
+        regions->Descriptors().push_back(descriptors[i]);
+      }
+      cache_[j] = regions;
+    }
+  }
+};
+
+// Keep for each landmark:
+//  - the described observation of its home view (i % nviews),
+//  - an observation without descriptor in the next view (used for the covisibility).
+static void Keep_Home_View_Observations
+(
+  const int nviews,
+  SfM_Data & sfm_data
+)
+{
+  for (auto & landmark : sfm_data.structure)
+  {
+    const IndexT home_view = landmark.first % nviews;
+    const IndexT next_view = (home_view + 1) % nviews;
+    Observations obs;
+    obs[home_view] = landmark.second.obs.at(home_view);
+    obs[next_view] = Observation(landmark.second.obs.at(next_view).x, UndefinedIndexT);
+    landmark.second.obs = std::move(obs);
+  }
+}
+
+// Return the home views of the landmarks used as 2D-3D candidates
+static std::set<IndexT> Candidate_Home_Views
+(
+  const int nviews,
+  const SfM_Data & sfm_data,
+  const Image_Localizer_Match_Data & resection_data
+)
+{
+  std::set<IndexT> home_views;
+  for (Mat::Index i = 0; i < resection_data.pt3D.cols(); ++i)
+  {
+    for (const auto & landmark : sfm_data.GetLandmarks())
+    {
+      if ((landmark.second.X - resection_data.pt3D.col(i)).norm() < 1e-8)
+        home_views.insert(landmark.first % nviews);
+    }
+  }
+  return home_views;
+}
+
+TEST(SfM_Localizer_Single_3DTrackObservation_Database, Localization_Prior) {
+
+  const int nviews = 12;
+  const int npoints = 240;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+  Keep_Home_View_Observations(nviews, sfm_data);
+
+  Synthetic_Regions_Provider regions_provider;
+  regions_provider.load(d);
+
+  SfM_Localization_Single_3DTrackObservation_Database localizer(matching::BRUTE_FORCE_L2);
+  EXPECT_TRUE(localizer.Init(sfm_data, regions_provider));
+
+  // Query: the view 0 that observes all the landmarks
+  const std::shared_ptr<features::Regions> query_regions = regions_provider.get(0);
+  const IntrinsicBase * intrinsic = sfm_data.GetIntrinsics().at(0).get();
+  const Pose3 pose_gt = sfm_data.GetPoses().at(0);
+  const Pair image_size(intrinsic->w(), intrinsic->h());
+
+  // Without prior, every landmark is a candidate
+  {
+    Pose3 pose;
+    Image_Localizer_Match_Data resection_data;
+    EXPECT_TRUE(localizer.Localize(
+      resection::SolverType::P3P_KE_CVPR17, image_size, intrinsic,
+      *query_regions, pose, &resection_data));
+    EXPECT_EQ(npoints, resection_data.pt3D.cols());
+    EXPECT_NEAR(0.0, (pose.center() - pose_gt.center()).norm(), 1e-2);
+  }
+
+  // With a view prior, only the landmarks described by the view 0
+  //  and its most covisible view (view 1) are candidates
+  {
+    Localization_Prior prior;
+    prior.view_id = 0;
+    prior.max_neighbor_views = 2;
+
+    Pose3 pose;
+    Image_Localizer_Match_Data resection_data;
+    EXPECT_TRUE(localizer.Localize(
+      resection::SolverType::P3P_KE_CVPR17, image_size, intrinsic,
+      *query_regions, prior, pose, &resection_data));
+    EXPECT_EQ(2 * npoints / nviews, resection_data.pt3D.cols());
+    const std::set<IndexT> home_views =
+      Candidate_Home_Views(nviews, sfm_data, resection_data);
+    EXPECT_EQ(2, home_views.size());
+    EXPECT_EQ(1, home_views.count(0));
+    EXPECT_EQ(1, home_views.count(1));
+    EXPECT_NEAR(0.0, (pose.center() - pose_gt.center()).norm(), 1e-2);
+  }
+
+  // With a pose prior, the landmarks of the views close to the prior are used
+  {
+    Localization_Prior prior;
+    prior.b_use_pose = true;
+    prior.pose = pose_gt;
+    prior.max_neighbor_views = 1;
+
+    Pose3 pose;
+    Image_Localizer_Match_Data resection_data;
+    EXPECT_TRUE(localizer.Localize(
+      resection::SolverType::P3P_KE_CVPR17, image_size, intrinsic,
+      *query_regions, prior, pose, &resection_data));
+    EXPECT_EQ(npoints / nviews, resection_data.pt3D.cols());
+    const std::set<IndexT> home_views =
+      Candidate_Home_Views(nviews, sfm_data, resection_data);
+    EXPECT_EQ(1, home_views.size());
+    EXPECT_EQ(1, home_views.count(0));
+    EXPECT_NEAR(0.0, (pose.center() - pose_gt.center()).norm(), 1e-2);
+  }
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
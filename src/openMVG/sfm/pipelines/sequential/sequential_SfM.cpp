@@ -149,6 +149,9 @@ bool SequentialSfMReconstructionEngine::Process() {
     }
     ++resectionGroupIndex;
   }
+  // Release the bundle adjustment problem memory
+  bundle_adjustment_obj_.reset();
+
   // Ensure there is no remaining outliers
   if (badTrackRejector(4.0, 0))
   {
@@ -1186,7 +1189,16 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
 /// Bundle adjustment to refine Structure; Motion and Intrinsics
 bool SequentialSfMReconstructionEngine::BundleAdjustment()
 {
-  Bundle_Adjustment_Ceres::BA_Ceres_options options;
+  if (!bundle_adjustment_obj_)
+  {
+    // The problem is rebuilt at each call: keeping it alive (bReuse_problem_)
+    // saves its setup time but raises the peak memory (residual index).
+    Bundle_Adjustment_Ceres::BA_Ceres_options options;
+    options.iterative_schur_threshold_ = iterative_schur_threshold_;
+    bundle_adjustment_obj_.reset(new Bundle_Adjustment_Ceres(options));
+  }
+  Bundle_Adjustment_Ceres::BA_Ceres_options & options =
+    bundle_adjustment_obj_->ceres_options();
   if ( sfm_data_.GetPoses().size() > 100 &&
       (ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::SUITE_SPARSE) ||
        ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::CX_SPARSE) ||
@@ -1201,7 +1213,6 @@ bool SequentialSfMReconstructionEngine::BundleAdjustment()
   {
     options.linear_solver_type_ = ceres::DENSE_SCHUR;
   }
-  Bundle_Adjustment_Ceres bundle_adjustment_obj(options);
   const Optimize_Options ba_refine_options
     ( ReconstructionEngine::intrinsic_refinement_options_,
       Extrinsic_Parameter_Type::ADJUST_ALL, // Adjust camera motion
@@ -1209,7 +1220,7 @@ bool SequentialSfMReconstructionEngine::BundleAdjustment()
       Control_Point_Parameter(),
       this->b_use_motion_prior_
     );
-  return bundle_adjustment_obj.Adjust(sfm_data_, ba_refine_options);
+  return bundle_adjustment_obj_->Adjust(sfm_data_, ba_refine_options);
 }
 
 /**
@@ -9,6 +9,7 @@
 #ifndef OPENMVG_SFM_LOCALIZATION_SEQUENTIAL_SFM_HPP
 #define OPENMVG_SFM_LOCALIZATION_SEQUENTIAL_SFM_HPP
 
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -25,6 +26,7 @@ namespace sfm {
 
 struct Features_Provider;
 struct Matches_Provider;
+class Bundle_Adjustment_Ceres;
 
 /// Sequential SfM Pipeline Reconstruction Engine.
 class SequentialSfMReconstructionEngine : public ReconstructionEngine
@@ -115,6 +117,9 @@ private:
 
   Hash_Map<IndexT, double> map_ACThreshold_; // Per camera confidence (A contrario estimated threshold error)
 
+  // Bundle adjustment problem (updated between the successive BA of the incremental process)
+  std::unique_ptr<Bundle_Adjustment_Ceres> bundle_adjustment_obj_;
+
   std::set<uint32_t> set_remaining_view_id_;     // Remaining camera index that can be used for resection
 };
 
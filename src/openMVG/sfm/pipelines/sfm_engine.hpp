@@ -31,7 +31,8 @@ public:
   :sOut_directory_(soutDirectory),
     sfm_data_(sfm_data),
     intrinsic_refinement_options_(cameras::Intrinsic_Parameter_Type::ADJUST_ALL),
-    b_use_motion_prior_(false)
+    b_use_motion_prior_(false),
+    iterative_schur_threshold_(0)
   {
   }
 
@@ -60,6 +61,16 @@ public:
     b_use_motion_prior_ = rhs;
   }
 
+  /// Bundle adjustment switches to an iterative linear solver (bounded memory)
+  /// when the scene has more poses than this threshold (0, the default, disables the switch)
+  void Set_Iterative_Schur_Threshold
+  (
+    unsigned int rhs
+  )
+  {
+    iterative_schur_threshold_ = rhs;
+  }
+
   const SfM_Data & Get_SfM_Data() const {return sfm_data_;}
 
 protected:
@@ -75,6 +86,7 @@ protected:
   //-----
   cameras::Intrinsic_Parameter_Type intrinsic_refinement_options_;
   bool b_use_motion_prior_;
+  unsigned int iterative_schur_threshold_;
 };
 
 } // namespace sfm
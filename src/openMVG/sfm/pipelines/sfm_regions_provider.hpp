@@ -10,6 +10,7 @@
 #define OPENMVG_SFM_SFM_REGIONS_PROVIDER_HPP
 
 #include <atomic>
+#include <ctime>
 #include <memory>
 #include <string>
 
@@ -118,9 +119,13 @@ public:
         const std::string basename = stlplus::basename_part(sImageName);
         const std::string featFile = stlplus::create_filespec(feat_directory, basename, ".feat");
         const std::string descFile = stlplus::create_filespec(feat_directory, basename, ".desc");
+        const std::string regionsFile = stlplus::create_filespec(feat_directory, basename, ".regions");
 
+        // Use the binary regions file if it is up to date (a single mapping, no parsing)
         std::unique_ptr<features::Regions> regions_ptr(region_type->EmptyClone());
-        if (!regions_ptr->Load(featFile, descFile))
+        if (!(IsRegionsFileUpToDate(regionsFile, featFile, descFile)
+              && regions_ptr->Load(regionsFile))
+            && !regions_ptr->Load(featFile, descFile))
         {
           std::cerr << "Invalid regions files for the view: " << sImageName << std::endl;
           bContinue = false;
@@ -139,6 +144,22 @@ public:
   }
 
 protected:
+  /// Tell if a binary regions file exists and is not older than the
+  ///  .feat/.desc files (a stale file is ignored if the features were recomputed)
+  static bool IsRegionsFileUpToDate
+  (
+    const std::string & regionsFile,
+    const std::string & featFile,
+    const std::string & descFile
+  )
+  {
+    if (!stlplus::file_exists(regionsFile))
+      return false;
+    const time_t regions_time = stlplus::file_modified(regionsFile);
+    return (!stlplus::file_exists(featFile) || regions_time >= stlplus::file_modified(featFile))
+      && (!stlplus::file_exists(descFile) || regions_time >= stlplus::file_modified(descFile));
+  }
+
   /// Regions per ViewId of the considered SfM_Data container
   mutable Hash_Map<IndexT, std::shared_ptr<features::Regions> > cache_;
   std::unique_ptr<openMVG::features::Regions> region_type_;
@@ -48,8 +48,11 @@ public:
         stlplus::create_filespec(feat_directory_, map_id_string_.at(x));
       const std::string featFile = id + ".feat";
       const std::string descFile = id + ".desc";
+      const std::string regionsFile = id + ".regions";
       ret.reset(region_type_->EmptyClone());
-      if (ret->Load(featFile, descFile))
+      // Use the binary regions file if it is up to date (a single mapping, no parsing)
+      if ((IsRegionsFileUpToDate(regionsFile, featFile, descFile) && ret->Load(regionsFile))
+          || ret->Load(featFile, descFile))
       {
         cache_[x] = ret;
       }
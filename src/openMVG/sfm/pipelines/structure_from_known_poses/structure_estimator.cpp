@@ -139,7 +139,7 @@ void SfM_Data_Structure_Estimation_From_Known_Poses::match(
     #else
       const Vec3 epipole2  = epipole_from_P(P_R, poseL);
 
-      geometry_aware::GuidedMatching_Fundamental_Fast
+      geometry_aware::GuidedMatching_Fundamental_Epipolar_Index
         <openMVG::fundamental::kernel::EpipolarDistanceError>
         (
           F_lr,
@@ -148,7 +148,6 @@ void SfM_Data_Structure_Estimation_From_Known_Poses::match(
           *regionsL.get(),
           iterIntrinsicR->second.get(),
           *regionsR.get(),
-          iterIntrinsicR->second->w(), iterIntrinsicR->second->h(),
           Square(thresholdF), Square(0.8),
           vec_corresponding_indexes
         );
@@ -275,41 +274,60 @@ void SfM_Data_Structure_Estimation_From_Known_Poses::triangulate(
   // Generate new Structure tracks
   sfm_data.structure.clear();
 
-  SfM_Data_Structure_Computation_Robust structure_estimator(max_reprojection_error_);
   C_Progress_display my_progress_bar( map_tracksCommon.size(), std::cout,
     "Tracks to structure conversion:\n" );
-  // Fill sfm_data with the computed tracks (no 3D yet)
+  // List the tracks for an indexed parallel loop
+  std::vector<const tracks::STLMAPTracks::value_type *> tracks;
+  tracks.reserve(map_tracksCommon.size());
+  for (const auto & track_it : map_tracksCommon)
+    tracks.push_back(&track_it);
+  // Fill sfm_data with the computed tracks (no 3D yet):
+  // the landmarks are built in per thread buffers then merged
 #ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel for schedule(dynamic)
+  #pragma omp parallel
 #endif // OPENMVG_USE_OPENMP
-  for (int i = 0; i < map_tracksCommon.size(); ++i)
   {
-    ++my_progress_bar;
-
-    tracks::STLMAPTracks::const_iterator itTracks = map_tracksCommon.begin();
-    std::advance(itTracks, i);
+    std::vector<std::pair<IndexT, Landmark>> thread_landmarks;
+    unsigned long progress_count = 0;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic, 256)
+#endif // OPENMVG_USE_OPENMP
+    for (int i = 0; i < static_cast<int>(tracks.size()); ++i)
     {
-      const tracks::submapTrack & track = itTracks->second;
+      if (++progress_count == 1024)
+      {
+#ifdef OPENMVG_USE_OPENMP
+        #pragma omp critical
+#endif // OPENMVG_USE_OPENMP
+        my_progress_bar += progress_count;
+        progress_count = 0;
+      }
 
-      Observations obs;
+      const tracks::submapTrack & track = tracks[i]->second;
+      Landmark landmark;
       for (tracks::submapTrack::const_iterator it = track.begin(); it != track.end(); ++it)
       {
         const IndexT imaIndex = it->first;
         const IndexT featIndex = it->second;
         const std::shared_ptr<features::Regions> regions = regions_provider->get(imaIndex);
         const Vec2 pt = regions->GetRegionPosition(featIndex);
-        obs[imaIndex] = Observation(pt, featIndex);
-      }
-      Landmark landmark;
-      if (structure_estimator.robust_triangulation(sfm_data, obs, landmark))
-      #ifdef OPENMVG_USE_OPENMP
-      #pragma omp critical
-      #endif // OPENMVG_USE_OPENMP
-      {
-        sfm_data.structure[itTracks->first] = landmark;
+        landmark.obs[imaIndex] = Observation(pt, featIndex);
       }
+      thread_landmarks.emplace_back(tracks[i]->first, std::move(landmark));
+    }
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif // OPENMVG_USE_OPENMP
+    {
+      my_progress_bar += progress_count;
+      for (auto & landmark_it : thread_landmarks)
+        sfm_data.structure[landmark_it.first] = std::move(landmark_it.second);
     }
   }
+
+  // Robust triangulation of the tracks (the invalid tracks are removed)
+  SfM_Data_Structure_Computation_Robust structure_estimator(max_reprojection_error_);
+  structure_estimator.triangulate(sfm_data);
 }
 
 } // namespace sfm
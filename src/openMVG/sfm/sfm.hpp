@@ -18,6 +18,9 @@
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_BA.hpp"
 #include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/sfm/sfm_data_BA_partitioned.hpp"
+#include "openMVG/sfm/sfm_data_colorization.hpp"
+#include "openMVG/sfm/sfm_data_export_undistorted.hpp"
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data_filters_frustum.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
@@ -21,15 +21,22 @@
 //- Robust estimation - LMeds (since no threshold can be defined)
 #include "openMVG/robust_estimation/robust_estimator_LMeds.hpp"
 #include "openMVG/sfm/sfm_data_BA_ceres_camera_functor.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_camera_functor_analytic.hpp"
 #include "openMVG/sfm/sfm_data_transform.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/system/timer.hpp"
 #include "openMVG/types.hpp"
 
 #include <ceres/rotation.h>
 #include <ceres/types.h>
 
+#include <algorithm>
+#include <array>
+#include <deque>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <vector>
 
 namespace openMVG {
 namespace sfm {
@@ -78,15 +85,80 @@ struct PoseCenterConstraintCostFunction
   }
 };
 
+/// Quadratic penalty between a parameter block and a target value:
+///  residual = weight * (x - target)
+class ConsensusCostFunction : public ceres::CostFunction
+{
+public:
+  ConsensusCostFunction
+  (
+    const double * target,
+    const int size,
+    const double weight
+  ): target_(target, target + size), weight_(weight)
+  {
+    set_num_residuals(size);
+    mutable_parameter_block_sizes()->push_back(size);
+  }
+
+  bool Evaluate
+  (
+    double const * const * parameters,
+    double * residuals,
+    double ** jacobians
+  )
+  const override
+  {
+    const int size = static_cast<int>(target_.size());
+    for (int i = 0; i < size; ++i)
+      residuals[i] = weight_ * (parameters[0][i] - target_[i]);
+    if (jacobians && jacobians[0])
+    {
+      std::fill(jacobians[0], jacobians[0] + size * size, 0.0);
+      for (int i = 0; i < size; ++i)
+        jacobians[0][i * size + i] = weight_;
+    }
+    return true;
+  }
+
+private:
+  std::vector<double> target_;
+  double weight_;
+};
+
 /// Create the appropriate cost functor according the provided input camera intrinsic model.
 /// The residual can be weighetd if desired (default 0.0 means no weight).
 ceres::CostFunction * IntrinsicsToCostFunction
 (
   IntrinsicBase * intrinsic,
   const Vec2 & observation,
-  const double weight
+  const double weight,
+  const bool b_analytic_jacobian
 )
 {
+  if (b_analytic_jacobian)
+  {
+    using namespace analytic_jacobian;
+    switch (intrinsic->getType())
+    {
+      case PINHOLE_CAMERA:
+        return new ResidualErrorCost_Pinhole_Intrinsic_Analytic(observation.data(), weight);
+      case PINHOLE_CAMERA_RADIAL1:
+        return new ResidualErrorCost_Pinhole_Intrinsic_Radial_K1_Analytic(observation.data(), weight);
+      case PINHOLE_CAMERA_RADIAL3:
+        return new ResidualErrorCost_Pinhole_Intrinsic_Radial_K3_Analytic(observation.data(), weight);
+      case PINHOLE_CAMERA_BROWN:
+        return new ResidualErrorCost_Pinhole_Intrinsic_Brown_T2_Analytic(observation.data(), weight);
+      case PINHOLE_CAMERA_FISHEYE:
+        return new ResidualErrorCost_Pinhole_Intrinsic_Fisheye_Analytic(observation.data(), weight);
+      case CAMERA_SPHERICAL:
+        return new ResidualErrorCost_Intrinsic_Spherical_Analytic(
+          observation.data(), intrinsic->w(), intrinsic->h(), weight);
+      default:
+        return {};
+    }
+  }
+
   switch (intrinsic->getType())
   {
     case PINHOLE_CAMERA:
@@ -106,6 +178,108 @@ ceres::CostFunction * IntrinsicsToCostFunction
   }
 }
 
+/// Cost functions of the observations of a camera.
+/// They share the camera cost functor and are stored in chunks of contiguous memory.
+struct Camera_Observation_Costs
+{
+  virtual ~Camera_Observation_Costs() = default;
+
+  /// Add the cost function of an observation (owned by this object).
+  /// Return the cost function and the address of its observation copy.
+  virtual ceres::CostFunction * Add(const Vec2 & observation, double ** observation_data) = 0;
+};
+
+template <typename CameraCost, typename ObservationCost>
+struct Camera_Observation_Costs_T : public Camera_Observation_Costs
+{
+  explicit Camera_Observation_Costs_T(CameraCost * camera_cost)
+  : camera_cost(camera_cost)
+  {
+  }
+
+  ceres::CostFunction * Add(const Vec2 & observation, double ** observation_data) override
+  {
+    observation_costs.emplace_back(camera_cost.get(), observation.data());
+    *observation_data = observation_costs.back().observation();
+    return &observation_costs.back();
+  }
+
+  std::unique_ptr<CameraCost> camera_cost;
+  std::deque<ObservationCost> observation_costs;
+};
+
+/// Create the storage of the observation cost functions according the provided camera intrinsic model.
+Camera_Observation_Costs * IntrinsicsToObservationCosts
+(
+  IntrinsicBase * intrinsic,
+  const bool b_analytic_jacobian
+)
+{
+  if (b_analytic_jacobian)
+  {
+    using namespace analytic_jacobian;
+    switch (intrinsic->getType())
+    {
+      case PINHOLE_CAMERA:
+        return new Camera_Observation_Costs_T<ResidualErrorCost_Pinhole_Intrinsic_Analytic,
+          ObservationCostFunction_Analytic<ResidualErrorCost_Pinhole_Intrinsic_Analytic>>(
+            new ResidualErrorCost_Pinhole_Intrinsic_Analytic(nullptr));
+      case PINHOLE_CAMERA_RADIAL1:
+        return new Camera_Observation_Costs_T<ResidualErrorCost_Pinhole_Intrinsic_Radial_K1_Analytic,
+          ObservationCostFunction_Analytic<ResidualErrorCost_Pinhole_Intrinsic_Radial_K1_Analytic>>(
+            new ResidualErrorCost_Pinhole_Intrinsic_Radial_K1_Analytic(nullptr));
+      case PINHOLE_CAMERA_RADIAL3:
+        return new Camera_Observation_Costs_T<ResidualErrorCost_Pinhole_Intrinsic_Radial_K3_Analytic,
+          ObservationCostFunction_Analytic<ResidualErrorCost_Pinhole_Intrinsic_Radial_K3_Analytic>>(
+            new ResidualErrorCost_Pinhole_Intrinsic_Radial_K3_Analytic(nullptr));
+      case PINHOLE_CAMERA_BROWN:
+        return new Camera_Observation_Costs_T<ResidualErrorCost_Pinhole_Intrinsic_Brown_T2_Analytic,
+          ObservationCostFunction_Analytic<ResidualErrorCost_Pinhole_Intrinsic_Brown_T2_Analytic>>(
+            new ResidualErrorCost_Pinhole_Intrinsic_Brown_T2_Analytic(nullptr));
+      case PINHOLE_CAMERA_FISHEYE:
+        return new Camera_Observation_Costs_T<ResidualErrorCost_Pinhole_Intrinsic_Fisheye_Analytic,
+          ObservationCostFunction_Analytic<ResidualErrorCost_Pinhole_Intrinsic_Fisheye_Analytic>>(
+            new ResidualErrorCost_Pinhole_Intrinsic_Fisheye_Analytic(nullptr));
+      case CAMERA_SPHERICAL:
+        return new Camera_Observation_Costs_T<ResidualErrorCost_Intrinsic_Spherical_Analytic,
+          ObservationCostFunction_Analytic<ResidualErrorCost_Intrinsic_Spherical_Analytic>>(
+            new ResidualErrorCost_Intrinsic_Spherical_Analytic(nullptr, intrinsic->w(), intrinsic->h()));
+      default:
+        return {};
+    }
+  }
+
+  switch (intrinsic->getType())
+  {
+    case PINHOLE_CAMERA:
+      return new Camera_Observation_Costs_T<ResidualErrorFunctor_Pinhole_Intrinsic,
+        ObservationCostFunction<ResidualErrorFunctor_Pinhole_Intrinsic, 3, 6, 3>>(
+          new ResidualErrorFunctor_Pinhole_Intrinsic(nullptr));
+    case PINHOLE_CAMERA_RADIAL1:
+      return new Camera_Observation_Costs_T<ResidualErrorFunctor_Pinhole_Intrinsic_Radial_K1,
+        ObservationCostFunction<ResidualErrorFunctor_Pinhole_Intrinsic_Radial_K1, 4, 6, 3>>(
+          new ResidualErrorFunctor_Pinhole_Intrinsic_Radial_K1(nullptr));
+    case PINHOLE_CAMERA_RADIAL3:
+      return new Camera_Observation_Costs_T<ResidualErrorFunctor_Pinhole_Intrinsic_Radial_K3,
+        ObservationCostFunction<ResidualErrorFunctor_Pinhole_Intrinsic_Radial_K3, 6, 6, 3>>(
+          new ResidualErrorFunctor_Pinhole_Intrinsic_Radial_K3(nullptr));
+    case PINHOLE_CAMERA_BROWN:
+      return new Camera_Observation_Costs_T<ResidualErrorFunctor_Pinhole_Intrinsic_Brown_T2,
+        ObservationCostFunction<ResidualErrorFunctor_Pinhole_Intrinsic_Brown_T2, 8, 6, 3>>(
+          new ResidualErrorFunctor_Pinhole_Intrinsic_Brown_T2(nullptr));
+    case PINHOLE_CAMERA_FISHEYE:
+      return new Camera_Observation_Costs_T<ResidualErrorFunctor_Pinhole_Intrinsic_Fisheye,
+        ObservationCostFunction<ResidualErrorFunctor_Pinhole_Intrinsic_Fisheye, 7, 6, 3>>(
+          new ResidualErrorFunctor_Pinhole_Intrinsic_Fisheye(nullptr));
+    case CAMERA_SPHERICAL:
+      return new Camera_Observation_Costs_T<ResidualErrorFunctor_Intrinsic_Spherical,
+        ObservationCostFunction<ResidualErrorFunctor_Intrinsic_Spherical, 6, 3>>(
+          new ResidualErrorFunctor_Intrinsic_Spherical(nullptr, intrinsic->w(), intrinsic->h()));
+    default:
+      return {};
+  }
+}
+
 Bundle_Adjustment_Ceres::BA_Ceres_options::BA_Ceres_options
 (
   const bool bVerbose,
@@ -114,7 +288,10 @@ Bundle_Adjustment_Ceres::BA_Ceres_options::BA_Ceres_options
 : bVerbose_(bVerbose),
   nb_threads_(1),
   parameter_tolerance_(1e-8), //~= numeric_limits<float>::epsilon()
-  bUse_loss_function_(true)
+  bUse_loss_function_(true),
+  bUse_analytic_jacobian_(false),
+  bReuse_problem_(false),
+  iterative_schur_threshold_(0)
 {
   #ifdef OPENMVG_USE_OPENMP
     nb_threads_ = omp_get_max_threads();
@@ -148,9 +325,370 @@ Bundle_Adjustment_Ceres::BA_Ceres_options::BA_Ceres_options
       linear_solver_type_ = ceres::SPARSE_SCHUR;
     }
   }
+
+  // Preconditioner used for the large scenes (ITERATIVE_SCHUR)
+  // - CLUSTER_JACOBI groups the views according their covisibility graph
+  //   (it requires SuiteSparse),
+  // - SCHUR_JACOBI uses only the block diagonal of the reduced camera system.
+  iterative_schur_preconditioner_type_ =
+    ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::SUITE_SPARSE) ?
+      ceres::CLUSTER_JACOBI : ceres::SCHUR_JACOBI;
 }
 
 
+/// Ceres problem with its parameter and residual blocks.
+/// Poses and observation cost functions are stored in chunks of contiguous
+/// memory (stable addresses), landmarks are used in place from the SfM_Data scene.
+/// The observation cost functions of a camera share the camera cost functor
+/// and only store their 2D observation.
+/// If the problem is reused, the residual blocks are indexed by landmark and view
+/// so that the problem can be extended (instead of rebuilt) when some blocks
+/// are added to the scene.
+/// The kept scene addresses are only compared to the current scene ones
+/// (never dereferenced) before being used again.
+struct Bundle_Adjustment_Ceres::Problem_Cache
+{
+  struct Intrinsic_Block
+  {
+    EINTRINSIC type;
+    std::vector<double> parameters;
+    std::weak_ptr<IntrinsicBase> intrinsic; // The SfM_Data camera (scene identity check)
+    std::unique_ptr<Camera_Observation_Costs> observation_costs;
+  };
+
+  struct Observation_Residual
+  {
+    IndexT id_view;
+    IndexT id_pose;
+    IndexT id_intrinsic;
+    double * observation; // The observation used by the cost function
+  };
+
+  struct Landmark_Residuals
+  {
+    double * X; // The SfM_Data landmark position
+    std::vector<Observation_Residual> residuals;
+  };
+
+  // Configuration used to build the problem (the problem is rebuilt if it changes)
+  const SfM_Data * sfm_data;
+  Intrinsic_Parameter_Type intrinsics_opt;
+  Extrinsic_Parameter_Type extrinsics_opt;
+  Structure_Parameter_Type structure_opt;
+  bool b_analytic_jacobian;
+  bool b_reuse_problem;
+
+  std::unique_ptr<ceres::Problem> problem;
+  std::unique_ptr<ceres::LossFunction> loss_function;
+
+  // Parameter blocks: angleAxis + translation per pose & intrinsic parameters
+  std::deque<std::array<double, 6>> pose_blocks;
+  Hash_Map<IndexT, double *> map_poses;
+  Hash_Map<IndexT, Intrinsic_Block> map_intrinsics;
+  Hash_Map<IndexT, Landmark_Residuals> map_landmarks;
+
+  // Ownership of the cost and loss functions that are not observations (GCP, priors)
+  std::vector<std::unique_ptr<ceres::CostFunction>> extra_cost_functions;
+  std::vector<std::unique_ptr<ceres::LossFunction>> extra_loss_functions;
+
+  Problem_Cache
+  (
+    const SfM_Data & sfm_data,
+    const Optimize_Options & options,
+    const BA_Ceres_options & ceres_options
+  )
+  : sfm_data(&sfm_data),
+    intrinsics_opt(options.intrinsics_opt),
+    extrinsics_opt(options.extrinsics_opt),
+    structure_opt(options.structure_opt),
+    b_analytic_jacobian(ceres_options.bUse_analytic_jacobian_),
+    b_reuse_problem(ceres_options.bReuse_problem_)
+  {
+    ceres::Problem::Options problem_options;
+    // The cost & loss functions are owned by the cache
+    problem_options.cost_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+    problem_options.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+    // No block is ever removed (the problem is rebuilt instead):
+    //  the residual dependencies index of the fast removal is not required.
+    problem_options.enable_fast_removal = false;
+    problem.reset(new ceres::Problem(problem_options));
+
+    // Set a LossFunction to be less penalized by false measurements
+    //  - set it to nullptr if you don't want use a lossFunction.
+    if (ceres_options.bUse_loss_function_)
+      loss_function.reset(new ceres::HuberLoss(Square(4.0)));
+  }
+
+  // Tell if the problem has been built for the same scene and configuration
+  // and if the scene changes can be applied by adding blocks to the problem
+  bool IsCompatible
+  (
+    const SfM_Data & sfm_data,
+    const Optimize_Options & options,
+    const BA_Ceres_options & ceres_options
+  ) const
+  {
+    if (this->sfm_data != &sfm_data
+        || intrinsics_opt != options.intrinsics_opt
+        || extrinsics_opt != options.extrinsics_opt
+        || structure_opt != options.structure_opt
+        || b_analytic_jacobian != ceres_options.bUse_analytic_jacobian_
+        || b_reuse_problem != ceres_options.bReuse_problem_
+        || (loss_function != nullptr) != ceres_options.bUse_loss_function_
+        || !extra_cost_functions.empty())
+      return false;
+    for (const auto & pose_it : map_poses)
+    {
+      if (sfm_data.poses.count(pose_it.first) == 0)
+        return false;
+    }
+    // A scene object reused for another scene (i.e. reloaded or reassigned)
+    //  does not share its camera objects with the previous one.
+    // A camera must keep its model.
+    for (const auto & intrinsic_it : map_intrinsics)
+    {
+      const auto sfm_intrinsic_it = sfm_data.intrinsics.find(intrinsic_it.first);
+      if (sfm_intrinsic_it == sfm_data.intrinsics.end() ||
+          sfm_intrinsic_it->second != intrinsic_it.second.intrinsic.lock() ||
+          sfm_intrinsic_it->second->getType() != intrinsic_it.second.type ||
+          sfm_intrinsic_it->second->getParams().size() != intrinsic_it.second.parameters.size())
+        return false;
+    }
+    for (const auto & landmark_it : map_landmarks)
+    {
+      const auto structure_it = sfm_data.structure.find(landmark_it.first);
+      if (structure_it == sfm_data.structure.end() ||
+          structure_it->second.X.data() != landmark_it.second.X)
+        return false;
+      const Observations & obs = structure_it->second.obs;
+      for (const Observation_Residual & residual : landmark_it.second.residuals)
+      {
+        if (obs.count(residual.id_view) == 0 || !IsValid(sfm_data, residual))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  // Add the new parameter and residual blocks of the scene (and refresh the values of the existing ones)
+  bool Update(const SfM_Data & sfm_data)
+  {
+    SetupPoses(sfm_data);
+    SetupIntrinsics(sfm_data);
+    return AddObservations(sfm_data);
+  }
+
+private:
+
+  // Tell if a residual is still linked to the scene view, pose and intrinsic
+  bool IsValid
+  (
+    const SfM_Data & sfm_data,
+    const Observation_Residual & residual
+  ) const
+  {
+    const auto view_it = sfm_data.views.find(residual.id_view);
+    return view_it != sfm_data.views.end()
+      && view_it->second->id_pose == residual.id_pose
+      && view_it->second->id_intrinsic == residual.id_intrinsic;
+  }
+
+  // Setup Poses data & subparametrization
+  void SetupPoses(const SfM_Data & sfm_data)
+  {
+    for (const auto & pose_it : sfm_data.poses)
+    {
+      const IndexT indexPose = pose_it.first;
+
+      const Pose3 & pose = pose_it.second;
+      const Mat3 R = pose.rotation();
+      const Vec3 t = pose.translation();
+
+      double angleAxis[3];
+      ceres::RotationMatrixToAngleAxis((const double*)R.data(), angleAxis);
+
+      const auto map_pose_it = map_poses.find(indexPose);
+      if (map_pose_it != map_poses.end())
+      {
+        // Existing block: only refresh the values
+        double * parameter_block = map_pose_it->second;
+        std::copy(angleAxis, angleAxis + 3, parameter_block);
+        std::copy(t.data(), t.data() + 3, parameter_block + 3);
+        continue;
+      }
+
+      pose_blocks.emplace_back();
+      double * parameter_block = pose_blocks.back().data();
+      // angleAxis + translation
+      std::copy(angleAxis, angleAxis + 3, parameter_block);
+      std::copy(t.data(), t.data() + 3, parameter_block + 3);
+      map_poses[indexPose] = parameter_block;
+
+      problem->AddParameterBlock(parameter_block, 6);
+      if (extrinsics_opt == Extrinsic_Parameter_Type::NONE)
+      {
+        // set the whole parameter block as constant for best performance
+        problem->SetParameterBlockConstant(parameter_block);
+      }
+      else  // Subset parametrization
+      {
+        std::vector<int> vec_constant_extrinsic;
+        // If we adjust only the translation, we must set ROTATION as constant
+        if (extrinsics_opt == Extrinsic_Parameter_Type::ADJUST_TRANSLATION)
+        {
+          // Subset rotation parametrization
+          vec_constant_extrinsic.insert(vec_constant_extrinsic.end(), {0,1,2});
+        }
+        // If we adjust only the rotation, we must set TRANSLATION as constant
+        if (extrinsics_opt == Extrinsic_Parameter_Type::ADJUST_ROTATION)
+        {
+          // Subset translation parametrization
+          vec_constant_extrinsic.insert(vec_constant_extrinsic.end(), {3,4,5});
+        }
+        if (!vec_constant_extrinsic.empty())
+        {
+          ceres::SubsetParameterization *subset_parameterization =
+            new ceres::SubsetParameterization(6, vec_constant_extrinsic);
+          problem->SetParameterization(parameter_block, subset_parameterization);
+        }
+      }
+    }
+  }
+
+  // Setup Intrinsics data & subparametrization
+  void SetupIntrinsics(const SfM_Data & sfm_data)
+  {
+    for (const auto & intrinsic_it : sfm_data.intrinsics)
+    {
+      const IndexT indexCam = intrinsic_it.first;
+
+      if (!isValid(intrinsic_it.second->getType()))
+      {
+        std::cerr << "Unsupported camera type." << std::endl;
+        continue;
+      }
+
+      const auto map_intrinsic_it = map_intrinsics.find(indexCam);
+      if (map_intrinsic_it != map_intrinsics.end())
+      {
+        // Existing block: only refresh the values
+        const std::vector<double> params = intrinsic_it.second->getParams();
+        std::copy(params.begin(), params.end(), map_intrinsic_it->second.parameters.begin());
+        continue;
+      }
+
+      Intrinsic_Block & intrinsic_block = map_intrinsics[indexCam];
+      intrinsic_block.type = intrinsic_it.second->getType();
+      intrinsic_block.parameters = intrinsic_it.second->getParams();
+      intrinsic_block.intrinsic = intrinsic_it.second;
+      intrinsic_block.observation_costs.reset(
+        IntrinsicsToObservationCosts(intrinsic_it.second.get(), b_analytic_jacobian));
+      if (!intrinsic_block.parameters.empty())
+      {
+        double * parameter_block = &intrinsic_block.parameters[0];
+        problem->AddParameterBlock(parameter_block, intrinsic_block.parameters.size());
+        if (intrinsics_opt == Intrinsic_Parameter_Type::NONE)
+        {
+          // set the whole parameter block as constant for best performance
+          problem->SetParameterBlockConstant(parameter_block);
+        }
+        else
+        {
+          const std::vector<int> vec_constant_intrinsic =
+            intrinsic_it.second->subsetParameterization(intrinsics_opt);
+          if (!vec_constant_intrinsic.empty())
+          {
+            ceres::SubsetParameterization *subset_parameterization =
+              new ceres::SubsetParameterization(
+                intrinsic_block.parameters.size(), vec_constant_intrinsic);
+            problem->SetParameterization(parameter_block, subset_parameterization);
+          }
+        }
+      }
+    }
+  }
+
+  // For all visibility add the missing reprojections errors
+  bool AddObservations(const SfM_Data & sfm_data)
+  {
+    std::vector<IndexT> existing_views;
+    for (const auto & structure_landmark_it : sfm_data.structure)
+    {
+      const Observations & obs = structure_landmark_it.second.obs;
+
+      auto landmark_it = map_landmarks.find(structure_landmark_it.first);
+      if (landmark_it == map_landmarks.end())
+      {
+        // Structure is used in place (no data wrapping)
+        double * X = const_cast<double *>(structure_landmark_it.second.X.data());
+        landmark_it = map_landmarks.emplace(
+          structure_landmark_it.first, Landmark_Residuals{X, {}}).first;
+        problem->AddParameterBlock(X, 3);
+        if (structure_opt == Structure_Parameter_Type::NONE)
+          problem->SetParameterBlockConstant(X);
+      }
+      Landmark_Residuals & landmark_residuals = landmark_it->second;
+      // Refresh the existing observation values (they can be edited in place)
+      existing_views.clear();
+      for (const Observation_Residual & residual : landmark_residuals.residuals)
+      {
+        const Vec2 & x = obs.at(residual.id_view).x;
+        std::copy(x.data(), x.data() + 2, residual.observation);
+        existing_views.push_back(residual.id_view);
+      }
+      if (landmark_residuals.residuals.size() == obs.size())
+        continue; // All the observations are already in the problem
+      std::sort(existing_views.begin(), existing_views.end());
+
+      if (b_reuse_problem)
+        landmark_residuals.residuals.reserve(obs.size());
+      for (const auto & obs_it : obs)
+      {
+        if (std::binary_search(existing_views.begin(), existing_views.end(), obs_it.first))
+          continue;
+
+        // Build the residual block corresponding to the track observation:
+        const View * view = sfm_data.views.at(obs_it.first).get();
+        const auto intrinsic_it = map_intrinsics.find(view->id_intrinsic);
+        const auto pose_it = map_poses.find(view->id_pose);
+        if (intrinsic_it == map_intrinsics.end() || pose_it == map_poses.end())
+        {
+          std::cerr << "Missing pose or intrinsic for the view: " << obs_it.first << std::endl;
+          return false;
+        }
+        // Each Residual block takes a point and a camera as input and outputs a 2
+        // dimensional residual. Internally, the cost function stores the observed
+        // image location and compares the reprojection against the observation.
+        if (!intrinsic_it->second.observation_costs)
+        {
+          std::cerr << "Cannot create a CostFunction for this camera model." << std::endl;
+          return false;
+        }
+        double * observation = nullptr;
+        ceres::CostFunction * cost_function =
+          intrinsic_it->second.observation_costs->Add(obs_it.second.x, &observation);
+
+        if (intrinsic_it->second.parameters.empty())
+          problem->AddResidualBlock(cost_function,
+            loss_function.get(),
+            pose_it->second,
+            landmark_residuals.X);
+        else
+          problem->AddResidualBlock(cost_function,
+            loss_function.get(),
+            &intrinsic_it->second.parameters[0],
+            pose_it->second,
+            landmark_residuals.X);
+
+        if (b_reuse_problem)
+          landmark_residuals.residuals.push_back(
+            {obs_it.first, view->id_pose, view->id_intrinsic, observation});
+      }
+    }
+    return true;
+  }
+};
+
 Bundle_Adjustment_Ceres::Bundle_Adjustment_Ceres
 (
   const Bundle_Adjustment_Ceres::BA_Ceres_options & options
@@ -158,17 +696,34 @@ Bundle_Adjustment_Ceres::Bundle_Adjustment_Ceres
 : ceres_options_(options)
 {}
 
+Bundle_Adjustment_Ceres::~Bundle_Adjustment_Ceres() = default;
+
 Bundle_Adjustment_Ceres::BA_Ceres_options &
 Bundle_Adjustment_Ceres::ceres_options()
 {
   return ceres_options_;
 }
 
+void Bundle_Adjustment_Ceres::ResetProblem()
+{
+  problem_cache_.reset();
+}
+
 bool Bundle_Adjustment_Ceres::Adjust
 (
   SfM_Data & sfm_data,     // the SfM scene to refine
   const Optimize_Options & options
 )
+{
+  return Adjust(sfm_data, options, Consensus_Terms());
+}
+
+bool Bundle_Adjustment_Ceres::Adjust
+(
+  SfM_Data & sfm_data,     // the SfM scene to refine
+  const Optimize_Options & options,
+  const Consensus_Terms & consensus
+)
 {
   //----------
   // Add camera parameters
@@ -237,145 +792,31 @@ bool Bundle_Adjustment_Ceres::Adjust
     }
   }
 
-  ceres::Problem problem;
-
-  // Data wrapper for refinement:
-  Hash_Map<IndexT, std::vector<double> > map_intrinsics;
-  Hash_Map<IndexT, std::vector<double> > map_poses;
-
-  // Setup Poses data & subparametrization
-  for (const auto & pose_it : sfm_data.poses)
-  {
-    const IndexT indexPose = pose_it.first;
-
-    const Pose3 & pose = pose_it.second;
-    const Mat3 R = pose.rotation();
-    const Vec3 t = pose.translation();
-
-    double angleAxis[3];
-    ceres::RotationMatrixToAngleAxis((const double*)R.data(), angleAxis);
-    // angleAxis + translation
-    map_poses[indexPose] = {angleAxis[0], angleAxis[1], angleAxis[2], t(0), t(1), t(2)};
-
-    double * parameter_block = &map_poses.at(indexPose)[0];
-    problem.AddParameterBlock(parameter_block, 6);
-    if (options.extrinsics_opt == Extrinsic_Parameter_Type::NONE)
-    {
-      // set the whole parameter block as constant for best performance
-      problem.SetParameterBlockConstant(parameter_block);
-    }
-    else  // Subset parametrization
-    {
-      std::vector<int> vec_constant_extrinsic;
-      // If we adjust only the translation, we must set ROTATION as constant
-      if (options.extrinsics_opt == Extrinsic_Parameter_Type::ADJUST_TRANSLATION)
-      {
-        // Subset rotation parametrization
-        vec_constant_extrinsic.insert(vec_constant_extrinsic.end(), {0,1,2});
-      }
-      // If we adjust only the rotation, we must set TRANSLATION as constant
-      if (options.extrinsics_opt == Extrinsic_Parameter_Type::ADJUST_ROTATION)
-      {
-        // Subset translation parametrization
-        vec_constant_extrinsic.insert(vec_constant_extrinsic.end(), {3,4,5});
-      }
-      if (!vec_constant_extrinsic.empty())
-      {
-        ceres::SubsetParameterization *subset_parameterization =
-          new ceres::SubsetParameterization(6, vec_constant_extrinsic);
-        problem.SetParameterization(parameter_block, subset_parameterization);
-      }
-    }
-  }
-
-  // Setup Intrinsics data & subparametrization
-  for (const auto & intrinsic_it : sfm_data.intrinsics)
+  // The problem can be updated only if it contains the observations residuals
+  const bool b_use_consensus = consensus.weight > 0.0 &&
+    (!consensus.landmarks.empty() || !consensus.intrinsics.empty());
+  const bool b_reuse_problem = ceres_options_.bReuse_problem_ &&
+    !b_usable_prior && !options.control_point_opt.bUse_control_points &&
+    !b_use_consensus;
+  system::Timer setup_timer;
+  if (!b_reuse_problem || !problem_cache_ ||
+      !problem_cache_->IsCompatible(sfm_data, options, ceres_options_))
   {
-    const IndexT indexCam = intrinsic_it.first;
-
-    if (isValid(intrinsic_it.second->getType()))
-    {
-      map_intrinsics[indexCam] = intrinsic_it.second->getParams();
-      if (!map_intrinsics.at(indexCam).empty())
-      {
-        double * parameter_block = &map_intrinsics.at(indexCam)[0];
-        problem.AddParameterBlock(parameter_block, map_intrinsics.at(indexCam).size());
-        if (options.intrinsics_opt == Intrinsic_Parameter_Type::NONE)
-        {
-          // set the whole parameter block as constant for best performance
-          problem.SetParameterBlockConstant(parameter_block);
-        }
-        else
-        {
-          const std::vector<int> vec_constant_intrinsic =
-            intrinsic_it.second->subsetParameterization(options.intrinsics_opt);
-          if (!vec_constant_intrinsic.empty())
-          {
-            ceres::SubsetParameterization *subset_parameterization =
-              new ceres::SubsetParameterization(
-                map_intrinsics.at(indexCam).size(), vec_constant_intrinsic);
-            problem.SetParameterization(parameter_block, subset_parameterization);
-          }
-        }
-      }
-    }
-    else
-    {
-      std::cerr << "Unsupported camera type." << std::endl;
-    }
+    problem_cache_.reset(new Problem_Cache(sfm_data, options, ceres_options_));
   }
-
-  // Set a LossFunction to be less penalized by false measurements
-  //  - set it to nullptr if you don't want use a lossFunction.
-  ceres::LossFunction * p_LossFunction =
-    ceres_options_.bUse_loss_function_ ?
-      new ceres::HuberLoss(Square(4.0))
-      : nullptr;
-
-  // For all visibility add reprojections errors:
-  for (auto & structure_landmark_it : sfm_data.structure)
+  // Add (or update) the parameters and the reprojection errors:
+  // - intrinsics
+  // - poses [R|t]
+  // - structure
+  if (!problem_cache_->Update(sfm_data))
   {
-    const Observations & obs = structure_landmark_it.second.obs;
-
-    for (const auto & obs_it : obs)
-    {
-      // Build the residual block corresponding to the track observation:
-      const View * view = sfm_data.views.at(obs_it.first).get();
-
-      // Each Residual block takes a point and a camera as input and outputs a 2
-      // dimensional residual. Internally, the cost function stores the observed
-      // image location and compares the reprojection against the observation.
-      ceres::CostFunction* cost_function =
-        IntrinsicsToCostFunction(sfm_data.intrinsics.at(view->id_intrinsic).get(),
-                                 obs_it.second.x);
-
-      if (cost_function)
-      {
-        if (!map_intrinsics.at(view->id_intrinsic).empty())
-        {
-          problem.AddResidualBlock(cost_function,
-            p_LossFunction,
-            &map_intrinsics.at(view->id_intrinsic)[0],
-            &map_poses.at(view->id_pose)[0],
-            structure_landmark_it.second.X.data());
-        }
-        else
-        {
-          problem.AddResidualBlock(cost_function,
-            p_LossFunction,
-            &map_poses.at(view->id_pose)[0],
-            structure_landmark_it.second.X.data());
-        }
-      }
-      else
-      {
-        std::cerr << "Cannot create a CostFunction for this camera model." << std::endl;
-        return false;
-      }
-    }
-    if (options.structure_opt == Structure_Parameter_Type::NONE)
-      problem.SetParameterBlockConstant(structure_landmark_it.second.X.data());
+    problem_cache_.reset();
+    return false;
   }
+  ceres::Problem & problem = *problem_cache_->problem;
+  Hash_Map<IndexT, double *> & map_poses = problem_cache_->map_poses;
+  Hash_Map<IndexT, Problem_Cache::Intrinsic_Block> & map_intrinsics =
+    problem_cache_->map_intrinsics;
 
   if (options.control_point_opt.bUse_control_points)
   {
@@ -397,23 +838,25 @@ bool Bundle_Adjustment_Ceres::Adjust
           IntrinsicsToCostFunction(
             sfm_data.intrinsics.at(view->id_intrinsic).get(),
             obs_it.second.x,
-            options.control_point_opt.weight);
+            options.control_point_opt.weight,
+            ceres_options_.bUse_analytic_jacobian_);
 
 		if (cost_function) {
+			problem_cache_->extra_cost_functions.emplace_back(cost_function);
 			auto map_intrinsic_for_view = map_intrinsics.find( view->id_intrinsic );
 			auto map_pose_for_view = map_poses.find(view->id_pose);
-			if ((map_intrinsic_for_view == map_intrinsics.end()) || map_intrinsic_for_view->second.empty()) {
+			if ((map_intrinsic_for_view == map_intrinsics.end()) || map_intrinsic_for_view->second.parameters.empty()) {
 				std::cerr << "Missing map intrinsic for view intrinsic ID " << view->id_intrinsic << " for GCP id: " << gcp_landmark_it.first << std::endl;
 			}
-			else if ((map_pose_for_view == map_poses.end()) || map_pose_for_view->second.empty()) {
+			else if (map_pose_for_view == map_poses.end()) {
 				std::cerr << "Missing map pose for view pose ID " << view->id_pose << " for GCP id: " << gcp_landmark_it.first << std::endl;
 			}
 			else {
 				problem.AddResidualBlock(
 					cost_function,
 					nullptr,
-					&map_intrinsic_for_view->second[0],
-					&map_pose_for_view->second[0],
+					&map_intrinsic_for_view->second.parameters[0],
+					map_pose_for_view->second,
 					gcp_landmark_it.second.X.data());
 				++added_block_count;
 			}
@@ -440,6 +883,9 @@ bool Bundle_Adjustment_Ceres::Adjust
   // Add Pose prior constraints if any
   if (b_usable_prior)
   {
+    ceres::LossFunction * prior_loss_function =
+      new ceres::HuberLoss(Square(pose_center_robust_fitting_error));
+    problem_cache_->extra_loss_functions.emplace_back(prior_loss_function);
     for (const auto & view_it : sfm_data.GetViews())
     {
       const sfm::ViewPriors * prior = dynamic_cast<sfm::ViewPriors*>(view_it.second.get());
@@ -449,16 +895,47 @@ bool Bundle_Adjustment_Ceres::Adjust
         ceres::CostFunction * cost_function =
           new ceres::AutoDiffCostFunction<PoseCenterConstraintCostFunction, 3, 6>(
             new PoseCenterConstraintCostFunction(prior->pose_center_, prior->center_weight_));
+        problem_cache_->extra_cost_functions.emplace_back(cost_function);
 
         problem.AddResidualBlock(
           cost_function,
-          new ceres::HuberLoss(
-            Square(pose_center_robust_fitting_error)),
-                   &map_poses.at(prior->id_view)[0]);
+          prior_loss_function,
+          map_poses.at(prior->id_view));
       }
     }
   }
 
+  // Add the consensus terms if any
+  if (b_use_consensus)
+  {
+    for (const auto & landmark_it : consensus.landmarks)
+    {
+      const auto it = sfm_data.structure.find(landmark_it.first);
+      if (it == sfm_data.structure.end() ||
+          !problem.HasParameterBlock(it->second.X.data()))
+        continue;
+      ceres::CostFunction * cost_function =
+        new ConsensusCostFunction(landmark_it.second.data(), 3, consensus.weight);
+      problem_cache_->extra_cost_functions.emplace_back(cost_function);
+      problem.AddResidualBlock(cost_function, nullptr, it->second.X.data());
+    }
+    for (const auto & intrinsic_it : consensus.intrinsics)
+    {
+      const auto it = map_intrinsics.find(intrinsic_it.first);
+      if (it == map_intrinsics.end() ||
+          it->second.parameters.size() != intrinsic_it.second.size() ||
+          !problem.HasParameterBlock(it->second.parameters.data()))
+        continue;
+      ceres::CostFunction * cost_function =
+        new ConsensusCostFunction(intrinsic_it.second.data(),
+          static_cast<int>(intrinsic_it.second.size()), consensus.weight);
+      problem_cache_->extra_cost_functions.emplace_back(cost_function);
+      problem.AddResidualBlock(cost_function, nullptr, it->second.parameters.data());
+    }
+  }
+
+  const double setup_time_ms = setup_timer.elapsedMs();
+
   // Configure a BA engine and run it
   //  Make Ceres automatically detect the bundle structure.
   ceres::Solver::Options ceres_config_options;
@@ -467,6 +944,22 @@ bool Bundle_Adjustment_Ceres::Adjust
     static_cast<ceres::PreconditionerType>(ceres_options_.preconditioner_type_);
   ceres_config_options.linear_solver_type =
     static_cast<ceres::LinearSolverType>(ceres_options_.linear_solver_type_);
+  // For large scenes, use a preconditioned conjugate gradient on the implicit
+  // Schur complement rather than a direct factorization of the reduced camera system
+  if (ceres_options_.iterative_schur_threshold_ > 0 &&
+      sfm_data.GetPoses().size() > ceres_options_.iterative_schur_threshold_)
+  {
+    ceres_config_options.linear_solver_type = ceres::ITERATIVE_SCHUR;
+    ceres_config_options.use_explicit_schur_complement = false;
+    ceres_config_options.preconditioner_type =
+      static_cast<ceres::PreconditionerType>(ceres_options_.iterative_schur_preconditioner_type_);
+    if (ceres_config_options.preconditioner_type == ceres::CLUSTER_JACOBI ||
+        ceres_config_options.preconditioner_type == ceres::CLUSTER_TRIDIAGONAL)
+    {
+      // Views are clustered from the covisibility graph (views sharing landmarks)
+      ceres_config_options.visibility_clustering_type = ceres::SINGLE_LINKAGE;
+    }
+  }
   ceres_config_options.sparse_linear_algebra_library_type =
     static_cast<ceres::SparseLinearAlgebraLibraryType>(ceres_options_.sparse_linear_algebra_library_type_);
   ceres_config_options.minimizer_progress_to_stdout = ceres_options_.bVerbose_;
@@ -486,6 +979,8 @@ bool Bundle_Adjustment_Ceres::Adjust
   {
     if (ceres_options_.bVerbose_)
       std::cout << "Bundle Adjustment failed." << std::endl;
+    if (!b_reuse_problem)
+      problem_cache_.reset();
     return false;
   }
   else // Solution is usable
@@ -500,8 +995,11 @@ bool Bundle_Adjustment_Ceres::Adjust
         << " #intrinsics: " << sfm_data.intrinsics.size() << "\n"
         << " #tracks: " << sfm_data.structure.size() << "\n"
         << " #residuals: " << summary.num_residuals << "\n"
+        << " Linear solver: " << ceres::LinearSolverTypeToString(summary.linear_solver_type_used)
+        << " (" << ceres::PreconditionerTypeToString(summary.preconditioner_type_used) << ")\n"
         << " Initial RMSE: " << std::sqrt( summary.initial_cost / summary.num_residuals) << "\n"
         << " Final RMSE: " << std::sqrt( summary.final_cost / summary.num_residuals) << "\n"
+        << " Problem setup time (ms): " << setup_time_ms << "\n"
         << " Time (s): " << summary.total_time_in_seconds << "\n"
         << std::endl;
       if (options.use_motion_priors_opt)
@@ -516,8 +1014,9 @@ bool Bundle_Adjustment_Ceres::Adjust
         const IndexT indexPose = pose_it.first;
 
         Mat3 R_refined;
-        ceres::AngleAxisToRotationMatrix(&map_poses.at(indexPose)[0], R_refined.data());
-        Vec3 t_refined(map_poses.at(indexPose)[3], map_poses.at(indexPose)[4], map_poses.at(indexPose)[5]);
+        const double * pose_block = map_poses.at(indexPose);
+        ceres::AngleAxisToRotationMatrix(pose_block, R_refined.data());
+        Vec3 t_refined(pose_block[3], pose_block[4], pose_block[5]);
         // Update the pose
         Pose3 & pose = pose_it.second;
         pose = Pose3(R_refined, -R_refined.transpose() * t_refined);
@@ -531,13 +1030,17 @@ bool Bundle_Adjustment_Ceres::Adjust
       {
         const IndexT indexCam = intrinsic_it.first;
 
-        const std::vector<double> & vec_params = map_intrinsics.at(indexCam);
+        const std::vector<double> & vec_params = map_intrinsics.at(indexCam).parameters;
         intrinsic_it.second->updateFromParams(vec_params);
       }
     }
 
     // Structure is already updated directly if needed (no data wrapping)
 
+    // Release the problem memory if it will not be updated
+    if (!b_reuse_problem)
+      problem_cache_.reset();
+
     if (b_usable_prior)
     {
       // set back to the original scene centroid
@@ -11,6 +11,10 @@
 
 #include "openMVG/numeric/eigen_alias_definition.hpp"
 #include "openMVG/sfm/sfm_data_BA.hpp"
+#include "openMVG/types.hpp"
+
+#include <memory>
+#include <vector>
 
 namespace ceres { class CostFunction; }
 namespace openMVG { namespace cameras { struct IntrinsicBase; } }
@@ -21,11 +25,14 @@ namespace sfm {
 
 /// Create the appropriate cost functor according the provided input camera intrinsic model
 /// Can be residual cost functor can be weighetd if desired (default 0.0 means no weight).
+/// The Jacobians are computed by automatic differentiation or by the hand-derived
+/// analytic formulas (b_analytic_jacobian).
 ceres::CostFunction * IntrinsicsToCostFunction
 (
   cameras::IntrinsicBase * intrinsic,
   const Vec2 & observation,
-  const double weight = 0.0
+  const double weight = 0.0,
+  const bool b_analytic_jacobian = false
 );
 
 class Bundle_Adjustment_Ceres : public Bundle_Adjustment
@@ -41,12 +48,38 @@ class Bundle_Adjustment_Ceres : public Bundle_Adjustment
     int sparse_linear_algebra_library_type_;
     double parameter_tolerance_;
     bool bUse_loss_function_;
+    bool bUse_analytic_jacobian_; // Use hand-derived Jacobians instead of AutoDiff
+    // Keep the Ceres problem alive between successive Adjust calls on the same scene.
+    // The new parameter and residual blocks are then added to it
+    // (i.e. useful for incremental reconstruction).
+    // The problem is rebuilt if some blocks have been removed from the scene.
+    bool bReuse_problem_;
+    // Switch to ITERATIVE_SCHUR once the scene has more poses than this threshold
+    // (0, the default, disables the switch). The reduced camera system is then
+    // never formed nor factorized, so the memory stays linear in the number of
+    // observations.
+    unsigned int iterative_schur_threshold_;
+    int iterative_schur_preconditioner_type_; // SCHUR_JACOBI or CLUSTER_JACOBI
 
     BA_Ceres_options(const bool bVerbose = true, bool bmultithreaded = true);
   };
+
+  /// Quadratic penalties pulling some parameters toward target values:
+  ///  weight^2 * ||x - target||^2
+  /// (i.e. used to reconcile the parameters shared by several sub-problems)
+  struct Consensus_Terms
+  {
+    double weight = 0.0;
+    Hash_Map<IndexT, Vec3> landmarks; // Target position of some landmarks
+    Hash_Map<IndexT, std::vector<double>> intrinsics; // Target intrinsic parameters
+  };
   private:
     BA_Ceres_options ceres_options_;
 
+    // Ceres problem and parameter blocks (kept between calls if bReuse_problem_)
+    struct Problem_Cache;
+    std::unique_ptr<Problem_Cache> problem_cache_;
+
   public:
   explicit Bundle_Adjustment_Ceres
   (
@@ -54,8 +87,14 @@ class Bundle_Adjustment_Ceres : public Bundle_Adjustment
     std::move(BA_Ceres_options())
   );
 
+  ~Bundle_Adjustment_Ceres() override;
+
   BA_Ceres_options & ceres_options();
 
+  /// Release the kept problem (see bReuse_problem_).
+  /// Must be called if the scene is replaced by another one between two Adjust calls.
+  void ResetProblem();
+
   bool Adjust
   (
     // the SfM scene to refine
@@ -63,6 +102,14 @@ class Bundle_Adjustment_Ceres : public Bundle_Adjustment
     // tell which parameter needs to be adjusted
     const Optimize_Options & options
   ) override;
+
+  // Bundle Adjustment with additional consensus terms
+  bool Adjust
+  (
+    sfm::SfM_Data & sfm_data,
+    const Optimize_Options & options,
+    const Consensus_Terms & consensus
+  );
 };
 
 } // namespace sfm
@@ -87,6 +87,51 @@ struct WeightedCostFunction
   const double weight_;
 };
 
+/// Cost function of one observation using a camera functor shared by all the
+/// observations of the camera: only the 2D observation is stored per residual.
+///  Data parameter blocks are the ones of the camera functor <2, N0, N1, [N2]>
+template <typename CostFunctor, int N0, int N1, int N2 = 0>
+class ObservationCostFunction : public ceres::SizedCostFunction<2, N0, N1, N2>
+{
+public:
+  ObservationCostFunction
+  (
+    const CostFunctor * functor,
+    const double * observation
+  )
+  : functor_(functor),
+    observation_{observation[0], observation[1]}
+  {
+  }
+
+  bool Evaluate
+  (
+    double const* const* parameters,
+    double* residuals,
+    double** jacobians
+  ) const override
+  {
+    // Bind a copy of the camera functor to the observation
+    CostFunctor functor(*functor_);
+    functor.m_pos_2dpoint = observation_;
+
+    if (!jacobians)
+    {
+      return ceres::internal::VariadicEvaluate<
+        CostFunctor, double, N0, N1, N2, 0, 0, 0, 0, 0, 0, 0>
+        ::Call(functor, parameters, residuals);
+    }
+    return ceres::internal::AutoDiff<CostFunctor, double, N0, N1, N2>::Differentiate(
+      functor, parameters, 2, residuals, jacobians);
+  }
+
+  double * observation() { return observation_; }
+
+private:
+  const CostFunctor * functor_; // The camera functor (not owned)
+  double observation_[2];       // The 2D observation
+};
+
 /**
  * @brief Ceres functor to use a Pinhole_Intrinsic (pinhole camera model K[R[t]) and a 3D point.
  *
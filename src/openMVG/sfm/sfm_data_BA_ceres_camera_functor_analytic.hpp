@@ -0,0 +1,528 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2015 Pierre Moulon.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_DATA_BA_CERES_CAMERA_FUNCTOR_ANALYTIC_HPP
+#define OPENMVG_SFM_SFM_DATA_BA_CERES_CAMERA_FUNCTOR_ANALYTIC_HPP
+
+#include <ceres/ceres.h>
+#include <ceres/rotation.h>
+
+#include "openMVG/cameras/Camera_Intrinsics.hpp"
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//--
+//- Define ceres CostFunction with analytic Jacobians for each OpenMVG camera model.
+//- They compute the same residuals as the AutoDiff functors of
+//-  sfm_data_BA_ceres_camera_functor.hpp, but avoid the Jet evaluation
+//-  of the 2 x (#intrinsics + 6 + 3) Jacobian.
+//--
+
+namespace openMVG {
+namespace sfm {
+namespace analytic_jacobian {
+
+using Mat2 = Eigen::Matrix<double, 2, 2>;
+
+/// Apply the pose [R(angle axis)|t] to a 3D point.
+/// Compute (if asked) the Jacobian of the camera point with respect to the angle axis.
+///  d(R(w) X)/dw = -[R(w) X]_x J_l(w), with J_l the left Jacobian of SO(3).
+inline Vec3 TransformPoint
+(
+  const double * cam_extrinsics,
+  const double * pos_3dpoint,
+  Mat3 * R_out,
+  Mat3 * dP_dw
+)
+{
+  const Eigen::Map<const Vec3> w(cam_extrinsics);
+  const Eigen::Map<const Vec3> t(cam_extrinsics + 3);
+  const Eigen::Map<const Vec3> X(pos_3dpoint);
+
+  Mat3 R;
+  ceres::AngleAxisToRotationMatrix(
+    cam_extrinsics, ceres::ColumnMajorAdapter3x3(R.data()));
+  const Vec3 RX = R * X;
+
+  if (dP_dw)
+  {
+    const double theta2 = w.squaredNorm();
+    Mat3 w_hat;
+    w_hat <<  0.0, -w(2),  w(1),
+             w(2),   0.0, -w(0),
+            -w(1),  w(0),   0.0;
+    Mat3 J_l;
+    if (theta2 > std::numeric_limits<double>::epsilon())
+    {
+      const double theta = std::sqrt(theta2);
+      J_l = Mat3::Identity()
+        + (1.0 - std::cos(theta)) / theta2 * w_hat
+        + (theta - std::sin(theta)) / (theta2 * theta) * w_hat * w_hat;
+    }
+    else
+    {
+      // Near the identity ceres uses the first order rotation R X ~= X + w x X
+      J_l = Mat3::Identity();
+    }
+    Mat3 RX_hat;
+    RX_hat <<    0.0, -RX(2),  RX(1),
+               RX(2),    0.0, -RX(0),
+              -RX(1),  RX(0),    0.0;
+    *dP_dw = - RX_hat * J_l;
+  }
+  if (R_out)
+    *R_out = R;
+  return RX + t;
+}
+
+/// Pinhole projection of a camera point to normalized image coordinates
+inline Vec2 Project
+(
+  const Vec3 & P,
+  Eigen::Matrix<double, 2, 3> * du_dP
+)
+{
+  const double inv_z = 1.0 / P(2);
+  const Vec2 u(P(0) * inv_z, P(1) * inv_z);
+  if (du_dP)
+  {
+    *du_dP << inv_z, 0.0, -u(0) * inv_z,
+              0.0, inv_z, -u(1) * inv_z;
+  }
+  return u;
+}
+
+//--
+// Distortion models: (xd,yd) = disto(x_u,y_u).
+// Each model gives the distorted point, its Jacobian with respect to the
+//  undistorted point and to the distortion coefficients.
+//--
+
+struct Distortion_None
+{
+  static const int NUM_PARAMS = 0;
+
+  static Vec2 Apply
+  (
+    const Vec2 & u,
+    const double * /*disto*/,
+    Mat2 * dd_du,
+    Eigen::Matrix<double, 2, NUM_PARAMS> * /*dd_dk*/
+  )
+  {
+    if (dd_du)
+      dd_du->setIdentity();
+    return u;
+  }
+};
+
+struct Distortion_Radial_K1
+{
+  static const int NUM_PARAMS = 1;
+
+  static Vec2 Apply
+  (
+    const Vec2 & u,
+    const double * disto,
+    Mat2 * dd_du,
+    Eigen::Matrix<double, 2, NUM_PARAMS> * dd_dk
+  )
+  {
+    const double & k1 = disto[0];
+    const double r2 = u.squaredNorm();
+    const double r_coeff = 1.0 + k1 * r2;
+    if (dd_du)
+      *dd_du = r_coeff * Mat2::Identity() + (2.0 * k1) * u * u.transpose();
+    if (dd_dk)
+      *dd_dk = u * r2;
+    return u * r_coeff;
+  }
+};
+
+struct Distortion_Radial_K3
+{
+  static const int NUM_PARAMS = 3;
+
+  static Vec2 Apply
+  (
+    const Vec2 & u,
+    const double * disto,
+    Mat2 * dd_du,
+    Eigen::Matrix<double, 2, NUM_PARAMS> * dd_dk
+  )
+  {
+    const double & k1 = disto[0], & k2 = disto[1], & k3 = disto[2];
+    const double r2 = u.squaredNorm();
+    const double r4 = r2 * r2;
+    const double r6 = r4 * r2;
+    const double r_coeff = 1.0 + k1 * r2 + k2 * r4 + k3 * r6;
+    if (dd_du)
+    {
+      const double dcoeff_dr2 = k1 + 2.0 * k2 * r2 + 3.0 * k3 * r4;
+      *dd_du = r_coeff * Mat2::Identity() + (2.0 * dcoeff_dr2) * u * u.transpose();
+    }
+    if (dd_dk)
+      *dd_dk << u * r2, u * r4, u * r6;
+    return u * r_coeff;
+  }
+};
+
+struct Distortion_Brown_T2
+{
+  static const int NUM_PARAMS = 5;
+
+  static Vec2 Apply
+  (
+    const Vec2 & u,
+    const double * disto,
+    Mat2 * dd_du,
+    Eigen::Matrix<double, 2, NUM_PARAMS> * dd_dk
+  )
+  {
+    const double & k1 = disto[0], & k2 = disto[1], & k3 = disto[2];
+    const double & t1 = disto[3], & t2 = disto[4];
+    const double x = u(0), y = u(1);
+    const double r2 = u.squaredNorm();
+    const double r4 = r2 * r2;
+    const double r6 = r4 * r2;
+    const double r_coeff = 1.0 + k1 * r2 + k2 * r4 + k3 * r6;
+    const Vec2 t_xy(
+      t2 * (r2 + 2.0 * x * x) + 2.0 * t1 * x * y,
+      t1 * (r2 + 2.0 * y * y) + 2.0 * t2 * x * y);
+    if (dd_du)
+    {
+      const double dcoeff_dr2 = k1 + 2.0 * k2 * r2 + 3.0 * k3 * r4;
+      Mat2 dt_du;
+      dt_du << 6.0 * t2 * x + 2.0 * t1 * y, 2.0 * t2 * y + 2.0 * t1 * x,
+               2.0 * t1 * x + 2.0 * t2 * y, 6.0 * t1 * y + 2.0 * t2 * x;
+      *dd_du = r_coeff * Mat2::Identity() + (2.0 * dcoeff_dr2) * u * u.transpose() + dt_du;
+    }
+    if (dd_dk)
+    {
+      *dd_dk << u * r2, u * r4, u * r6,
+                Vec2(2.0 * x * y, r2 + 2.0 * y * y),
+                Vec2(r2 + 2.0 * x * x, 2.0 * x * y);
+    }
+    return u * r_coeff + t_xy;
+  }
+};
+
+struct Distortion_Fisheye
+{
+  static const int NUM_PARAMS = 4;
+
+  static Vec2 Apply
+  (
+    const Vec2 & u,
+    const double * disto,
+    Mat2 * dd_du,
+    Eigen::Matrix<double, 2, NUM_PARAMS> * dd_dk
+  )
+  {
+    const double & k1 = disto[0], & k2 = disto[1], & k3 = disto[2], & k4 = disto[3];
+    const double r2 = u.squaredNorm();
+    const double r = std::sqrt(r2);
+    if (r <= 1e-8)
+    {
+      // Same fallback as the AutoDiff functor: cdist = 1
+      if (dd_du)
+        dd_du->setIdentity();
+      if (dd_dk)
+        dd_dk->setZero();
+      return u;
+    }
+    const double
+      theta = std::atan(r),
+      theta2 = theta * theta,
+      theta3 = theta2 * theta,
+      theta4 = theta2 * theta2,
+      theta5 = theta4 * theta,
+      theta6 = theta3 * theta3,
+      theta7 = theta6 * theta,
+      theta8 = theta4 * theta4,
+      theta9 = theta8 * theta;
+    const double theta_dist = theta + k1 * theta3 + k2 * theta5 + k3 * theta7 + k4 * theta9;
+    const double inv_r = 1.0 / r;
+    const double cdist = theta_dist * inv_r;
+    if (dd_du)
+    {
+      const double dtheta_dist_dtheta =
+        1.0 + 3.0 * k1 * theta2 + 5.0 * k2 * theta4 + 7.0 * k3 * theta6 + 9.0 * k4 * theta8;
+      const double dtheta_dr = 1.0 / (1.0 + r2);
+      const double dcdist_dr = (dtheta_dist_dtheta * dtheta_dr * r - theta_dist) * inv_r * inv_r;
+      *dd_du = cdist * Mat2::Identity() + (dcdist_dr * inv_r) * u * u.transpose();
+    }
+    if (dd_dk)
+      *dd_dk << u * (theta3 * inv_r), u * (theta5 * inv_r), u * (theta7 * inv_r), u * (theta9 * inv_r);
+    return u * cdist;
+  }
+};
+
+/**
+ * @brief Analytic Jacobian reprojection error for the Pinhole camera family.
+ *
+ *  Data parameter blocks are the following <2, 3 + #distortion, 6, 3>
+ *  - 2 => dimension of the residuals,
+ *  - 3 + #distortion => the intrinsic data block [focal, principal point x, principal point y, distortion...],
+ *  - 6 => the camera extrinsic data block (camera orientation and position) [R;t],
+ *         - rotation(angle axis), and translation [rX,rY,rZ,tx,ty,tz].
+ *  - 3 => a 3D point data block.
+ */
+template <typename Distortion>
+class ResidualErrorCost_Pinhole_Analytic :
+  public ceres::SizedCostFunction<2, 3 + Distortion::NUM_PARAMS, 6, 3>
+{
+public:
+  static const int NUM_INTRINSICS = 3 + Distortion::NUM_PARAMS;
+
+  explicit ResidualErrorCost_Pinhole_Analytic
+  (
+    const double* const pos_2dpoint,
+    const double weight = 0.0
+  )
+  : m_pos_2dpoint(pos_2dpoint),
+    m_weight(weight == 0.0 ? 1.0 : weight)
+  {
+  }
+
+  bool Evaluate
+  (
+    double const* const* parameters,
+    double* residuals,
+    double** jacobians
+  ) const override
+  {
+    return EvaluateObservation(m_pos_2dpoint, parameters, residuals, jacobians);
+  }
+
+  /// Evaluate the residual (and the Jacobians) of the given 2D observation
+  bool EvaluateObservation
+  (
+    const double * pos_2dpoint,
+    double const* const* parameters,
+    double* residuals,
+    double** jacobians
+  ) const
+  {
+    const double * cam_intrinsics = parameters[0];
+    const double * cam_extrinsics = parameters[1];
+    const double * pos_3dpoint = parameters[2];
+
+    const bool b_jacobian_intrinsics = jacobians && jacobians[0];
+    const bool b_jacobian_extrinsics = jacobians && jacobians[1];
+    const bool b_jacobian_point = jacobians && jacobians[2];
+    const bool b_jacobian_P = b_jacobian_extrinsics || b_jacobian_point;
+
+    //--
+    // Apply external parameters (Pose)
+    //--
+    Mat3 R, dP_dw;
+    const Vec3 P = TransformPoint(
+      cam_extrinsics, pos_3dpoint,
+      b_jacobian_point ? &R : nullptr,
+      b_jacobian_extrinsics ? &dP_dw : nullptr);
+
+    // Transform the point from homogeneous to euclidean (undistorted point)
+    Eigen::Matrix<double, 2, 3> du_dP;
+    const Vec2 u = Project(P, b_jacobian_P ? &du_dP : nullptr);
+
+    //--
+    // Apply intrinsic parameters
+    //--
+    const double & focal = cam_intrinsics[0];
+    Mat2 dd_du;
+    Eigen::Matrix<double, 2, Distortion::NUM_PARAMS> dd_dk;
+    const Vec2 d = Distortion::Apply(
+      u, cam_intrinsics + 3,
+      b_jacobian_P ? &dd_du : nullptr,
+      b_jacobian_intrinsics ? &dd_dk : nullptr);
+
+    // Apply focal length and principal point to get the final image coordinates
+    // and compare to the observed position
+    residuals[0] = m_weight * (cam_intrinsics[1] + focal * d(0) - pos_2dpoint[0]);
+    residuals[1] = m_weight * (cam_intrinsics[2] + focal * d(1) - pos_2dpoint[1]);
+
+    if (b_jacobian_intrinsics)
+    {
+      Eigen::Map<Eigen::Matrix<double, 2, NUM_INTRINSICS, Eigen::RowMajor>>
+        J(jacobians[0]);
+      J.col(0) = m_weight * d;
+      J.col(1) << m_weight, 0.0;
+      J.col(2) << 0.0, m_weight;
+      J.template rightCols<Distortion::NUM_PARAMS>() = (m_weight * focal) * dd_dk;
+    }
+    if (b_jacobian_P)
+    {
+      const Eigen::Matrix<double, 2, 3> dr_dP = (m_weight * focal) * dd_du * du_dP;
+      if (b_jacobian_extrinsics)
+      {
+        Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor>> J(jacobians[1]);
+        J.leftCols<3>() = dr_dP * dP_dw;
+        J.rightCols<3>() = dr_dP;
+      }
+      if (b_jacobian_point)
+      {
+        Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> J(jacobians[2]);
+        J = dr_dP * R;
+      }
+    }
+    return true;
+  }
+
+private:
+  const double * m_pos_2dpoint; // The 2D observation
+  const double m_weight;
+};
+
+using ResidualErrorCost_Pinhole_Intrinsic_Analytic =
+  ResidualErrorCost_Pinhole_Analytic<Distortion_None>;
+using ResidualErrorCost_Pinhole_Intrinsic_Radial_K1_Analytic =
+  ResidualErrorCost_Pinhole_Analytic<Distortion_Radial_K1>;
+using ResidualErrorCost_Pinhole_Intrinsic_Radial_K3_Analytic =
+  ResidualErrorCost_Pinhole_Analytic<Distortion_Radial_K3>;
+using ResidualErrorCost_Pinhole_Intrinsic_Brown_T2_Analytic =
+  ResidualErrorCost_Pinhole_Analytic<Distortion_Brown_T2>;
+using ResidualErrorCost_Pinhole_Intrinsic_Fisheye_Analytic =
+  ResidualErrorCost_Pinhole_Analytic<Distortion_Fisheye>;
+
+/**
+ * @brief Analytic Jacobian reprojection error for the Spherical camera.
+ *
+ *  Data parameter blocks are the following <2,6,3>
+ *  - 2 => dimension of the residuals,
+ *  - 6 => the camera extrinsic data block (camera orientation and position) [R;t],
+ *  - 3 => a 3D point data block.
+ */
+class ResidualErrorCost_Intrinsic_Spherical_Analytic :
+  public ceres::SizedCostFunction<2, 6, 3>
+{
+public:
+  ResidualErrorCost_Intrinsic_Spherical_Analytic
+  (
+    const double* const pos_2dpoint,
+    const size_t imageSize_w,
+    const size_t imageSize_h,
+    const double weight = 0.0
+  )
+  : m_pos_2dpoint(pos_2dpoint),
+    m_imageSize{imageSize_w, imageSize_h},
+    m_weight(weight == 0.0 ? 1.0 : weight)
+  {
+  }
+
+  bool Evaluate
+  (
+    double const* const* parameters,
+    double* residuals,
+    double** jacobians
+  ) const override
+  {
+    return EvaluateObservation(m_pos_2dpoint, parameters, residuals, jacobians);
+  }
+
+  /// Evaluate the residual (and the Jacobians) of the given 2D observation
+  bool EvaluateObservation
+  (
+    const double * pos_2dpoint,
+    double const* const* parameters,
+    double* residuals,
+    double** jacobians
+  ) const
+  {
+    const bool b_jacobian_extrinsics = jacobians && jacobians[0];
+    const bool b_jacobian_point = jacobians && jacobians[1];
+
+    Mat3 R, dP_dw;
+    const Vec3 P = TransformPoint(
+      parameters[0], parameters[1],
+      b_jacobian_point ? &R : nullptr,
+      b_jacobian_extrinsics ? &dP_dw : nullptr);
+
+    // Transform the coord in is Image space
+    const double rho2 = P(0) * P(0) + P(2) * P(2);
+    const double rho = std::sqrt(rho2);
+    const double lon = std::atan2(P(0), P(2)); // Horizontal normalization of the  X-Z component
+    const double lat = std::atan2(-P(1), rho); // Tilt angle
+
+    const double size = std::max(m_imageSize[0], m_imageSize[1]);
+    const double scale = size / (2 * M_PI);
+    residuals[0] = m_weight * (lon * scale - 0.5 + m_imageSize[0] / 2.0 - pos_2dpoint[0]);
+    residuals[1] = m_weight * (lat * scale - 0.5 + m_imageSize[1] / 2.0 - pos_2dpoint[1]);
+
+    if (b_jacobian_extrinsics || b_jacobian_point)
+    {
+      const double norm2 = rho2 + P(1) * P(1);
+      Eigen::Matrix<double, 2, 3> dr_dP;
+      dr_dP << P(2) / rho2, 0.0, -P(0) / rho2,
+               P(1) * P(0) / (rho * norm2), -rho / norm2, P(1) * P(2) / (rho * norm2);
+      dr_dP *= m_weight * scale;
+      if (b_jacobian_extrinsics)
+      {
+        Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor>> J(jacobians[0]);
+        J.leftCols<3>() = dr_dP * dP_dw;
+        J.rightCols<3>() = dr_dP;
+      }
+      if (b_jacobian_point)
+      {
+        Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> J(jacobians[1]);
+        J = dr_dP * R;
+      }
+    }
+    return true;
+  }
+
+private:
+  const double * m_pos_2dpoint;  // The 2D observation
+  size_t         m_imageSize[2]; // The image width and height
+  const double   m_weight;
+};
+
+/// Analytic cost function of one observation using a camera cost function
+/// shared by all the observations of the camera: only the 2D observation is
+/// stored per residual.
+template <typename AnalyticCostFunction>
+class ObservationCostFunction_Analytic : public ceres::CostFunction
+{
+public:
+  ObservationCostFunction_Analytic
+  (
+    const AnalyticCostFunction * cost_function,
+    const double * observation
+  )
+  : cost_function_(cost_function),
+    observation_{observation[0], observation[1]}
+  {
+    set_num_residuals(2);
+    *mutable_parameter_block_sizes() = cost_function->parameter_block_sizes();
+  }
+
+  bool Evaluate
+  (
+    double const* const* parameters,
+    double* residuals,
+    double** jacobians
+  ) const override
+  {
+    return cost_function_->EvaluateObservation(observation_, parameters, residuals, jacobians);
+  }
+
+  double * observation() { return observation_; }
+
+private:
+  const AnalyticCostFunction * cost_function_; // The camera cost function (not owned)
+  double observation_[2];                      // The 2D observation
+};
+
+} // namespace analytic_jacobian
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_DATA_BA_CERES_CAMERA_FUNCTOR_ANALYTIC_HPP
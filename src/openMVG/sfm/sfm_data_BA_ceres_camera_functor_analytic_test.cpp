@@ -0,0 +1,266 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2015 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+//-----------------
+// Test summary:
+//-----------------
+// - Evaluate the analytic Jacobian cost functions and the AutoDiff functors
+//   at random parameters (camera, pose and 3D point)
+// - Check that the residuals and all the Jacobian blocks are the same
+// --
+// - Perform the test for all the camera models (with and without weight)
+// - Check that the observation cost functions sharing a camera cost function
+//   give the same residuals and Jacobians
+//-----------------
+
+#include "openMVG/cameras/cameras.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_camera_functor.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres_camera_functor_analytic.hpp"
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::sfm;
+using namespace openMVG::sfm::analytic_jacobian;
+
+// Check that the residuals of the two cost functions are the same
+bool AreResidualsEqual
+(
+  const std::vector<double> & residuals_autodiff,
+  const std::vector<double> & residuals_analytic
+)
+{
+  for (size_t i = 0; i < residuals_autodiff.size(); ++i)
+    if (std::abs(residuals_autodiff[i] - residuals_analytic[i]) > 1e-8)
+      return false;
+  return true;
+}
+
+// Check that the Jacobian blocks are the same (relative tolerance)
+bool AreJacobiansEqual
+(
+  const std::vector<double> & J_autodiff,
+  const std::vector<double> & J_analytic
+)
+{
+  for (size_t j = 0; j < J_autodiff.size(); ++j)
+    if (std::abs(J_autodiff[j] - J_analytic[j]) > 1e-6 * std::max(1.0, std::abs(J_autodiff[j])))
+      return false;
+  return true;
+}
+
+// Evaluate the two cost functions and compare residuals and Jacobians
+bool CompareCostFunctions
+(
+  const ceres::CostFunction & autodiff_cost,
+  const ceres::CostFunction & analytic_cost,
+  const std::vector<double*> & parameters
+)
+{
+  const std::vector<int32_t> & block_sizes = autodiff_cost.parameter_block_sizes();
+  if (block_sizes != analytic_cost.parameter_block_sizes() ||
+      autodiff_cost.num_residuals() != analytic_cost.num_residuals())
+    return false;
+
+  const int num_residuals = autodiff_cost.num_residuals();
+  std::vector<double> residuals_autodiff(num_residuals), residuals_analytic(num_residuals);
+  std::vector<std::vector<double>> J_autodiff(block_sizes.size()), J_analytic(block_sizes.size());
+  std::vector<double*> jacobians_autodiff, jacobians_analytic;
+  for (size_t i = 0; i < block_sizes.size(); ++i)
+  {
+    J_autodiff[i].resize(num_residuals * block_sizes[i]);
+    J_analytic[i].resize(num_residuals * block_sizes[i]);
+    jacobians_autodiff.push_back(J_autodiff[i].data());
+    jacobians_analytic.push_back(J_analytic[i].data());
+  }
+
+  if (!autodiff_cost.Evaluate(parameters.data(), residuals_autodiff.data(), jacobians_autodiff.data()) ||
+      !analytic_cost.Evaluate(parameters.data(), residuals_analytic.data(), jacobians_analytic.data()))
+    return false;
+  if (!AreResidualsEqual(residuals_autodiff, residuals_analytic))
+    return false;
+  for (size_t i = 0; i < block_sizes.size(); ++i)
+    if (!AreJacobiansEqual(J_autodiff[i], J_analytic[i]))
+      return false;
+
+  // Residual only evaluation (no Jacobian requested)
+  std::fill(residuals_analytic.begin(), residuals_analytic.end(), 0.0);
+  if (!analytic_cost.Evaluate(parameters.data(), residuals_analytic.data(), nullptr) ||
+      !AreResidualsEqual(residuals_autodiff, residuals_analytic))
+    return false;
+
+  // Partial Jacobian evaluation (i.e. constant intrinsic or pose blocks)
+  for (size_t i = 0; i < block_sizes.size(); ++i)
+  {
+    std::vector<double*> jacobians_partial(block_sizes.size(), nullptr);
+    std::fill(J_analytic[i].begin(), J_analytic[i].end(), 0.0);
+    jacobians_partial[i] = J_analytic[i].data();
+    if (!analytic_cost.Evaluate(parameters.data(), residuals_analytic.data(), jacobians_partial.data()) ||
+        !AreJacobiansEqual(J_autodiff[i], J_analytic[i]))
+      return false;
+  }
+  return true;
+}
+
+// Random camera pose looking at the origin area and random 3D point in front of it
+struct RandomScene
+{
+  double pose[6];
+  double point[3];
+  Vec2 observation;
+
+  explicit RandomScene(std::mt19937 & random_generator, const double rotation_amplitude = 0.3)
+  {
+    std::uniform_real_distribution<double> rotation(-rotation_amplitude, rotation_amplitude);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    for (int i = 0; i < 3; ++i)
+      pose[i] = rotation(random_generator);
+    pose[3] = unit(random_generator);
+    pose[4] = unit(random_generator);
+    pose[5] = 5.0 + unit(random_generator);
+    point[0] = unit(random_generator);
+    point[1] = unit(random_generator);
+    point[2] = unit(random_generator);
+    observation << 500.0 + 100.0 * unit(random_generator), 400.0 + 100.0 * unit(random_generator);
+  }
+};
+
+template <typename AutoDiffFunctor, typename AnalyticCost>
+bool ComparePinholeModel
+(
+  std::vector<double> intrinsics,
+  const double distortion_amplitude
+)
+{
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> disto(-distortion_amplitude, distortion_amplitude);
+  for (const double weight : {0.0, 2.5})
+  {
+    for (int i = 0; i < 20; ++i)
+    {
+      // Randomize the distortion coefficients
+      for (size_t k = 3; k < intrinsics.size(); ++k)
+        intrinsics[k] = disto(random_generator);
+      // Test also the identity rotation (special case of the angle axis Jacobian)
+      RandomScene scene(random_generator, i == 0 ? 0.0 : 0.3);
+
+      std::unique_ptr<ceres::CostFunction> autodiff_cost(
+        AutoDiffFunctor::Create(scene.observation, weight));
+      const AnalyticCost analytic_cost(scene.observation.data(), weight);
+      if (!CompareCostFunctions(*autodiff_cost, analytic_cost,
+            {intrinsics.data(), scene.pose, scene.point}))
+        return false;
+      if (weight != 0.0)
+        continue;
+      // Observation cost functions sharing the camera cost (not weighted)
+      const AutoDiffFunctor camera_functor(nullptr);
+      const ObservationCostFunction<AutoDiffFunctor, AnalyticCost::NUM_INTRINSICS, 6, 3>
+        autodiff_observation_cost(&camera_functor, scene.observation.data());
+      const AnalyticCost camera_cost(nullptr);
+      const ObservationCostFunction_Analytic<AnalyticCost>
+        analytic_observation_cost(&camera_cost, scene.observation.data());
+      if (!CompareCostFunctions(*autodiff_cost, autodiff_observation_cost,
+            {intrinsics.data(), scene.pose, scene.point}) ||
+          !CompareCostFunctions(*autodiff_cost, analytic_observation_cost,
+            {intrinsics.data(), scene.pose, scene.point}))
+        return false;
+    }
+  }
+  return true;
+}
+
+TEST(BUNDLE_ADJUSTMENT_ANALYTIC, Pinhole)
+{
+  const bool b_same_cost = ComparePinholeModel<
+    ResidualErrorFunctor_Pinhole_Intrinsic,
+    ResidualErrorCost_Pinhole_Intrinsic_Analytic>
+    ({1000.0, 500.0, 500.0}, 0.0);
+  EXPECT_TRUE(b_same_cost);
+}
+
+TEST(BUNDLE_ADJUSTMENT_ANALYTIC, Pinhole_Radial_K1)
+{
+  const bool b_same_cost = ComparePinholeModel<
+    ResidualErrorFunctor_Pinhole_Intrinsic_Radial_K1,
+    ResidualErrorCost_Pinhole_Intrinsic_Radial_K1_Analytic>
+    ({1000.0, 500.0, 500.0, 0.0}, 0.2);
+  EXPECT_TRUE(b_same_cost);
+}
+
+TEST(BUNDLE_ADJUSTMENT_ANALYTIC, Pinhole_Radial_K3)
+{
+  const bool b_same_cost = ComparePinholeModel<
+    ResidualErrorFunctor_Pinhole_Intrinsic_Radial_K3,
+    ResidualErrorCost_Pinhole_Intrinsic_Radial_K3_Analytic>
+    ({1000.0, 500.0, 500.0, 0.0, 0.0, 0.0}, 0.2);
+  EXPECT_TRUE(b_same_cost);
+}
+
+TEST(BUNDLE_ADJUSTMENT_ANALYTIC, Pinhole_Brown_T2)
+{
+  const bool b_same_cost = ComparePinholeModel<
+    ResidualErrorFunctor_Pinhole_Intrinsic_Brown_T2,
+    ResidualErrorCost_Pinhole_Intrinsic_Brown_T2_Analytic>
+    ({1000.0, 500.0, 500.0, 0.0, 0.0, 0.0, 0.0, 0.0}, 0.05);
+  EXPECT_TRUE(b_same_cost);
+}
+
+TEST(BUNDLE_ADJUSTMENT_ANALYTIC, Pinhole_Fisheye)
+{
+  const bool b_same_cost = ComparePinholeModel<
+    ResidualErrorFunctor_Pinhole_Intrinsic_Fisheye,
+    ResidualErrorCost_Pinhole_Intrinsic_Fisheye_Analytic>
+    ({1000.0, 500.0, 500.0, 0.0, 0.0, 0.0, 0.0}, 0.05);
+  EXPECT_TRUE(b_same_cost);
+}
+
+TEST(BUNDLE_ADJUSTMENT_ANALYTIC, Spherical)
+{
+  const Intrinsic_Spherical intrinsic(2048, 1024);
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  for (const double weight : {0.0, 2.5})
+  {
+    for (int i = 0; i < 20; ++i)
+    {
+      // Use large rotations to sample the whole sphere
+      RandomScene scene(random_generator, i == 0 ? 0.0 : 3.0);
+
+      std::unique_ptr<ceres::CostFunction> autodiff_cost(
+        ResidualErrorFunctor_Intrinsic_Spherical::Create(&intrinsic, scene.observation, weight));
+      const ResidualErrorCost_Intrinsic_Spherical_Analytic analytic_cost(
+        scene.observation.data(), intrinsic.w(), intrinsic.h(), weight);
+      EXPECT_TRUE(CompareCostFunctions(*autodiff_cost, analytic_cost, {scene.pose, scene.point}));
+      if (weight != 0.0)
+        continue;
+      // Observation cost functions sharing the camera cost (not weighted)
+      const ResidualErrorFunctor_Intrinsic_Spherical camera_functor(
+        nullptr, intrinsic.w(), intrinsic.h());
+      const ObservationCostFunction<ResidualErrorFunctor_Intrinsic_Spherical, 6, 3>
+        autodiff_observation_cost(&camera_functor, scene.observation.data());
+      const ResidualErrorCost_Intrinsic_Spherical_Analytic camera_cost(
+        nullptr, intrinsic.w(), intrinsic.h());
+      const ObservationCostFunction_Analytic<ResidualErrorCost_Intrinsic_Spherical_Analytic>
+        analytic_observation_cost(&camera_cost, scene.observation.data());
+      EXPECT_TRUE(CompareCostFunctions(*autodiff_cost, autodiff_observation_cost,
+        {scene.pose, scene.point}));
+      EXPECT_TRUE(CompareCostFunctions(*autodiff_cost, analytic_observation_cost,
+        {scene.pose, scene.point}));
+    }
+  }
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -0,0 +1,578 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre Moulon.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/sfm_data_BA_partitioned.hpp"
+
+#include "openMVG/cameras/Camera_Intrinsics.hpp"
+#include "openMVG/numeric/numeric.h"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_io.hpp"
+#include "openMVG/system/timer.hpp"
+
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+namespace openMVG {
+namespace sfm {
+
+using namespace openMVG::cameras;
+
+std::vector<std::set<IndexT>> PartitionPoses
+(
+  const SfM_Data & sfm_data,
+  const unsigned int max_poses_per_submap
+)
+{
+  // Build the pose covisibility graph (edge weight: #shared landmarks)
+  Hash_Map<IndexT, std::map<IndexT, unsigned int>> covisibility;
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+  {
+    std::set<IndexT> pose_ids;
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      const View * view = sfm_data.GetViews().at(obs_it.first).get();
+      if (sfm_data.IsPoseAndIntrinsicDefined(view))
+        pose_ids.insert(view->id_pose);
+    }
+    for (auto it_a = pose_ids.cbegin(); it_a != pose_ids.cend(); ++it_a)
+      for (auto it_b = std::next(it_a); it_b != pose_ids.cend(); ++it_b)
+      {
+        ++covisibility[*it_a][*it_b];
+        ++covisibility[*it_b][*it_a];
+      }
+  }
+
+  // Greedy region growing from the first unassigned pose:
+  //  the frontier pose with the strongest connection to the submap is added first
+  std::set<IndexT> unassigned;
+  for (const auto & pose_it : sfm_data.GetPoses())
+    unassigned.insert(pose_it.first);
+
+  std::vector<std::set<IndexT>> submaps;
+  while (!unassigned.empty())
+  {
+    std::set<IndexT> submap;
+    Hash_Map<IndexT, unsigned int> frontier_weight;
+    std::set<std::pair<unsigned int, IndexT>> frontier; // sorted by connection strength
+    IndexT next_pose = *unassigned.cbegin();
+    while (true)
+    {
+      submap.insert(next_pose);
+      unassigned.erase(next_pose);
+      if (submap.size() >= max_poses_per_submap)
+        break;
+      // Update the connection strength of the neighbors
+      const auto neighbors_it = covisibility.find(next_pose);
+      if (neighbors_it != covisibility.end())
+      {
+        for (const auto & neighbor : neighbors_it->second)
+        {
+          if (unassigned.count(neighbor.first) == 0)
+            continue;
+          unsigned int & weight = frontier_weight[neighbor.first];
+          frontier.erase({weight, neighbor.first});
+          weight += neighbor.second;
+          frontier.insert({weight, neighbor.first});
+        }
+      }
+      if (frontier.empty())
+        break;
+      next_pose = frontier.crbegin()->second;
+      frontier.erase(std::prev(frontier.end()));
+    }
+    submaps.push_back(std::move(submap));
+  }
+  return submaps;
+}
+
+namespace {
+
+/// A part of the scene refined independently.
+/// The separator estimates and duals are kept in memory,
+/// the scene itself can be stored on disk.
+struct Submap
+{
+  std::set<IndexT> pose_ids;
+  std::unique_ptr<SfM_Data> scene; // nullptr if stored on disk
+  std::string filename;
+
+  // Estimates and (scaled) dual variables of the separators
+  Hash_Map<IndexT, Vec3> landmark_estimates, landmark_duals;
+  Hash_Map<IndexT, std::vector<double>> intrinsic_estimates, intrinsic_duals;
+};
+
+/// Extract the part of the scene observed by the given poses
+/// (landmarks with a single observation are kept only if they are separators)
+std::unique_ptr<SfM_Data> ExtractSubmap
+(
+  const SfM_Data & sfm_data,
+  const std::set<IndexT> & pose_ids,
+  const Hash_Map<IndexT, unsigned int> & landmark_submap_count,
+  const bool b_use_control_points
+)
+{
+  std::unique_ptr<SfM_Data> submap(new SfM_Data);
+  for (const auto & view_it : sfm_data.GetViews())
+  {
+    const View * view = view_it.second.get();
+    if (!sfm_data.IsPoseAndIntrinsicDefined(view) || pose_ids.count(view->id_pose) == 0)
+      continue;
+    submap->views.insert(view_it);
+    submap->poses[view->id_pose] = sfm_data.GetPoses().at(view->id_pose);
+    // The intrinsics are cloned since their parameters are refined per submap
+    if (submap->intrinsics.count(view->id_intrinsic) == 0)
+    {
+      submap->intrinsics[view->id_intrinsic] = std::shared_ptr<IntrinsicBase>(
+        sfm_data.GetIntrinsics().at(view->id_intrinsic)->clone());
+    }
+  }
+
+  const auto restrict_observations = [&](const Landmark & landmark)
+  {
+    Landmark restricted;
+    restricted.X = landmark.X;
+    for (const auto & obs_it : landmark.obs)
+    {
+      if (submap->views.count(obs_it.first) != 0)
+        restricted.obs.insert(obs_it);
+    }
+    return restricted;
+  };
+
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+  {
+    const auto count_it = landmark_submap_count.find(landmark_it.first);
+    if (count_it == landmark_submap_count.end())
+      continue;
+    Landmark landmark = restrict_observations(landmark_it.second);
+    if (landmark.obs.size() > 1 || (!landmark.obs.empty() && count_it->second > 1))
+      submap->structure[landmark_it.first] = std::move(landmark);
+  }
+  if (b_use_control_points)
+  {
+    for (const auto & control_point_it : sfm_data.control_points)
+    {
+      Landmark control_point = restrict_observations(control_point_it.second);
+      if (!control_point.obs.empty())
+        submap->control_points[control_point_it.first] = std::move(control_point);
+    }
+  }
+  return submap;
+}
+
+} // namespace
+
+Bundle_Adjustment_Partitioned::Partitioned_BA_options::Partitioned_BA_options
+(
+  const bool bVerbose,
+  bool bmultithreaded
+)
+: bVerbose_(bVerbose),
+  bMultithreaded_(bmultithreaded),
+  max_poses_per_submap_(1000),
+  max_iterations_(10),
+  consensus_weight_(100.0),
+  consensus_tolerance_(1e-4),
+  // The submaps are refined in parallel, each one by a single thread
+  ba_options_(false, false)
+{
+}
+
+Bundle_Adjustment_Partitioned::Bundle_Adjustment_Partitioned
+(
+  const Partitioned_BA_options & options
+)
+: options_(options)
+{
+}
+
+Bundle_Adjustment_Partitioned::Partitioned_BA_options &
+Bundle_Adjustment_Partitioned::partitioned_options()
+{
+  return options_;
+}
+
+bool Bundle_Adjustment_Partitioned::Adjust
+(
+  SfM_Data & sfm_data,     // the SfM scene to refine
+  const Optimize_Options & options
+)
+{
+  openMVG::system::Timer timer;
+
+  const std::vector<std::set<IndexT>> partition =
+    PartitionPoses(sfm_data, std::max(1u, options_.max_poses_per_submap_));
+
+  // Small scene: a single bundle adjustment
+  if (partition.size() < 2)
+  {
+    Bundle_Adjustment_Ceres bundle_adjustment_obj(options_.ba_options_);
+    return bundle_adjustment_obj.Adjust(sfm_data, options);
+  }
+
+  // The motion prior registration is computed on the whole scene, it cannot be
+  // applied independently to each submap
+  Optimize_Options submap_options = options;
+  if (submap_options.use_motion_priors_opt)
+  {
+    std::cerr << "Partitioned bundle adjustment: the motion priors are not used." << std::endl;
+    submap_options.use_motion_priors_opt = false;
+  }
+
+  const bool b_stream_submaps = !options_.sTemp_directory_.empty();
+  const bool b_create_directory = b_stream_submaps &&
+    !stlplus::folder_exists(options_.sTemp_directory_);
+  if (b_create_directory && !stlplus::folder_create(options_.sTemp_directory_))
+  {
+    std::cerr << "Partitioned bundle adjustment: cannot create the directory "
+      << options_.sTemp_directory_ << std::endl;
+    return false;
+  }
+
+  //--
+  // Find the separators: the landmarks and intrinsics used by several submaps
+  //--
+  Hash_Map<IndexT, IndexT> pose_to_submap;
+  for (IndexT i = 0; i < partition.size(); ++i)
+    for (const IndexT pose_id : partition[i])
+      pose_to_submap[pose_id] = i;
+
+  const auto submap_of_view = [&](const IndexT view_id) -> IndexT
+  {
+    const View * view = sfm_data.GetViews().at(view_id).get();
+    if (!sfm_data.IsPoseAndIntrinsicDefined(view))
+      return UndefinedIndexT;
+    return pose_to_submap.at(view->id_pose);
+  };
+
+  Hash_Map<IndexT, unsigned int> landmark_submap_count;
+  Hash_Map<IndexT, std::vector<IndexT>> separator_landmarks, separator_intrinsics;
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+  {
+    std::set<IndexT> submap_ids;
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      const IndexT submap_id = submap_of_view(obs_it.first);
+      if (submap_id != UndefinedIndexT)
+        submap_ids.insert(submap_id);
+    }
+    if (submap_ids.empty())
+      continue;
+    landmark_submap_count[landmark_it.first] = submap_ids.size();
+    if (submap_ids.size() > 1)
+      separator_landmarks[landmark_it.first].assign(submap_ids.cbegin(), submap_ids.cend());
+  }
+  {
+    Hash_Map<IndexT, std::set<IndexT>> intrinsic_submaps;
+    for (const auto & view_it : sfm_data.GetViews())
+    {
+      const IndexT submap_id = submap_of_view(view_it.first);
+      if (submap_id != UndefinedIndexT)
+        intrinsic_submaps[view_it.second->id_intrinsic].insert(submap_id);
+    }
+    for (const auto & intrinsic_it : intrinsic_submaps)
+      if (intrinsic_it.second.size() > 1)
+        separator_intrinsics[intrinsic_it.first].assign(
+          intrinsic_it.second.cbegin(), intrinsic_it.second.cend());
+  }
+
+  //--
+  // Build the submaps (initialize the separators estimates and duals)
+  //--
+  std::vector<Submap> submaps(partition.size());
+  Hash_Map<IndexT, Vec3> landmark_consensus;
+  Hash_Map<IndexT, std::vector<double>> intrinsic_consensus;
+  for (const auto & separator_it : separator_landmarks)
+  {
+    const Vec3 & X = sfm_data.structure.at(separator_it.first).X;
+    landmark_consensus[separator_it.first] = X;
+    for (const IndexT submap_id : separator_it.second)
+    {
+      submaps[submap_id].landmark_estimates[separator_it.first] = X;
+      submaps[submap_id].landmark_duals[separator_it.first] = Vec3::Zero();
+    }
+  }
+  for (const auto & separator_it : separator_intrinsics)
+  {
+    const std::vector<double> params =
+      sfm_data.intrinsics.at(separator_it.first)->getParams();
+    intrinsic_consensus[separator_it.first] = params;
+    for (const IndexT submap_id : separator_it.second)
+    {
+      submaps[submap_id].intrinsic_estimates[separator_it.first] = params;
+      submaps[submap_id].intrinsic_duals[separator_it.first] =
+        std::vector<double>(params.size(), 0.0);
+    }
+  }
+
+  bool b_success = true;
+  for (IndexT i = 0; i < partition.size() && b_success; ++i)
+  {
+    Submap & submap = submaps[i];
+    submap.pose_ids = partition[i];
+    submap.scene = ExtractSubmap(sfm_data, submap.pose_ids, landmark_submap_count,
+      options.control_point_opt.bUse_control_points);
+    if (b_stream_submaps)
+    {
+      std::ostringstream os;
+      os << "submap_" << i;
+      submap.filename = stlplus::create_filespec(options_.sTemp_directory_, os.str(), "bin");
+      b_success = Save(*submap.scene, submap.filename, ESfM_Data(ALL));
+      submap.scene.reset();
+      if (!b_success)
+        std::cerr << "Partitioned bundle adjustment: cannot write the submap "
+          << submap.filename << std::endl;
+    }
+  }
+
+  if (options_.bVerbose_)
+  {
+    std::cout << "\nPartitioned Bundle Adjustment:\n"
+      << " #submaps: " << submaps.size() << "\n"
+      << " #separator landmarks: " << separator_landmarks.size() << "\n"
+      << " #separator intrinsics: " << separator_intrinsics.size() << std::endl;
+  }
+
+  //--
+  // Consensus ADMM iterations
+  //--
+  double consensus_weight = options_.consensus_weight_;
+  for (unsigned int iteration = 0;
+       iteration < options_.max_iterations_ && b_success; ++iteration)
+  {
+    // Refine each submap, pulled toward the current consensus (z - u)
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic) if (options_.bMultithreaded_)
+#endif
+    for (int i = 0; i < static_cast<int>(submaps.size()); ++i)
+    {
+      Submap & submap = submaps[i];
+      std::unique_ptr<SfM_Data> streamed_scene;
+      SfM_Data * scene = submap.scene.get();
+      if (b_stream_submaps)
+      {
+        streamed_scene.reset(new SfM_Data);
+        if (!Load(*streamed_scene, submap.filename, ESfM_Data(ALL)))
+        {
+#ifdef OPENMVG_USE_OPENMP
+          #pragma omp critical
+#endif
+          {
+            std::cerr << "Partitioned bundle adjustment: cannot read the submap "
+              << submap.filename << std::endl;
+            b_success = false;
+          }
+          continue;
+        }
+        scene = streamed_scene.get();
+      }
+
+      Bundle_Adjustment_Ceres::Consensus_Terms consensus;
+      consensus.weight = consensus_weight;
+      for (const auto & dual_it : submap.landmark_duals)
+      {
+        consensus.landmarks[dual_it.first] =
+          landmark_consensus.at(dual_it.first) - dual_it.second;
+      }
+      for (const auto & dual_it : submap.intrinsic_duals)
+      {
+        std::vector<double> target = intrinsic_consensus.at(dual_it.first);
+        for (size_t k = 0; k < target.size(); ++k)
+          target[k] -= dual_it.second[k];
+        consensus.intrinsics[dual_it.first] = std::move(target);
+      }
+
+      Bundle_Adjustment_Ceres bundle_adjustment_obj(options_.ba_options_);
+      if (!bundle_adjustment_obj.Adjust(*scene, submap_options, consensus))
+      {
+#ifdef OPENMVG_USE_OPENMP
+        #pragma omp critical
+#endif
+        {
+          std::cerr << "Partitioned bundle adjustment: the refinement of the submap "
+            << i << " failed." << std::endl;
+          b_success = false;
+        }
+        continue;
+      }
+
+      for (auto & estimate_it : submap.landmark_estimates)
+        estimate_it.second = scene->structure.at(estimate_it.first).X;
+      for (auto & estimate_it : submap.intrinsic_estimates)
+        estimate_it.second = scene->intrinsics.at(estimate_it.first)->getParams();
+
+      if (b_stream_submaps && !Save(*scene, submap.filename, ESfM_Data(ALL)))
+      {
+#ifdef OPENMVG_USE_OPENMP
+        #pragma omp critical
+#endif
+        {
+          std::cerr << "Partitioned bundle adjustment: cannot write the submap "
+            << submap.filename << std::endl;
+          b_success = false;
+        }
+      }
+    }
+    if (!b_success)
+      break;
+
+    // Consensus update: z = mean(x + u), then u += x - z
+    double primal_residual = 0.0, dual_residual = 0.0;
+    size_t nb_estimates = 0;
+    for (auto & consensus_it : landmark_consensus)
+    {
+      const std::vector<IndexT> & submap_ids = separator_landmarks.at(consensus_it.first);
+      Vec3 z = Vec3::Zero();
+      for (const IndexT submap_id : submap_ids)
+      {
+        z += submaps[submap_id].landmark_estimates.at(consensus_it.first)
+          + submaps[submap_id].landmark_duals.at(consensus_it.first);
+      }
+      z /= submap_ids.size();
+      for (const IndexT submap_id : submap_ids)
+      {
+        const Vec3 disagreement =
+          submaps[submap_id].landmark_estimates.at(consensus_it.first) - z;
+        submaps[submap_id].landmark_duals.at(consensus_it.first) += disagreement;
+        primal_residual += disagreement.squaredNorm();
+        dual_residual += (z - consensus_it.second).squaredNorm();
+        ++nb_estimates;
+      }
+      consensus_it.second = z;
+    }
+    for (auto & consensus_it : intrinsic_consensus)
+    {
+      const std::vector<IndexT> & submap_ids = separator_intrinsics.at(consensus_it.first);
+      std::vector<double> z(consensus_it.second.size(), 0.0);
+      for (const IndexT submap_id : submap_ids)
+      {
+        const std::vector<double> & x =
+          submaps[submap_id].intrinsic_estimates.at(consensus_it.first);
+        const std::vector<double> & u =
+          submaps[submap_id].intrinsic_duals.at(consensus_it.first);
+        for (size_t k = 0; k < z.size(); ++k)
+          z[k] += (x[k] + u[k]) / submap_ids.size();
+      }
+      for (const IndexT submap_id : submap_ids)
+      {
+        const std::vector<double> & x =
+          submaps[submap_id].intrinsic_estimates.at(consensus_it.first);
+        std::vector<double> & u =
+          submaps[submap_id].intrinsic_duals.at(consensus_it.first);
+        for (size_t k = 0; k < z.size(); ++k)
+        {
+          u[k] += x[k] - z[k];
+          primal_residual += Square(x[k] - z[k]);
+          dual_residual += Square(z[k] - consensus_it.second[k]);
+        }
+        ++nb_estimates;
+      }
+      consensus_it.second = std::move(z);
+    }
+    primal_residual = std::sqrt(primal_residual / std::max<size_t>(1, nb_estimates));
+    dual_residual = std::sqrt(dual_residual / std::max<size_t>(1, nb_estimates));
+
+    if (options_.bVerbose_)
+    {
+      std::cout << " Iteration " << iteration
+        << ": separators RMS disagreement: " << primal_residual
+        << ", consensus RMS change: " << dual_residual
+        << ", consensus weight: " << consensus_weight << std::endl;
+    }
+    if (primal_residual < options_.consensus_tolerance_ &&
+        dual_residual < options_.consensus_tolerance_)
+      break;
+
+    // Residual balancing: the penalty (weight^2) is doubled or halved
+    // and the scaled dual variables are rescaled accordingly
+    double dual_scale = 1.0;
+    if (primal_residual > 10.0 * dual_residual)
+    {
+      consensus_weight *= std::sqrt(2.0);
+      dual_scale = 0.5;
+    }
+    else if (dual_residual > 10.0 * primal_residual)
+    {
+      consensus_weight /= std::sqrt(2.0);
+      dual_scale = 2.0;
+    }
+    if (dual_scale != 1.0)
+    {
+      for (Submap & submap : submaps)
+      {
+        for (auto & dual_it : submap.landmark_duals)
+          dual_it.second *= dual_scale;
+        for (auto & dual_it : submap.intrinsic_duals)
+          for (double & u : dual_it.second)
+            u *= dual_scale;
+      }
+    }
+  }
+
+  //--
+  // Gather the refined parameters:
+  // - the separators get the consensus value,
+  // - the other parameters come from their unique submap.
+  // The scene is only updated once all the submaps have been read.
+  //--
+  Poses refined_poses;
+  Hash_Map<IndexT, Vec3> refined_landmarks = std::move(landmark_consensus);
+  Hash_Map<IndexT, std::vector<double>> refined_intrinsics = std::move(intrinsic_consensus);
+  for (Submap & submap : submaps)
+  {
+    if (b_success && b_stream_submaps)
+    {
+      submap.scene.reset(new SfM_Data);
+      b_success = Load(*submap.scene, submap.filename, ESfM_Data(ALL));
+      if (!b_success)
+        std::cerr << "Partitioned bundle adjustment: cannot read the submap "
+          << submap.filename << std::endl;
+    }
+    if (b_success)
+    {
+      const SfM_Data & scene = *submap.scene;
+      for (const auto & pose_it : scene.poses)
+        refined_poses[pose_it.first] = pose_it.second;
+      for (const auto & landmark_it : scene.structure)
+        if (separator_landmarks.count(landmark_it.first) == 0)
+          refined_landmarks[landmark_it.first] = landmark_it.second.X;
+      for (const auto & intrinsic_it : scene.intrinsics)
+        if (separator_intrinsics.count(intrinsic_it.first) == 0)
+          refined_intrinsics[intrinsic_it.first] = intrinsic_it.second->getParams();
+    }
+    submap.scene.reset();
+    if (b_stream_submaps && stlplus::file_exists(submap.filename))
+      stlplus::file_delete(submap.filename);
+  }
+  if (b_create_directory)
+    stlplus::folder_delete(options_.sTemp_directory_);
+  if (!b_success)
+    return false;
+
+  for (const auto & pose_it : refined_poses)
+    sfm_data.poses[pose_it.first] = pose_it.second;
+  for (const auto & landmark_it : refined_landmarks)
+    sfm_data.structure[landmark_it.first].X = landmark_it.second;
+  for (const auto & intrinsic_it : refined_intrinsics)
+    sfm_data.intrinsics[intrinsic_it.first]->updateFromParams(intrinsic_it.second);
+
+  if (options_.bVerbose_)
+    std::cout << " Time (s): " << timer.elapsed() << "\n" << std::endl;
+  return true;
+}
+
+} // namespace sfm
+} // namespace openMVG
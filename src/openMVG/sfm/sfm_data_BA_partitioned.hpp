@@ -0,0 +1,87 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre Moulon.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_DATA_BA_PARTITIONED_HPP
+#define OPENMVG_SFM_SFM_DATA_BA_PARTITIONED_HPP
+
+#include "openMVG/sfm/sfm_data_BA.hpp"
+#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
+#include "openMVG/types.hpp"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace openMVG { namespace sfm { struct SfM_Data; } }
+
+namespace openMVG {
+namespace sfm {
+
+/// Split the scene poses into connected submaps of at most max_poses_per_submap poses.
+/// The submaps are grown greedily on the pose covisibility graph
+/// (the poses sharing the most landmarks with the submap are added first).
+std::vector<std::set<IndexT>> PartitionPoses
+(
+  const SfM_Data & sfm_data,
+  const unsigned int max_poses_per_submap
+);
+
+/// Bundle Adjustment of a large scene by submaps:
+/// - the poses are split into submaps (see PartitionPoses),
+/// - the submaps are refined independently (and in parallel),
+/// - the landmarks and intrinsics shared by several submaps (separators) are
+///   reconciled by a consensus ADMM: each submap is pulled toward the consensus
+///   value, the consensus is the average of the submap estimates, and the dual
+///   variables accumulate the remaining disagreement.
+/// The submaps that are not being processed can be stored on disk.
+/// Library only: the SfM pipelines and command lines do not use it.
+class Bundle_Adjustment_Partitioned : public Bundle_Adjustment
+{
+  public:
+  struct Partitioned_BA_options
+  {
+    bool bVerbose_;
+    bool bMultithreaded_; // Refine the submaps in parallel
+    unsigned int max_poses_per_submap_;
+    unsigned int max_iterations_; // Maximal number of consensus iterations
+    double consensus_weight_; // Initial weight of the consensus terms
+    double consensus_tolerance_; // Stop once the separators RMS disagreement is below
+    // If not empty, the submaps are written in this directory and
+    // loaded only while they are refined.
+    // Only the submap copies are streamed: the input scene stays in memory.
+    // The directory is removed at the end if it has been created by Adjust.
+    std::string sTemp_directory_;
+    // Options of the submaps bundle adjustment
+    Bundle_Adjustment_Ceres::BA_Ceres_options ba_options_;
+
+    Partitioned_BA_options(const bool bVerbose = true, bool bmultithreaded = true);
+  };
+  private:
+    Partitioned_BA_options options_;
+
+  public:
+  explicit Bundle_Adjustment_Partitioned
+  (
+    const Partitioned_BA_options & options = Partitioned_BA_options()
+  );
+
+  Partitioned_BA_options & partitioned_options();
+
+  bool Adjust
+  (
+    // the SfM scene to refine
+    sfm::SfM_Data & sfm_data,
+    // tell which parameter needs to be adjusted
+    const Optimize_Options & options
+  ) override;
+};
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_DATA_BA_PARTITIONED_HPP
@@ -22,8 +22,11 @@
 
 #include "testing/testing.h"
 
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <random>
 
@@ -184,6 +187,217 @@ TEST(BUNDLE_ADJUSTMENT, EffectiveMinimization_Pinhole_Intrinsic_Fisheye) {
   EXPECT_TRUE( dResidual_before > dResidual_after);
 }
 
+TEST(BUNDLE_ADJUSTMENT, EffectiveMinimization_AnalyticJacobian) {
+
+  const int nviews = 3;
+  const int npoints = 6;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Check that the analytic Jacobian cost functions minimize the error
+  // for all the Pinhole camera models
+  for (const EINTRINSIC intrinsic_type :
+    {PINHOLE_CAMERA, PINHOLE_CAMERA_RADIAL1, PINHOLE_CAMERA_RADIAL3,
+     PINHOLE_CAMERA_BROWN, PINHOLE_CAMERA_FISHEYE})
+  {
+    // Translate the input dataset to a SfM_Data scene
+    SfM_Data sfm_data = getInputScene(d, config, intrinsic_type);
+
+    const double dResidual_before = RMSE(sfm_data);
+
+    const bool bVerbose = true;
+    const bool bMultithread = false;
+    Bundle_Adjustment_Ceres::BA_Ceres_options options(bVerbose, bMultithread);
+    options.bUse_analytic_jacobian_ = true;
+    std::shared_ptr<Bundle_Adjustment> ba_object =
+      std::make_shared<Bundle_Adjustment_Ceres>(options);
+    EXPECT_TRUE( ba_object->Adjust(sfm_data,
+      Optimize_Options(
+        Intrinsic_Parameter_Type::ADJUST_ALL,
+        Extrinsic_Parameter_Type::ADJUST_ALL,
+        Structure_Parameter_Type::ADJUST_ALL)) );
+
+    const double dResidual_after = RMSE(sfm_data);
+    EXPECT_TRUE( dResidual_before > dResidual_after);
+  }
+}
+
+TEST(BUNDLE_ADJUSTMENT, EffectiveMinimization_IterativeSchur) {
+
+  const int nviews = 6;
+  const int npoints = 32;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA_RADIAL3);
+
+  const double dResidual_before = RMSE(sfm_data);
+
+  // Force the large scene mode (ITERATIVE_SCHUR) for this small scene
+  Bundle_Adjustment_Ceres::BA_Ceres_options options;
+  options.iterative_schur_threshold_ = 1;
+  std::shared_ptr<Bundle_Adjustment> ba_object =
+    std::make_shared<Bundle_Adjustment_Ceres>(options);
+  EXPECT_TRUE( ba_object->Adjust(sfm_data,
+    Optimize_Options(
+      Intrinsic_Parameter_Type::ADJUST_ALL,
+      Extrinsic_Parameter_Type::ADJUST_ALL,
+      Structure_Parameter_Type::ADJUST_ALL)) );
+
+  const double dResidual_after = RMSE(sfm_data);
+  EXPECT_TRUE( dResidual_before > dResidual_after);
+  EXPECT_TRUE( dResidual_after < 0.5);
+}
+
+TEST(BUNDLE_ADJUSTMENT, EffectiveMinimization_ReuseProblem) {
+
+  const int nviews = 6;
+  const int npoints = 32;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  const SfM_Data full_scene = getInputScene(d, config, PINHOLE_CAMERA_RADIAL3);
+
+  const bool bVerbose = true;
+  const bool bMultithread = false;
+  Bundle_Adjustment_Ceres::BA_Ceres_options options(bVerbose, bMultithread);
+  options.bReuse_problem_ = true;
+  Bundle_Adjustment_Ceres ba_object(options);
+  const Optimize_Options ba_refine_options(
+    Intrinsic_Parameter_Type::ADJUST_ALL,
+    Extrinsic_Parameter_Type::ADJUST_ALL,
+    Structure_Parameter_Type::ADJUST_ALL);
+
+  // Simulate an incremental reconstruction:
+  // 1. Adjust the whole scene
+  SfM_Data sfm_data = full_scene;
+  const double dResidual_before = RMSE(sfm_data);
+  EXPECT_TRUE( ba_object.Adjust(sfm_data, ba_refine_options) );
+  EXPECT_TRUE( dResidual_before > RMSE(sfm_data) );
+
+  // 2. Remove a pose (and its observations), a landmark and some observations
+  const IndexT removed_pose = nviews - 1;
+  sfm_data.poses.erase(removed_pose);
+  for (auto & landmark_it : sfm_data.structure)
+    landmark_it.second.obs.erase(removed_pose);
+  sfm_data.structure.erase(0);
+  sfm_data.structure.at(1).obs.erase(0);
+  sfm_data.structure.at(2).obs.erase(1);
+  EXPECT_TRUE( ba_object.Adjust(sfm_data, ba_refine_options) );
+
+  // 3. Add back the pose and the observations, add a new landmark
+  //    (use a new node for an existing observation and edit another one in place)
+  sfm_data.poses[removed_pose] = full_scene.poses.at(removed_pose);
+  for (auto & landmark_it : sfm_data.structure)
+    landmark_it.second.obs[removed_pose] =
+      full_scene.structure.at(landmark_it.first).obs.at(removed_pose);
+  sfm_data.structure[0] = full_scene.structure.at(0);
+  sfm_data.structure.at(1).obs[0] = full_scene.structure.at(1).obs.at(0);
+  const Observation observation = sfm_data.structure.at(3).obs.at(2);
+  sfm_data.structure.at(3).obs.erase(2);
+  sfm_data.structure.at(3).obs[2] = observation;
+  sfm_data.structure.at(4).obs.at(3).x += Vec2(0.5, -0.5);
+  SfM_Data sfm_data_copy = sfm_data;
+  for (auto & intrinsic_it : sfm_data_copy.intrinsics) // (intrinsics are shared pointers)
+    intrinsic_it.second.reset(intrinsic_it.second->clone());
+  EXPECT_TRUE( ba_object.Adjust(sfm_data, ba_refine_options) );
+
+  // The updated problem must give the same result as a new problem
+  Bundle_Adjustment_Ceres ba_object_new(
+    Bundle_Adjustment_Ceres::BA_Ceres_options(bVerbose, bMultithread));
+  EXPECT_TRUE( ba_object_new.Adjust(sfm_data_copy, ba_refine_options) );
+  EXPECT_NEAR( RMSE(sfm_data_copy), RMSE(sfm_data), 1e-6 );
+  for (const auto & pose_it : sfm_data.poses)
+  {
+    EXPECT_MATRIX_NEAR(sfm_data_copy.poses.at(pose_it.first).center(),
+                       pose_it.second.center(), 1e-4);
+  }
+
+  // 4. Replace the scene by another one (new camera objects): the problem is rebuilt
+  sfm_data = getInputScene(d, config, PINHOLE_CAMERA_RADIAL3);
+  const double dResidual_replaced = RMSE(sfm_data);
+  EXPECT_TRUE( ba_object.Adjust(sfm_data, ba_refine_options) );
+  EXPECT_TRUE( dResidual_replaced > RMSE(sfm_data) );
+
+  // 5. Explicit release of the problem
+  ba_object.ResetProblem();
+  EXPECT_TRUE( ba_object.Adjust(sfm_data, ba_refine_options) );
+}
+
+TEST(BUNDLE_ADJUSTMENT, PartitionPoses) {
+
+  const int nviews = 12;
+  const int npoints = 32;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Each pose is in one and only one submap
+  const std::vector<std::set<IndexT>> partition = PartitionPoses(sfm_data, 5);
+  EXPECT_EQ(3, partition.size());
+  std::set<IndexT> pose_ids;
+  for (const std::set<IndexT> & submap : partition)
+  {
+    CHECK(submap.size() <= 5);
+    pose_ids.insert(submap.cbegin(), submap.cend());
+  }
+  EXPECT_EQ(sfm_data.poses.size(), pose_ids.size());
+
+  EXPECT_EQ(1, PartitionPoses(sfm_data, nviews).size());
+}
+
+TEST(BUNDLE_ADJUSTMENT, EffectiveMinimization_Partitioned) {
+
+  const int nviews = 12;
+  const int npoints = 32;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  const SfM_Data input_scene = getInputScene(d, config, PINHOLE_CAMERA_RADIAL3);
+
+  const double dResidual_before = RMSE(input_scene);
+
+  // Split the scene in 3 submaps reconciled by their common landmarks & intrinsics
+  Bundle_Adjustment_Partitioned::Partitioned_BA_options options;
+  options.max_poses_per_submap_ = 4;
+  const Optimize_Options ba_refine_options(
+    Intrinsic_Parameter_Type::ADJUST_ALL,
+    Extrinsic_Parameter_Type::ADJUST_ALL,
+    Structure_Parameter_Type::ADJUST_ALL);
+
+  SfM_Data sfm_data = input_scene;
+  for (auto & intrinsic_it : sfm_data.intrinsics) // (intrinsics are shared pointers)
+    intrinsic_it.second.reset(intrinsic_it.second->clone());
+  {
+    Bundle_Adjustment_Partitioned ba_object(options);
+    EXPECT_TRUE( ba_object.Adjust(sfm_data, ba_refine_options) );
+  }
+  const double dResidual_after = RMSE(sfm_data);
+  EXPECT_TRUE( dResidual_before > dResidual_after);
+  EXPECT_TRUE( dResidual_after < 0.5);
+
+  // Same refinement with the submaps stored in a temporary directory
+  const char * tmp_dir = std::getenv("TMPDIR");
+  const std::string sTemp_directory = stlplus::create_filespec(
+    tmp_dir ? tmp_dir : stlplus::folder_current(), "openMVG_partitioned_BA_test");
+  SfM_Data sfm_data_streamed = input_scene;
+  for (auto & intrinsic_it : sfm_data_streamed.intrinsics)
+    intrinsic_it.second.reset(intrinsic_it.second->clone());
+  {
+    options.sTemp_directory_ = sTemp_directory;
+    Bundle_Adjustment_Partitioned ba_object(options);
+    EXPECT_TRUE( ba_object.Adjust(sfm_data_streamed, ba_refine_options) );
+  }
+  // The submaps and the directory created by the adjustment are removed
+  EXPECT_FALSE( stlplus::folder_exists(sTemp_directory) );
+  if (stlplus::folder_exists(sTemp_directory))
+    stlplus::folder_delete(sTemp_directory, true);
+  EXPECT_NEAR( dResidual_after, RMSE(sfm_data_streamed), 1e-6 );
+}
+
 //-- Test with GCP - Camera position once BA done must be the same as the GT
 TEST(BUNDLE_ADJUSTMENT, EffectiveMinimization_Pinhole_GCP) {
 
@@ -0,0 +1,138 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2015 Pierre Moulon.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/sfm_data_colorization.hpp"
+#include "openMVG/image/image_container.hpp"
+#include "openMVG/image/image_io.hpp"
+#include "openMVG/image/sample.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/types.hpp"
+
+#include "third_party/progress/progress_display.hpp"
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <utility>
+
+namespace openMVG {
+namespace sfm {
+
+using namespace openMVG::image;
+
+bool ColorizeTracks
+(
+  const SfM_Data & sfm_data,
+  std::vector<Vec3> & vec_3dPoints,
+  std::vector<Vec3> & vec_tracksColor
+)
+{
+  const Landmarks & landmarks = sfm_data.GetLandmarks();
+  vec_tracksColor.assign(landmarks.size(), Vec3::Zero());
+  vec_3dPoints.resize(landmarks.size());
+
+  // Count the number of observations per view
+  Hash_Map<IndexT, IndexT> map_IndexCardinal; // ViewId, Cardinal
+  for (const auto & landmark_it : landmarks)
+  {
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      ++map_IndexCardinal[obs_it.first];
+    }
+  }
+
+  // Assign each landmark to its most representative view
+  // and group the landmarks (contiguous index, observation) by view
+  Hash_Map<IndexT, std::vector<std::pair<IndexT, Vec2>>> map_view_observations;
+  IndexT cpt = 0;
+  for (const auto & landmark_it : landmarks)
+  {
+    vec_3dPoints[cpt] = landmark_it.second.X;
+
+    const Observations & obs = landmark_it.second.obs;
+    Observations::const_iterator best_obs = obs.end();
+    for (Observations::const_iterator iterObs = obs.begin();
+      iterObs != obs.end(); ++iterObs)
+    {
+      if (sfm_data.GetViews().count(iterObs->first) == 0)
+        continue;
+      if (best_obs == obs.end() ||
+          map_IndexCardinal.at(iterObs->first) > map_IndexCardinal.at(best_obs->first))
+      {
+        best_obs = iterObs;
+      }
+    }
+    if (best_obs != obs.end())
+    {
+      map_view_observations[best_obs->first].emplace_back(cpt, best_obs->second.x);
+    }
+    ++cpt;
+  }
+
+  // Decode each image once and sample the color of its landmarks
+  std::vector<IndexT> vec_view_ids;
+  vec_view_ids.reserve(map_view_observations.size());
+  for (const auto & view_it : map_view_observations)
+    vec_view_ids.push_back(view_it.first);
+
+  C_Progress_display my_progress_bar(landmarks.size(),
+                                     std::cout,
+                                     "\nCompute scene structure color\n");
+
+  bool bOk = true;
+  const Sampler2d<SamplerLinear> sampler;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(vec_view_ids.size()); ++i)
+  {
+    if (!bOk)
+      continue;
+
+    const IndexT view_index = vec_view_ids[i];
+    const View * view = sfm_data.GetViews().at(view_index).get();
+    const std::string sView_filename = stlplus::create_filespec(sfm_data.s_root_path,
+      view->s_Img_path);
+    Image<RGBColor> image_rgb;
+    Image<unsigned char> image_gray;
+    const bool b_rgb_image = ReadImage(sView_filename.c_str(), &image_rgb);
+    if (!b_rgb_image) //try Gray level
+    {
+      const bool b_gray_image = ReadImage(sView_filename.c_str(), &image_gray);
+      if (!b_gray_image)
+      {
+#ifdef OPENMVG_USE_OPENMP
+        #pragma omp critical
+#endif
+        {
+          std::cerr << "Cannot open provided the image: " << sView_filename << std::endl;
+          bOk = false;
+        }
+        continue;
+      }
+    }
+
+    // Color the tracks
+    const std::vector<std::pair<IndexT, Vec2>> & observations = map_view_observations.at(view_index);
+    for (const auto & observation : observations)
+    {
+      const Vec2 & pt = observation.second;
+      const RGBColor color = b_rgb_image ?
+        sampler(image_rgb, pt.y(), pt.x()) :
+        RGBColor(sampler(image_gray, pt.y(), pt.x()));
+      vec_tracksColor[observation.first] = Vec3(color.r(), color.g(), color.b());
+    }
+
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
+    my_progress_bar += observations.size();
+  }
+  return bOk;
+}
+
+} // namespace sfm
+} // namespace openMVG
@@ -0,0 +1,102 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/image/image_container.hpp"
+#include "openMVG/image/image_io.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_colorization.hpp"
+
+#include "testing/testing.h"
+
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+using namespace openMVG;
+using namespace openMVG::image;
+using namespace openMVG::sfm;
+
+// Two views:
+// - a color image with horizontal and vertical gradients,
+// - a gray level image with a constant value.
+bool getColorizationScene(SfM_Data & sfm_data)
+{
+  Image<RGBColor> image_rgb(8, 6);
+  for (int y = 0; y < image_rgb.Height(); ++y)
+    for (int x = 0; x < image_rgb.Width(); ++x)
+      image_rgb(y, x) = RGBColor(10 * x, 20 * y, 100);
+
+  Image<unsigned char> image_gray(8, 6);
+  image_gray.fill(50);
+
+  sfm_data.s_root_path = stlplus::folder_current_full();
+  sfm_data.views[0] = std::make_shared<View>("colorization_view_0.ppm", 0, 0, 0, 8, 6);
+  sfm_data.views[1] = std::make_shared<View>("colorization_view_1.pgm", 1, 0, 1, 8, 6);
+
+  // Landmarks (view 0 observes the most landmarks)
+  Landmark landmark;
+  landmark.X = Vec3(0, 0, 0);
+  landmark.obs[0] = Observation(Vec2(2.5, 1.0), 0);
+  landmark.obs[1] = Observation(Vec2(1.0, 1.0), 0);
+  sfm_data.structure[0] = landmark;
+
+  landmark.obs.clear();
+  landmark.X = Vec3(1, 0, 0);
+  landmark.obs[0] = Observation(Vec2(1.0, 2.5), 1);
+  sfm_data.structure[1] = landmark;
+
+  landmark.obs.clear();
+  landmark.X = Vec3(2, 0, 0);
+  landmark.obs[0] = Observation(Vec2(7.0, 5.0), 2);
+  sfm_data.structure[5] = landmark;
+
+  landmark.obs.clear();
+  landmark.X = Vec3(3, 0, 0);
+  landmark.obs[1] = Observation(Vec2(3.0, 4.0), 1);
+  sfm_data.structure[10] = landmark;
+
+  return WriteImage("colorization_view_0.ppm", image_rgb)
+    && WriteImage("colorization_view_1.pgm", image_gray);
+}
+
+TEST(SFM_DATA_COLORIZATION, ColorizeTracks)
+{
+  SfM_Data sfm_data;
+  EXPECT_TRUE(getColorizationScene(sfm_data));
+
+  std::vector<Vec3> vec_3dPoints, vec_tracksColor;
+  EXPECT_TRUE(ColorizeTracks(sfm_data, vec_3dPoints, vec_tracksColor));
+
+  EXPECT_EQ(4, vec_3dPoints.size());
+  EXPECT_EQ(4, vec_tracksColor.size());
+  // Points are listed in the structure order
+  EXPECT_MATRIX_NEAR(Vec3(0, 0, 0), vec_3dPoints[0], 1e-8);
+  EXPECT_MATRIX_NEAR(Vec3(3, 0, 0), vec_3dPoints[3], 1e-8);
+  // Colors are sampled in the view 0 with a bilinear interpolation
+  EXPECT_MATRIX_NEAR(Vec3(25, 20, 100), vec_tracksColor[0], 1e-8);
+  EXPECT_MATRIX_NEAR(Vec3(10, 50, 100), vec_tracksColor[1], 1e-8);
+  EXPECT_MATRIX_NEAR(Vec3(70, 100, 100), vec_tracksColor[2], 1e-8);
+  // Gray level image
+  EXPECT_MATRIX_NEAR(Vec3(50, 50, 50), vec_tracksColor[3], 1e-8);
+
+  EXPECT_TRUE(stlplus::file_delete("colorization_view_0.ppm"));
+  EXPECT_TRUE(stlplus::file_delete("colorization_view_1.pgm"));
+}
+
+TEST(SFM_DATA_COLORIZATION, MissingImage)
+{
+  SfM_Data sfm_data;
+  EXPECT_TRUE(getColorizationScene(sfm_data));
+  EXPECT_TRUE(stlplus::file_delete("colorization_view_0.ppm"));
+  EXPECT_TRUE(stlplus::file_delete("colorization_view_1.pgm"));
+
+  std::vector<Vec3> vec_3dPoints, vec_tracksColor;
+  EXPECT_FALSE(ColorizeTracks(sfm_data, vec_3dPoints, vec_tracksColor));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -0,0 +1,345 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/sfm_data_export_undistorted.hpp"
+#include "openMVG/cameras/Camera_undistort_image.hpp"
+#include "openMVG/image/image_converter.hpp"
+#include "openMVG/image/image_io.hpp"
+#include "openMVG/image/image_resampling.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+
+#include "third_party/progress/progress_display.hpp"
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+namespace openMVG {
+namespace sfm {
+
+using namespace openMVG::cameras;
+using namespace openMVG::image;
+
+namespace {
+
+std::string lower_extension(const std::string & filename)
+{
+  std::string extension = stlplus::extension_part(filename);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+    [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return extension;
+}
+
+bool create_folder(const std::string & folder)
+{
+  if (stlplus::folder_exists(folder) || stlplus::folder_create(folder))
+    return true;
+  std::cerr << "Cannot create the output directory:\n" << folder << std::endl;
+  return false;
+}
+
+/// Naive image bilinear resampling of an image for thumbnail generation
+/// Inspired by create_thumbnail from MVE (cropping is here ignored)
+template <typename ImageT>
+ImageT
+create_thumbnail
+(
+  const ImageT & image,
+  int thumb_width,
+  int thumb_height
+)
+{
+  const int width = image.Width();
+  const int height = image.Height();
+  const float image_aspect = static_cast<float>(width) / height;
+  const float thumb_aspect = static_cast<float>(thumb_width) / thumb_height;
+
+  int rescale_width, rescale_height;
+  if (image_aspect > thumb_aspect)
+  {
+    rescale_width = std::ceil(thumb_height * image_aspect);
+    rescale_height = thumb_height;
+  }
+  else
+  {
+    rescale_width = thumb_width;
+    rescale_height = std::ceil(thumb_width / image_aspect);
+  }
+
+  // Generation of the sampling grid
+  std::vector< std::pair<float,float> > sampling_grid;
+  sampling_grid.reserve(rescale_height * rescale_width);
+  for ( int i = 0; i < rescale_height; ++i )
+  {
+    for ( int j = 0; j < rescale_width; ++j )
+    {
+      const float dx = static_cast<float>(j) * width / rescale_width;
+      const float dy = static_cast<float>(i) * height / rescale_height;
+      sampling_grid.push_back( std::make_pair( dy , dx ) );
+    }
+  }
+
+  const Sampler2d<SamplerLinear> sampler;
+  ImageT imageOut;
+  GenericRessample(image, sampling_grid, rescale_width, rescale_height, sampler, imageOut);
+  return imageOut;
+}
+
+} // namespace
+
+bool ExportUndistortedImages
+(
+  const SfM_Data & sfm_data,
+  const std::vector<UndistortedImagePath> & destinations,
+  const UndistortedImageCallback & callback,
+  C_Progress_display * my_progress_bar
+)
+{
+  const Views & views = sfm_data.GetViews();
+  std::vector<const View *> vec_views;
+  vec_views.reserve(views.size());
+  for (const auto & view_it : views)
+    vec_views.push_back(view_it.second.get());
+
+  bool bOk = true;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(vec_views.size()); ++i)
+  {
+    const View * view = vec_views[i];
+
+    // List the requested output images of this view
+    std::vector<std::string> vec_dst_images;
+    for (const UndistortedImagePath & destination : destinations)
+    {
+      const std::string dst_image = destination(*view);
+      if (!dst_image.empty())
+        vec_dst_images.push_back(dst_image);
+    }
+
+    bool bView_ok = true;
+    if (!vec_dst_images.empty())
+    {
+      const std::string src_image =
+        stlplus::create_filespec(sfm_data.s_root_path, view->s_Img_path);
+      const std::string src_extension = lower_extension(src_image);
+
+      const auto iterIntrinsic = sfm_data.GetIntrinsics().find(view->id_intrinsic);
+      const IntrinsicBase * cam = (iterIntrinsic != sfm_data.GetIntrinsics().end()) ?
+        iterIntrinsic->second.get() : nullptr;
+      const bool b_undistort = cam && cam->have_disto();
+
+      // The image is decoded and undistorted only if needed, and at most once
+      Image<RGBColor> image_rgb;
+      Image<unsigned char> image_gray;
+      bool b_decoded = false, b_rgb_image = false;
+      const auto decode = [&]() -> bool
+      {
+        if (b_decoded)
+          return true;
+        b_rgb_image = ReadImage(src_image.c_str(), &image_rgb);
+        if (!b_rgb_image && !ReadImage(src_image.c_str(), &image_gray)) // try Gray level
+        {
+          std::cerr << "Unable to read the input image:\n" << src_image << std::endl;
+          return false;
+        }
+        if (b_undistort)
+        {
+          if (b_rgb_image)
+          {
+            Image<RGBColor> image_ud;
+            UndistortImage(image_rgb, cam, image_ud, BLACK);
+            image_rgb = std::move(image_ud);
+          }
+          else
+          {
+            Image<unsigned char> image_ud;
+            UndistortImage(image_gray, cam, image_ud, static_cast<unsigned char>(0));
+            image_gray = std::move(image_ud);
+          }
+        }
+        b_decoded = true;
+        return true;
+      };
+
+      // First written image per output extension
+      std::map<std::string, std::string> map_encoded_images;
+      for (const std::string & dst_image : vec_dst_images)
+      {
+        const std::string dst_extension = lower_extension(dst_image);
+        bool bWrite_ok = true;
+        if (!b_undistort && dst_extension == src_extension)
+        {
+          bWrite_ok = stlplus::file_copy(src_image, dst_image);
+        }
+        else if (map_encoded_images.count(dst_extension))
+        {
+          bWrite_ok = stlplus::file_copy(map_encoded_images.at(dst_extension), dst_image);
+        }
+        else
+        {
+          if (!decode())
+          {
+            bView_ok = false;
+            break;
+          }
+          bWrite_ok = b_rgb_image ?
+            WriteImage(dst_image.c_str(), image_rgb) :
+            WriteImage(dst_image.c_str(), image_gray);
+          if (bWrite_ok)
+            map_encoded_images[dst_extension] = dst_image;
+        }
+        if (!bWrite_ok)
+        {
+          std::cerr << "Unable to write the output image:\n" << dst_image << std::endl;
+          bView_ok = false;
+        }
+      }
+
+      if (bView_ok && callback)
+      {
+        if (!decode())
+        {
+          bView_ok = false;
+        }
+        else if (b_rgb_image)
+        {
+          bView_ok = callback(*view, image_rgb);
+        }
+        else
+        {
+          ConvertPixelType(image_gray, &image_rgb);
+          bView_ok = callback(*view, image_rgb);
+        }
+      }
+    }
+
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
+    bOk &= bView_ok;
+
+    if (my_progress_bar)
+      ++(*my_progress_bar);
+  }
+  return bOk;
+}
+
+bool PMVSUndistortedImagePath
+(
+  const SfM_Data & sfm_data,
+  const std::string & sOutDirectory,
+  UndistortedImagePath & image_path
+)
+{
+  const std::string sOutVisualizeDirectory =
+    stlplus::folder_append_separator(sOutDirectory) + "visualize";
+  if (!create_folder(sOutDirectory) || !create_folder(sOutVisualizeDirectory))
+    return false;
+
+  // PMVS requires contiguous camera indexes
+  auto map_viewIdToContiguous = std::make_shared<Hash_Map<IndexT, IndexT>>();
+  for (const auto & view_it : sfm_data.GetViews())
+  {
+    if (sfm_data.IsPoseAndIntrinsicDefined(view_it.second.get()))
+      map_viewIdToContiguous->insert({view_it.first, map_viewIdToContiguous->size()});
+  }
+
+  image_path = [=](const View & view) -> std::string
+  {
+    const auto iter = map_viewIdToContiguous->find(view.id_view);
+    if (iter == map_viewIdToContiguous->end())
+      return std::string();
+    std::ostringstream os;
+    os << std::setw(8) << std::setfill('0') << iter->second;
+    return stlplus::create_filespec(sOutVisualizeDirectory, os.str(), "jpg");
+  };
+  return true;
+}
+
+std::string MVEViewDirectory
+(
+  const std::string & sOutDirectory,
+  const View & view
+)
+{
+  std::ostringstream padding;
+  padding << std::setw(4) << std::setfill('0') << view.id_view;
+  return stlplus::folder_append_separator(sOutDirectory)
+    + stlplus::folder_append_separator("views") + "view_" + padding.str() + ".mve";
+}
+
+bool MVEUndistortedImagePath
+(
+  const SfM_Data & sfm_data,
+  const std::string & sOutDirectory,
+  UndistortedImagePath & image_path
+)
+{
+  if (!create_folder(sOutDirectory) ||
+      !create_folder(stlplus::folder_append_separator(sOutDirectory) + "views"))
+    return false;
+  for (const auto & view_it : sfm_data.GetViews())
+  {
+    if (sfm_data.IsPoseAndIntrinsicDefined(view_it.second.get()) &&
+        !create_folder(MVEViewDirectory(sOutDirectory, *view_it.second)))
+      return false;
+  }
+
+  image_path = [&sfm_data, sOutDirectory](const View & view) -> std::string
+  {
+    if (!sfm_data.IsPoseAndIntrinsicDefined(&view))
+      return std::string();
+    return stlplus::create_filespec(MVEViewDirectory(sOutDirectory, view), "undistorted", "png");
+  };
+  return true;
+}
+
+bool WriteMVEThumbnail
+(
+  const std::string & sOutDirectory,
+  const View & view,
+  const image::Image<image::RGBColor> & image
+)
+{
+  const Image<RGBColor> thumbnail = create_thumbnail(image, 50, 50);
+  const std::string dstThumbnailImage =
+    stlplus::create_filespec(MVEViewDirectory(sOutDirectory, view), "thumbnail", "png");
+  return WriteImage(dstThumbnailImage.c_str(), thumbnail) != 0;
+}
+
+bool OpenMVSUndistortedImagePath
+(
+  const SfM_Data & sfm_data,
+  const std::string & sOutDirectory,
+  UndistortedImagePath & image_path
+)
+{
+  if (!create_folder(sOutDirectory))
+    return false;
+
+  image_path = [&sfm_data, sOutDirectory](const View & view) -> std::string
+  {
+    const std::string srcImage = stlplus::create_filespec(sfm_data.s_root_path, view.s_Img_path);
+    if (!stlplus::is_file(srcImage))
+      return std::string();
+    return stlplus::create_filespec(sOutDirectory, view.s_Img_path);
+  };
+  return true;
+}
+
+} // namespace sfm
+} // namespace openMVG
@@ -0,0 +1,102 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_DATA_EXPORT_UNDISTORTED_HPP
+#define OPENMVG_SFM_SFM_DATA_EXPORT_UNDISTORTED_HPP
+
+#include "openMVG/image/image_container.hpp"
+#include "openMVG/image/pixel_types.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class C_Progress_display;
+
+namespace openMVG {
+namespace sfm {
+
+struct SfM_Data;
+struct View;
+
+/// Return the path of the undistorted image of a view for an export format
+/// (an empty path means that the view is not exported for this format).
+using UndistortedImagePath = std::function<std::string(const View &)>;
+
+/// Optional processing of the undistorted image of an exported view (e.g. thumbnail).
+/// It is called concurrently for different views.
+using UndistortedImageCallback =
+  std::function<bool(const View &, const image::Image<image::RGBColor> &)>;
+
+/// Export the views of a scene as undistorted images for one or several formats.
+/// - the views are processed in parallel,
+/// - each image is decoded and undistorted once for all the formats,
+/// - the undistorted image is encoded once per output extension,
+///   the other destinations with the same extension are file copies,
+/// - an image without distortion is copied if its extension matches the output one.
+/// Return false if an image cannot be read or written.
+bool ExportUndistortedImages
+(
+  const SfM_Data & sfm_data,
+  const std::vector<UndistortedImagePath> & destinations,
+  const UndistortedImageCallback & callback = nullptr,
+  C_Progress_display * my_progress_bar = nullptr
+);
+
+/// Undistorted image layouts of the MVS exporters.
+/// Several layouts can be passed to the same ExportUndistortedImages call.
+/// They create the image directories of the layout in sOutDirectory and
+/// return false if a directory cannot be created.
+/// The returned image paths keep a reference to sfm_data.
+
+/// PMVS: <sOutDirectory>/visualize/%08d.jpg, for the views with a pose and an
+/// intrinsic, numbered contiguously in the views order.
+bool PMVSUndistortedImagePath
+(
+  const SfM_Data & sfm_data,
+  const std::string & sOutDirectory,
+  UndistortedImagePath & image_path
+);
+
+/// MVE: <sOutDirectory>/views/view_%04d.mve/undistorted.png (view id),
+/// for the views with a pose and an intrinsic.
+bool MVEUndistortedImagePath
+(
+  const SfM_Data & sfm_data,
+  const std::string & sOutDirectory,
+  UndistortedImagePath & image_path
+);
+
+/// Directory of a view in the MVE layout (<sOutDirectory>/views/view_%04d.mve)
+std::string MVEViewDirectory
+(
+  const std::string & sOutDirectory,
+  const View & view
+);
+
+/// Write the MVE thumbnail (50x50 pixels) of an undistorted view image
+/// in its MVE view directory
+bool WriteMVEThumbnail
+(
+  const std::string & sOutDirectory,
+  const View & view,
+  const image::Image<image::RGBColor> & image
+);
+
+/// openMVS: <sOutDirectory>/<view image path>, for the views whose image exists.
+bool OpenMVSUndistortedImagePath
+(
+  const SfM_Data & sfm_data,
+  const std::string & sOutDirectory,
+  UndistortedImagePath & image_path
+);
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_DATA_EXPORT_UNDISTORTED_HPP
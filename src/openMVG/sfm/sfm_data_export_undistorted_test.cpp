@@ -0,0 +1,173 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "openMVG/cameras/Camera_Pinhole_Radial.hpp"
+#include "openMVG/image/image_container.hpp"
+#include "openMVG/image/image_io.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_export_undistorted.hpp"
+
+#include "testing/testing.h"
+
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <atomic>
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::image;
+using namespace openMVG::sfm;
+
+// Two views sharing the same image:
+// - view 0 without distortion,
+// - view 1 with a radial distortion.
+bool getExportScene(SfM_Data & sfm_data)
+{
+  Image<RGBColor> image(16, 12);
+  for (int y = 0; y < image.Height(); ++y)
+    for (int x = 0; x < image.Width(); ++x)
+      image(y, x) = RGBColor(10 * x, 20 * y, 100);
+
+  sfm_data.s_root_path = stlplus::folder_current_full();
+  sfm_data.views[0] = std::make_shared<View>("export_view.ppm", 0, 0, 0, 16, 12);
+  sfm_data.views[1] = std::make_shared<View>("export_view.ppm", 1, 1, 1, 16, 12);
+  sfm_data.intrinsics[0] = std::make_shared<Pinhole_Intrinsic>(16, 12, 20, 8, 6);
+  sfm_data.intrinsics[1] = std::make_shared<Pinhole_Intrinsic_Radial_K1>(16, 12, 20, 8, 6, 0.1);
+  return WriteImage("export_view.ppm", image);
+}
+
+bool isSameImage(const Image<RGBColor> & image_a, const Image<RGBColor> & image_b)
+{
+  if (image_a.Width() != image_b.Width() || image_a.Height() != image_b.Height())
+    return false;
+  for (int y = 0; y < image_a.Height(); ++y)
+    for (int x = 0; x < image_a.Width(); ++x)
+      if (image_a(y, x) != image_b(y, x))
+        return false;
+  return true;
+}
+
+TEST(SFM_DATA_EXPORT_UNDISTORTED, TwoFormats)
+{
+  SfM_Data sfm_data;
+  EXPECT_TRUE(getExportScene(sfm_data));
+
+  // Two formats: the same extension (ppm) and a png export of the view 1 only
+  const std::vector<UndistortedImagePath> destinations =
+  {
+    [](const View & view) { return "export_A_" + std::to_string(view.id_view) + ".ppm"; },
+    [](const View & view) { return "export_B_" + std::to_string(view.id_view) + ".ppm"; },
+    [](const View & view) { return (view.id_view == 1) ? std::string("export_C_1.png") : std::string(); },
+  };
+  std::atomic<int> callback_count(0);
+  const UndistortedImageCallback callback =
+    [&](const View & view, const Image<RGBColor> & image)
+    {
+      ++callback_count;
+      return image.Width() == 16 && image.Height() == 12;
+    };
+  EXPECT_TRUE(ExportUndistortedImages(sfm_data, destinations, callback));
+  EXPECT_EQ(2, callback_count);
+
+  // View 0 is a copy of the input image
+  Image<RGBColor> image, image_A, image_B, image_C;
+  EXPECT_TRUE(ReadImage("export_view.ppm", &image));
+  EXPECT_TRUE(ReadImage("export_A_0.ppm", &image_A));
+  EXPECT_TRUE(isSameImage(image, image_A));
+  EXPECT_TRUE(ReadImage("export_B_0.ppm", &image_B));
+  EXPECT_TRUE(isSameImage(image, image_B));
+
+  // View 1 is undistorted and identical in all the formats
+  EXPECT_TRUE(ReadImage("export_A_1.ppm", &image_A));
+  EXPECT_TRUE(ReadImage("export_B_1.ppm", &image_B));
+  EXPECT_TRUE(ReadImage("export_C_1.png", &image_C));
+  EXPECT_FALSE(isSameImage(image, image_A));
+  EXPECT_TRUE(isSameImage(image_A, image_B));
+  EXPECT_TRUE(isSameImage(image_A, image_C));
+  // The principal point is not moved by the distortion
+  EXPECT_TRUE(image(6, 8) == image_A(6, 8));
+
+  for (const std::string & filename :
+    {"export_view.ppm", "export_A_0.ppm", "export_B_0.ppm",
+     "export_A_1.ppm", "export_B_1.ppm", "export_C_1.png"})
+  {
+    EXPECT_TRUE(stlplus::file_delete(filename));
+  }
+}
+
+TEST(SFM_DATA_EXPORT_UNDISTORTED, MVSLayouts)
+{
+  SfM_Data sfm_data;
+  EXPECT_TRUE(getExportScene(sfm_data));
+  EXPECT_TRUE(stlplus::file_copy("export_view.ppm", "export_view_1.ppm"));
+  sfm_data.views[1]->s_Img_path = "export_view_1.ppm";
+  // Only the view 0 has a pose
+  sfm_data.poses[0] = geometry::Pose3();
+
+  // The PMVS, MVE and openMVS layouts are exported by one call
+  UndistortedImagePath pmvs_image_path, mve_image_path, openMVS_image_path;
+  EXPECT_TRUE(PMVSUndistortedImagePath(sfm_data, "export_PMVS", pmvs_image_path));
+  EXPECT_TRUE(MVEUndistortedImagePath(sfm_data, "export_MVE", mve_image_path));
+  EXPECT_TRUE(OpenMVSUndistortedImagePath(sfm_data, "export_openMVS", openMVS_image_path));
+  std::atomic<int> callback_count(0);
+  const UndistortedImageCallback mve_thumbnail =
+    [&](const View & view, const Image<RGBColor> & image)
+    {
+      ++callback_count;
+      return !sfm_data.IsPoseAndIntrinsicDefined(&view) ||
+        WriteMVEThumbnail("export_MVE", view, image);
+    };
+  EXPECT_TRUE(ExportUndistortedImages(sfm_data,
+    {pmvs_image_path, mve_image_path, openMVS_image_path}, mve_thumbnail));
+  // Each view with an output image is decoded once
+  EXPECT_EQ(2, callback_count);
+
+  // PMVS and MVE: only the view 0 (with a pose)
+  EXPECT_TRUE(stlplus::is_file("export_PMVS/visualize/00000000.jpg"));
+  EXPECT_FALSE(stlplus::is_file("export_PMVS/visualize/00000001.jpg"));
+  Image<RGBColor> image, image_MVE, thumbnail;
+  EXPECT_TRUE(ReadImage("export_view.ppm", &image));
+  EXPECT_TRUE(ReadImage("export_MVE/views/view_0000.mve/undistorted.png", &image_MVE));
+  EXPECT_TRUE(isSameImage(image, image_MVE));
+  EXPECT_TRUE(ReadImage("export_MVE/views/view_0000.mve/thumbnail.png", &thumbnail));
+  // The thumbnail keeps the image aspect ratio (16x12 -> 67x50)
+  EXPECT_EQ(67, thumbnail.Width());
+  EXPECT_EQ(50, thumbnail.Height());
+  EXPECT_FALSE(stlplus::folder_exists("export_MVE/views/view_0001.mve"));
+
+  // openMVS: every view
+  EXPECT_TRUE(stlplus::is_file("export_openMVS/export_view.ppm"));
+  EXPECT_TRUE(stlplus::is_file("export_openMVS/export_view_1.ppm"));
+
+  for (const std::string & folder : {"export_PMVS", "export_MVE", "export_openMVS"})
+  {
+    EXPECT_TRUE(stlplus::folder_delete(folder, true));
+  }
+  for (const std::string & filename : {"export_view.ppm", "export_view_1.ppm"})
+  {
+    EXPECT_TRUE(stlplus::file_delete(filename));
+  }
+}
+
+TEST(SFM_DATA_EXPORT_UNDISTORTED, MissingImage)
+{
+  SfM_Data sfm_data;
+  EXPECT_TRUE(getExportScene(sfm_data));
+  EXPECT_TRUE(stlplus::file_delete("export_view.ppm"));
+
+  const std::vector<UndistortedImagePath> destinations =
+  {
+    [](const View & view) { return "export_A_" + std::to_string(view.id_view) + ".png"; }
+  };
+  EXPECT_FALSE(ExportUndistortedImages(sfm_data, destinations));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -15,9 +15,16 @@
 
 #include "third_party/progress/progress_display.hpp"
 
+#ifdef OPENMVG_USE_OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <iterator>
+#include <limits>
+#include <numeric>
 
 namespace openMVG {
 namespace sfm {
@@ -81,54 +88,186 @@ void Frustum_Filter::initFrustum
   }
 }
 
+namespace {
+
+// Axis aligned bounding box of a frustum.
+// Infinite frustums are unbounded along the axes their rays are going to.
+void FrustumBounds
+(
+  const Frustum & frustum,
+  Vec3 & bound_min,
+  Vec3 & bound_max
+)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  if (frustum.isInfinite())
+  {
+    const Vec3 & C = frustum.cones[0];
+    bound_min = bound_max = C;
+    for (int k = 1; k < 5; ++k)
+    {
+      const Vec3 ray = frustum.cones[k] - C;
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        if (ray(axis) < 0.0) bound_min(axis) = -inf;
+        if (ray(axis) > 0.0) bound_max(axis) = inf;
+      }
+    }
+  }
+  else
+  {
+    const std::vector<Vec3> & points = frustum.frustum_points();
+    bound_min = bound_max = points.front();
+    for (const Vec3 & point : points)
+    {
+      bound_min = bound_min.cwiseMin(point);
+      bound_max = bound_max.cwiseMax(point);
+    }
+  }
+  // Keep a margin so that touching frustums are still tested
+  double max_coordinate = 1.0;
+  for (const Vec3 & point : frustum.frustum_points())
+    max_coordinate = std::max(max_coordinate, point.cwiseAbs().maxCoeff());
+  const double margin = 1e-6 * max_coordinate;
+  bound_min.array() -= margin;
+  bound_max.array() += margin;
+}
+
+} // namespace
+
 Pair_Set Frustum_Filter::getFrustumIntersectionPairs
 (
   const std::vector<HalfPlaneObject>& bounding_volume
 )
 const
 {
-  Pair_Set pairs;
   // List active view Id
   std::vector<IndexT> viewIds;
-  viewIds.reserve(z_near_z_far_perView.size());
-  std::transform(z_near_z_far_perView.begin(), z_near_z_far_perView.end(),
-    std::back_inserter(viewIds), stl::RetrieveKey());
+  viewIds.reserve(frustum_perView.size());
+  for (const auto & it : z_near_z_far_perView)
+  {
+    if (frustum_perView.count(it.first))
+      viewIds.push_back(it.first);
+  }
+  const int nb_views = static_cast<int>(viewIds.size());
+
+  //-- Cull the candidate pairs with the frustum bounding boxes
+  //  (sweep and prune along the axis where the boxes are the most spread)
+  //  A box overlap is a necessary condition for a frustum intersection,
+  //  so only the remaining candidates run the exact half-space test.
+  std::vector<Vec3> bounds_min(nb_views), bounds_max(nb_views);
+  for (int i = 0; i < nb_views; ++i)
+  {
+    FrustumBounds(frustum_perView.at(viewIds[i]), bounds_min[i], bounds_max[i]);
+  }
+  int sweep_axis = 0;
+  {
+    Vec3 extent_min = Vec3::Constant(std::numeric_limits<double>::max());
+    Vec3 extent_max = Vec3::Constant(std::numeric_limits<double>::lowest());
+    for (int i = 0; i < nb_views; ++i)
+    {
+      const Vec3 & C = frustum_perView.at(viewIds[i]).cones[0];
+      extent_min = extent_min.cwiseMin(C);
+      extent_max = extent_max.cwiseMax(C);
+    }
+    if (nb_views > 0)
+      (extent_max - extent_min).maxCoeff(&sweep_axis);
+  }
+  std::vector<int> sweep_order(nb_views);
+  std::iota(sweep_order.begin(), sweep_order.end(), 0);
+  std::sort(sweep_order.begin(), sweep_order.end(),
+    [&](int a, int b) { return bounds_min[a](sweep_axis) < bounds_min[b](sweep_axis); });
 
   C_Progress_display my_progress_bar(
-    viewIds.size() * (viewIds.size()-1)/2,
+    nb_views,
     std::cout, "\nCompute frustum intersection\n");
 
-  // Exhaustive comparison (use the fact that the intersect function is symmetric)
+  // Each thread collects its own intersecting pairs
+#ifdef OPENMVG_USE_OPENMP
+  std::vector<std::vector<Pair>> thread_pairs(omp_get_max_threads());
+#else
+  std::vector<std::vector<Pair>> thread_pairs(1);
+#endif
+
 #ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel for schedule(dynamic)
 #endif
-  for (int i = 0; i < (int)viewIds.size(); ++i)
+  for (int s = 0; s < nb_views; ++s)
   {
+#ifdef OPENMVG_USE_OPENMP
+    std::vector<Pair> & pairs = thread_pairs[omp_get_thread_num()];
+#else
+    std::vector<Pair> & pairs = thread_pairs[0];
+#endif
+    const int i = sweep_order[s];
     // Prepare vector of intersecting objects (within loop to keep it
     // thread-safe)
     std::vector<HalfPlaneObject> objects = bounding_volume;
     objects.insert(objects.end(),
                    { frustum_perView.at(viewIds[i]), HalfPlaneObject() });
 
-    for (size_t j = i+1; j < viewIds.size(); ++j)
+    for (int t = s + 1; t < nb_views; ++t)
     {
+      const int j = sweep_order[t];
+      // The boxes are sorted along the sweep axis: no further overlap
+      if (bounds_min[j](sweep_axis) > bounds_max[i](sweep_axis))
+        break;
+      if ((bounds_min[j].array() > bounds_max[i].array()).any() ||
+          (bounds_min[i].array() > bounds_max[j].array()).any())
+        continue;
+
       objects.back() = frustum_perView.at(viewIds[j]);
       if (intersect(objects))
       {
-#ifdef OPENMVG_USE_OPENMP
-        #pragma omp critical
-#endif
-        {
-          pairs.insert({viewIds[i], viewIds[j]});
-        }
+        // Keep the pair orientation of the exhaustive listing order
+        pairs.emplace_back(viewIds[std::min(i, j)], viewIds[std::max(i, j)]);
       }
-      // Progress bar update
-      ++my_progress_bar;
     }
+    // Progress bar update
+    ++my_progress_bar;
+  }
+
+  Pair_Set pairs;
+  for (const auto & it : thread_pairs)
+  {
+    pairs.insert(it.begin(), it.end());
   }
   return pairs;
 }
 
+std::vector<IndexT> Frustum_Filter::getFrustumIntersections
+(
+  const Frustum & frustum,
+  const std::vector<IndexT> & candidate_view_ids
+)
+const
+{
+  std::vector<IndexT> view_ids;
+  std::vector<HalfPlaneObject> objects = { frustum, HalfPlaneObject() };
+  if (candidate_view_ids.empty())
+  {
+    for (const auto & frustum_it : frustum_perView)
+    {
+      objects.back() = frustum_it.second;
+      if (intersect(objects))
+        view_ids.push_back(frustum_it.first);
+    }
+  }
+  else
+  {
+    for (const IndexT view_id : candidate_view_ids)
+    {
+      const auto frustum_it = frustum_perView.find(view_id);
+      if (frustum_it == frustum_perView.end())
+        continue;
+      objects.back() = frustum_it->second;
+      if (intersect(objects))
+        view_ids.push_back(view_id);
+    }
+  }
+  return view_ids;
+}
+
 // Export defined frustum in PLY file for viewing
 bool Frustum_Filter::export_Ply
 (
@@ -49,6 +49,13 @@ public:
     const std::vector<geometry::halfPlane::HalfPlaneObject>& bounding_volume = {}
   ) const;
 
+  // Return the view Ids (chosen among the candidates, or among all the views
+  // if no candidate is provided) whose frustum intersects the given one.
+  std::vector<IndexT> getFrustumIntersections(
+    const geometry::Frustum & frustum,
+    const std::vector<IndexT> & candidate_view_ids = {}
+  ) const;
+
   // Export defined frustum in PLY file for viewing
   bool export_Ply(const std::string & filename) const;
 
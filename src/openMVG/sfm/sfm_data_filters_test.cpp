@@ -9,6 +9,9 @@
 #include "openMVG/cameras/Camera_Pinhole.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_filters.hpp"
+#include "openMVG/sfm/sfm_data_filters_frustum.hpp"
+
+#include <algorithm>
 
 #include "testing/testing.h"
 
@@ -164,6 +167,110 @@ TEST(SFM_DATA_FILTERS, eraseUnstablePosesAndObservations)
   EXPECT_EQ(0, sfm_data.structure.count(5));
 }
 
+TEST(SFM_DATA_FILTERS, FrustumIntersectionPairs)
+{
+  // Init an aerial like block of 8x8 nadir cameras
+  const int grid_size = 8;
+  SfM_Data sfm_data;
+  init_scene(sfm_data, grid_size * grid_size);
+  sfm_data.intrinsics[0] =
+    std::make_shared<Pinhole_Intrinsic>(1000, 1000, 1000.0, 500.0, 500.0);
+  const Mat3 R_nadir = Vec3(1., -1., -1.).asDiagonal();
+  for (IndexT i = 0; i < sfm_data.poses.size(); ++i)
+  {
+    sfm_data.poses[i] = Pose3(R_nadir, Vec3(i % grid_size, i / grid_size, 2.0));
+  }
+
+  const Pinhole_Intrinsic * cam =
+    dynamic_cast<const Pinhole_Intrinsic*>(sfm_data.intrinsics.at(0).get());
+
+  // Test with truncated and infinite frustums
+  for (const double z_far : {1.5, -1.})
+  {
+    const double z_near = (z_far > 0) ? 0.5 : -1.;
+    const Frustum_Filter frustum_filter(sfm_data, z_near, z_far);
+    const Pair_Set pairs = frustum_filter.getFrustumIntersectionPairs();
+
+    // Compare to the exhaustive listing
+    Pair_Set expected_pairs;
+    for (IndexT i = 0; i < sfm_data.poses.size(); ++i)
+    {
+      for (IndexT j = i + 1; j < sfm_data.poses.size(); ++j)
+      {
+        const Pose3 & pose_i = sfm_data.poses.at(i), & pose_j = sfm_data.poses.at(j);
+        const Frustum frustum_i = (z_far > 0) ?
+          Frustum(cam->w(), cam->h(), cam->K(), pose_i.rotation(), pose_i.center(), z_near, z_far) :
+          Frustum(cam->w(), cam->h(), cam->K(), pose_i.rotation(), pose_i.center());
+        const Frustum frustum_j = (z_far > 0) ?
+          Frustum(cam->w(), cam->h(), cam->K(), pose_j.rotation(), pose_j.center(), z_near, z_far) :
+          Frustum(cam->w(), cam->h(), cam->K(), pose_j.rotation(), pose_j.center());
+        if (frustum_i.intersect(frustum_j))
+          expected_pairs.insert({i, j});
+      }
+    }
+    Pair_Set sorted_pairs;
+    for (const Pair & pair : pairs)
+      sorted_pairs.insert({std::min(pair.first, pair.second), std::max(pair.first, pair.second)});
+
+    EXPECT_EQ(expected_pairs.size(), sorted_pairs.size());
+    EXPECT_TRUE(expected_pairs == sorted_pairs);
+    if (z_far > 0)
+    {
+      // Distant views must not be paired
+      EXPECT_TRUE(pairs.size() < grid_size * grid_size * (grid_size * grid_size - 1) / 2);
+    }
+  }
+}
+
+TEST(SFM_DATA_FILTERS, FrustumIntersections)
+{
+  // Init a line of 8 nadir cameras
+  const int nb_views = 8;
+  SfM_Data sfm_data;
+  init_scene(sfm_data, nb_views);
+  sfm_data.intrinsics[0] =
+    std::make_shared<Pinhole_Intrinsic>(1000, 1000, 1000.0, 500.0, 500.0);
+  const Mat3 R_nadir = Vec3(1., -1., -1.).asDiagonal();
+  for (IndexT i = 0; i < sfm_data.poses.size(); ++i)
+  {
+    sfm_data.poses[i] = Pose3(R_nadir, Vec3(i, 0.0, 2.0));
+  }
+
+  const Pinhole_Intrinsic * cam =
+    dynamic_cast<const Pinhole_Intrinsic*>(sfm_data.intrinsics.at(0).get());
+
+  const double z_near = 0.5, z_far = 1.5;
+  const Frustum_Filter frustum_filter(sfm_data, z_near, z_far);
+  // Query frustum above the view 0
+  const Frustum query_frustum(cam->w(), cam->h(), cam->K(),
+    R_nadir, Vec3(0.0, 0.0, 2.0), z_near, z_far);
+
+  // Compare to the exhaustive listing
+  std::vector<IndexT> expected_views;
+  for (IndexT i = 0; i < sfm_data.poses.size(); ++i)
+  {
+    const Pose3 & pose = sfm_data.poses.at(i);
+    const Frustum frustum(cam->w(), cam->h(), cam->K(),
+      pose.rotation(), pose.center(), z_near, z_far);
+    if (query_frustum.intersect(frustum))
+      expected_views.push_back(i);
+  }
+  std::vector<IndexT> views = frustum_filter.getFrustumIntersections(query_frustum);
+  std::sort(views.begin(), views.end());
+  EXPECT_TRUE(expected_views == views);
+  EXPECT_EQ(0, views.front());
+  // Distant views must not be listed
+  EXPECT_TRUE(views.size() < nb_views);
+
+  // Only the candidate views are tested
+  const std::vector<IndexT> candidate_views = {nb_views - 1, 1, 0};
+  const std::vector<IndexT> candidate_intersections =
+    frustum_filter.getFrustumIntersections(query_frustum, candidate_views);
+  EXPECT_EQ(2, candidate_intersections.size());
+  EXPECT_EQ(1, candidate_intersections[0]);
+  EXPECT_EQ(0, candidate_intersections[1]);
+}
+
 
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
@@ -79,6 +79,8 @@ bool Load(SfM_Data & sfm_data, const std::string & filename, ESfM_Data flags_par
     bStatus = Load_Cereal<cereal::PortableBinaryInputArchive>(sfm_data, filename, flags_part);
   else if (ext == "xml")
     bStatus = Load_Cereal<cereal::XMLInputArchive>(sfm_data, filename, flags_part);
+  else if (ext == "ply")
+    bStatus = Load_PLY(sfm_data, filename, flags_part);
   else
   {
     std::cerr << "Unknown sfm_data input format: " << ext << std::endl;
@@ -10,11 +10,11 @@
 #define OPENMVG_SFM_SFM_DATA_IO_PLY_HPP
 
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "openMVG/sfm/sfm_ply_vertex_stream.hpp"
 
 #include <fstream>
-#include <iomanip>
-#include <limits>
 #include <string>
+#include <vector>
 
 namespace openMVG {
 namespace sfm {
@@ -61,125 +61,91 @@ inline bool Save_PLY
       }
     }
 
-    stream << std::fixed << std::setprecision (std::numeric_limits<double>::digits10 + 1);
-
-    using Vec3uc = Eigen::Matrix<unsigned char, 3, 1>;
-
-    stream << "ply"
-      << '\n' << "format "
-              << (b_write_in_ascii ? "ascii 1.0" : "binary_little_endian 1.0")
-      << '\n' << "comment generated by OpenMVG"
-      << '\n' << "element vertex "
-        // Vertex count: (#landmark + #GCP + #view_with_valid_pose)
-        << (  (b_structure ? sfm_data.GetLandmarks().size() : 0)
-            + (b_control_points ? sfm_data.GetControl_Points().size() : 0)
-            + view_with_pose_count
-            + view_with_pose_prior_count)
-      << '\n' << "property double x"
-      << '\n' << "property double y"
-      << '\n' << "property double z"
-      << '\n' << "property uchar red"
-      << '\n' << "property uchar green"
-      << '\n' << "property uchar blue"
-      << '\n' << "end_header" << std::endl;
-
-      if (b_extrinsics)
+    WritePlyHeader(stream,
+      // Vertex count: (#landmark + #GCP + #view_with_valid_pose)
+      (  (b_structure ? sfm_data.GetLandmarks().size() : 0)
+       + (b_control_points ? sfm_data.GetControl_Points().size() : 0)
+       + view_with_pose_count
+       + view_with_pose_prior_count),
+      b_write_in_ascii);
+
+    // Stream the vertices by chunks
+    Ply_Vertex_Writer vertex_writer(stream, b_write_in_ascii);
+
+    if (b_extrinsics)
+    {
+      for (const auto & view : sfm_data.GetViews())
       {
-        for (const auto & view : sfm_data.GetViews())
+        // Export pose as Green points
+        if (sfm_data.IsPoseAndIntrinsicDefined(view.second.get()))
         {
-          // Export pose as Green points
-          if (sfm_data.IsPoseAndIntrinsicDefined(view.second.get()))
-          {
-            const geometry::Pose3 pose = sfm_data.GetPoseOrDie(view.second.get());
-            if (b_write_in_ascii)
-            {
-              stream
-                << pose.center()(0) << ' '
-                << pose.center()(1) << ' '
-                << pose.center()(2) << ' '
-                << "0 255 0\n";
-            }
-            else
-            {
-              stream.write( reinterpret_cast<const char*> ( pose.center().data() ), sizeof( Vec3 ) );
-              stream.write( reinterpret_cast<const char*> ( Vec3uc(0, 255, 0).data() ), sizeof( Vec3uc ) );
-            }
-          }
+          const geometry::Pose3 pose = sfm_data.GetPoseOrDie(view.second.get());
+          vertex_writer.write(pose.center(), Vec3uc(0, 255, 0));
+        }
 
-          // Export pose priors as Blue points
-          if (const sfm::ViewPriors *prior = dynamic_cast<sfm::ViewPriors*>(view.second.get()))
+        // Export pose priors as Blue points
+        if (const sfm::ViewPriors *prior = dynamic_cast<sfm::ViewPriors*>(view.second.get()))
+        {
+          if (prior->b_use_pose_center_)
           {
-            if (prior->b_use_pose_center_)
-            {
-              if (b_write_in_ascii)
-              {
-                stream
-                  << prior->pose_center_(0) << ' '
-                  << prior->pose_center_(1) << ' '
-                  << prior->pose_center_(2) << ' '
-                  << "0 0 255\n";
-              }
-              else
-              {
-                stream.write( reinterpret_cast<const char*> ( prior->pose_center_.data() ), sizeof( Vec3 ) );
-                stream.write( reinterpret_cast<const char*> ( Vec3uc(0, 0, 255).data() ), sizeof( Vec3uc ) );
-              }
-            }
+            vertex_writer.write(prior->pose_center_, Vec3uc(0, 0, 255));
           }
         }
       }
+    }
 
-      if (b_structure)
+    if (b_structure)
+    {
+      // Export structure points as White points
+      const Landmarks & landmarks = sfm_data.GetLandmarks();
+      for ( const auto & iterLandmarks : landmarks )
       {
-        // Export structure points as White points
-        const Landmarks & landmarks = sfm_data.GetLandmarks();
-        for ( const auto & iterLandmarks : landmarks )
-        {
-          if (b_write_in_ascii)
-          {
-            stream
-              << iterLandmarks.second.X(0) << ' '
-              << iterLandmarks.second.X(1) << ' '
-              << iterLandmarks.second.X(2) << ' '
-              << "255 255 255\n";
-          }
-          else
-          {
-            stream.write( reinterpret_cast<const char*> ( iterLandmarks.second.X.data() ), sizeof( Vec3 ) );
-            stream.write( reinterpret_cast<const char*> ( Vec3uc(255, 255, 255).data() ), sizeof( Vec3uc ) );
-          }
-        }
+        vertex_writer.write(iterLandmarks.second.X, Vec3uc(255, 255, 255));
       }
+    }
 
-      if (b_control_points)
+    if (b_control_points)
+    {
+      // Export GCP as Red points
+      const Landmarks & landmarks = sfm_data.GetControl_Points();
+      for ( const auto & iterGCP : landmarks )
       {
-        // Export GCP as Red points
-        const Landmarks & landmarks = sfm_data.GetControl_Points();
-        for ( const auto & iterGCP : landmarks )
-        {
-          if (b_write_in_ascii)
-          {
-            stream
-              << iterGCP.second.X(0) << ' '
-              << iterGCP.second.X(1) << ' '
-              << iterGCP.second.X(2) << ' '
-              << "255 0 0\n";
-          }
-          else
-          {
-            stream.write( reinterpret_cast<const char*> ( iterGCP.second.X.data() ), sizeof( Vec3 ) );
-            stream.write( reinterpret_cast<const char*> ( Vec3uc(255, 255, 255).data() ), sizeof( Vec3uc ) );
-          }
-        }
+        vertex_writer.write(iterGCP.second.X, Vec3uc(255, 0, 0));
       }
+    }
 
-      stream.flush();
-      bOk = stream.good();
-      stream.close();
+    vertex_writer.flush();
+    stream.flush();
+    bOk = stream.good();
+    stream.close();
   }
   return bOk;
 }
 
+/// Load the vertices of an ASCII/BIN PLY file as the SfM_Data structure
+/// (landmarks without observations, indexed in the file order).
+inline bool Load_PLY
+(
+  SfM_Data & sfm_data,
+  const std::string & filename,
+  ESfM_Data flags_part
+)
+{
+  std::vector<Vec3> vec_points;
+  if (!ReadPlyVertices(filename, vec_points))
+    return false;
+
+  if ((flags_part & STRUCTURE) == STRUCTURE)
+  {
+    Landmarks & landmarks = sfm_data.structure;
+    for (size_t i = 0; i < vec_points.size(); ++i)
+    {
+      landmarks[static_cast<IndexT>(i)].X = vec_points[i];
+    }
+  }
+  return true;
+}
+
 } // namespace sfm
 } // namespace openMVG
 
@@ -9,11 +9,13 @@
 #include "openMVG/cameras/Camera_Pinhole.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "openMVG/sfm/sfm_data_io_ply.hpp"
 #include "openMVG/cameras/Camera_Intrinsics.hpp"
 
 #include "testing/testing.h"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <algorithm>
 #include <sstream>
 
 using namespace openMVG;
@@ -180,6 +182,54 @@ TEST(SfM_Data_IO, SAVE_PLY) {
   }
 }
 
+TEST(SfM_Data_IO, SAVE_LOAD_PLY) {
+
+  SfM_Data sfm_data = create_test_scene(2, true);
+  // Add enough landmarks to use several chunks
+  for (IndexT i = 1; i < 100000; ++i)
+  {
+    sfm_data.structure[i].X = Vec3(i, -0.5 * i, 1.0 / i);
+  }
+
+  for (const bool b_write_in_ascii : {false, true})
+  {
+    const std::string filename = "SAVE_LOAD_PLY.ply";
+    std::cout << "Testing:" << filename << (b_write_in_ascii ? " (ascii)" : " (binary)") << std::endl;
+
+    EXPECT_TRUE( Save_PLY(sfm_data, filename, ESfM_Data(EXTRINSICS | STRUCTURE), b_write_in_ascii) );
+
+    // Vertices: 2 camera centers (green) then the landmarks (white)
+    std::vector<Vec3> vec_points;
+    std::vector<Vec3uc> vec_colors;
+    EXPECT_TRUE( ReadPlyVertices(filename, vec_points, &vec_colors) );
+    EXPECT_EQ( 2 + sfm_data.structure.size(), vec_points.size() );
+    EXPECT_EQ( vec_points.size(), vec_colors.size() );
+    EXPECT_TRUE( Vec3uc(0, 255, 0) == vec_colors[0] );
+    EXPECT_TRUE( Vec3uc(255, 255, 255) == vec_colors[2] );
+    double max_error = 0.0;
+    IndexT i = 2;
+    for (const auto & landmark_it : sfm_data.structure)
+    {
+      max_error = std::max(max_error, (landmark_it.second.X - vec_points[i++]).norm());
+    }
+    if (b_write_in_ascii)
+    {
+      EXPECT_NEAR( 0.0, max_error, 1e-10 );
+    }
+    else
+    {
+      EXPECT_EQ( 0.0, max_error );
+    }
+
+    // Load the vertices as SfM_Data structure
+    SfM_Data sfm_data_load;
+    EXPECT_TRUE( Load(sfm_data_load, filename, ESfM_Data(ALL)) );
+    EXPECT_EQ( vec_points.size(), sfm_data_load.structure.size() );
+    EXPECT_MATRIX_NEAR( Vec3(11,22,33), sfm_data_load.structure.at(2).X, 1e-10 );
+    EXPECT_TRUE( stlplus::file_delete(filename) );
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
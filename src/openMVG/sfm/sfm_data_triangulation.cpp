@@ -8,7 +8,9 @@
 
 #include "openMVG/sfm/sfm_data_triangulation.hpp"
 
-#include <deque>
+#include <algorithm>
+#include <numeric>
+#include <vector>
 
 #include "openMVG/geometry/pose3.hpp"
 #include "openMVG/multiview/triangulation_nview.hpp"
@@ -40,30 +42,95 @@ SfM_Data_Structure_Computation_Blind::SfM_Data_Structure_Computation_Blind
 {
 }
 
+namespace {
+
+/// Data of a posed view used by the triangulation
+/// (computed once for all the tracks)
+struct View_Triangulation_Data
+{
+  const IntrinsicBase * intrinsic;
+  const Pose3 * pose;
+  Mat34 P;
+};
+
+/// Triangulation data of all the views that have a valid pose & intrinsic
+class Views_Triangulation_Data
+{
+public:
+  explicit Views_Triangulation_Data(const SfM_Data & sfm_data)
+  {
+    for (const auto & view_it : sfm_data.GetViews())
+    {
+      const View * view = view_it.second.get();
+      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
+        continue;
+      const IntrinsicBase * intrinsic = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
+      const Pose3 & pose = sfm_data.GetPoses().at(view->id_pose);
+      map_view_index_[view_it.first] = views_.size();
+      views_.push_back({intrinsic, &pose, intrinsic->get_projective_equivalent(pose)});
+    }
+  }
+
+  /// Return nullptr if the view cannot be used for triangulation
+  const View_Triangulation_Data * get(const IndexT view_id) const
+  {
+    const auto it = map_view_index_.find(view_id);
+    return (it == map_view_index_.end()) ? nullptr : &views_[it->second];
+  }
+
+private:
+  std::vector<View_Triangulation_Data,
+    Eigen::aligned_allocator<View_Triangulation_Data>> views_;
+  Hash_Map<IndexT, IndexT> map_view_index_;
+};
+
+/// A track observation with its precomputed triangulation data
+struct Track_Observation
+{
+  IndexT view_id;
+  const Observation * observation;
+  const View_Triangulation_Data * view;
+  Vec2 ud_x; // undistorted observation (computed once)
+};
+using Track_Observations =
+  std::vector<Track_Observation, Eigen::aligned_allocator<Track_Observation>>;
+
+/// Collect the observations that can be used for triangulation
+/// (the output buffer is reused between the tracks)
+void GatherTrackObservations
+(
+  const Views_Triangulation_Data & views_data,
+  const Observations & obs,
+  Track_Observations & track
+)
+{
+  track.clear();
+  for (const auto & obs_it : obs)
+  {
+    const View_Triangulation_Data * view = views_data.get(obs_it.first);
+    if (view == nullptr)
+      continue;
+    track.push_back(
+      {obs_it.first, &obs_it.second, view, view->intrinsic->get_ud_pixel(obs_it.second.x)});
+  }
+}
+
 /// Triangulate a given track from a selection of observations
+template <typename SampleIndexes>
 bool track_sample_triangulation
 (
-  const SfM_Data & sfm_data,
-  const Observations & obs,
-  const std::set<IndexT> & samples,
+  const Track_Observations & track,
+  const SampleIndexes & samples,
+  Triangulation & trian_obj,
   Vec3 & X
 )
 {
-  if (samples.size() >= 2 && obs.size() >= 2)
+  trian_obj.clear();
+  if (samples.size() >= 2 && track.size() >= 2)
   {
-    Triangulation trian_obj;
-    for (const auto& idx : samples)
+    for (const auto & idx : samples)
     {
-      Observations::const_iterator itObs = obs.begin();
-      std::advance(itObs, idx);
-      const View * view = sfm_data.views.at(itObs->first).get();
-      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-        continue;
-      const IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
-      const Pose3 pose = sfm_data.GetPoseOrDie(view);
-      trian_obj.add(
-        cam->get_projective_equivalent(pose),
-        cam->get_ud_pixel(itObs->second.x));
+      trian_obj.add(track[idx].view->P, track[idx].ud_x);
     }
     if (trian_obj.size() >= 2)
     {
@@ -74,6 +141,157 @@ bool track_sample_triangulation
   return false;
 }
 
+/// Test the validity of a 3D point hypothesis for the given observations:
+/// - chierality
+/// - residual error
+template <typename SampleIndexes>
+IndexT count_valid_samples
+(
+  const Track_Observations & track,
+  const SampleIndexes & samples,
+  const Vec3 & X,
+  const double dSquared_pixel_threshold
+)
+{
+  IndexT validity_test_count = 0;
+  for (const auto & idx : samples)
+  {
+    const Track_Observation & track_obs = track[idx];
+    const double z = track_obs.view->pose->depth(X);
+    const Vec2 residual =
+      track_obs.view->intrinsic->residual(*track_obs.view->pose, X, track_obs.observation->x);
+    if (z <= 0 || residual.squaredNorm() >= dSquared_pixel_threshold)
+      return 0;
+    ++validity_test_count;
+  }
+  return validity_test_count;
+}
+
+/// Robustly try to estimate the best 3D point using a ransac Scheme
+bool robust_track_triangulation
+(
+  const Track_Observations & track,
+  const double max_reprojection_error,
+  const IndexT min_required_inliers,
+  const IndexT min_sample_index,
+  Triangulation & trian_obj,
+  Landmark & landmark // X & valid observations
+)
+{
+  if (track.size() < min_required_inliers)
+  {
+    return false;
+  }
+
+  const double dSquared_pixel_threshold = Square(max_reprojection_error);
+
+  // Handle the case where all observations must be used
+  if (min_required_inliers == min_sample_index &&
+      track.size() == min_required_inliers)
+  {
+    std::vector<IndexT> samples(min_required_inliers);
+    std::iota(samples.begin(), samples.end(), 0);
+    // Generate the 3D point hypothesis by triangulating the observations
+    Vec3 X;
+    if (track_sample_triangulation(track, samples, trian_obj, X) &&
+        count_valid_samples(track, samples, X, dSquared_pixel_threshold) >= min_required_inliers)
+    {
+      landmark.X = X;
+      landmark.obs.clear();
+      for (const Track_Observation & track_obs : track)
+        landmark.obs[track_obs.view_id] = *track_obs.observation;
+      return true;
+    }
+    return false;
+  }
+
+  // We must perform a robust estimation
+  // - There is more observations than the minimal number of required sample
+  if (track.size() < min_sample_index)
+  {
+    return false;
+  }
+
+  const IndexT nbIter = track.size(); // TODO: automatic computation of the number of iterations?
+
+  // - Ransac variables
+  Vec3 best_model = Vec3::Zero();
+  std::vector<IndexT> best_inlier_set, inlier_set;
+  double best_error = std::numeric_limits<double>::max();
+
+  //--
+  // Random number generation
+  std::mt19937 random_generator(std::mt19937::default_seed);
+
+  // - Ransac loop
+  std::vector<uint32_t> vec_samples;
+  for (IndexT i = 0; i < nbIter; ++i)
+  {
+    robust::UniformSample(min_sample_index, track.size(), random_generator, &vec_samples);
+    std::sort(vec_samples.begin(), vec_samples.end());
+
+    // Hypothesis generation
+    Vec3 X;
+    if (!track_sample_triangulation(track, vec_samples, trian_obj, X))
+      continue;
+
+    // Test validity of the hypothesis
+    // - chierality (for the samples)
+    // - residual error
+    if (count_valid_samples(track, vec_samples, X, dSquared_pixel_threshold) < min_required_inliers)
+      continue;
+
+    inlier_set.clear();
+    double current_error = 0.0;
+    // inlier/outlier classification according pixel residual errors.
+    for (IndexT k = 0; k < track.size(); ++k)
+    {
+      const Track_Observation & track_obs = track[k];
+      const Vec2 residual =
+        track_obs.view->intrinsic->residual(*track_obs.view->pose, X, track_obs.observation->x);
+      const double residual_d = residual.squaredNorm();
+      if (residual_d < dSquared_pixel_threshold)
+      {
+        inlier_set.push_back(k);
+        current_error += residual_d;
+      }
+      else
+      {
+        current_error += dSquared_pixel_threshold;
+      }
+    }
+    // Does the hypothesis is the best one we have seen and have sufficient inliers.
+    if (current_error < best_error && inlier_set.size() >= min_required_inliers)
+    {
+      best_model = X;
+      best_inlier_set.swap(inlier_set);
+      best_error = current_error;
+    }
+  }
+  if (!best_inlier_set.empty() && best_inlier_set.size() >= min_required_inliers)
+  {
+    // Update information (3D landmark position & valid observations)
+    landmark.X = best_model;
+    landmark.obs.clear();
+    for (const IndexT k : best_inlier_set)
+    {
+      landmark.obs[track[k].view_id] = *track[k].observation;
+    }
+  }
+  return !best_inlier_set.empty();
+}
+
+/// List the tracks of the scene structure (for indexed parallel loops)
+std::vector<Landmarks::value_type *> ListTracks(Landmarks & structure)
+{
+  std::vector<Landmarks::value_type *> tracks;
+  tracks.reserve(structure.size());
+  for (auto & tracks_it : structure)
+    tracks.push_back(&tracks_it);
+  return tracks;
+}
+
+} // namespace
 
 void SfM_Data_Structure_Computation_Blind::triangulate
 (
@@ -81,67 +299,75 @@ void SfM_Data_Structure_Computation_Blind::triangulate
 )
 const
 {
-  std::deque<IndexT> rejectedId;
+  const Views_Triangulation_Data views_data(sfm_data);
+  const std::vector<Landmarks::value_type *> tracks = ListTracks(sfm_data.structure);
+  // The tracks are independent: each one writes only its own landmark and
+  // validity flag, the rejected tracks are erased once all are processed
+  std::vector<uint8_t> valid_tracks(tracks.size(), 0);
+
   std::unique_ptr<C_Progress> my_progress_bar;
   if (bConsole_verbose_)
     my_progress_bar.reset(
       new C_Progress_display(
-        sfm_data.structure.size(),
+        tracks.size(),
         std::cout,
         "Blind triangulation progress:\n" ));
 #ifdef OPENMVG_USE_OPENMP
   #pragma omp parallel
 #endif
-  for (auto& tracks_it :sfm_data.structure)
   {
+    // Per thread buffers
+    Track_Observations track;
+    Triangulation trian_obj;
+    std::vector<IndexT> samples;
+    unsigned long progress_count = 0;
 #ifdef OPENMVG_USE_OPENMP
-  #pragma omp single nowait
+    #pragma omp for schedule(dynamic, 256)
 #endif
+    for (int i = 0; i < static_cast<int>(tracks.size()); ++i)
     {
-      if (bConsole_verbose_)
+      if (bConsole_verbose_ && ++progress_count == 1024)
       {
-        ++(*my_progress_bar);
+#ifdef OPENMVG_USE_OPENMP
+        #pragma omp critical
+#endif
+        *my_progress_bar += progress_count;
+        progress_count = 0;
       }
 
-      const Observations & obs = tracks_it.second.obs;
-      bool bKeep = false;
+      Landmark & landmark = tracks[i]->second;
+      // Generate the track 3D hypothesis from all the observations
+      GatherTrackObservations(views_data, landmark.obs, track);
+      samples.resize(track.size());
+      std::iota(samples.begin(), samples.end(), 0);
+      Vec3 X;
+      if (track_sample_triangulation(track, samples, trian_obj, X))
       {
-        // Generate the track 3D hypothesis
-        std::set<IndexT> samples;
-        for (int i = 0; i < obs.size(); ++i)  { samples.insert(i); }
-        Vec3 X;
-        if (track_sample_triangulation(sfm_data, obs, samples, X))
+        bool bChierality = true;
+        for (Track_Observations::const_iterator track_it = track.begin();
+          track_it != track.end() && bChierality; ++track_it)
         {
-          bool bChierality = true;
-          for (Observations::const_iterator obs_it = obs.begin();
-            obs_it != obs.end() && bChierality; ++obs_it)
-          {
-            const View * view = sfm_data.views.at(obs_it->first).get();
-            const Pose3 pose = sfm_data.GetPoseOrDie(view);
-            const double z = pose.depth(X);
-            bChierality &= z > 0;
-          }
-
-          if (bChierality) // Keep the point only if it have a positive depth
-          {
-            tracks_it.second.X = X;
-            bKeep = true;
-          }
+          bChierality &= track_it->view->pose->depth(X) > 0;
+        }
+
+        if (bChierality) // Keep the point only if it have a positive depth
+        {
+          landmark.X = X;
+          valid_tracks[i] = 1;
         }
       }
-      if (!bKeep)
-      {
+    }
 #ifdef OPENMVG_USE_OPENMP
-        #pragma omp critical
+    #pragma omp critical
 #endif
-        rejectedId.push_front(tracks_it.first);
-      }
-    }
+    if (bConsole_verbose_)
+      *my_progress_bar += progress_count;
   }
   // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
+  for (size_t i = 0; i < tracks.size(); ++i)
   {
-    sfm_data.structure.erase(it);
+    if (!valid_tracks[i])
+      sfm_data.structure.erase(tracks[i]->first);
   }
 }
 
@@ -171,52 +397,66 @@ const
 /// Robust triangulation of track data contained in the structure
 /// All observations must have View with valid Intrinsic and Pose data
 /// Invalid landmark are removed.
+/// The tracks are processed in parallel, each one writes only its own landmark.
 void SfM_Data_Structure_Computation_Robust::robust_triangulation
 (
   SfM_Data & sfm_data
 )
 const
 {
-  std::deque<IndexT> rejectedId;
+  const Views_Triangulation_Data views_data(sfm_data);
+  const std::vector<Landmarks::value_type *> tracks = ListTracks(sfm_data.structure);
+  std::vector<uint8_t> valid_tracks(tracks.size(), 0);
+
   std::unique_ptr<C_Progress_display> my_progress_bar;
   if (bConsole_verbose_)
     my_progress_bar.reset(
       new C_Progress_display(
-        sfm_data.structure.size(),
+        tracks.size(),
         std::cout,
         "Robust triangulation progress:\n" ));
 #ifdef OPENMVG_USE_OPENMP
   #pragma omp parallel
 #endif
-  for (auto& tracks_it :sfm_data.structure)
   {
+    // Per thread buffers
+    Track_Observations track;
+    Triangulation trian_obj;
+    Landmark landmark;
+    unsigned long progress_count = 0;
 #ifdef OPENMVG_USE_OPENMP
-  #pragma omp single nowait
+    #pragma omp for schedule(dynamic, 256)
 #endif
+    for (int i = 0; i < static_cast<int>(tracks.size()); ++i)
     {
-      if (bConsole_verbose_)
-      {
-        ++(*my_progress_bar);
-      }
-      Landmark landmark;
-      if (robust_triangulation(sfm_data, tracks_it.second.obs, landmark))
-      {
-        tracks_it.second = landmark;
-      }
-      else
+      if (bConsole_verbose_ && ++progress_count == 1024)
       {
-        // Track must be deleted
 #ifdef OPENMVG_USE_OPENMP
         #pragma omp critical
 #endif
-        rejectedId.push_front(tracks_it.first);
+        *my_progress_bar += progress_count;
+        progress_count = 0;
+      }
+      GatherTrackObservations(views_data, tracks[i]->second.obs, track);
+      if (robust_track_triangulation(track, max_reprojection_error_,
+            min_required_inliers_, min_sample_index_, trian_obj, landmark))
+      {
+        tracks[i]->second.X = landmark.X;
+        tracks[i]->second.obs.swap(landmark.obs);
+        valid_tracks[i] = 1;
       }
     }
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
+    if (bConsole_verbose_)
+      *my_progress_bar += progress_count;
   }
   // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
+  for (size_t i = 0; i < tracks.size(); ++i)
   {
-    sfm_data.structure.erase(it);
+    if (!valid_tracks[i])
+      sfm_data.structure.erase(tracks[i]->first);
   }
 }
 
@@ -235,147 +475,26 @@ const
   {
     return false;
   }
-
-  const double dSquared_pixel_threshold = Square(max_reprojection_error_);
-
-  // Handle the case where all observations must be used
-  if (min_required_inliers_ == min_sample_index_ &&
-      obs.size() == min_required_inliers_)
-  {
-    std::set<IndexT> samples;
-    for (int i = 0; i < min_required_inliers_; ++i)  { samples.insert(i); }
-    // Generate the 3D point hypothesis by triangulating the observations
-    Vec3 X;
-    if (track_sample_triangulation(sfm_data, obs, samples, X))
-    {
-      // Test validity of the hypothesis:
-      // - residual error
-      // - chierality
-      bool bChierality = true;
-      bool bReprojection_error = true;
-      IndexT validity_test_count = 0;
-      for (std::set<IndexT>::const_iterator it = samples.begin();
-        it != samples.end() && bChierality && bReprojection_error; ++it)
-      {
-        Observations::const_iterator itObs = obs.begin();
-        std::advance(itObs, *it);
-        const View * view = sfm_data.views.at(itObs->first).get();
-        if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-          continue;
-        const IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
-        const Pose3 pose = sfm_data.GetPoseOrDie(view);
-        const double z = pose.depth(X);
-        bChierality &= z > 0;
-        const Vec2 residual = cam->residual(pose, X, itObs->second.x);
-        bReprojection_error &= residual.squaredNorm() < dSquared_pixel_threshold;
-        validity_test_count += (bChierality && bReprojection_error) ? 1 : 0;
-      }
-
-      if (bChierality && bReprojection_error &&
-          validity_test_count >= min_required_inliers_)
-      {
-        landmark.X = X;
-        landmark.obs = obs;
-        return true;
-      }
-    }
-    return false;
-  }
-
-  // We must perform a robust estimation
-  // - There is more observations than the minimal number of required sample
-
-  const IndexT nbIter = obs.size(); // TODO: automatic computation of the number of iterations?
-
-  // - Ransac variables
-  Vec3 best_model = Vec3::Zero();
-  std::deque<IndexT> best_inlier_set;
-  double best_error = std::numeric_limits<double>::max();
-
-  //--
-  // Random number generation
-  std::mt19937 random_generator(std::mt19937::default_seed);
-
-  // - Ransac loop
-  for (IndexT i = 0; i < nbIter; ++i)
+  // Collect only the data of the views used by this track
+  Track_Observations track;
+  track.reserve(obs.size());
+  std::vector<View_Triangulation_Data,
+    Eigen::aligned_allocator<View_Triangulation_Data>> views(obs.size());
+  for (const auto & obs_it : obs)
   {
-    std::vector<uint32_t> vec_samples;
-    robust::UniformSample(min_sample_index_, obs.size(), random_generator, &vec_samples);
-    const std::set<IndexT> samples(vec_samples.begin(), vec_samples.end());
-
-    // Hypothesis generation
-    Vec3 X;
-    if (!track_sample_triangulation(sfm_data, obs, samples, X))
+    const View * view = sfm_data.views.at(obs_it.first).get();
+    if (!sfm_data.IsPoseAndIntrinsicDefined(view))
       continue;
-
-    // Test validity of the hypothesis
-    // - chierality (for the samples)
-    // - residual error
-
-    bool bChierality = true;
-    bool bReprojection_error = true;
-    IndexT validity_test_count = 0;
-    for (std::set<IndexT>::const_iterator it = samples.begin();
-      it != samples.end() && bChierality && bReprojection_error; ++it)
-    {
-      Observations::const_iterator itObs = obs.begin();
-      std::advance(itObs, *it);
-      const View * view = sfm_data.views.at(itObs->first).get();
-      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-        continue;
-      const IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
-      const Pose3 pose = sfm_data.GetPoseOrDie(view);
-      const double z = pose.depth(X);
-      bChierality &= z > 0;
-      const Vec2 residual = cam->residual(pose, X, itObs->second.x);
-      bReprojection_error &= residual.squaredNorm() < dSquared_pixel_threshold;
-      validity_test_count += (bChierality && bReprojection_error) ? 1 : 0;
-    }
-
-    if (!bChierality || !bReprojection_error ||
-        validity_test_count < min_required_inliers_)
-      continue;
-
-    std::deque<IndexT> inlier_set;
-    double current_error = 0.0;
-    // inlier/outlier classification according pixel residual errors.
-    for (const auto & obs_it : obs)
-    {
-      const View * view = sfm_data.views.at(obs_it.first).get();
-      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-        continue;
-      const IntrinsicBase * intrinsic = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
-      const Pose3 pose = sfm_data.GetPoseOrDie(view);
-      const Vec2 residual = intrinsic->residual(pose, X, obs_it.second.x);
-      const double residual_d = residual.squaredNorm();
-      if (residual_d < dSquared_pixel_threshold)
-      {
-        inlier_set.push_front(obs_it.first);
-        current_error += residual_d;
-      }
-      else
-      {
-        current_error += dSquared_pixel_threshold;
-      }
-    }
-    // Does the hypothesis is the best one we have seen and have sufficient inliers.
-    if (current_error < best_error && inlier_set.size() >= min_required_inliers_)
-    {
-      best_model = X;
-      best_inlier_set = inlier_set;
-      best_error = current_error;
-    }
+    View_Triangulation_Data & view_data = views[track.size()];
+    view_data.intrinsic = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
+    view_data.pose = &sfm_data.GetPoses().at(view->id_pose);
+    view_data.P = view_data.intrinsic->get_projective_equivalent(*view_data.pose);
+    track.push_back(
+      {obs_it.first, &obs_it.second, &view_data, view_data.intrinsic->get_ud_pixel(obs_it.second.x)});
   }
-  if (!best_inlier_set.empty() && best_inlier_set.size() >= min_required_inliers_)
-  {
-    // Update information (3D landmark position & valid observations)
-    landmark.X = best_model;
-    for (const IndexT & val : best_inlier_set)
-    {
-      landmark.obs[val] = obs.at(val);
-    }
-  }
-  return !best_inlier_set.empty();
+  Triangulation trian_obj;
+  return robust_track_triangulation(track, max_reprojection_error_,
+    min_required_inliers_, min_sample_index_, trian_obj, landmark);
 }
 
 } // namespace sfm
@@ -0,0 +1,104 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "openMVG/multiview/test_data_sets.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_triangulation.hpp"
+
+#include "testing/testing.h"
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+// Create a SfM_Data scene from a synthetic dataset (tracks without 3D position)
+SfM_Data getInputScene(const NViewDataSet & d, const nViewDatasetConfigurator & config)
+{
+  SfM_Data sfm_data;
+  const int nviews = d._C.size();
+  const int npoints = d._X.cols();
+  for (int i = 0; i < nviews; ++i)
+  {
+    sfm_data.views[i] = std::make_shared<View>("", i, 0, i, config._cx * 2, config._cy * 2);
+    sfm_data.poses[i] = Pose3(d._R[i], d._C[i]);
+  }
+  sfm_data.intrinsics[0] = std::make_shared<Pinhole_Intrinsic>(
+    config._cx * 2, config._cy * 2, config._fx, config._cx, config._cy);
+  for (int i = 0; i < npoints; ++i)
+  {
+    Landmark landmark;
+    for (int j = 0; j < nviews; ++j)
+      landmark.obs[j] = Observation(d._x[j].col(i), i);
+    sfm_data.structure[i] = landmark;
+  }
+  return sfm_data;
+}
+
+TEST(SFM_DATA_TRIANGULATION, Blind)
+{
+  const int nviews = 6;
+  const int npoints = 512;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  SfM_Data sfm_data = getInputScene(d, config);
+  // A track observed by a view without pose is triangulated from the other views
+  sfm_data.poses.erase(nviews - 1);
+
+  SfM_Data_Structure_Computation_Blind structure_estimator;
+  structure_estimator.triangulate(sfm_data);
+
+  EXPECT_EQ(npoints, sfm_data.structure.size());
+  for (const auto & landmark_it : sfm_data.structure)
+  {
+    EXPECT_MATRIX_NEAR(d._X.col(landmark_it.first), landmark_it.second.X, 1e-6);
+  }
+}
+
+TEST(SFM_DATA_TRIANGULATION, Robust)
+{
+  const int nviews = 6;
+  const int npoints = 512;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  SfM_Data sfm_data = getInputScene(d, config);
+  // Add an outlier observation to every odd track
+  for (int i = 1; i < npoints; i += 2)
+    sfm_data.structure.at(i).obs.at(i % nviews).x += Vec2(50.0, -30.0);
+  // Keep only 2 observations for a track (not enough inliers)
+  Observations & short_track = sfm_data.structure.at(0).obs;
+  short_track.erase(short_track.begin(), std::next(short_track.begin(), nviews - 2));
+
+  SfM_Data_Structure_Computation_Robust structure_estimator;
+  structure_estimator.triangulate(sfm_data);
+
+  EXPECT_EQ(npoints - 1, sfm_data.structure.size());
+  for (const auto & landmark_it : sfm_data.structure)
+  {
+    const IndexT i = landmark_it.first;
+    EXPECT_MATRIX_NEAR(d._X.col(i), landmark_it.second.X, 1e-6);
+    // The outlier observation is removed from the track
+    EXPECT_EQ((i % 2) ? nviews - 1 : nviews, landmark_it.second.obs.size());
+    EXPECT_TRUE((i % 2) == 0 || landmark_it.second.obs.count(i % nviews) == 0);
+  }
+
+  // Single track interface
+  const SfM_Data scene = getInputScene(d, config);
+  const Landmark & track = scene.structure.at(1);
+  Landmark landmark;
+  EXPECT_TRUE(structure_estimator.robust_triangulation(sfm_data, track.obs, landmark));
+  EXPECT_MATRIX_NEAR(d._X.col(1), landmark.X, 1e-6);
+  EXPECT_EQ(nviews, landmark.obs.size());
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -8,6 +8,9 @@
 
 #include "openMVG/cameras/Camera_Intrinsics.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_utils.hpp"
+
+#include <algorithm>
 
 namespace openMVG {
 namespace sfm {
@@ -56,5 +59,75 @@ void GroupSharedIntrinsics(SfM_Data & sfm_data)
   }
 }
 
+std::map<IndexT, std::vector<IndexT>> ComputeViewCovisibility(const SfM_Data & sfm_data)
+{
+  // Contiguous view index of the observed views
+  Hash_Map<IndexT, IndexT> map_view_index;
+  std::vector<IndexT> vec_view_ids;
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+  {
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      if (map_view_index.insert({obs_it.first, vec_view_ids.size()}).second)
+        vec_view_ids.push_back(obs_it.first);
+    }
+  }
+
+  // Tracks as contiguous view index lists, and the tracks observed by each view
+  std::vector<size_t> track_offsets(1, 0);
+  std::vector<IndexT> track_views;
+  std::vector<std::vector<IndexT>> view_tracks(vec_view_ids.size());
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+  {
+    const IndexT track_index = track_offsets.size() - 1;
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      const IndexT view_index = map_view_index.at(obs_it.first);
+      track_views.push_back(view_index);
+      view_tracks[view_index].push_back(track_index);
+    }
+    track_offsets.push_back(track_views.size());
+  }
+
+  std::vector<std::vector<IndexT>> vec_covisibility(vec_view_ids.size());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    // Last view that has visited a view
+    std::vector<IndexT> visited(vec_view_ids.size(), UndefinedIndexT);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (int i = 0; i < static_cast<int>(vec_view_ids.size()); ++i)
+    {
+      const IndexT view_index = static_cast<IndexT>(i);
+      visited[view_index] = view_index;
+      std::vector<IndexT> & covisible_views = vec_covisibility[view_index];
+      for (const IndexT track_index : view_tracks[view_index])
+      {
+        for (size_t k = track_offsets[track_index]; k < track_offsets[track_index + 1]; ++k)
+        {
+          const IndexT other_view_index = track_views[k];
+          if (visited[other_view_index] != view_index)
+          {
+            visited[other_view_index] = view_index;
+            covisible_views.push_back(vec_view_ids[other_view_index]);
+          }
+        }
+      }
+      std::sort(covisible_views.begin(), covisible_views.end());
+    }
+  }
+
+  std::map<IndexT, std::vector<IndexT>> map_covisibility;
+  for (size_t i = 0; i < vec_view_ids.size(); ++i)
+  {
+    if (!vec_covisibility[i].empty())
+      map_covisibility[vec_view_ids[i]] = std::move(vec_covisibility[i]);
+  }
+  return map_covisibility;
+}
+
 } // namespace sfm
 } // namespace openMVG
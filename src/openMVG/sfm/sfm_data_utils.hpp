@@ -9,6 +9,11 @@
 #ifndef OPENMVG_SFM_SFM_DATA_UTILS_HPP
 #define OPENMVG_SFM_SFM_DATA_UTILS_HPP
 
+#include "openMVG/types.hpp"
+
+#include <map>
+#include <vector>
+
 namespace openMVG {
 namespace sfm {
 
@@ -20,6 +25,12 @@ struct SfM_Data;
 // - it allow to merge camera model that share common camera parameters & image sizes
 void GroupSharedIntrinsics(SfM_Data & sfm_data);
 
+// List for each view the views that share at least one landmark with it
+// (sorted view ids, the views without covisible view are not listed).
+// Each view visits the tracks it observes and marks the visited views,
+// so no pair set is built from the track observation pairs.
+std::map<IndexT, std::vector<IndexT>> ComputeViewCovisibility(const SfM_Data & sfm_data);
+
 } // namespace sfm
 } // namespace openMVG
 
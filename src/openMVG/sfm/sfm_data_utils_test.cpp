@@ -133,6 +133,31 @@ TEST(SfM_Data_IntrinsicGrouping, Grouping_Two_Different_Camera_Type)
   CHECK_EQUAL(2, map_viewCount_per_intrinsic_id[1].size());
 }
 
+// The covisibility must list the views that share a landmark (symmetric)
+TEST(SfM_Data_Covisibility, ComputeViewCovisibility)
+{
+  SfM_Data sfm_data;
+  CHECK_EQUAL(0, ComputeViewCovisibility(sfm_data).size());
+
+  // Tracks {0,1,2}, {2,5}, {1,2} and a single observation track {7}
+  const std::vector<std::vector<IndexT>> tracks = {{0, 1, 2}, {2, 5}, {1, 2}, {7}};
+  for (size_t i = 0; i < tracks.size(); ++i)
+  {
+    Landmark landmark;
+    for (const IndexT view_id : tracks[i])
+      landmark.obs[view_id] = Observation(Vec2::Zero(), i);
+    sfm_data.structure[i] = landmark;
+  }
+
+  const std::map<IndexT, std::vector<IndexT>> covisibility = ComputeViewCovisibility(sfm_data);
+  CHECK_EQUAL(4, covisibility.size());
+  CHECK(covisibility.at(0) == std::vector<IndexT>({1, 2}));
+  CHECK(covisibility.at(1) == std::vector<IndexT>({0, 2}));
+  CHECK(covisibility.at(2) == std::vector<IndexT>({0, 1, 5}));
+  CHECK(covisibility.at(5) == std::vector<IndexT>({2}));
+  CHECK_EQUAL(0, covisibility.count(7));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr); }
 /* ************************************************************************* */
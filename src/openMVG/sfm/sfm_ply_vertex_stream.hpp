@@ -0,0 +1,360 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_PLY_VERTEX_STREAM_HPP
+#define OPENMVG_SFM_SFM_PLY_VERTEX_STREAM_HPP
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace openMVG {
+namespace sfm {
+
+using Vec3uc = Eigen::Matrix<unsigned char, 3, 1>;
+
+/// Write the header of a PLY file of colored vertices
+/// (property double x,y,z & property uchar red,green,blue).
+inline void WritePlyHeader
+(
+  std::ostream & stream,
+  const size_t vertex_count,
+  const bool b_write_in_ascii
+)
+{
+  stream << "ply"
+    << '\n' << "format "
+            << (b_write_in_ascii ? "ascii 1.0" : "binary_little_endian 1.0")
+    << '\n' << "comment generated by OpenMVG"
+    << '\n' << "element vertex " << vertex_count
+    << '\n' << "property double x"
+    << '\n' << "property double y"
+    << '\n' << "property double z"
+    << '\n' << "property uchar red"
+    << '\n' << "property uchar green"
+    << '\n' << "property uchar blue"
+    << '\n' << "end_header" << std::endl;
+}
+
+/// Buffered writer of colored PLY vertices (to be used after WritePlyHeader).
+/// The vertices are stored in a chunk of bounded size, the chunk is encoded
+/// (ASCII formatting is done in parallel) and written with a single write.
+class Ply_Vertex_Writer
+{
+public:
+  Ply_Vertex_Writer
+  (
+    std::ostream & stream,
+    const bool b_write_in_ascii,
+    const size_t chunk_size = 1 << 16
+  ):
+    stream_(stream),
+    b_write_in_ascii_(b_write_in_ascii),
+    chunk_size_(std::max(chunk_size, size_t(1)))
+  {
+    points_.reserve(chunk_size_);
+    colors_.reserve(chunk_size_);
+  }
+
+  ~Ply_Vertex_Writer()
+  {
+    flush();
+  }
+
+  void write(const Vec3 & X, const Vec3uc & color)
+  {
+    points_.push_back(X);
+    colors_.push_back(color);
+    if (points_.size() == chunk_size_)
+      flush();
+  }
+
+  /// Write the buffered vertices, return the stream status
+  bool flush()
+  {
+    if (!points_.empty())
+    {
+      if (b_write_in_ascii_)
+        write_ascii();
+      else
+        write_binary();
+      points_.clear();
+      colors_.clear();
+    }
+    return stream_.good();
+  }
+
+private:
+  void write_binary()
+  {
+    const size_t vertex_size = sizeof(Vec3) + sizeof(Vec3uc);
+    buffer_.resize(points_.size() * vertex_size);
+    char * ptr = &buffer_[0];
+    for (size_t i = 0; i < points_.size(); ++i, ptr += vertex_size)
+    {
+      std::memcpy(ptr, points_[i].data(), sizeof(Vec3));
+      std::memcpy(ptr + sizeof(Vec3), colors_[i].data(), sizeof(Vec3uc));
+    }
+    stream_.write(&buffer_[0], buffer_.size());
+  }
+
+  void write_ascii()
+  {
+    // Formatting the values is the bottleneck: encode the chunk by blocks
+    // in parallel and write the blocks in order.
+    // ("%.16f" is the std::fixed, std::setprecision(16) formatting)
+    const int block_count = 16;
+    const size_t block_size = (points_.size() + block_count - 1) / block_count;
+    std::vector<std::string> blocks(block_count);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int b = 0; b < block_count; ++b)
+    {
+      const size_t begin = std::min(b * block_size, points_.size());
+      const size_t end = std::min(begin + block_size, points_.size());
+      char line[3 * (DBL_MAX_10_EXP + 20) + 16];
+      for (size_t i = begin; i < end; ++i)
+      {
+        const int length = std::snprintf(line, sizeof(line), "%.16f %.16f %.16f %d %d %d\n",
+          points_[i](0), points_[i](1), points_[i](2),
+          colors_[i](0), colors_[i](1), colors_[i](2));
+        blocks[b].append(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+      }
+    }
+    for (const std::string & block : blocks)
+    {
+      stream_.write(block.data(), block.size());
+    }
+  }
+
+  std::ostream & stream_;
+  const bool b_write_in_ascii_;
+  const size_t chunk_size_;
+  std::vector<Vec3> points_;
+  std::vector<Vec3uc> colors_;
+  std::vector<char> buffer_;
+};
+
+/// Read the vertex positions (and colors if any) of an ASCII/BIN PLY file.
+/// The vertex element must be the first element of the file.
+/// If the file has no color properties, the colors are set to white.
+inline bool ReadPlyVertices
+(
+  const std::string & filename,
+  std::vector<Vec3> & vec_points,
+  std::vector<Vec3uc> * vec_colors = nullptr
+)
+{
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+    return false;
+
+  // Parse the header
+  enum class EFormat { ASCII, BINARY_LITTLE_ENDIAN, BINARY_BIG_ENDIAN };
+  struct Property
+  {
+    char type; // 'i' signed int, 'u' unsigned int, 'f' floating point
+    size_t size;
+    size_t offset;
+  };
+  EFormat format = EFormat::ASCII;
+  size_t vertex_count = 0;
+  std::vector<Property> properties;
+  // Index of the x,y,z,red,green,blue properties
+  int property_index[6] = {-1, -1, -1, -1, -1, -1};
+  bool b_vertex_element = false;
+
+  std::string line;
+  if (!std::getline(stream, line) || line.compare(0, 3, "ply") != 0)
+    return false;
+  while (std::getline(stream, line))
+  {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    std::istringstream iss(line);
+    std::string keyword;
+    iss >> keyword;
+    if (keyword == "format")
+    {
+      std::string format_name;
+      iss >> format_name;
+      if (format_name == "ascii")
+        format = EFormat::ASCII;
+      else if (format_name == "binary_little_endian")
+        format = EFormat::BINARY_LITTLE_ENDIAN;
+      else if (format_name == "binary_big_endian")
+        format = EFormat::BINARY_BIG_ENDIAN;
+      else
+        return false;
+    }
+    else if (keyword == "element")
+    {
+      if (b_vertex_element)
+        break; // The following elements are not read
+      std::string name;
+      size_t count = 0;
+      iss >> name >> count;
+      if (name == "vertex")
+      {
+        b_vertex_element = true;
+        vertex_count = count;
+      }
+      else if (count > 0)
+      {
+        std::cerr << "PLY: unsupported element before the vertex element: " << name << std::endl;
+        return false;
+      }
+    }
+    else if (keyword == "property" && b_vertex_element)
+    {
+      std::string type, name;
+      iss >> type >> name;
+      Property property;
+      if (type == "char" || type == "int8") property = {'i', 1, 0};
+      else if (type == "uchar" || type == "uint8") property = {'u', 1, 0};
+      else if (type == "short" || type == "int16") property = {'i', 2, 0};
+      else if (type == "ushort" || type == "uint16") property = {'u', 2, 0};
+      else if (type == "int" || type == "int32") property = {'i', 4, 0};
+      else if (type == "uint" || type == "uint32") property = {'u', 4, 0};
+      else if (type == "float" || type == "float32") property = {'f', 4, 0};
+      else if (type == "double" || type == "float64") property = {'f', 8, 0};
+      else
+      {
+        std::cerr << "PLY: unsupported vertex property type: " << type << std::endl;
+        return false;
+      }
+      property.offset = properties.empty() ? 0 : properties.back().offset + properties.back().size;
+      const char * names[6] = {"x", "y", "z", "red", "green", "blue"};
+      for (int i = 0; i < 6; ++i)
+        if (name == names[i])
+          property_index[i] = static_cast<int>(properties.size());
+      properties.push_back(property);
+    }
+    else if (keyword == "end_header")
+      break;
+  }
+  // Skip the remaining header lines (elements after the vertex element)
+  while (line.compare(0, 10, "end_header") != 0)
+  {
+    if (!std::getline(stream, line))
+      return false;
+  }
+  if (!b_vertex_element ||
+      property_index[0] < 0 || property_index[1] < 0 || property_index[2] < 0)
+    return false;
+
+  const bool b_color = property_index[3] >= 0 && property_index[4] >= 0 && property_index[5] >= 0;
+  vec_points.resize(vertex_count);
+  if (vec_colors)
+    vec_colors->assign(vertex_count, Vec3uc(255, 255, 255));
+
+  if (format == EFormat::ASCII)
+  {
+    std::vector<double> values(properties.size());
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+      if (!std::getline(stream, line))
+        return false;
+      const char * ptr = line.c_str();
+      for (double & value : values)
+      {
+        char * end = nullptr;
+        value = std::strtod(ptr, &end);
+        if (end == ptr)
+          return false;
+        ptr = end;
+      }
+      vec_points[i] << values[property_index[0]], values[property_index[1]], values[property_index[2]];
+      if (vec_colors && b_color)
+        (*vec_colors)[i] <<
+          static_cast<unsigned char>(values[property_index[3]]),
+          static_cast<unsigned char>(values[property_index[4]]),
+          static_cast<unsigned char>(values[property_index[5]]);
+    }
+  }
+  else
+  {
+    // Read the vertices by chunks
+    const bool b_swap_bytes = (format == EFormat::BINARY_BIG_ENDIAN);
+    const size_t vertex_size = properties.back().offset + properties.back().size;
+    const size_t chunk_size = 1 << 16;
+    std::vector<char> buffer(chunk_size * vertex_size);
+
+    const auto decode = [&](const char * vertex, const int index) -> double
+    {
+      const Property & property = properties[index];
+      unsigned char bytes[8];
+      std::memcpy(bytes, vertex + property.offset, property.size);
+      if (b_swap_bytes)
+        std::reverse(bytes, bytes + property.size);
+      switch (property.type)
+      {
+        case 'i':
+        {
+          switch (property.size)
+          {
+            case 1: { int8_t v; std::memcpy(&v, bytes, 1); return v; }
+            case 2: { int16_t v; std::memcpy(&v, bytes, 2); return v; }
+            default: { int32_t v; std::memcpy(&v, bytes, 4); return v; }
+          }
+        }
+        case 'u':
+        {
+          switch (property.size)
+          {
+            case 1: { uint8_t v; std::memcpy(&v, bytes, 1); return v; }
+            case 2: { uint16_t v; std::memcpy(&v, bytes, 2); return v; }
+            default: { uint32_t v; std::memcpy(&v, bytes, 4); return v; }
+          }
+        }
+        default:
+        {
+          if (property.size == 4) { float v; std::memcpy(&v, bytes, 4); return v; }
+          double v; std::memcpy(&v, bytes, 8); return v;
+        }
+      }
+    };
+
+    for (size_t first = 0; first < vertex_count; first += chunk_size)
+    {
+      const size_t count = std::min(chunk_size, vertex_count - first);
+      if (!stream.read(&buffer[0], count * vertex_size))
+        return false;
+      for (size_t i = 0; i < count; ++i)
+      {
+        const char * vertex = &buffer[i * vertex_size];
+        vec_points[first + i] <<
+          decode(vertex, property_index[0]),
+          decode(vertex, property_index[1]),
+          decode(vertex, property_index[2]);
+        if (vec_colors && b_color)
+          (*vec_colors)[first + i] <<
+            static_cast<unsigned char>(decode(vertex, property_index[3])),
+            static_cast<unsigned char>(decode(vertex, property_index[4])),
+            static_cast<unsigned char>(decode(vertex, property_index[5]));
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_PLY_VERTEX_STREAM_HPP
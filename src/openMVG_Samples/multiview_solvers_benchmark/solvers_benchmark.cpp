@@ -0,0 +1,131 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2017 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Throughput of the minimal solvers used in the robust estimation loops.
+// Run it on two versions of the library to compare them.
+
+#include "openMVG/multiview/solver_essential_kernel.hpp"
+#include "openMVG/multiview/solver_fundamental_kernel.hpp"
+#include "openMVG/multiview/solver_resection_p3p_ke.hpp"
+#include "openMVG/multiview/solver_resection_p3p_kneip.hpp"
+#include "openMVG/numeric/extract_columns.hpp"
+#include "openMVG/numeric/numeric.h"
+#include "openMVG/robust_estimation/rand_sampling.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace openMVG;
+
+// Random 3D points seen by two cameras (normalized camera coordinates)
+struct Scene
+{
+  Mat X;          // 3D points
+  Mat x1, x2;     // Projections in the two views
+  Mat bearing2;   // Unit bearing vectors of the second view
+};
+
+Scene MakeScene(const int nb_points, std::mt19937 & random_generator)
+{
+  std::uniform_real_distribution<double> dist_xy(-2.0, 2.0), dist_z(4.0, 8.0);
+  const Mat3 R = RotationAroundY(0.15) * RotationAroundX(0.05);
+  const Vec3 t(-1.0, 0.1, 0.2);
+
+  Scene scene;
+  scene.X.resize(3, nb_points);
+  scene.x1.resize(2, nb_points);
+  scene.x2.resize(2, nb_points);
+  scene.bearing2.resize(3, nb_points);
+  for (int i = 0; i < nb_points; ++i)
+  {
+    const Vec3 X(dist_xy(random_generator), dist_xy(random_generator), dist_z(random_generator));
+    const Vec3 X2 = R * X + t;
+    scene.X.col(i) = X;
+    scene.x1.col(i) = X.hnormalized();
+    scene.x2.col(i) = X2.hnormalized();
+    scene.bearing2.col(i) = X2.normalized();
+  }
+  return scene;
+}
+
+// Run the solver on random minimal samples and display its throughput
+template <typename SolverT, typename ModelT>
+void Benchmark
+(
+  const std::string & name,
+  const Mat & a,
+  const Mat & b,
+  const int nb_iterations,
+  std::mt19937 & random_generator
+)
+{
+  // Prepare a pool of random minimal samples of distinct points (outside of the timing)
+  const int nb_samples = 1000;
+  std::vector<uint32_t> sample;
+  std::vector<Mat> a_samples, b_samples;
+  for (int i = 0; i < nb_samples; ++i)
+  {
+    robust::UniformSample(SolverT::MINIMUM_SAMPLES, a.cols(), random_generator, &sample);
+    a_samples.push_back(ExtractColumns(a, sample));
+    b_samples.push_back(ExtractColumns(b, sample));
+  }
+
+  std::vector<ModelT> models;
+  size_t nb_models = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int iter = 0; iter < nb_iterations; ++iter)
+  {
+    models.clear();
+    SolverT::Solve(a_samples[iter % nb_samples], b_samples[iter % nb_samples], &models);
+    nb_models += models.size();
+  }
+  const double elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+
+  std::cout
+    << std::left << std::setw(24) << name << std::right
+    << std::setw(12) << std::fixed << std::setprecision(2)
+    << 1e6 * elapsed / nb_iterations << " us/solve"
+    << std::setw(14) << std::setprecision(0)
+    << nb_iterations / elapsed << " solves/s"
+    << std::setw(10) << std::setprecision(2)
+    << static_cast<double>(nb_models) / nb_iterations << " models/solve"
+    << std::endl;
+}
+
+int main(int argc, char ** argv)
+{
+  const int nb_iterations = (argc > 1) ? std::atoi(argv[1]) : 100000;
+  if (nb_iterations <= 0)
+  {
+    std::cerr << "Usage: " << argv[0] << " [nb_iterations]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  const Scene scene = MakeScene(1000, random_generator);
+
+  std::cout << "Minimal solvers throughput (" << nb_iterations << " random samples)" << std::endl;
+  Benchmark<fundamental::kernel::SevenPointSolver, Mat3>
+    ("Fundamental 7pt", scene.x1, scene.x2, nb_iterations, random_generator);
+  Benchmark<fundamental::kernel::EightPointSolver, Mat3>
+    ("Fundamental 8pt", scene.x1, scene.x2, nb_iterations, random_generator);
+  Benchmark<essential::kernel::FivePointSolver, Mat3>
+    ("Essential 5pt", scene.x1, scene.x2, nb_iterations, random_generator);
+  Benchmark<euclidean_resection::P3PSolver_Kneip, Mat34>
+    ("P3P Kneip", scene.bearing2, scene.X, nb_iterations, random_generator);
+  Benchmark<euclidean_resection::P3PSolver_Ke, Mat34>
+    ("P3P Ke", scene.bearing2, scene.X, nb_iterations, random_generator);
+
+  return EXIT_SUCCESS;
+}
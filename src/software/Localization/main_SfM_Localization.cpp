@@ -23,6 +23,7 @@ using namespace openMVG::sfm;
 
 #include "nonFree/sift/SIFT_describer_io.hpp"
 #include "openMVG/features/image_describer_akaze_io.hpp"
+#include "openMVG/features/image_describer_compressed_io.hpp"
 
 #include "third_party/cmdLine/cmdLine.h"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
@@ -66,6 +67,10 @@ int main(int argc, char **argv)
   double dMaxResidualError = std::numeric_limits<double>::infinity();
   bool bUseSingleIntrinsics = false;
   bool bExportStructure = false;
+  bool bProgressive_sampling = false;
+  bool bLast_pose_prior = false;
+  std::string sNearestMatchingMethod = "ANNL2";
+  matching::HNSW_Params hnsw_params;
 
 #ifdef OPENMVG_USE_OPENMP
   int iNumThreads = 0;
@@ -79,6 +84,12 @@ int main(int argc, char **argv)
   cmd.add( make_option('r', dMaxResidualError, "residual_error"));
   cmd.add( make_switch('s', "single_intrinsics"));
   cmd.add( make_switch('e', "export_structure"));
+  cmd.add( make_switch('p', "progressive_sampling"));
+  cmd.add( make_switch('l', "last_pose_prior"));
+  cmd.add( make_option('t', sNearestMatchingMethod, "nearest_matching_method"));
+  cmd.add( make_option('M', hnsw_params.M, "hnsw_M"));
+  cmd.add( make_option('C', hnsw_params.ef_construction, "hnsw_ef_construction"));
+  cmd.add( make_option('E', hnsw_params.ef_search, "hnsw_ef_search"));
 #ifdef OPENMVG_USE_OPENMP
   cmd.add( make_option('n', iNumThreads, "numThreads") );
 #endif
@@ -105,6 +116,18 @@ int main(int argc, char **argv)
     << "  (OFF by default)\n"
     << "[-e|--export_structure] (switch) when switched on, the program will also export structure to output sfm_data.\n"
     << "  if OFF only VIEWS, INTRINSICS and EXTRINSICS are exported (OFF by default)\n"
+    << "[-p|--progressive_sampling] (switch) when switched on, the resection samples are drawn\n"
+    << "  among the best 2D-3D matches first (PROSAC) (OFF by default)\n"
+    << "[-l|--last_pose_prior] (switch) when switched on, the query images are localized in sequence\n"
+    << "  and the 2D-3D matches are first searched among the landmarks seen by the scene views\n"
+    << "  close to the last found pose (i.e. video frames) (OFF by default)\n"
+    << "[-t|--nearest_matching_method] 2D-3D descriptor matching method\n"
+    << "  ANNL2: (default) L2 Approximate Nearest Neighbor matching,\n"
+    << "  HNSWL2: L2 Hierarchical Navigable Small World graph matching,\n"
+    << "  PQL2: L2 Product Quantization matching (for regions computed with --quantize PQ).\n"
+    << "[-M|--hnsw_M] HNSWL2: number of links per graph node (default 16)\n"
+    << "[-C|--hnsw_ef_construction] HNSWL2: candidate list size used to build the graph (default 100)\n"
+    << "[-E|--hnsw_ef_search] HNSWL2: candidate list size used for the queries (default 64)\n"
 #ifdef OPENMVG_USE_OPENMP
     << "[-n|--numThreads] number of thread(s)\n"
 #endif
@@ -136,6 +159,23 @@ int main(int argc, char **argv)
 
   bUseSingleIntrinsics = cmd.used('s');
   bExportStructure = cmd.used('e');
+  bProgressive_sampling = cmd.used('p');
+  bLast_pose_prior = cmd.used('l');
+
+  matching::EMatcherType matcher_type = matching::ANN_L2;
+  if (sNearestMatchingMethod == "HNSWL2")
+  {
+    matcher_type = matching::HNSW_L2;
+  }
+  else if (sNearestMatchingMethod == "PQL2")
+  {
+    matcher_type = matching::PRODUCT_QUANTIZATION_L2;
+  }
+  else if (sNearestMatchingMethod != "ANNL2")
+  {
+    std::cerr << "Unknown nearest matching method: " << sNearestMatchingMethod << std::endl;
+    return EXIT_FAILURE;
+  }
   // ---------------
   // Initialization
   // ---------------
@@ -218,7 +258,7 @@ int main(int argc, char **argv)
 
   std::vector<Vec3> vec_found_poses;
 
-  sfm::SfM_Localization_Single_3DTrackObservation_Database localizer;
+  sfm::SfM_Localization_Single_3DTrackObservation_Database localizer(matcher_type, hnsw_params);
   if (!localizer.Init(sfm_data, *regions_provider.get()))
   {
     std::cerr << "Cannot initialize the SfM localizer" << std::endl;
@@ -279,10 +319,14 @@ int main(int argc, char **argv)
 
   int total_num_images = 0;
 
+  // Pose prior used for the next image (last found pose)
+  sfm::Localization_Prior localization_prior;
+
 #ifdef OPENMVG_USE_OPENMP
   const unsigned int nb_max_thread = (iNumThreads == 0) ? 0 : omp_get_max_threads();
     omp_set_num_threads(nb_max_thread);
-    #pragma omp parallel for schedule(dynamic)
+    // the last pose prior requires to process the images in order
+    #pragma omp parallel for schedule(dynamic) if(!bLast_pose_prior)
 #endif
   for (int i = 0; i < static_cast<int>(vec_image_new.size()); ++i)
   {
@@ -355,17 +399,32 @@ int main(int argc, char **argv)
     geometry::Pose3 pose;
     sfm::Image_Localizer_Match_Data matching_data;
     matching_data.error_max = dMaxResidualError;
+    if (bProgressive_sampling)
+      matching_data.sampling = robust::ACRANSAC_SAMPLING::PROGRESSIVE;
 
     bool bSuccessfulLocalization = false;
 
+    const resection::SolverType solver_type = optional_intrinsic ?
+      resection::SolverType::P3P_KE_CVPR17 : resection::SolverType::DLT_6POINTS;
+
     // Try to localize the image in the database thanks to its regions
-    if (!localizer.Localize(
-      optional_intrinsic ? resection::SolverType::P3P_KE_CVPR17 : resection::SolverType::DLT_6POINTS,
-      {imageGray.Width(), imageGray.Height()},
-      optional_intrinsic.get(),
-      *(query_regions.get()),
-      pose,
-      &matching_data))
+    const bool bLocalized = (bLast_pose_prior && localization_prior.b_use_pose) ?
+      localizer.Localize(
+        solver_type,
+        {imageGray.Width(), imageGray.Height()},
+        optional_intrinsic.get(),
+        *(query_regions.get()),
+        localization_prior,
+        pose,
+        &matching_data)
+      : localizer.Localize(
+        solver_type,
+        {imageGray.Width(), imageGray.Height()},
+        optional_intrinsic.get(),
+        *(query_regions.get()),
+        pose,
+        &matching_data);
+    if (!bLocalized)
     {
       std::cerr << "Cannot locate the image " << *iter_image << std::endl;
       bSuccessfulLocalization = false;
@@ -401,6 +460,11 @@ int main(int argc, char **argv)
 
       bSuccessfulLocalization = true;
 
+      if (bLast_pose_prior)
+      {
+        localization_prior.b_use_pose = true;
+        localization_prior.pose = pose;
+      }
     }
 #ifdef OPENMVG_USE_OPENMP
     #pragma omp critical
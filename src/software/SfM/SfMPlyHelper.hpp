@@ -10,9 +10,9 @@
 #define OPENMVG_SFM_PLY_HELPER_H
 
 #include "openMVG/numeric/numeric.h"
+#include "openMVG/sfm/sfm_ply_vertex_stream.hpp"
 
 #include <fstream>
-#include <iomanip>
 #include <string>
 #include <vector>
 
@@ -28,32 +28,18 @@ exportToPly
   const std::string & sFileName
 )
 {
-  std::ofstream outfile(sFileName.c_str());
+  std::ofstream outfile(sFileName.c_str(), std::ios::out | std::ios::binary);
   if (!outfile.is_open())
     return false;
 
-  outfile << "ply"
-    << std::endl << "format ascii 1.0"
-    << std::endl << "element vertex " << vec_points.size()
-    << std::endl << "property double x"
-    << std::endl << "property double y"
-    << std::endl << "property double z"
-    << std::endl << "property uchar red"
-    << std::endl << "property uchar green"
-    << std::endl << "property uchar blue"
-    << std::endl << "end_header" << std::endl;
-
-  outfile << std::fixed << std::setprecision (std::numeric_limits<double>::digits10 + 1);
+  sfm::WritePlyHeader(outfile, vec_points.size(), true);
 
+  sfm::Ply_Vertex_Writer vertex_writer(outfile, true);
   for (size_t i=0; i < vec_points.size(); ++i)
   {
-    outfile
-      << vec_points[i](0) << ' '
-      << vec_points[i](1) << ' '
-      << vec_points[i](2) << ' '
-      << "255 255 255" << "\n";
+    vertex_writer.write(vec_points[i], sfm::Vec3uc(255, 255, 255));
   }
-  const bool bOk = outfile.good();
+  const bool bOk = vertex_writer.flush();
   outfile.close();
   return bOk;
 }
@@ -67,50 +53,24 @@ inline bool exportToPly
   const std::vector<Vec3> * vec_coloredPoints = nullptr
 )
 {
-  std::ofstream outfile(sFileName.c_str());
+  std::ofstream outfile(sFileName.c_str(), std::ios::out | std::ios::binary);
   if (!outfile.is_open())
     return false;
 
-  outfile << "ply"
-    << '\n' << "format ascii 1.0"
-    << '\n' << "element vertex " << vec_points.size()+vec_camPos.size()
-    << '\n' << "property double x"
-    << '\n' << "property double y"
-    << '\n' << "property double z"
-    << '\n' << "property uchar red"
-    << '\n' << "property uchar green"
-    << '\n' << "property uchar blue"
-    << '\n' << "end_header" << std::endl;
-
-  outfile << std::fixed << std::setprecision (std::numeric_limits<double>::digits10 + 1);
+  sfm::WritePlyHeader(outfile, vec_points.size()+vec_camPos.size(), true);
 
+  sfm::Ply_Vertex_Writer vertex_writer(outfile, true);
   for (size_t i=0; i < vec_points.size(); ++i)  {
     if (vec_coloredPoints == nullptr)
-      outfile
-        << vec_points[i](0) << ' '
-        << vec_points[i](1) << ' '
-        << vec_points[i](2) << ' '
-        << "255 255 255\n";
+      vertex_writer.write(vec_points[i], sfm::Vec3uc(255, 255, 255));
     else
-      outfile
-        << vec_points[i](0) << ' '
-        << vec_points[i](1) << ' '
-        << vec_points[i](2) << ' '
-        << static_cast<int>((*vec_coloredPoints)[i](0)) << ' '
-        << static_cast<int>((*vec_coloredPoints)[i](1)) << ' '
-        << static_cast<int>((*vec_coloredPoints)[i](2))
-        << "\n";
+      vertex_writer.write(vec_points[i], (*vec_coloredPoints)[i].cast<unsigned char>());
   }
 
   for (size_t i=0; i < vec_camPos.size(); ++i)  {
-    outfile
-      << vec_camPos[i](0) << ' '
-      << vec_camPos[i](1) << ' '
-      << vec_camPos[i](2) << ' '
-      << "0 255 0\n";
+    vertex_writer.write(vec_camPos[i], sfm::Vec3uc(0, 255, 0));
   }
-  outfile.flush();
-  const bool bOk = outfile.good();
+  const bool bOk = vertex_writer.flush();
   outfile.close();
   return bOk;
 }
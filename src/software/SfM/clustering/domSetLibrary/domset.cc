@@ -12,6 +12,7 @@
 #endif
 
 #include <fstream>
+#include <iterator>
 #include <limits>
 #include <random>
 #include <set>
@@ -27,7 +28,7 @@ void Domset::computeInformation()
 {
   normalizePointCloud();
   voxelGridFilter( kVoxelSize, kVoxelSize, kVoxelSize );
-  getAllDistances();
+  computeViewSimilarities();
 }
 
 void Domset::normalizePointCloud()
@@ -179,68 +180,55 @@ void Domset::voxelGridFilter( const float &sizeX, const float &sizeY, const floa
   */
 
   /* adding points to the voxels */
-  std::map<size_t, std::vector<size_t>> voxels;
-  std::vector<size_t> voxelIds;
+  std::vector<size_t> pointVoxelIds( numP );
 #if OPENMVG_USE_OPENMP
 #pragma omp parallel for
 #endif
   for_parallel( p, numP )
   {
-    const Point pt  = points[ p ];
+    const Point &pt = points[ p ];
     const size_t x  = static_cast<size_t>( floor( ( pt.pos( 0 ) - minPt.pos( 0 ) ) / sizeX ) );
     const size_t y  = static_cast<size_t>( floor( ( pt.pos( 1 ) - minPt.pos( 1 ) ) / sizeY ) );
     const size_t z  = static_cast<size_t>( floor( ( pt.pos( 2 ) - minPt.pos( 2 ) ) / sizeZ ) );
-    const size_t id = ( z * numVoxelZ ) + ( y * numVoxelY ) + x;
-#if OPENMVG_USE_OPENMP
-#pragma omp critical( voxelGridUpdate )
-#endif
-    {
-      if ( voxels.find( id ) == voxels.end() )
-      {
-        voxels[ id ] = std::vector<size_t>();
-        voxelIds.push_back( id );
-      }
-
-      voxels[ id ].push_back( p );
-    }
+    pointVoxelIds[ p ] = ( z * numVoxelZ ) + ( y * numVoxelY ) + x;
   }
-
-  std::vector<Point> newPoints;
-  const size_t numVoxelMaps = voxelIds.size();
+  // (filled serially, so that the voxel ordering does not depend on the threads)
+  std::map<size_t, std::vector<size_t>> voxels;
+  for ( size_t p = 0; p < numP; p++ )
+    voxels[ pointVoxelIds[ p ] ].push_back( p );
+  std::vector<const std::vector<size_t> *> voxelPoints;
+  voxelPoints.reserve( voxels.size() );
+  for ( const auto &voxel : voxels )
+    voxelPoints.push_back( &voxel.second );
+
+  const size_t numVoxelMaps = voxelPoints.size();
+  std::vector<Point> newPoints( numVoxelMaps );
 #if OPENMVG_USE_OPENMP
 #pragma omp parallel for
 #endif
   for_parallel( vmId, numVoxelMaps )
   {
-    const size_t vId  = voxelIds[ vmId ];
-    const size_t nPts = voxels[ vId ].size();
-    if ( nPts == 0 )
-      continue;
-
-    Eigen::Vector3f pos;
+    const std::vector<size_t> &voxelPts = *voxelPoints[ vmId ];
+    Eigen::Vector3f pos = Eigen::Vector3f::Zero();
     std::set<size_t> vl;
-    for ( const auto &p : voxels[ vId ] )
+    for ( const auto &p : voxelPts )
     {
-      const Point pt = points[ p ];
+      const Point &pt = points[ p ];
       pos += pt.pos;
-      const size_t numV = pt.viewList.size();
-      for ( size_t j = 0; j < numV; j++ )
-        vl.insert( pt.viewList[ j ] );
+      vl.insert( pt.viewList.begin(), pt.viewList.end() );
     }
-    pos /= (float)nPts;
+    pos /= (float)voxelPts.size();
 
-    Point newSP;
-    newSP.pos      = pos;
-    newSP.viewList = std::vector<size_t>( vl.begin(), vl.end() );
-#if OPENMVG_USE_OPENMP
-#pragma omp critical( pointsUpdate )
-#endif
+    newPoints[ vmId ].pos      = pos;
+    newPoints[ vmId ].viewList = std::vector<size_t>( vl.begin(), vl.end() );
+  }
+
+  // view -> points visibility (sorted point indexes)
+  for ( size_t pId = 0; pId < numVoxelMaps; pId++ )
+  {
+    for ( const size_t viewID : newPoints[ pId ].viewList )
     {
-      for ( const size_t viewID : vl )
-      {
-        views[ viewID ].viewPoints.push_back( newPoints.size() );
-      }
-      newPoints.push_back( newSP );
+      views[ viewID ].viewPoints.push_back( pId );
     }
   }
 
@@ -251,6 +239,63 @@ void Domset::voxelGridFilter( const float &sizeX, const float &sizeY, const floa
   // std::cerr << "Number of points = " << points.size() << std::endl;
 } // voxelGridFilter
 
+void Domset::computeViewSimilarities()
+{
+  const size_t numC = views.size();
+  if ( numC == 0 )
+  {
+    std::cerr << "No Views initialized \n";
+    exit( 0 );
+  }
+  // The similarity of two views only depends on their common points:
+  // each view row is accumulated from the views that observe its points,
+  // so only the covisible view pairs are visited.
+  viewSimilarities.assign( numC, {} );
+#if OPENMVG_USE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    // per thread accumulators (reset after each view)
+    std::vector<float> sumExpAngle( numC, 0.f );
+    std::vector<size_t> numCommonPoints( numC, 0 );
+    std::vector<size_t> covisibleViews;
+#if OPENMVG_USE_OPENMP
+#pragma omp for schedule( dynamic )
+#endif
+    for_parallel( i, numC )
+    {
+      const size_t vId1 = static_cast<size_t>( i );
+      const View &v1    = views[ vId1 ];
+      for ( const size_t pId : v1.viewPoints )
+      {
+        const Eigen::Vector3f c1 = ( v1.trans - points[ pId ].pos ).normalized();
+        for ( const size_t vId2 : points[ pId ].viewList )
+        {
+          if ( vId2 == vId1 )
+            continue;
+          const Eigen::Vector3f c2 = ( views[ vId2 ].trans - points[ pId ].pos ).normalized();
+          const float angle        = acos( c1.dot( c2 ) );
+          if ( numCommonPoints[ vId2 ]++ == 0 )
+            covisibleViews.push_back( vId2 );
+          sumExpAngle[ vId2 ] += exp( -( angle * angle ) / kAngleSigma_2 );
+        }
+      }
+
+      std::sort( covisibleViews.begin(), covisibleViews.end() );
+      auto &similarities = viewSimilarities[ vId1 ];
+      similarities.reserve( covisibleViews.size() );
+      for ( const size_t vId2 : covisibleViews )
+      {
+        const float ans = sumExpAngle[ vId2 ] / numCommonPoints[ vId2 ];
+        similarities.emplace_back( vId2, ( ans != ans ) ? 0.f : ans );
+        sumExpAngle[ vId2 ]     = 0.f;
+        numCommonPoints[ vId2 ] = 0;
+      }
+      covisibleViews.clear();
+    }
+  }
+} // computeViewSimilarities
+
 Eigen::MatrixXf Domset::getSimilarityMatrix( std::map<size_t, size_t> &xId2vId )
 {
 //  std::cout << "Generating Similarity Matrix " << std::endl;
@@ -263,34 +308,31 @@ Eigen::MatrixXf Domset::getSimilarityMatrix( std::map<size_t, size_t> &xId2vId )
   }
   const float medianDist = getDistanceMedian( xId2vId );
 //  std::cout << "Median dists = " << medianDist << std::endl;
-  Eigen::MatrixXf simMat;
-  simMat.resize( numC, numC );
+
+  // view id -> matrix index (-1 if the view is not in the matrix)
+  std::vector<int> vId2xId( views.size(), -1 );
+  std::vector<size_t> vIds( numC );
+  for ( const auto &x_v : xId2vId )
+  {
+    vIds[ x_v.first ]     = x_v.second;
+    vId2xId[ x_v.second ]  = static_cast<int>( x_v.first );
+  }
+
+  // views without common points have a null similarity
+  Eigen::MatrixXf simMat = Eigen::MatrixXf::Zero( numC, numC );
 #if OPENMVG_USE_OPENMP
-#if _OPENMP > 200505 // collapse is only accessible from OpenMP 3.0
-#pragma omp parallel for collapse( 2 )
-#else
-#pragma omp parallel for
-#endif
+#pragma omp parallel for schedule( dynamic )
 #endif
   for_parallel( xId1, numC )
   {
-    for_parallel( xId2, numC )
+    const size_t vId1 = vIds[ xId1 ];
+    for ( const auto &similarity : viewSimilarities[ vId1 ] )
     {
-      const size_t vId1 = xId2vId[ xId1 ];
-      const size_t vId2 = xId2vId[ xId2 ];
-      if ( vId1 == vId2 )
-      {
-        simMat( xId1, xId2 ) = 0;
-      }
-      else
-      {
-        const View v2   = views[ vId2 ];
-        const View v1   = views[ vId1 ];
-        const float sv  = computeViewSimilaity( v1, v2 );
-        const float sd  = computeViewDistance( vId1, vId2, medianDist );
-        const float sim = sv * sd;
-        simMat( xId1, xId2 ) = sim;
-      }
+      const int xId2 = vId2xId[ similarity.first ];
+      if ( xId2 < 0 )
+        continue;
+      const float sd = computeViewDistance( vId1, similarity.first, medianDist );
+      simMat( xId1, xId2 ) = similarity.second * sd;
     }
   }
   return simMat;
@@ -300,7 +342,7 @@ float Domset::computeViewDistance( const size_t &vId1, const size_t &vId2, const
 {
   if ( vId1 == vId2 )
     return 1.f;
-  const float vd = viewDists( vId1, vId2 );
+  const float vd = getViewDistance( vId1, vId2 );
   const float dm = 1.f + exp( -( vd - medianDist ) / medianDist );
   return 1.f / dm;
 }
@@ -315,90 +357,59 @@ float Domset::getDistanceMedian( const std::map<size_t, size_t> &xId2vId )
   }
 
   const size_t numC = xId2vId.size();
-  std::vector<float> dists;
-  dists.reserve( numC * numC - numC );
-  // float totalDist = 0;
-  for ( size_t i = 0; i < numC; i++ )
+  if ( numC == 1 )
+    return 1.f;
+  std::vector<size_t> vIds;
+  vIds.reserve( numC );
+  for ( const auto &x_v : xId2vId )
+    vIds.push_back( x_v.second );
+
+  std::vector<float> dists( numC * numC - numC );
+#if OPENMVG_USE_OPENMP
+#pragma omp parallel for
+#endif
+  for_parallel( i, numC )
   {
-    const size_t v1 = xId2vId.at( i );
+    float *rowDists = &dists[ i * ( numC - 1 ) ];
     for ( size_t j = 0; j < numC; j++ )
     {
-      if ( i == j )
+      if ( static_cast<size_t>( i ) == j )
         continue;
-      const size_t v2 = xId2vId.at( j );
-      dists.push_back( viewDists( v1, v2 ) );
+      *rowDists++ = getViewDistance( vIds[ i ], vIds[ j ] );
     }
   }
-  std::sort( dists.begin(), dists.end() );
+  std::nth_element( dists.begin(), dists.begin() + dists.size() / 2, dists.end() );
   return dists[ dists.size() / 2 ];
 } // getDistanceMedian
 
-void Domset::getAllDistances()
+void Domset::partitionViews( std::vector<size_t> vIds, const size_t &maxPartitionSize,
+                             std::vector<std::vector<size_t>> &partitions ) const
 {
-//  std::cout << "Finding View Distances\n";
-  const size_t numC = views.size();
-  if ( numC == 0 )
+  if ( maxPartitionSize == 0 || vIds.size() <= maxPartitionSize )
   {
-    std::cerr << "No Views initialized \n";
-    exit( 0 );
-  }
-  viewDists.resize( numC, numC );
-  for ( size_t i = 0; i < numC; i++ )
-  {
-    const auto v1 = views[ i ];
-    for ( size_t j = 0; j < numC; j++ )
-    {
-      const auto v2    = views[ j ];
-      const float dist = ( v1.trans - v2.trans ).norm();
-      viewDists( i, j ) = dist;
-    }
+    partitions.emplace_back( std::move( vIds ) );
+    return;
   }
-}
-
-void Domset::findCommonPoints( const View &v1, const View &v2,
-                               std::vector<size_t> &commonPoints )
-{
-  commonPoints.clear();
-  const size_t numVP1 = v1.viewPoints.size();
-  const size_t numVP2 = v2.viewPoints.size();
-  const size_t minNum = std::min( numVP1, numVP2 );
-
-  //std::sort(v1.viewPoints.begin(), v1.viewPoints.end());
-  //std::sort(v2.viewPoints.begin(), v2.viewPoints.end());
-  commonPoints.resize( minNum );
-
-  const auto it = std::set_intersection( v1.viewPoints.begin(), v1.viewPoints.end(),
-                                         v2.viewPoints.begin(), v2.viewPoints.end(), commonPoints.begin() );
-  commonPoints.resize( it - commonPoints.begin() );
-} // findCommonPoints
 
-const float Domset::computeViewSimilaity( const View &v1, const View &v2 )
-{
-  std::vector<size_t> commonPoints;
-  findCommonPoints( v1, v2, commonPoints );
-  const size_t numCP = commonPoints.size();
-
-  float w = 0.f;
-#if OPENMVG_USE_OPENMP
-#pragma omp parallel for
-#endif
-  for_parallel( p, numCP )
-  {
-    const auto pId = commonPoints[ p ];
-    //for ( const auto pId : commonPoints ){
-    const Eigen::Vector3f c1 = (v1.trans - points[ pId ].pos).normalized();
-    const Eigen::Vector3f c2 = (v2.trans - points[ pId ].pos).normalized();
-    const float angle    = acos( c1.dot( c2 ) );
-    const float expAngle = exp( -( angle * angle ) / kAngleSigma_2 );
-//std::cerr << angle <<  " = " << expAngle << std::endl;
-#if OPENMVG_USE_OPENMP
-#pragma omp atomic
-#endif
-    w += expAngle;
+  // recursive bisection along the largest extent of the camera centers
+  Eigen::Vector3f minPos = views[ vIds[ 0 ] ].trans;
+  Eigen::Vector3f maxPos = minPos;
+  for ( const size_t vId : vIds )
+  {
+    minPos = minPos.cwiseMin( views[ vId ].trans );
+    maxPos = maxPos.cwiseMax( views[ vId ].trans );
   }
-  const float ans = w / numCP;
-  return ( ans != ans ) ? 0 : ans;
-} // computeViewSimilaity
+  int axis = 0;
+  ( maxPos - minPos ).maxCoeff( &axis );
+
+  const auto middle = vIds.begin() + vIds.size() / 2;
+  std::nth_element( vIds.begin(), middle, vIds.end(),
+    [&]( const size_t vId1, const size_t vId2 ) {
+      return views[ vId1 ].trans( axis ) < views[ vId2 ].trans( axis );
+    } );
+  partitionViews( std::vector<size_t>( vIds.begin(), middle ), maxPartitionSize, partitions );
+  partitionViews( std::vector<size_t>( middle, vIds.end() ), maxPartitionSize, partitions );
+} // partitionViews
 
 void Domset::computeClustersAP( std::map<size_t, size_t> &xId2vId,
                                 std::vector<std::vector<size_t>> &clusters )
@@ -539,9 +550,10 @@ void Domset::computeClustersAP( std::map<size_t, size_t> &xId2vId,
           if ( p1->first == p2->first )
             continue;
           const size_t vId2 = xId2vId.at( p2->first );
-          if ( viewDists( vId1, vId2 ) < minDist && ( p1->second.size() + p2->second.size() ) < kMaxClusterSize )
+          const float dist  = getViewDistance( vId1, vId2 );
+          if ( dist < minDist && ( p1->second.size() + p2->second.size() ) < kMaxClusterSize )
           {
-            minDist = viewDists( vId1, vId2 );
+            minDist = dist;
             minId   = p2->first;
           }
         }
@@ -614,20 +626,42 @@ void Domset::clusterViews( std::map<size_t, size_t> &xId2vId, const size_t &minC
 }
 
 void Domset::clusterViews(
-    const size_t &minClusterSize, const size_t &maxClusterSize )
+    const size_t &minClusterSize, const size_t &maxClusterSize,
+    const size_t &maxPartitionSize )
 {
 //  std::cout << "[ Clustering Views ] " << std::endl;
   const size_t numC = views.size();
   kMinClusterSize   = minClusterSize;
   kMaxClusterSize   = maxClusterSize;
 
-  std::map<size_t, size_t> xId2vId;
+  // the dense clustering is quadratic in the number of views:
+  // large scenes are split in spatial partitions that are clustered independently
+  std::vector<size_t> vIds( numC );
   for ( size_t i = 0; i < numC; i++ )
+    vIds[ i ] = i;
+  std::vector<std::vector<size_t>> partitions;
+  partitionViews( vIds, maxPartitionSize, partitions );
+
+  std::vector<std::vector<std::vector<size_t>>> partitionClusters( partitions.size() );
+#if OPENMVG_USE_OPENMP
+#pragma omp parallel for schedule( dynamic )
+#endif
+  for_parallel( i, partitions.size() )
   {
-    xId2vId[ i ] = i;
+    std::map<size_t, size_t> xId2vId;
+    for ( size_t xId = 0; xId < partitions[ i ].size(); xId++ )
+    {
+      xId2vId[ xId ] = partitions[ i ][ xId ];
+    }
+    computeClustersAP( xId2vId, partitionClusters[ i ] );
   }
+
   std::vector<std::vector<size_t>> clusters;
-  computeClustersAP( xId2vId, clusters );
+  for ( auto &cls : partitionClusters )
+  {
+    clusters.insert( clusters.end(),
+      std::make_move_iterator( cls.begin() ), std::make_move_iterator( cls.end() ) );
+  }
 
   deNormalizePointCloud();
   finalClusters.swap( clusters );
@@ -22,19 +22,23 @@
 namespace nomoko {
   class Domset{
     private:
-      // Generic clustering
-      void findCommonPoints(const View& v1, const View& v2,
-          std::vector<size_t>& commonPts);
       // similarity measures
-      const float computeViewSimilaity(const View&, const View&);
+      // (sparse view similarities, computed once from the point visibility)
+      void computeViewSimilarities();
       Eigen::MatrixXf getSimilarityMatrix(std::map<size_t,size_t>&);
 
       // distance measures
-      void getAllDistances();
+      float getViewDistance(const size_t& vId1, const size_t& vId2) const {
+        return (views[vId1].trans - views[vId2].trans).norm();
+      }
       float getDistanceMedian(const std::map<size_t,size_t> &);
       float computeViewDistance(const size_t& vId1, const size_t & vId2,
               const float& medianDist);
 
+      // split the views in spatially coherent partitions of bounded size
+      void partitionViews(std::vector<size_t> vIds, const size_t& maxPartitionSize,
+          std::vector<std::vector<size_t> >& partitions) const;
+
       void computeInformation();
 
       // subsamples the initial point cloud
@@ -62,8 +66,11 @@ namespace nomoko {
       void clusterViews(std::map<size_t, size_t>& xId2vId, const size_t& minClustersize,
           const size_t& maxClusterSize);
 
+      // cluster all the views
+      // (if maxPartitionSize > 0, the views are first split in partitions of
+      //  at most maxPartitionSize views that are clustered in parallel)
       void clusterViews(const size_t& minClustersize,
-          const size_t& maxClusterSize);
+          const size_t& maxClusterSize, const size_t& maxPartitionSize = 0);
 
       // export function
       void exportToPLY(const std::string& plyFile, bool exportPoints = false);
@@ -84,7 +91,8 @@ namespace nomoko {
       std::vector<Camera> cameras;
       std::vector<View> views;
 
-      Eigen::MatrixXf viewDists;
+      // for each view, the (view, similarity) of its covisible views
+      std::vector<std::vector<std::pair<size_t, float> > > viewSimilarities;
 
       std::vector<std::vector<size_t > > finalClusters;
 
@@ -72,22 +72,28 @@ bool domsetImporter(
     }
   }
 
-  // adding landmarks
-  for ( const auto &it_landmark : sfm_data.GetLandmarks())
+  // adding landmarks (only the observations of the imported views are kept)
+  std::vector<const Landmark *> landmarks;
+  landmarks.reserve( sfm_data.GetLandmarks().size() );
+  for ( const auto &it_landmark : sfm_data.GetLandmarks() )
+    landmarks.push_back( &it_landmark.second );
+
+  points.resize( landmarks.size() );
+#ifdef OPENMVG_USE_OPENMP
+#pragma omp parallel for
+#endif
+  for ( int i = 0; i < static_cast<int>( landmarks.size() ); ++i )
   {
-    const Landmark &landmark = it_landmark.second;
-    const Observations &obs  = landmark.obs;
-    // X, color, obsCount
-    std::vector<size_t> vIds;
-    for ( const auto &it_obs : obs)
+    const Landmark &landmark = *landmarks[ i ];
+    nomoko::Point &p         = points[ i ];
+    p.pos = landmark.X.transpose().cast<float>();
+    p.viewList.reserve( landmark.obs.size() );
+    for ( const auto &it_obs : landmark.obs )
     {
-      vIds.push_back( map_view[ it_obs.first ] );
+      const auto it_view = map_view.find( it_obs.first );
+      if ( it_view != map_view.end() )
+        p.viewList.push_back( it_view->second );
     }
-
-    nomoko::Point p;
-    p.pos      = landmark.X.transpose().cast<float>();
-    p.viewList = vIds;
-    points.push_back( p );
   }
 
   std::cout << std::endl
@@ -101,12 +107,14 @@ bool domsetImporter(
 /**
 * @brief Export a sfm_data file using a subset of the view of a given sfm_data
 * @param sfm_data The whole data set
+* @param view_landmarks For each view, the id of the landmarks it observes
 * @param outFilename Output file name
 * @param cluster List of view to consider
 * @retval true if success
 * @retval false if failure
 */
 bool exportData( const SfM_Data &sfm_data,
+                 const std::map<IndexT, std::vector<IndexT>> &view_landmarks,
                  const std::string &outFilename,
                  const std::set<size_t> &cluster )
 {
@@ -114,38 +122,46 @@ bool exportData( const SfM_Data &sfm_data,
   cl_sfm_data.s_root_path = sfm_data.s_root_path;
 
   // Copy the view (only the requested ones)
-  for ( const auto view : sfm_data.GetViews() )
+  // and list the landmarks they observe
+  std::vector<IndexT> cl_landmarks;
+  for ( const size_t view_id : cluster )
   {
-    const bool inCluster = cluster.find(view.first) != cluster.end();
-    if ( inCluster && sfm_data.IsPoseAndIntrinsicDefined( view.second.get() ) )
-    {
-      cl_sfm_data.poses[ view.first ] = sfm_data.GetPoseOrDie( view.second.get() );
-      cl_sfm_data.views[ view.first ] = view.second;
-
-      const auto intrinsic  = sfm_data.GetIntrinsics().at( view.second.get()->id_intrinsic );
-      if (cl_sfm_data.intrinsics.count(view.second.get()->id_intrinsic) == 0)
-        cl_sfm_data.intrinsics[ view.second.get()->id_intrinsic ] = intrinsic;
-    }
+    const auto it_view = sfm_data.GetViews().find( view_id );
+    if ( it_view == sfm_data.GetViews().end() ||
+         !sfm_data.IsPoseAndIntrinsicDefined( it_view->second.get() ) )
+      continue;
+    const View *view = it_view->second.get();
+    cl_sfm_data.poses[ view->id_pose ] = sfm_data.GetPoseOrDie( view );
+    cl_sfm_data.views[ view_id ]       = it_view->second;
+    if ( cl_sfm_data.intrinsics.count( view->id_intrinsic ) == 0 )
+      cl_sfm_data.intrinsics[ view->id_intrinsic ] = sfm_data.GetIntrinsics().at( view->id_intrinsic );
+
+    const auto it_landmarks = view_landmarks.find( view_id );
+    if ( it_landmarks != view_landmarks.end() )
+      cl_landmarks.insert( cl_landmarks.end(),
+        it_landmarks->second.begin(), it_landmarks->second.end() );
   }
+  std::sort( cl_landmarks.begin(), cl_landmarks.end() );
+  cl_landmarks.erase( std::unique( cl_landmarks.begin(), cl_landmarks.end() ), cl_landmarks.end() );
 
   // Copy observations that have relation with the considered view
-  for ( const auto &it_landmark : sfm_data.GetLandmarks() )
+  for ( const IndexT landmark_id : cl_landmarks )
   {
-    const Landmark &landmark = it_landmark.second;
+    const Landmark &landmark = sfm_data.GetLandmarks().at( landmark_id );
     Observations obs;
     for ( const auto &observation : landmark.obs )
     {
-      const auto &it = cl_sfm_data.views.find( observation.first );
-      if ( it != cl_sfm_data.views.end() )
+      if ( cl_sfm_data.views.count( observation.first ) )
       {
         obs[ observation.first ] = observation.second;
       }
     }
-    // Landmark observed in less than 3 view are ignored
+    // Landmark observed in less than 2 view are ignored
     if ( obs.size() < 2 )
       continue;
-    cl_sfm_data.structure[ it_landmark.first ].X   = landmark.X;
-    cl_sfm_data.structure[ it_landmark.first ].obs = obs;
+    Landmark &cl_landmark = cl_sfm_data.structure[ landmark_id ];
+    cl_landmark.X         = landmark.X;
+    cl_landmark.obs       = std::move( obs );
   }
 
   return Save( cl_sfm_data, outFilename, ESfM_Data( ALL ) );
@@ -164,12 +180,14 @@ int main( int argc, char **argv )
   unsigned int clusterSizeLowerBound = 20;
   unsigned int clusterSizeUpperBound = 30;
   float voxelGridSize                = 10.0f;
+  unsigned int maxPartitionSize      = 2000;
 
   cmd.add( make_option( 'i', sSfM_Data_Filename, "input_file" ) );
   cmd.add( make_option( 'o', sOutDir, "outdir" ) );
   cmd.add( make_option( 'l', clusterSizeLowerBound, "cluster_size_lower_bound" ) );
   cmd.add( make_option( 'u', clusterSizeUpperBound, "cluster_size_upper_bound" ) );
   cmd.add( make_option( 'v', voxelGridSize, "voxel_grid_size" ) );
+  cmd.add( make_option( 'p', maxPartitionSize, "max_partition_size" ) );
 
   try
   {
@@ -185,6 +203,9 @@ int main( int argc, char **argv )
               << "[-l|--cluster_size_lower_bound] lower bound to cluster size\n"
               << "[-u|--cluster_size_upper_bound] upper bound to cluster size\n"
               << "[-v|--voxel_grid_size] voxel grid size\n"
+              << "[-p|--max_partition_size] maximum number of views clustered together\n"
+              << "\t (larger scenes are split in spatial partitions clustered in parallel,\n"
+              << "\t  0: no partitioning)\n"
               << std::endl;
 
     std::cerr << s << std::endl;
@@ -197,7 +218,8 @@ int main( int argc, char **argv )
             << "[Cluster size:"         << std::endl
             << "    Lower bound   = "   << clusterSizeLowerBound << std::endl
             << "    Upper bound]   = "  << clusterSizeUpperBound << std::endl
-            << "[Voxel grid size]  = "  << voxelGridSize << std::endl;
+            << "[Voxel grid size]  = "  << voxelGridSize << std::endl
+            << "[Max partition size] = " << maxPartitionSize << std::endl;
 
   if ( sSfM_Data_Filename.empty() )
   {
@@ -240,7 +262,7 @@ int main( int argc, char **argv )
   openMVG::system::Timer clusteringTimer;
 
   nomoko::Domset domset( points, views, cameras, voxelGridSize );
-  domset.clusterViews( clusterSizeLowerBound, clusterSizeUpperBound );
+  domset.clusterViews( clusterSizeLowerBound, clusterSizeUpperBound, maxPartitionSize );
 
   std::cout << "Clustering view took (s): "
             << clusteringTimer.elapsed() << std::endl;
@@ -264,7 +286,7 @@ int main( int argc, char **argv )
     {
       std::set<size_t> newCl;
       for ( const auto vId : cl )
-        newCl.insert( origViewMap_reverse[ vId ] );
+        newCl.insert( origViewMap_reverse.at( vId ) );
       finalClusters.emplace_back(newCl);
     }
   }
@@ -272,10 +294,16 @@ int main( int argc, char **argv )
   const size_t numClusters = finalClusters.size();
   std::cout << "Number of clusters = " << numClusters << std::endl;
 
+  // Index the landmarks observed by each view once for all the clusters
+  std::map<IndexT, std::vector<IndexT>> view_landmarks;
+  for ( const auto &it_landmark : sfm_data.GetLandmarks() )
+    for ( const auto &observation : it_landmark.second.obs )
+      view_landmarks[ observation.first ].push_back( it_landmark.first );
+
 #ifdef OPENMVG_USE_OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic)
 #endif
-  for ( int i = 0; i < numClusters; ++i )
+  for ( int i = 0; i < static_cast<int>( numClusters ); ++i )
   {
     std::stringstream filename;
     filename << sOutDir << "/sfm_data";
@@ -291,7 +319,7 @@ int main( int argc, char **argv )
       std::cout << ss.str();
     }
 
-    if ( !exportData( sfm_data, filename.str(), finalClusters[ i ] ) )
+    if ( !exportData( sfm_data, view_landmarks, filename.str(), finalClusters[ i ] ) )
     {
       std::stringstream str;
       str << "Could not write cluster : " << filename.str() << std::endl;
@@ -10,6 +10,7 @@
 #include <cereal/archives/json.hpp>
 
 #include "openMVG/features/image_describer_akaze_io.hpp"
+#include "openMVG/features/image_describer_compressed_io.hpp"
 
 #include "openMVG/features/sift/SIFT_Anatomy_Image_Describer_io.hpp"
 #include "openMVG/image/image_io.hpp"
@@ -29,6 +30,8 @@
 #include <atomic>
 #include <cstdlib>
 #include <fstream>
+#include <numeric>
+#include <random>
 #include <string>
 
 #ifdef OPENMVG_USE_OPENMP
@@ -57,6 +60,75 @@ features::EDESCRIBER_PRESET stringToEnum(const std::string & sPreset)
   return preset;
 }
 
+/// Train the descriptor compression of an image describer on the descriptors of
+///  some views regularly spread over the collection (the model is shared by all the views)
+bool Train_Descriptor_Compression
+(
+  const SfM_Data & sfm_data,
+  Compressed_Image_describer & image_describer,
+  bool b_multithreaded
+)
+{
+  const int kMaxTrainingViews = 100;
+  const int kMaxDescriptorsPerView = 1000;
+
+  std::vector<std::string> training_images;
+  const size_t step = std::max<size_t>(1, sfm_data.GetViews().size() / kMaxTrainingViews);
+  size_t view_index = 0;
+  for (const auto & view_it : sfm_data.GetViews())
+  {
+    if (view_index++ % step == 0)
+      training_images.push_back(
+        stlplus::create_filespec(sfm_data.s_root_path, view_it.second->s_Img_path));
+  }
+
+  C_Progress_display my_progress_bar(training_images.size(),
+    std::cout, "\n- TRAIN THE DESCRIPTOR COMPRESSION -\n" );
+  std::vector<Eigen::MatrixXf> view_descriptors(training_images.size());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic) if (b_multithreaded)
+#endif
+  for (int i = 0; i < static_cast<int>(training_images.size()); ++i)
+  {
+    Image<unsigned char> imageGray;
+    Eigen::MatrixXf descriptors;
+    if (ReadImage(training_images[i].c_str(), &imageGray))
+    {
+      const auto regions = image_describer.Describer()->Describe(imageGray);
+      if (regions && Get_SIO_Scalar_Regions_Data(*regions, nullptr, &descriptors))
+      {
+        // Random subset of the view descriptors
+        std::vector<int> rows(descriptors.rows());
+        std::iota(rows.begin(), rows.end(), 0);
+        std::mt19937 random_generator(i);
+        std::shuffle(rows.begin(), rows.end(), random_generator);
+        rows.resize(std::min<size_t>(rows.size(), kMaxDescriptorsPerView));
+        view_descriptors[i].resize(rows.size(), descriptors.cols());
+        for (size_t r = 0; r < rows.size(); ++r)
+          view_descriptors[i].row(r) = descriptors.row(rows[r]);
+      }
+    }
+    ++my_progress_bar;
+  }
+
+  Eigen::Index nb_descriptors = 0, dimension = 0;
+  for (const auto & descriptors : view_descriptors)
+  {
+    nb_descriptors += descriptors.rows();
+    dimension = std::max(dimension, descriptors.cols());
+  }
+  Eigen::MatrixXf training_descriptors(nb_descriptors, dimension);
+  nb_descriptors = 0;
+  for (const auto & descriptors : view_descriptors)
+  {
+    training_descriptors.middleRows(nb_descriptors, descriptors.rows()) = descriptors;
+    nb_descriptors += descriptors.rows();
+  }
+  std::cout << "Training on " << nb_descriptors << " descriptors of "
+    << training_images.size() << " views." << std::endl;
+  return image_describer.Train(training_descriptors);
+}
+
 /// - Compute view image description (feature & descriptor extraction)
 /// - Export computed data
 int main(int argc, char **argv)
@@ -69,6 +141,8 @@ int main(int argc, char **argv)
   std::string sImage_Describer_Method = "SIFT";
   bool bForce = false;
   std::string sFeaturePreset = "";
+  bool bBinaryRegions = false;
+  std::string sQuantization = "";
 #ifdef OPENMVG_USE_OPENMP
   int iNumThreads = 0;
 #endif
@@ -81,6 +155,8 @@ int main(int argc, char **argv)
   cmd.add( make_option('u', bUpRight, "upright") );
   cmd.add( make_option('f', bForce, "force") );
   cmd.add( make_option('p', sFeaturePreset, "describerPreset") );
+  cmd.add( make_option('b', bBinaryRegions, "binaryRegions") );
+  cmd.add( make_option('q', sQuantization, "quantize") );
 
 #ifdef OPENMVG_USE_OPENMP
   cmd.add( make_option('n', iNumThreads, "numThreads") );
@@ -107,6 +183,14 @@ int main(int argc, char **argv)
       << "   NORMAL (default),\n"
       << "   HIGH,\n"
       << "   ULTRA: !!Can take long time!!\n"
+      << "[-b|--binaryRegions] Also export the regions in a binary .regions file 0 or 1\n"
+      << "  (memory mapped file with checksum, loaded faster than the .feat/.desc files)\n"
+      << "[-q|--quantize] Compress the descriptors (less memory and disk usage):\n"
+      << "   UINT8: AKAZE_FLOAT descriptors quantized on 8 bits (4 times smaller),\n"
+      << "   PCA: 32 principal components on 8 bits (SIFT: 4 times smaller),\n"
+      << "   PQ: product quantization codes of 16 bytes (SIFT: 8 times smaller),\n"
+      << "    to be matched with the PQL2 method of openMVG_main_ComputeMatches.\n"
+      << "  (the PCA basis and the PQ codebook are trained once on the image collection)\n"
 #ifdef OPENMVG_USE_OPENMP
       << "[-n|--numThreads] number of parallel computations\n"
 #endif
@@ -124,6 +208,8 @@ int main(int argc, char **argv)
             << "--upright " << bUpRight << std::endl
             << "--describerPreset " << (sFeaturePreset.empty() ? "NORMAL" : sFeaturePreset) << std::endl
             << "--force " << bForce << std::endl
+            << "--binaryRegions " << bBinaryRegions << std::endl
+            << "--quantize " << (sQuantization.empty() ? "NONE" : sQuantization) << std::endl
 #ifdef OPENMVG_USE_OPENMP
             << "--numThreads " << iNumThreads << std::endl
 #endif
@@ -135,6 +221,26 @@ int main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
+  if (!sQuantization.empty() && sQuantization != "UINT8"
+      && sQuantization != "PCA" && sQuantization != "PQ")
+  {
+    std::cerr << "\nUnknown descriptor quantization: " << sQuantization << std::endl;
+    return EXIT_FAILURE;
+  }
+
+#ifdef OPENMVG_USE_OPENMP
+  const unsigned int nb_max_thread = omp_get_max_threads();
+
+  if (iNumThreads > 0) {
+      omp_set_num_threads(iNumThreads);
+  } else {
+      omp_set_num_threads(nb_max_thread);
+  }
+  const bool b_multithreaded = iNumThreads > 0;
+#else
+  const bool b_multithreaded = false;
+#endif
+
   // Create output dir
   if (!stlplus::folder_exists(sOutDir))
   {
@@ -201,7 +307,8 @@ int main(int argc, char **argv)
     if (sImage_Describer_Method == "AKAZE_FLOAT")
     {
       image_describer = AKAZE_Image_describer::create
-        (AKAZE_Image_describer::Params(AKAZE::Params(), AKAZE_MSURF), !bUpRight);
+        (AKAZE_Image_describer::Params(AKAZE::Params(),
+          sQuantization == "UINT8" ? AKAZE_MSURF_UCHAR : AKAZE_MSURF), !bUpRight);
     }
     else
     if (sImage_Describer_Method == "AKAZE_MLDB")
@@ -209,6 +316,11 @@ int main(int argc, char **argv)
       image_describer = AKAZE_Image_describer::create
         (AKAZE_Image_describer::Params(AKAZE::Params(), AKAZE_MLDB), !bUpRight);
     }
+    if (sQuantization == "UINT8" && sImage_Describer_Method != "AKAZE_FLOAT")
+    {
+      std::cout << "The " << sImage_Describer_Method
+        << " descriptors are not quantized on 8 bits (only AKAZE_FLOAT supports it)." << std::endl;
+    }
     if (!image_describer)
     {
       std::cerr << "Cannot create the designed Image_describer:"
@@ -225,6 +337,29 @@ int main(int argc, char **argv)
       }
     }
 
+    // Compress the descriptors with a model trained once on the image collection
+    if (sQuantization == "PCA" || sQuantization == "PQ")
+    {
+      if (!Get_SIO_Scalar_Regions_Data(*image_describer->Allocate(), nullptr, nullptr))
+      {
+        std::cerr << "The " << sImage_Describer_Method
+          << " descriptors cannot be compressed with " << sQuantization << "." << std::endl;
+        return EXIT_FAILURE;
+      }
+      std::unique_ptr<Compressed_Image_describer> compressed_image_describer;
+      if (sQuantization == "PCA")
+        compressed_image_describer.reset(new PCA_Image_describer(std::move(image_describer)));
+      else
+        compressed_image_describer.reset(new PQ_Image_describer(std::move(image_describer)));
+
+      if (!Train_Descriptor_Compression(sfm_data, *compressed_image_describer, b_multithreaded))
+      {
+        std::cerr << "Cannot train the " << sQuantization << " descriptor compression." << std::endl;
+        return EXIT_FAILURE;
+      }
+      image_describer = std::move(compressed_image_describer);
+    }
+
     // Export the used Image_describer and region type for:
     // - dynamic future regions computation and/or loading
     {
@@ -253,15 +388,7 @@ int main(int argc, char **argv)
     // Use a boolean to track if we must stop feature extraction
     std::atomic<bool> preemptive_exit(false);
 #ifdef OPENMVG_USE_OPENMP
-    const unsigned int nb_max_thread = omp_get_max_threads();
-
-    if (iNumThreads > 0) {
-        omp_set_num_threads(iNumThreads);
-    } else {
-        omp_set_num_threads(nb_max_thread);
-    }
-
-    #pragma omp parallel for schedule(dynamic) if (iNumThreads > 0) private(imageGray)
+    #pragma omp parallel for schedule(dynamic) if (b_multithreaded) private(imageGray)
 #endif
     for (int i = 0; i < static_cast<int>(sfm_data.views.size()); ++i)
     {
@@ -271,10 +398,12 @@ int main(int argc, char **argv)
       const std::string
         sView_filename = stlplus::create_filespec(sfm_data.s_root_path, view->s_Img_path),
         sFeat = stlplus::create_filespec(sOutDir, stlplus::basename_part(sView_filename), "feat"),
-        sDesc = stlplus::create_filespec(sOutDir, stlplus::basename_part(sView_filename), "desc");
+        sDesc = stlplus::create_filespec(sOutDir, stlplus::basename_part(sView_filename), "desc"),
+        sRegions = stlplus::create_filespec(sOutDir, stlplus::basename_part(sView_filename), "regions");
 
       // If features or descriptors file are missing, compute them
-      if (!preemptive_exit && (bForce || !stlplus::file_exists(sFeat) || !stlplus::file_exists(sDesc)))
+      if (!preemptive_exit && (bForce || !stlplus::file_exists(sFeat) || !stlplus::file_exists(sDesc)
+          || (bBinaryRegions && !stlplus::file_exists(sRegions))))
       {
         if (!ReadImage(sView_filename.c_str(), &imageGray))
           continue;
@@ -324,9 +453,15 @@ int main(int argc, char **argv)
           }
         }
 
+        // A previous binary regions file is no longer valid once the
+        //  .feat/.desc files are rewritten
+        if (!bBinaryRegions && stlplus::file_exists(sRegions))
+          stlplus::file_delete(sRegions);
+
         // Compute features and descriptors and export them to files
         auto regions = image_describer->Describe(imageGray, mask);
-        if (regions && !image_describer->Save(regions.get(), sFeat, sDesc)) {
+        if (regions && (!image_describer->Save(regions.get(), sFeat, sDesc)
+            || (bBinaryRegions && !regions->Save(sRegions)))) {
           std::cerr << "Cannot save regions for images: " << sView_filename << std::endl
                     << "Stopping feature extraction." << std::endl;
           preemptive_exit = true;
@@ -75,8 +75,10 @@ int main(int argc, char **argv)
   std::string sNearestMatchingMethod = "AUTO";
   bool bForce = false;
   bool bGuided_matching = false;
+  bool bProgressive_sampling = false;
   int imax_iteration = 2048;
   unsigned int ui_max_cache_size = 0;
+  matching::HNSW_Params hnsw_params;
 
   //required
   cmd.add( make_option('i', sSfM_Data_Filename, "input_file") );
@@ -90,7 +92,11 @@ int main(int argc, char **argv)
   cmd.add( make_option('f', bForce, "force") );
   cmd.add( make_option('m', bGuided_matching, "guided_matching") );
   cmd.add( make_option('I', imax_iteration, "max_iteration") );
+  cmd.add( make_option('s', bProgressive_sampling, "progressive_sampling") );
   cmd.add( make_option('c', ui_max_cache_size, "cache_size") );
+  cmd.add( make_option('M', hnsw_params.M, "hnsw_M") );
+  cmd.add( make_option('C', hnsw_params.ef_construction, "hnsw_ef_construction") );
+  cmd.add( make_option('E', hnsw_params.ef_search, "hnsw_ef_search") );
 
 
   try {
@@ -124,13 +130,23 @@ int main(int argc, char **argv)
       << "    FASTCASCADEHASHINGL2: (default)\n"
       << "      L2 Cascade Hashing with precomputed hashed regions\n"
       << "     (faster than CASCADEHASHINGL2 but use more memory).\n"
+      << "    HNSWL2: L2 Hierarchical Navigable Small World graph matching\n"
+      << "     (approximate search, CPU multi-threaded).\n"
+      << "  For product quantized regions (computed with --quantize PQ):\n"
+      << "    PQL2: L2 Product Quantization matching (asymmetric distance on the codes).\n"
       << "  For Binary based descriptor:\n"
       << "    BRUTEFORCEHAMMING: BruteForce Hamming matching.\n"
       << "[-m|--guided_matching]\n"
       << "  use the found model to improve the pairwise correspondences."
+      << "[-s|--progressive_sampling]\n"
+      << "  draw the robust estimation samples among the best putative matches first (PROSAC).\n"
       << "[-c|--cache_size]\n"
       << "  Use a regions cache (only cache_size regions will be stored in memory)"
-      << "  If not used, all regions will be load in memory."
+      << "  If not used, all regions will be load in memory.\n"
+      << "[-M|--hnsw_M] HNSWL2: number of links per graph node (default 16)\n"
+      << "[-C|--hnsw_ef_construction] HNSWL2: candidate list size used to build the graph (default 100)\n"
+      << "[-E|--hnsw_ef_search] HNSWL2: candidate list size used for the queries (default 64),\n"
+      << "  a larger value improves the recall and slows down the search."
       << std::endl;
 
       std::cerr << s << std::endl;
@@ -149,7 +165,11 @@ int main(int argc, char **argv)
             << "--pair_list " << sPredefinedPairList << "\n"
             << "--nearest_matching_method " << sNearestMatchingMethod << "\n"
             << "--guided_matching " << bGuided_matching << "\n"
-            << "--cache_size " << ((ui_max_cache_size == 0) ? "unlimited" : std::to_string(ui_max_cache_size)) << std::endl;
+            << "--progressive_sampling " << bProgressive_sampling << "\n"
+            << "--cache_size " << ((ui_max_cache_size == 0) ? "unlimited" : std::to_string(ui_max_cache_size)) << "\n"
+            << "--hnsw_M " << hnsw_params.M << "\n"
+            << "--hnsw_ef_construction " << hnsw_params.ef_construction << "\n"
+            << "--hnsw_ef_search " << hnsw_params.ef_search << std::endl;
 
   EPairMode ePairmode = (iMatchingVideoMode == -1 ) ? PAIR_EXHAUSTIVE : PAIR_CONTIGUOUS;
 
@@ -306,6 +326,12 @@ int main(int argc, char **argv)
         std::cout << "Using BRUTE_FORCE_HAMMING matcher" << std::endl;
         collectionMatcher.reset(new Matcher_Regions(fDistRatio, BRUTE_FORCE_HAMMING));
       }
+      else
+      if (dynamic_cast<const PQ_Regions *>(regions_type.get()))
+      {
+        std::cout << "Using PRODUCT_QUANTIZATION_L2 matcher" << std::endl;
+        collectionMatcher.reset(new Matcher_Regions(fDistRatio, PRODUCT_QUANTIZATION_L2));
+      }
     }
     else
     if (sNearestMatchingMethod == "BRUTEFORCEL2")
@@ -332,6 +358,18 @@ int main(int argc, char **argv)
       collectionMatcher.reset(new Matcher_Regions(fDistRatio, CASCADE_HASHING_L2));
     }
     else
+    if (sNearestMatchingMethod == "HNSWL2")
+    {
+      std::cout << "Using HNSW_L2 matcher" << std::endl;
+      collectionMatcher.reset(new Matcher_Regions(fDistRatio, HNSW_L2, hnsw_params));
+    }
+    else
+    if (sNearestMatchingMethod == "PQL2")
+    {
+      std::cout << "Using PRODUCT_QUANTIZATION_L2 matcher" << std::endl;
+      collectionMatcher.reset(new Matcher_Regions(fDistRatio, PRODUCT_QUANTIZATION_L2));
+    }
+    else
     if (sNearestMatchingMethod == "FASTCASCADEHASHINGL2")
     {
       std::cout << "Using FAST_CASCADE_HASHING_L2 matcher" << std::endl;
@@ -401,6 +439,8 @@ int main(int argc, char **argv)
   {
     system::Timer timer;
     const double d_distance_ratio = 0.6;
+    const robust::ACRANSAC_SAMPLING sampling = bProgressive_sampling ?
+      robust::ACRANSAC_SAMPLING::PROGRESSIVE : robust::ACRANSAC_SAMPLING::UNIFORM;
 
     PairWiseMatches map_GeometricMatches;
     switch (eGeometricModelToCompute)
@@ -408,7 +448,7 @@ int main(int argc, char **argv)
       case HOMOGRAPHY_MATRIX:
       {
         const bool bGeometric_only_guided_matching = true;
-        filter_ptr->Robust_model_estimation(GeometricFilter_HMatrix_AC(4.0, imax_iteration),
+        filter_ptr->Robust_model_estimation(GeometricFilter_HMatrix_AC(4.0, imax_iteration, sampling),
           map_PutativesMatches, bGuided_matching,
           bGeometric_only_guided_matching ? -1.0 : d_distance_ratio, &progress);
         map_GeometricMatches = filter_ptr->Get_geometric_matches();
@@ -416,14 +456,14 @@ int main(int argc, char **argv)
       break;
       case FUNDAMENTAL_MATRIX:
       {
-        filter_ptr->Robust_model_estimation(GeometricFilter_FMatrix_AC(4.0, imax_iteration),
+        filter_ptr->Robust_model_estimation(GeometricFilter_FMatrix_AC(4.0, imax_iteration, sampling),
           map_PutativesMatches, bGuided_matching, d_distance_ratio, &progress);
         map_GeometricMatches = filter_ptr->Get_geometric_matches();
       }
       break;
       case ESSENTIAL_MATRIX:
       {
-        filter_ptr->Robust_model_estimation(GeometricFilter_EMatrix_AC(4.0, imax_iteration),
+        filter_ptr->Robust_model_estimation(GeometricFilter_EMatrix_AC(4.0, imax_iteration, sampling),
           map_PutativesMatches, bGuided_matching, d_distance_ratio, &progress);
         map_GeometricMatches = filter_ptr->Get_geometric_matches();
 
@@ -40,6 +40,7 @@ int main(int argc, char **argv)
   } catch (const std::string& s) {
       std::cerr << "Usage: " << argv[0] << '\n'
         << "[-i|--input_file] path to the input SfM_Data scene\n"
+        << "\t .json, .bin, .xml, .ply (structure only)\n"
         << "[-o|--output_file] path to the output SfM_Data scene\n"
         << "\t .json, .bin, .xml, .ply, .baf\n"
         << "\n[Options to export partial data (by default all data are exported)]\n"
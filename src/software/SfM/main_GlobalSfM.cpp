@@ -53,6 +53,7 @@ int main(int argc, char **argv)
   int iTranslationAveragingMethod = int (TRANSLATION_AVERAGING_SOFTL1);
   std::string sIntrinsic_refinement_options = "ADJUST_ALL";
   bool b_use_motion_priors = false;
+  unsigned int iterative_schur_threshold = 0;
 
   cmd.add( make_option('i', sSfM_Data_Filename, "input_file") );
   cmd.add( make_option('m', sMatchesDir, "matchdir") );
@@ -61,6 +62,7 @@ int main(int argc, char **argv)
   cmd.add( make_option('t', iTranslationAveragingMethod, "translationAveraging") );
   cmd.add( make_option('f', sIntrinsic_refinement_options, "refineIntrinsics") );
   cmd.add( make_switch('P', "prior_usage") );
+  cmd.add( make_option('S', iterative_schur_threshold, "iterative_schur_threshold") );
 
   try {
     if (argc == 1) throw std::string("Invalid parameter.");
@@ -74,10 +76,12 @@ int main(int argc, char **argv)
     << "[-r|--rotationAveraging]\n"
       << "\t 1 -> L1 minimization\n"
       << "\t 2 -> L2 minimization (default)\n"
+      << "\t 3 -> L2 minimization with a sparse solver (large scenes)\n"
     << "[-t|--translationAveraging]:\n"
       << "\t 1 -> L1 minimization\n"
       << "\t 2 -> L2 minimization of sum of squared Chordal distances\n"
       << "\t 3 -> SoftL1 minimization (default)\n"
+      << "\t 4 -> L1 minimization with an iterative sparse solver (large scenes)\n"
     << "[-f|--refineIntrinsics] Intrinsic parameters refinement option\n"
       << "\t ADJUST_ALL -> refine all existing parameters (default) \n"
       << "\t NONE -> intrinsic parameters are held as constant\n"
@@ -92,6 +96,9 @@ int main(int argc, char **argv)
       << "\t ADJUST_PRINCIPAL_POINT|ADJUST_DISTORTION\n"
       <<      "\t\t-> refine the principal point position & the distortion coefficient(s) (if any)\n"
     << "[-P|--prior_usage] Enable usage of motion priors (i.e GPS positions)\n"
+    << "[-S|--iterative_schur_threshold] Number of poses from which the bundle adjustment uses\n"
+      << "\t an iterative Schur solver with a Schur/Cluster-Jacobi preconditioner (bounded memory)\n"
+      << "\t (default: 0 -> disabled, e.g. 2000 for large scenes)\n"
     << std::endl;
 
     std::cerr << s << std::endl;
@@ -99,7 +106,7 @@ int main(int argc, char **argv)
   }
 
   if (iRotationAveragingMethod < ROTATION_AVERAGING_L1 ||
-      iRotationAveragingMethod > ROTATION_AVERAGING_L2 )  {
+      iRotationAveragingMethod > ROTATION_AVERAGING_L2_SPARSE )  {
     std::cerr << "\n Rotation averaging method is invalid" << std::endl;
     return EXIT_FAILURE;
   }
@@ -113,7 +120,7 @@ int main(int argc, char **argv)
   }
 
   if (iTranslationAveragingMethod < TRANSLATION_AVERAGING_L1 ||
-      iTranslationAveragingMethod > TRANSLATION_AVERAGING_SOFTL1 )  {
+      iTranslationAveragingMethod > TRANSLATION_AVERAGING_L1_IRLS )  {
     std::cerr << "\n Translation averaging method is invalid" << std::endl;
     return EXIT_FAILURE;
   }
@@ -188,6 +195,7 @@ int main(int argc, char **argv)
   sfmEngine.Set_Intrinsics_Refinement_Type(intrinsic_refinement_options);
   b_use_motion_priors = cmd.used('P');
   sfmEngine.Set_Use_Motion_Prior(b_use_motion_priors);
+  sfmEngine.Set_Iterative_Schur_Threshold(iterative_schur_threshold);
 
   // Configure motion averaging method
   sfmEngine.SetRotationAveragingMethod(
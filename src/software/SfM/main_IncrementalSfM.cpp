@@ -82,6 +82,7 @@ int main(int argc, char **argv)
   std::string sIntrinsic_refinement_options = "ADJUST_ALL";
   int i_User_camera_model = PINHOLE_CAMERA_RADIAL3;
   bool b_use_motion_priors = false;
+  unsigned int iterative_schur_threshold = 0;
 
   cmd.add( make_option('i', sSfM_Data_Filename, "input_file") );
   cmd.add( make_option('m', sMatchesDir, "matchdir") );
@@ -91,6 +92,7 @@ int main(int argc, char **argv)
   cmd.add( make_option('c', i_User_camera_model, "camera_model") );
   cmd.add( make_option('f', sIntrinsic_refinement_options, "refineIntrinsics") );
   cmd.add( make_switch('P', "prior_usage") );
+  cmd.add( make_option('S', iterative_schur_threshold, "iterative_schur_threshold") );
 
   try {
     if (argc == 1) throw std::string("Invalid parameter.");
@@ -123,6 +125,9 @@ int main(int argc, char **argv)
       << "\t ADJUST_PRINCIPAL_POINT|ADJUST_DISTORTION\n"
       <<      "\t\t-> refine the principal point position & the distortion coefficient(s) (if any)\n"
       << "[-P|--prior_usage] Enable usage of motion priors (i.e GPS positions) (default: false)\n"
+      << "[-S|--iterative_schur_threshold] Number of poses from which the bundle adjustment uses\n"
+      << "\t an iterative Schur solver with a Schur/Cluster-Jacobi preconditioner (bounded memory)\n"
+      << "\t (default: 0 -> disabled, e.g. 2000 for large scenes)\n"
     << std::endl;
 
     std::cerr << s << std::endl;
@@ -213,6 +218,7 @@ int main(int argc, char **argv)
   sfmEngine.SetUnknownCameraType(EINTRINSIC(i_User_camera_model));
   b_use_motion_priors = cmd.used('P');
   sfmEngine.Set_Use_Motion_Prior(b_use_motion_priors);
+  sfmEngine.Set_Iterative_Schur_Threshold(iterative_schur_threshold);
 
   // Handle Initial pair parameter
   if (!initialPairString.first.empty() && !initialPairString.second.empty())
@@ -63,35 +63,31 @@ bool checkIntrinsicStringValidity(const std::string & Kmatrix, double & focal, d
 
 std::pair<bool, Vec3> checkGPS
 (
-  const std::string & filename,
+  const Exif_IO & exifReader,
   const int & GPS_to_XYZ_method = 0
 )
 {
   std::pair<bool, Vec3> val(false, Vec3::Zero());
-  std::unique_ptr<Exif_IO> exifReader(new Exif_IO_EasyExif);
-  if (exifReader)
+  // Check existence of EXIF data
+  if ( exifReader.doesHaveExifInfo() )
   {
-    // Try to parse EXIF metada & check existence of EXIF data
-    if ( exifReader->open( filename ) && exifReader->doesHaveExifInfo() )
+    // Check existence of GPS coordinates
+    double latitude, longitude, altitude;
+    if ( exifReader.GPSLatitude( &latitude ) &&
+         exifReader.GPSLongitude( &longitude ) &&
+         exifReader.GPSAltitude( &altitude ) )
     {
-      // Check existence of GPS coordinates
-      double latitude, longitude, altitude;
-      if ( exifReader->GPSLatitude( &latitude ) &&
-           exifReader->GPSLongitude( &longitude ) &&
-           exifReader->GPSAltitude( &altitude ) )
+      // Add ECEF or UTM XYZ position to the GPS position array
+      val.first = true;
+      switch (GPS_to_XYZ_method)
       {
-        // Add ECEF or UTM XYZ position to the GPS position array
-        val.first = true;
-        switch (GPS_to_XYZ_method)
-        {
-          case 1:
-            val.second = lla_to_utm( latitude, longitude, altitude );
-            break;
-          case 0:
-          default:
-            val.second = lla_to_ecef( latitude, longitude, altitude );
-            break;
-        }
+        case 1:
+          val.second = lla_to_utm( latitude, longitude, altitude );
+          break;
+        case 0:
+        default:
+          val.second = lla_to_ecef( latitude, longitude, altitude );
+          break;
       }
     }
   }
@@ -377,9 +373,6 @@ int main(int argc, char **argv)
 	  << "--exif_extended_lookup " << b_EXIF_Extended_Lookup << std::endl
 	  << "--landmarksFilename " << sLandmarksFilename << std::endl;
 
-  // Expected properties for each image
-  double width = -1, height = -1, focal = -1, ppx = -1,  ppy = -1;
-
   const EINTRINSIC e_User_camera_model = EINTRINSIC(i_User_camera_model);
 
   if ( !stlplus::folder_exists( sImageDir ) )
@@ -403,6 +396,7 @@ int main(int argc, char **argv)
     }
   }
 
+  double focal = -1, ppx = -1,  ppy = -1;
   if (sKmatrix.size() > 0 &&
     !checkIntrinsicStringValidity(sKmatrix, focal, ppx, ppy) )
   {
@@ -427,6 +421,8 @@ int main(int argc, char **argv)
       return EXIT_FAILURE;
     }
   }
+  // Index the database by camera maker (faster camera model lookup)
+  const DatabaseMakerIndex database_index = indexDatabase( vec_database );
 
   // Check if prior weights are given
   if (cmd.used('P') && !sPriorWeights.empty())
@@ -448,103 +444,145 @@ int main(int argc, char **argv)
   Intrinsics & intrinsics = sfm_data.intrinsics;
   Landmarks& landmarks = sfm_data.control_points;
 
+  // The images are read in parallel (image header & EXIF metadata),
+  // then the views are added in the image listing order.
+  struct ImageListingInfo
+  {
+    bool bValid = false;
+    double width = -1, height = -1, focal = -1, ppx = -1, ppy = -1;
+    std::pair<bool, Vec3> gps_info = {false, Vec3::Zero()};
+    std::string sError;
+    // Sensor width used to compute the focal length from the EXIF metadata
+    double ccdw = -1.0;
+    float exif_focal = -1.0f;
+  };
+  std::vector<ImageListingInfo> vec_image_info(vec_image.size());
+
   C_Progress_display my_progress_bar( vec_image.size(),
       std::cout, "\n- Image listing -\n" );
-  std::ostringstream error_report_stream;
-  double last_computed_focal = -1.0;
-  for ( std::vector<std::string>::const_iterator iter_image = vec_image.begin();
-    iter_image != vec_image.end();
-    ++iter_image, ++my_progress_bar )
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(vec_image.size()); ++i)
   {
-    // Read meta data to fill camera parameter (w,h,focal,ppx,ppy) fields.
-    width = height = ppx = ppy = focal = -1.0;
+    ImageListingInfo & info = vec_image_info[i];
+    std::ostringstream error_stream;
 
-    const std::string sImageFilename = stlplus::create_filespec( sImageDir, *iter_image );
+    // Read meta data to fill camera parameter (w,h,focal,ppx,ppy) fields.
+    const std::string sImageFilename = stlplus::create_filespec( sImageDir, vec_image[i] );
     const std::string sImFilenamePart = stlplus::filename_part(sImageFilename);
 
     // Test if the image format is supported:
     if (openMVG::image::GetFormat(sImageFilename.c_str()) == openMVG::image::Unknown)
     {
-      error_report_stream
+      error_stream
           << sImFilenamePart << ": Unkown image file format." << "\n";
-      continue; // image cannot be opened
     }
-
-    if (sImFilenamePart.find("mask.png") != std::string::npos
+    else if (sImFilenamePart.find("mask.png") != std::string::npos
        || sImFilenamePart.find("_mask.png") != std::string::npos)
     {
-      error_report_stream
+      error_stream
           << sImFilenamePart << " is a mask image" << "\n";
-      continue;
     }
+    else
+    {
+      ImageHeader imgHeader;
+      if (openMVG::image::ReadImageHeader(sImageFilename.c_str(), &imgHeader))
+      {
+        info.bValid = true;
+        double & width = info.width, & height = info.height, & focal = info.focal;
+        double & ppx = info.ppx, & ppy = info.ppy;
 
-    ImageHeader imgHeader;
-    if (!openMVG::image::ReadImageHeader(sImageFilename.c_str(), &imgHeader))
-      continue; // image cannot be read
-
-    width = imgHeader.width;
-    height = imgHeader.height;
-    ppx = width / 2.0;
-    ppy = height / 2.0;
-
-    std::unique_ptr<Exif_IO> exifReader(new Exif_IO_EasyExif);
-    exifReader->open( sImageFilename );
+        width = imgHeader.width;
+        height = imgHeader.height;
+        ppx = width / 2.0;
+        ppy = height / 2.0;
 
-    const bool bHaveValidExifMetadata =
-      exifReader->doesHaveExifInfo()
-      && !exifReader->getModel().empty();
+        // Read the EXIF metadata once (for the focal and the GPS data)
+        Exif_IO_EasyExif exifReader;
+        exifReader.open( sImageFilename );
 
-    // Consider the case where the focal is provided manually
-    if ( !bHaveValidExifMetadata || focal_pixels != -1)
-    {
-      if (sKmatrix.size() > 0) // Known user calibration K matrix
-      {
-        if (!checkIntrinsicStringValidity(sKmatrix, focal, ppx, ppy))
-          focal = -1.0;
-      }
-      else // User provided focal length value
-        if (focal_pixels != -1 )
-          focal = focal_pixels;
-    }
-    else // If image contains meta data
-    {
-      const std::string sCamModel = exifReader->getModel();
+        const bool bHaveValidExifMetadata =
+          exifReader.doesHaveExifInfo()
+          && !exifReader.getModel().empty();
 
-      // Handle case where focal length is equal to 0
-      if (exifReader->getFocal() == 0.0f)
-      {
-        error_report_stream
-          << stlplus::basename_part(sImageFilename) << ": Focal length is missing." << "\n";
-        focal = -1.0;
-      }
-      else
-      // Create the image entry in the list file
-      {
-        Datasheet datasheet;
-        if ( getInfo( sCamModel, vec_database, datasheet, b_EXIF_Extended_Lookup))
+        // Consider the case where the focal is provided manually
+        if ( !bHaveValidExifMetadata || focal_pixels != -1)
         {
-          // The camera model was found in the database so we can compute it's approximated focal length
-          const double ccdw = datasheet.sensorSize_;
-          focal = std::max ( width, height ) * exifReader->getFocal() / ccdw;
-
-		  // Log what we computed if different than last
-		  if (focal != last_computed_focal)
-		  {
-			  std::cout << "Computed new focal length pixels = " << focal << " for image <" << sImageFilename
-				  << "> of size " << width << "x" << height << ", focal = " << exifReader->getFocal() << "mm, ccdw ="
-				  << ccdw << "mm" << std::endl;
-			  last_computed_focal = focal;
-		  }
+          if (sKmatrix.size() > 0) // Known user calibration K matrix
+          {
+            if (!checkIntrinsicStringValidity(sKmatrix, focal, ppx, ppy))
+              focal = -1.0;
+          }
+          else // User provided focal length value
+            if (focal_pixels != -1 )
+              focal = focal_pixels;
         }
-        else
+        else // If image contains meta data
         {
-          error_report_stream
-            << stlplus::basename_part(sImageFilename)
-            << "\" model \"" << sCamModel << "\" doesn't exist in the database" << "\n"
-            << "Please consider add your camera model and sensor width in the database." << "\n";
+          const std::string sCamModel = exifReader.getModel();
+
+          // Handle case where focal length is equal to 0
+          if (exifReader.getFocal() == 0.0f)
+          {
+            error_stream
+              << stlplus::basename_part(sImageFilename) << ": Focal length is missing." << "\n";
+            focal = -1.0;
+          }
+          else
+          // Create the image entry in the list file
+          {
+            Datasheet datasheet;
+            if ( getInfo( sCamModel, vec_database, database_index, datasheet, b_EXIF_Extended_Lookup))
+            {
+              // The camera model was found in the database so we can compute it's approximated focal length
+              info.ccdw = datasheet.sensorSize_;
+              info.exif_focal = exifReader.getFocal();
+              focal = std::max ( width, height ) * exifReader.getFocal() / info.ccdw;
+            }
+            else
+            {
+              error_stream
+                << stlplus::basename_part(sImageFilename)
+                << "\" model \"" << sCamModel << "\" doesn't exist in the database" << "\n"
+                << "Please consider add your camera model and sensor width in the database." << "\n";
+            }
+          }
         }
+
+        info.gps_info = checkGPS(exifReader, i_GPS_XYZ_method);
       }
     }
+    info.sError = error_stream.str();
+
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
+    ++my_progress_bar;
+  }
+
+  std::ostringstream error_report_stream;
+  double last_computed_focal = -1.0;
+  for (size_t i = 0; i < vec_image.size(); ++i)
+  {
+    const ImageListingInfo & info = vec_image_info[i];
+    error_report_stream << info.sError;
+    if (!info.bValid)
+      continue; // image cannot be opened
+
+    const double
+      width = info.width, height = info.height,
+      focal = info.focal, ppx = info.ppx, ppy = info.ppy;
+
+    // Log what we computed if different than last
+    if (info.ccdw > 0 && focal != last_computed_focal)
+    {
+      std::cout << "Computed new focal length pixels = " << focal << " for image <"
+        << stlplus::create_filespec( sImageDir, vec_image[i] )
+        << "> of size " << width << "x" << height << ", focal = " << info.exif_focal << "mm, ccdw ="
+        << info.ccdw << "mm" << std::endl;
+      last_computed_focal = focal;
+    }
 
     // Build intrinsic parameter related to the view
     std::shared_ptr<IntrinsicBase> intrinsic;
@@ -581,10 +619,10 @@ int main(int argc, char **argv)
     }
 
     // Build the view corresponding to the image
-    const std::pair<bool, Vec3> gps_info = checkGPS(sImageFilename, i_GPS_XYZ_method);
+    const std::pair<bool, Vec3> & gps_info = info.gps_info;
     if (gps_info.first && cmd.used('P'))
     {
-      ViewPriors v(*iter_image, views.size(), views.size(), views.size(), width, height);
+      ViewPriors v(vec_image[i], views.size(), views.size(), views.size(), width, height);
 
       // Add intrinsic related to the image (if any)
       if (intrinsic == nullptr)
@@ -612,7 +650,7 @@ int main(int argc, char **argv)
     }
     else
     {
-      View v(*iter_image, views.size(), views.size(), views.size(), width, height);
+      View v(vec_image[i], views.size(), views.size(), views.size(), width, height);
 
       // Add intrinsic related to the image (if any)
       if (intrinsic == nullptr)
@@ -11,11 +11,10 @@
  */
 
 #include "openMVG/cameras/Camera_Pinhole.hpp"
-#include "openMVG/cameras/Camera_undistort_image.hpp"
 #include "openMVG/features/feature.hpp"
 #include "openMVG/image/image_io.hpp"
-#include "openMVG/image/image_resampling.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_export_undistorted.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 
 using namespace openMVG;
@@ -32,17 +31,6 @@ using namespace openMVG::features;
 #include <cmath>
 #include <iterator>
 #include <iomanip>
-#include <atomic>
-
-/// Naive image bilinear resampling of an image for thumbnail generation
-template <typename ImageT>
-ImageT
-create_thumbnail
-(
-  const ImageT & image,
-  int thumb_width,
-  int thumb_height
-);
 
 /* Notes:
  * - An MVE2 scene appears to duplicate camera rot matrix and trans vector per-view data in 'meta.ini'
@@ -58,10 +46,11 @@ create_thumbnail
 
 bool exportToMVE2Format(
   const SfM_Data & sfm_data,
-  const std::string & sOutDirectory // Output MVE2 files directory
+  const std::string & sOutDirectory, // Output MVE2 files directory
+  const bool b_export_images = true // false if the images are already exported
   )
 {
-  std::atomic<bool> bOk(true);
+  bool bOk = true;
   // Create basis directory structure
   if (!stlplus::is_folder(sOutDirectory))
   {
@@ -144,7 +133,7 @@ bool exportToMVE2Format(
     }
     out.close();
 
-    // Export (calibrated) views as undistorted images in parallel
+    // Export (calibrated) views as undistorted images
     std::cout << "Exporting views..." << std::endl;
 
     // Create 'views' subdirectory
@@ -155,78 +144,23 @@ bool exportToMVE2Format(
       stlplus::folder_create(sOutViewsDirectory);
     }
 
-    C_Progress_display my_progress_bar(views.size());
-
-    #pragma omp parallel for schedule(dynamic)
-    for (int i = 0; i < static_cast<int>(views.size()); ++i)
+    // Write the 'meta.ini' file of each valid view
+    for (const auto & views_it : views)
     {
-      if (!bOk) continue;
-      auto views_it = views.begin();
-      std::advance(views_it, i);
-      const View * view = views_it->second.get();
-
+      const View * view = views_it.second.get();
       if (!sfm_data.IsPoseAndIntrinsicDefined(view))
           continue;
 
       // Create current view subdirectory 'view_xxxx.mve'
-      std::ostringstream padding;
-      padding << std::setw(4) << std::setfill('0') << view->id_view;
-      std::string sOutViewIteratorDirectory;
-      sOutViewIteratorDirectory = stlplus::folder_append_separator(sOutViewsDirectory) + "view_" + padding.str() + ".mve";
-
-      // We have a valid view with a corresponding camera & pose
-      const std::string srcImage = stlplus::create_filespec(sfm_data.s_root_path, view->s_Img_path);
-      const std::string dstImage =
-        stlplus::create_filespec(stlplus::folder_append_separator(sOutViewIteratorDirectory), "undistorted","png");
-
+      const std::string sOutViewIteratorDirectory = MVEViewDirectory(sOutDirectory, *view);
       if (!stlplus::folder_exists(sOutViewIteratorDirectory))
         stlplus::folder_create(sOutViewIteratorDirectory);
 
-      Image<RGBColor> image, image_ud, thumbnail;
-      Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->id_intrinsic);
-      const IntrinsicBase * cam = iterIntrinsic->second.get();
-      if (cam->have_disto())
-      {
-        // Undistort and save the image
-        if (!ReadImage(srcImage.c_str(), &image))
-        {
-          std::cerr
-            << "Unable to read the input image as a RGB image:\n"
-            << srcImage << std::endl;
-          bOk = false;
-          continue;
-        }
-        UndistortImage(image, cam, image_ud, BLACK);
-        if (!WriteImage(dstImage.c_str(), image_ud))
-        {
-          std::cerr
-            << "Unable to write the output image as a RGB image:\n"
-            << dstImage << std::endl;
-          bOk = false;
-          continue;
-        }
-      }
-      else // (no distortion)
-      {
-        // If extensions match, copy the PNG image
-        if (stlplus::extension_part(srcImage) == "PNG" ||
-            stlplus::extension_part(srcImage) == "png")
-        {
-          stlplus::file_copy(srcImage, dstImage);
-        }
-        else
-        {
-          if (!ReadImage( srcImage.c_str(), &image) ||
-              !WriteImage( dstImage.c_str(), image))
-          {
-            std::cerr << "Unable to read and write the image" << std::endl;
-            bOk = false;
-            continue;
-          }
-        }
-      }
+      // We have a valid view with a corresponding camera & pose
+      const std::string srcImage = stlplus::create_filespec(sfm_data.s_root_path, view->s_Img_path);
 
       // Prepare to write an MVE 'meta.ini' file for the current view
+      const IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
       const Pose3 & pose = sfm_data.GetPoseOrDie(view);
       const Pinhole_Intrinsic * pinhole_cam = static_cast<const Pinhole_Intrinsic *>(cam);
       const Mat3 & rotation = pose.rotation();
@@ -266,14 +200,21 @@ bool exportToMVE2Format(
         "meta","ini").c_str());
       file << fileOut.str();
       file.close();
+    }
 
-      // Save a thumbnail image "thumbnail.png", 50x50 pixels
-      thumbnail = create_thumbnail(image, 50, 50);
-      const std::string dstThumbnailImage =
-        stlplus::create_filespec(stlplus::folder_append_separator(sOutViewIteratorDirectory), "thumbnail","png");
-      WriteImage(dstThumbnailImage.c_str(), thumbnail);
+    // Export the undistorted images "undistorted.png"
+    // and their thumbnail "thumbnail.png" (50x50 pixels)
+    if (b_export_images)
+    {
+      UndistortedImagePath mve_image_path;
+      const UndistortedImageCallback mve_thumbnail = [&](const View & view, const Image<RGBColor> & image)
+      {
+        return WriteMVEThumbnail(sOutDirectory, view, image);
+      };
 
-      ++my_progress_bar;
+      C_Progress_display my_progress_bar(views.size());
+      bOk = MVEUndistortedImagePath(sfm_data, sOutDirectory, mve_image_path) &&
+        ExportUndistortedImages(sfm_data, {mve_image_path}, mve_thumbnail, &my_progress_bar);
     }
   }
   return bOk;
@@ -287,6 +228,7 @@ int main(int argc, char *argv[])
   std::string sOutDir = "";
   cmd.add( make_option('i', sSfM_Data_Filename, "sfmdata") );
   cmd.add( make_option('o', sOutDir, "outdir") );
+  cmd.add( make_switch('s', "skip_images") );
   std::cout << "Note:  this program writes output in MVE file format.\n";
 
   try {
@@ -296,6 +238,8 @@ int main(int argc, char *argv[])
       std::cerr << "Usage: " << argv[0] << '\n'
       << "[-i|--sfmdata] filename, the SfM_Data file to convert\n"
       << "[-o|--outdir] path\n"
+      << "[-s|--skip_images] do not export the undistorted images\n"
+      << "\t (already exported with openMVG_main_ExportUndistortedImages --mve_dir)\n"
       << std::endl;
 
       std::cerr << s << std::endl;
@@ -314,55 +258,8 @@ int main(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
-  if (exportToMVE2Format(sfm_data, stlplus::folder_append_separator(sOutDir) + "MVE"))
+  if (exportToMVE2Format(sfm_data, stlplus::folder_append_separator(sOutDir) + "MVE", !cmd.used('s')))
     return EXIT_SUCCESS;
   else
     return EXIT_FAILURE;
 }
-
-/// Naive image bilinear resampling of an image for thumbnail generation
-/// Inspired by create_thumbnail from MVE (cropping is here ignored)
-template <typename ImageT>
-ImageT
-create_thumbnail
-(
-  const ImageT & image,
-  int thumb_width,
-  int thumb_height
-)
-{
-  const int width = image.Width();
-  const int height = image.Height();
-  const float image_aspect = static_cast<float>(width) / height;
-  const float thumb_aspect = static_cast<float>(thumb_width) / thumb_height;
-
-  int rescale_width, rescale_height;
-  if (image_aspect > thumb_aspect)
-  {
-    rescale_width = std::ceil(thumb_height * image_aspect);
-    rescale_height = thumb_height;
-  }
-  else
-  {
-    rescale_width = thumb_width;
-    rescale_height = std::ceil(thumb_width / image_aspect);
-  }
-
-  // Generation of the sampling grid
-  std::vector< std::pair<float,float> > sampling_grid;
-  sampling_grid.reserve(rescale_height * rescale_width);
-  for ( int i = 0; i < rescale_height; ++i )
-  {
-    for ( int j = 0; j < rescale_width; ++j )
-    {
-      const float dx = static_cast<float>(j) * width / rescale_width;
-      const float dy = static_cast<float>(i) * height / rescale_height;
-      sampling_grid.push_back( std::make_pair( dy , dx ) );
-    }
-  }
-
-  const Sampler2d<SamplerLinear> sampler;
-  ImageT imageOut;
-  GenericRessample(image, sampling_grid, rescale_width, rescale_height, sampler, imageOut);
-  return imageOut;
-}
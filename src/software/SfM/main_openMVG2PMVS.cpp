@@ -7,12 +7,12 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "openMVG/cameras/Camera_Pinhole.hpp"
-#include "openMVG/cameras/Camera_undistort_image.hpp"
 #include "openMVG/geometry/pose3.hpp"
-#include "openMVG/image/image_io.hpp"
 #include "openMVG/numeric/eigen_alias_definition.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_export_undistorted.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "openMVG/sfm/sfm_data_utils.hpp"
 #include "openMVG/sfm/sfm_landmark.hpp"
 #include "openMVG/sfm/sfm_view.hpp"
 #include "openMVG/types.hpp"
@@ -30,7 +30,6 @@
 using namespace openMVG;
 using namespace openMVG::cameras;
 using namespace openMVG::geometry;
-using namespace openMVG::image;
 using namespace openMVG::sfm;
 
 
@@ -39,7 +38,8 @@ bool exportToPMVSFormat(
   const std::string & sOutDirectory,  //Output PMVS files directory
   const int downsampling_factor,
   const int CPU_core_count,
-  const bool b_VisData = true
+  const bool b_VisData = true,
+  const bool b_export_images = true // false if the images are already exported
   )
 {
   bool bOk = true;
@@ -68,7 +68,7 @@ bool exportToPMVSFormat(
 
   if (bOk)
   {
-    C_Progress_display my_progress_bar( sfm_data.GetViews().size()*2 );
+    C_Progress_display my_progress_bar( sfm_data.GetViews().size() * (b_export_images ? 2 : 1) );
 
     // Since PMVS requires contiguous camera index, and that some views can have some missing poses,
     // we reindex the poses to ensure a contiguous pose list.
@@ -101,49 +101,11 @@ bool exportToPMVSFormat(
     }
 
     // Export (calibrated) views as undistorted images
-    Image<RGBColor> image, image_ud;
-    const Views & views = sfm_data.GetViews();
-    #pragma omp parallel for private(image, image_ud)
-    for (int i = 0; i < static_cast<int>(views.size()); ++i)
+    UndistortedImagePath pmvs_image_path;
+    if (b_export_images)
     {
-      ++my_progress_bar;
-      auto view_it = views.begin();
-      std::advance(view_it, i);
-      const View * view = view_it->second.get();
-      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-        continue;
-
-      Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->id_intrinsic);
-
-      // We have a valid view with a corresponding camera & pose
-      const std::string srcImage = stlplus::create_filespec(sfm_data.s_root_path, view->s_Img_path);
-      std::ostringstream os;
-      os << std::setw(8) << std::setfill('0') << map_viewIdToContiguous[view->id_view];
-      const std::string dstImage = stlplus::create_filespec(
-        stlplus::folder_append_separator(sOutDirectory) + "visualize", os.str(),"jpg");
-
-      const IntrinsicBase * cam = iterIntrinsic->second.get();
-      if (cam->have_disto())
-      {
-        // undistort the image and save it
-        ReadImage( srcImage.c_str(), &image);
-        UndistortImage(image, cam, image_ud, BLACK);
-        WriteImage(dstImage.c_str(), image_ud);
-      }
-      else // (no distortion)
-      {
-        // copy the image if extension match
-        if (stlplus::extension_part(srcImage) == "JPG" ||
-          stlplus::extension_part(srcImage) == "jpg")
-        {
-          stlplus::file_copy(srcImage, dstImage);
-        }
-        else
-        {
-          ReadImage( srcImage.c_str(), &image);
-          WriteImage( dstImage.c_str(), image);
-        }
-      }
+      bOk = PMVSUndistortedImagePath(sfm_data, sOutDirectory, pmvs_image_path) &&
+        ExportUndistortedImages(sfm_data, {pmvs_image_path}, nullptr, &my_progress_bar);
     }
 
     //pmvs_options.txt
@@ -165,25 +127,18 @@ bool exportToPMVSFormat(
 
     if (b_VisData)
     {
-      std::map< IndexT, std::set<IndexT> > view_shared;
-      // From the structure observations, list the putatives pairs (symmetric)
-      for (Landmarks::const_iterator itL = sfm_data.GetLandmarks().begin();
-        itL != sfm_data.GetLandmarks().end(); ++itL)
+      // From the structure observations, list the views that share some landmarks
+      // (the contiguous indexes follow the view id order)
+      std::map< IndexT, std::vector<IndexT> > view_shared;
+      for (const auto & covisibility_it : ComputeViewCovisibility(sfm_data))
       {
-        const Landmark & landmark = itL->second;
-        const Observations & obs = landmark.obs;
-        for (Observations::const_iterator itOb = obs.begin();
-          itOb != obs.end(); ++itOb)
+        if (map_viewIdToContiguous.count(covisibility_it.first) == 0)
+          continue;
+        std::vector<IndexT> & vec_view = view_shared[map_viewIdToContiguous.at(covisibility_it.first)];
+        for (const IndexT viewId : covisibility_it.second)
         {
-          const IndexT viewId = itOb->first;
-          Observations::const_iterator itOb2 = itOb;
-          ++itOb2;
-          for (; itOb2 != obs.end(); ++itOb2)
-          {
-            const IndexT viewId2 = itOb2->first;
-            view_shared[map_viewIdToContiguous[viewId]].insert(map_viewIdToContiguous[viewId2]);
-            view_shared[map_viewIdToContiguous[viewId2]].insert(map_viewIdToContiguous[viewId]);
-          }
+          if (map_viewIdToContiguous.count(viewId))
+            vec_view.push_back(map_viewIdToContiguous.at(viewId));
         }
       }
       // Export the vis.dat file
@@ -192,15 +147,13 @@ bool exportToPMVSFormat(
         << "VISDATA" << os.widen('\n')
         << view_shared.size() << os.widen('\n'); // #images
       // Export view shared visibility
-      for (std::map< IndexT, std::set<IndexT> >::const_iterator it = view_shared.begin();
-        it != view_shared.end(); ++it)
+      for (const auto & view_shared_it : view_shared)
       {
-        const std::set<IndexT> & setView = it->second;
-        osVisData << it->first << ' ' << setView.size();
-        for (std::set<IndexT>::const_iterator itV = setView.begin();
-          itV != setView.end(); ++itV)
+        const std::vector<IndexT> & vec_view = view_shared_it.second;
+        osVisData << view_shared_it.first << ' ' << vec_view.size();
+        for (const IndexT view_index : vec_view)
         {
-          osVisData << ' ' << *itV;
+          osVisData << ' ' << view_index;
         }
         osVisData << os.widen('\n');
       }
@@ -324,6 +277,7 @@ int main(int argc, char *argv[]) {
   int CPU = 8;
   bool bVisData = true;
 
+  cmd.add( make_switch('s', "skip_images") );
   cmd.add( make_option('i', sSfM_Data_Filename, "sfmdata") );
   cmd.add( make_option('o', sOutDir, "outdir") );
   cmd.add( make_option('r', resolution, "resolution") );
@@ -339,7 +293,9 @@ int main(int argc, char *argv[]) {
       << "[-o|--outdir path]\n"
       << "[-r|--resolution] divide image coefficient\n"
       << "[-c|--nb core]\n"
-      << "[-v|--useVisData] use visibility information."
+      << "[-v|--useVisData] use visibility information.\n"
+      << "[-s|--skip_images] do not export the undistorted images\n"
+      << "\t (already exported with openMVG_main_ExportUndistortedImages --pmvs_dir)"
       << std::endl;
 
       std::cerr << s << std::endl;
@@ -362,7 +318,8 @@ int main(int argc, char *argv[]) {
       stlplus::folder_append_separator(sOutDir) + "PMVS",
       resolution,
       CPU,
-      bVisData);
+      bVisData,
+      !cmd.used('s'));
 
     exportToBundlerFormat(sfm_data,
       stlplus::folder_append_separator(sOutDir) +
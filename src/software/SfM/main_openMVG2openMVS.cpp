@@ -7,9 +7,9 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "openMVG/cameras/Camera_Pinhole.hpp"
-#include "openMVG/cameras/Camera_undistort_image.hpp"
 #include "openMVG/image/image_io.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_export_undistorted.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 
 #define _USE_EIGEN
@@ -31,7 +31,8 @@ using namespace openMVG::sfm;
 bool exportToOpenMVS(
   const SfM_Data & sfm_data,
   const std::string & sOutFile,
-  const std::string & sOutDir
+  const std::string & sOutDir,
+  const bool b_export_images = true // false if the images are already exported
   )
 {
   // Create undistorted images directory structure
@@ -93,21 +94,6 @@ bool exportToOpenMVS(
       const openMVG::geometry::Pose3 poseMVG(sfm_data.GetPoseOrDie(view.second.get()));
       pose.R = poseMVG.rotation();
       pose.C = poseMVG.center();
-      // export undistorted images
-      const openMVG::cameras::IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view.second->id_intrinsic).get();
-      if (cam->have_disto())
-      {
-        // undistort image and save it
-        Image<openMVG::image::RGBColor> imageRGB, imageRGB_ud;
-        ReadImage(srcImage.c_str(), &imageRGB);
-        UndistortImage(imageRGB, cam, imageRGB_ud, BLACK);
-        WriteImage(image.name.c_str(), imageRGB_ud);
-      }
-      else
-      {
-        // just copy image
-        stlplus::file_copy(srcImage, image.name);
-      }
       platform.poses.push_back(pose);
       ++nPoses;
     }
@@ -115,11 +101,18 @@ bool exportToOpenMVS(
     {
       // image have not valid pose, so set an undefined pose
       image.poseID = NO_ID;
-      // just copy the image
-      stlplus::file_copy(srcImage, image.name);
     }
     scene.images.emplace_back(image);
-    ++my_progress_bar;
+  }
+
+  // export the images (undistorted if the camera has some distortion)
+  UndistortedImagePath openMVS_image_path;
+  if (b_export_images &&
+      (!OpenMVSUndistortedImagePath(sfm_data, sOutDir, openMVS_image_path) ||
+       !ExportUndistortedImages(sfm_data, {openMVS_image_path}, nullptr, &my_progress_bar)))
+  {
+    std::cerr << "Cannot export the undistorted images" << std::endl;
+    return false;
   }
 
   // define structure
@@ -205,6 +198,7 @@ int main(int argc, char *argv[])
   cmd.add( make_option('i', sSfM_Data_Filename, "sfmdata") );
   cmd.add( make_option('o', sOutFile, "outfile") );
   cmd.add( make_option('d', sOutDir, "outdir") );
+  cmd.add( make_switch('s', "skip_images") );
 
   try {
       if (argc == 1) throw std::string("Invalid command line parameter.");
@@ -214,6 +208,8 @@ int main(int argc, char *argv[])
       << "[-i|--sfmdata] filename, the SfM_Data file to convert\n"
       << "[-o|--outfile] OpenMVS scene file\n"
       << "[-d|--outdir] undistorted images path\n"
+      << "[-s|--skip_images] do not export the undistorted images\n"
+      << "\t (already exported with openMVG_main_ExportUndistortedImages --openmvs_dir)\n"
       << std::endl;
 
       std::cerr << s << std::endl;
@@ -235,7 +231,7 @@ int main(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
-  if (!exportToOpenMVS(sfm_data, sOutFile, sOutDir))
+  if (!exportToOpenMVS(sfm_data, sOutFile, sOutDir, !cmd.used('s')))
   {
     std::cerr << std::endl
       << "The output openMVS scene file cannot be written" << std::endl;
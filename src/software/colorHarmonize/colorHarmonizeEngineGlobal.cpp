@@ -9,6 +9,8 @@
 #include "colorHarmonizeEngineGlobal.hpp"
 #include "software/SfM/SfMIOHelper.hpp"
 
+#include "openMVG/image/image_cache.hpp"
+#include "openMVG/image/image_converter.hpp"
 #include "openMVG/image/image_io.hpp"
 //-- Feature matches
 #include <openMVG/matching/indMatch.hpp>
@@ -58,9 +60,11 @@ ColorHarmonizationEngineGlobal::ColorHarmonizationEngineGlobal(
   const std::string & sMatchesFile,
   const std::string & sOutDirectory,
   const int selectionMethod,
-  const int imgRef):
+  const int imgRef,
+  const size_t cacheSize):
   _selectionMethod( selectionMethod ),
   _imgRef( imgRef ),
+  _cacheSize( cacheSize ),
   _sMatchesFile(sMatchesFile),
   _sSfM_Data_Path(sSfM_Data_Filename),
   _sMatchesPath(sMatchesPath),
@@ -76,6 +80,29 @@ ColorHarmonizationEngineGlobal::~ColorHarmonizationEngineGlobal()
 {
 }
 
+/// Compute the RGB channels histograms of the masked pixels in a single pass
+void computeHistograms
+(
+  const Image< unsigned char > & mask,
+  const Image< RGBColor > & image,
+  std::vector< Histogram< double > > & histograms
+)
+{
+  for (int j = 0; j < mask.Height(); ++j )
+  {
+    for (int i = 0; i < mask.Width(); ++i )
+    {
+      if (mask( j, i ) != 0 )
+      {
+        const RGBColor & color = image( j, i );
+        histograms[0].Add( color( 0 ) );
+        histograms[1].Add( color( 1 ) );
+        histograms[2].Add( color( 2 ) );
+      }
+    }
+  }
+}
+
 void pauseProcess()
 {
   unsigned char i;
@@ -105,14 +132,12 @@ bool ColorHarmonizationEngineGlobal::Process()
   //-- Remove EG with poor support:
 
   for (matching::PairWiseMatches::iterator iter = _map_Matches.begin();
-    iter != _map_Matches.end();
-    ++iter)
+    iter != _map_Matches.end();)
   {
     if (iter->second.size() < 120)
-    {
-      _map_Matches.erase(iter);
-      iter = _map_Matches.begin();
-    }
+      iter = _map_Matches.erase(iter);
+    else
+      ++iter;
   }
 
   {
@@ -174,15 +199,10 @@ bool ColorHarmonizationEngineGlobal::Process()
   std::map<size_t, size_t> map_cameraNodeToCameraIndex; // graph node Id to 0->Ncam
   std::map<size_t, size_t> map_cameraIndexTocameraNode; // 0->Ncam correspondance to graph node Id
   std::set<size_t> set_indeximage;
-  for (size_t i = 0; i < _map_Matches.size(); ++i)
+  for (const auto & iter : _map_Matches)
   {
-    matching::PairWiseMatches::const_iterator iter = _map_Matches.begin();
-    std::advance(iter, i);
-
-    const size_t I = iter->first.first;
-    const size_t J = iter->first.second;
-    set_indeximage.insert(I);
-    set_indeximage.insert(J);
+    set_indeximage.insert(iter.first.first);
+    set_indeximage.insert(iter.first.second);
   }
 
   for (std::set<size_t>::const_iterator iterSet = set_indeximage.begin();
@@ -195,32 +215,77 @@ bool ColorHarmonizationEngineGlobal::Process()
   std::cout << "\n Remaining cameras after CC filter : \n"
     << map_cameraIndexTocameraNode.size() << " from a total of " << _vec_fileNames.size() << std::endl;
 
-  size_t bin      = 256;
-  double minvalue = 0.0;
-  double maxvalue = 255.0;
+  const size_t bin      = 256;
+  const double minvalue = 0.0;
+  const double maxvalue = 255.0;
+
+  enum EHistogramSelectionMethod
+  {
+      eHistogramHarmonizeFullFrame     = 0,
+      eHistogramHarmonizeMatchedPoints = 1,
+      eHistogramHarmonizeVLDSegment    = 2,
+  };
+  if (_selectionMethod < eHistogramHarmonizeFullFrame ||
+      _selectionMethod > eHistogramHarmonizeVLDSegment)
+  {
+    std::cout << "Selection method unsupported" << std::endl;
+    return false;
+  }
 
   // For each edge computes the selection masks and histograms (for the RGB channels)
+  // - the edges are processed in parallel,
+  // - the decoded images are shared between the edges by a memory bounded cache
+  //   (the edges are listed by image index, so consecutive edges share an image).
   std::vector<relativeColorHistogramEdge> map_relativeHistograms[3];
   map_relativeHistograms[0].resize(_map_Matches.size());
   map_relativeHistograms[1].resize(_map_Matches.size());
   map_relativeHistograms[2].resize(_map_Matches.size());
 
-  for (size_t i = 0; i < _map_Matches.size(); ++i)
+  const std::vector<matching::PairWiseMatches::const_iterator> vec_edges = [&]
   {
-    matching::PairWiseMatches::const_iterator iter = _map_Matches.begin();
-    std::advance(iter, i);
+    std::vector<matching::PairWiseMatches::const_iterator> edges;
+    for (matching::PairWiseMatches::const_iterator iter = _map_Matches.begin();
+      iter != _map_Matches.end(); ++iter)
+    {
+      edges.push_back(iter);
+    }
+    return edges;
+  }();
 
-    const size_t I = iter->first.first;
-    const size_t J = iter->first.second;
+  Image_Cache<RGBColor> image_cache(_cacheSize);
+  bool bOk = true;
+  C_Progress_display my_progress_bar_edges( vec_edges.size(),
+    std::cout, "\n Compute the histograms of the edges\n" );
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(vec_edges.size()); ++i)
+  {
+    const size_t I = vec_edges[i]->first.first;
+    const size_t J = vec_edges[i]->first.second;
 
-    const std::vector<IndMatch> & vec_matchesInd = iter->second;
+    const std::vector<IndMatch> & vec_matchesInd = vec_edges[i]->second;
 
     //-- Edges names:
     std::pair< std::string, std::string > p_imaNames;
     p_imaNames = make_pair( _vec_fileNames[ I ], _vec_fileNames[ J ] );
-    std::cout << "Current edge : "
-      << stlplus::filename_part(p_imaNames.first) << "\t"
-      << stlplus::filename_part(p_imaNames.second) << std::endl;
+
+    //-- Get the decoded images
+    const Image_Cache<RGBColor>::ImagePtr imageI = image_cache.get( p_imaNames.first );
+    const Image_Cache<RGBColor>::ImagePtr imageJ = image_cache.get( p_imaNames.second );
+    if (!imageI || !imageJ)
+    {
+#ifdef OPENMVG_USE_OPENMP
+      #pragma omp critical
+#endif
+      {
+        std::cerr << "Unable to read the images of the edge : "
+          << p_imaNames.first << "\t" << p_imaNames.second << std::endl;
+        bOk = false;
+      }
+      ++my_progress_bar_edges;
+      continue;
+    }
 
     //-- Compute the masks from the data selection:
     Image< unsigned char > maskI ( _vec_imageSize[ I ].first, _vec_imageSize[ I ].second );
@@ -228,13 +293,6 @@ bool ColorHarmonizationEngineGlobal::Process()
 
     switch (_selectionMethod)
     {
-      enum EHistogramSelectionMethod
-      {
-          eHistogramHarmonizeFullFrame     = 0,
-          eHistogramHarmonizeMatchedPoints = 1,
-          eHistogramHarmonizeVLDSegment    = 2,
-      };
-
       case eHistogramHarmonizeFullFrame:
       {
         color_harmonization::commonDataByPair_FullFrame  dataSelector(
@@ -250,27 +308,30 @@ bool ColorHarmonizationEngineGlobal::Process()
           p_imaNames.first,
           p_imaNames.second,
           vec_matchesInd,
-          _map_feats[ I ],
-          _map_feats[ J ],
+          _map_feats.at( I ),
+          _map_feats.at( J ),
           circleSize);
         dataSelector.computeMask( maskI, maskJ );
       }
       break;
       case eHistogramHarmonizeVLDSegment:
       {
+        // The gray level images are computed from the cached color images
+        Image< unsigned char > imageGrayI, imageGrayJ;
+        ConvertPixelType( *imageI, &imageGrayI );
+        ConvertPixelType( *imageJ, &imageGrayJ );
         color_harmonization::commonDataByPair_VLDSegment dataSelector(
           p_imaNames.first,
           p_imaNames.second,
           vec_matchesInd,
-          _map_feats[ I ],
-          _map_feats[ J ]);
+          _map_feats.at( I ),
+          _map_feats.at( J ),
+          &imageGrayI,
+          &imageGrayJ);
 
         dataSelector.computeMask( maskI, maskJ );
       }
       break;
-      default:
-        std::cout << "Selection method unsupported" << std::endl;
-        return false;
     }
 
     //-- Export the masks
@@ -292,37 +353,23 @@ bool ColorHarmonizationEngineGlobal::Process()
       WriteImage( out_filename_J.c_str(), maskJ );
     }
 
-    //-- Compute the histograms
-    Image< RGBColor > imageI, imageJ;
-    ReadImage( p_imaNames.first.c_str(), &imageI );
-    ReadImage( p_imaNames.second.c_str(), &imageJ );
-
-    Histogram< double > histoI( minvalue, maxvalue, bin);
-    Histogram< double > histoJ( minvalue, maxvalue, bin);
-
-    int channelIndex = 0; // RED channel
-    color_harmonization::commonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    color_harmonization::commonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeR = map_relativeHistograms[channelIndex][i];
-    edgeR = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[I], map_cameraNodeToCameraIndex[J],
-      histoI.GetHist(), histoJ.GetHist());
-
-    histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
-    channelIndex = 1; // GREEN channel
-    color_harmonization::commonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    color_harmonization::commonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeG = map_relativeHistograms[channelIndex][i];
-    edgeG = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[I], map_cameraNodeToCameraIndex[J],
-      histoI.GetHist(), histoJ.GetHist());
-
-    histoI = histoJ = Histogram< double >( minvalue, maxvalue, bin);
-    channelIndex = 2; // BLUE channel
-    color_harmonization::commonDataByPair::computeHisto( histoI, maskI, channelIndex, imageI );
-    color_harmonization::commonDataByPair::computeHisto( histoJ, maskJ, channelIndex, imageJ );
-    relativeColorHistogramEdge & edgeB = map_relativeHistograms[channelIndex][i];
-    edgeB = relativeColorHistogramEdge(map_cameraNodeToCameraIndex[I], map_cameraNodeToCameraIndex[J],
-      histoI.GetHist(), histoJ.GetHist());
+    //-- Compute the histograms (the RGB channels are computed in a single pass)
+    std::vector< Histogram< double > > histoI( 3, Histogram< double >( minvalue, maxvalue, bin ) );
+    std::vector< Histogram< double > > histoJ( 3, Histogram< double >( minvalue, maxvalue, bin ) );
+    computeHistograms( maskI, *imageI, histoI );
+    computeHistograms( maskJ, *imageJ, histoJ );
+
+    for (int channelIndex = 0; channelIndex < 3; ++channelIndex) // RED, GREEN, BLUE channel
+    {
+      map_relativeHistograms[channelIndex][i] = relativeColorHistogramEdge(
+        map_cameraNodeToCameraIndex.at(I), map_cameraNodeToCameraIndex.at(J),
+        histoI[channelIndex].GetHist(), histoJ[channelIndex].GetHist());
+    }
+    ++my_progress_bar_edges;
   }
+  image_cache.clear();
+  if (!bOk)
+    return false;
 
   std::cout << "\n -- \n SOLVE for color consistency with linear programming\n --" << std::endl;
   //-- Solve for the gains and offsets:
@@ -331,45 +378,30 @@ bool ColorHarmonizationEngineGlobal::Process()
 
   using namespace openMVG::linearProgramming;
 
-  std::vector<double> vec_solution_r(_vec_fileNames.size() * 2 + 1);
-  std::vector<double> vec_solution_g(_vec_fileNames.size() * 2 + 1);
-  std::vector<double> vec_solution_b(_vec_fileNames.size() * 2 + 1);
+  // Solution of the RED, GREEN and BLUE channels
+  std::vector<double> vec_solution[3];
 
   openMVG::system::Timer timer;
 
-  // Red channel
-  {
-    OSI_CLP_SolverWrapper lpSolver(vec_solution_r.size());
-
-    ConstraintBuilder_GainOffset cstBuilder(map_relativeHistograms[0], vec_indexToFix);
-    LP_Constraints_Sparse constraint;
-    cstBuilder.Build(constraint);
-    lpSolver.setup(constraint);
-    lpSolver.solve();
-    lpSolver.getSolution(vec_solution_r);
-  }
-  // Green channel
-  {
-    OSI_CLP_SolverWrapper lpSolver(vec_solution_g.size());
-
-    ConstraintBuilder_GainOffset cstBuilder(map_relativeHistograms[1], vec_indexToFix);
-    LP_Constraints_Sparse constraint;
-    cstBuilder.Build(constraint);
-    lpSolver.setup(constraint);
-    lpSolver.solve();
-    lpSolver.getSolution(vec_solution_g);
-  }
-  // Blue channel
+  // The three channels are independent: solve them in parallel
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int channelIndex = 0; channelIndex < 3; ++channelIndex)
   {
-    OSI_CLP_SolverWrapper lpSolver(vec_solution_b.size());
+    vec_solution[channelIndex].resize(_vec_fileNames.size() * 2 + 1);
+    OSI_CLP_SolverWrapper lpSolver(vec_solution[channelIndex].size());
 
-    ConstraintBuilder_GainOffset cstBuilder(map_relativeHistograms[2], vec_indexToFix);
+    ConstraintBuilder_GainOffset cstBuilder(map_relativeHistograms[channelIndex], vec_indexToFix);
     LP_Constraints_Sparse constraint;
     cstBuilder.Build(constraint);
     lpSolver.setup(constraint);
     lpSolver.solve();
-    lpSolver.getSolution(vec_solution_b);
+    lpSolver.getSolution(vec_solution[channelIndex]);
   }
+  const std::vector<double> & vec_solution_r = vec_solution[0];
+  const std::vector<double> & vec_solution_g = vec_solution[1];
+  const std::vector<double> & vec_solution_b = vec_solution[2];
 
   std::cout << std::endl
     << " ColorHarmonization solving on a graph with: " << _map_Matches.size() << " edges took (s): "
@@ -391,56 +423,67 @@ bool ColorHarmonizationEngineGlobal::Process()
 
   std::cout << "\n\nThere is :\n" << set_indeximage.size() << " images to transform." << std::endl;
 
+  const std::string out_folder = stlplus::create_filespec( _sOutDirectory,
+    vec_selectionMethod[ _selectionMethod ] + "_" + vec_harmonizeMethod[ harmonizeMethod ]);
+  if ( !stlplus::folder_exists( out_folder ) )
+    stlplus::folder_create( out_folder );
+
   //-> convert solution to gain offset and creation of the LUT per image
-  C_Progress_display my_progress_bar( set_indeximage.size() );
-  for (std::set<size_t>::const_iterator iterSet = set_indeximage.begin();
-    iterSet != set_indeximage.end(); ++iterSet, ++my_progress_bar)
+  //   (the images are streamed: read, transformed and written in parallel)
+  const std::vector<size_t> vec_indeximage(set_indeximage.begin(), set_indeximage.end());
+  C_Progress_display my_progress_bar( vec_indeximage.size() );
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int nodeIndex = 0; nodeIndex < static_cast<int>(vec_indeximage.size()); ++nodeIndex)
   {
-    const size_t imaNum = *iterSet;
-    using Vec256 = Eigen::Matrix<double, 256, 1>;
-    std::vector< Vec256 > vec_map_lut(3);
-
-    const size_t nodeIndex = std::distance(set_indeximage.begin(), iterSet);
-
-    const  double g_r = vec_solution_r[nodeIndex*2];
-    const  double offset_r = vec_solution_r[nodeIndex*2+1];
-    const  double g_g = vec_solution_g[nodeIndex*2];
-    const  double offset_g = vec_solution_g[nodeIndex*2+1];
-    const  double g_b = vec_solution_b[nodeIndex*2];
-    const double offset_b = vec_solution_b[nodeIndex*2+1];
-
-    for (size_t k = 0; k < 256; ++k)
+    const size_t imaNum = vec_indeximage[nodeIndex];
+    unsigned char map_lut[3][256];
+    for (int channelIndex = 0; channelIndex < 3; ++channelIndex)
     {
-      vec_map_lut[0][k] = clamp( k * g_r + offset_r, 0., 255. );
-      vec_map_lut[1][k] = clamp( k * g_g + offset_g, 0., 255. );
-      vec_map_lut[2][k] = clamp( k * g_b + offset_b, 0., 255. );
+      const double gain = vec_solution[channelIndex][nodeIndex*2];
+      const double offset = vec_solution[channelIndex][nodeIndex*2+1];
+      for (size_t k = 0; k < 256; ++k)
+      {
+        map_lut[channelIndex][k] =
+          static_cast<unsigned char>(clamp( k * gain + offset, 0., 255. ));
+      }
     }
 
     Image< RGBColor > image_c;
-    ReadImage( _vec_fileNames[ imaNum ].c_str(), &image_c );
-
+    if (!ReadImage( _vec_fileNames[ imaNum ].c_str(), &image_c ))
+    {
 #ifdef OPENMVG_USE_OPENMP
-#pragma omp parallel for
+      #pragma omp critical
 #endif
+      bOk = false;
+      ++my_progress_bar;
+      continue;
+    }
+
     for (int j = 0; j < image_c.Height(); ++j)
     {
       for (int i = 0; i < image_c.Width(); ++i)
       {
-        image_c(j, i)[0] = clamp(vec_map_lut[0][image_c(j, i)[0]], 0., 255.);
-        image_c(j, i)[1] = clamp(vec_map_lut[1][image_c(j, i)[1]], 0., 255.);
-        image_c(j, i)[2] = clamp(vec_map_lut[2][image_c(j, i)[2]], 0., 255.);
+        RGBColor & color = image_c(j, i);
+        color[0] = map_lut[0][color[0]];
+        color[1] = map_lut[1][color[1]];
+        color[2] = map_lut[2][color[2]];
       }
     }
 
-    const std::string out_folder = stlplus::create_filespec( _sOutDirectory,
-      vec_selectionMethod[ _selectionMethod ] + "_" + vec_harmonizeMethod[ harmonizeMethod ]);
-    if ( !stlplus::folder_exists( out_folder ) )
-      stlplus::folder_create( out_folder );
     const std::string out_filename = stlplus::create_filespec( out_folder, stlplus::filename_part(_vec_fileNames[ imaNum ]) );
 
-    WriteImage( out_filename.c_str(), image_c );
+    if (!WriteImage( out_filename.c_str(), image_c ))
+    {
+#ifdef OPENMVG_USE_OPENMP
+      #pragma omp critical
+#endif
+      bOk = false;
+    }
+    ++my_progress_bar;
   }
-  return true;
+  return bOk;
 }
 
 bool ColorHarmonizationEngineGlobal::ReadInputData()
@@ -26,7 +26,8 @@ public:
     const std::string & sMatchesFile,
     const std::string & sOutDirectory,
     const int selectionMethod = -1,
-    const int imgRef = -1);
+    const int imgRef = -1,
+    const size_t cacheSize = size_t(1) << 30);
 
   ~ColorHarmonizationEngineGlobal();
 
@@ -49,6 +50,7 @@ private:
 
   int _selectionMethod;
   int _imgRef;
+  size_t _cacheSize; // Memory budget of the decoded images cache (in bytes)
   std::string _sMatchesFile;
 
   // -----
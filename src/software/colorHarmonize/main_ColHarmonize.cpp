@@ -12,6 +12,7 @@
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 #include "openMVG/system/timer.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 
@@ -30,12 +31,14 @@ int main( int argc, char **argv )
   std::string sOutDir = "";
   int selectionMethod = -1;
   int imgRef = -1;
+  int cacheSizeMB = 1024;
 
   cmd.add( make_option( 'i', sSfM_Data_Filename, "input_file" ) );
   cmd.add( make_option( 'm', sMatchesFile, "matchesFile" ) );
   cmd.add( make_option( 'o', sOutDir, "outdir" ) );
   cmd.add( make_option( 's', selectionMethod, "selectionMethod" ) );
   cmd.add( make_option( 'r', imgRef, "referenceImage" ) );
+  cmd.add( make_option( 'c', cacheSizeMB, "cacheSize" ) );
 
   try
   {
@@ -51,6 +54,7 @@ int main( int argc, char **argv )
     << "\n[Optional]\n"
     << "[-s|--selectionMethod int]\n"
     << "[-r|--referenceImage int]\n"
+    << "[-c|--cacheSize int] memory budget of the decoded images (in MB, default 1024)\n"
     << std::endl;
 
     std::cerr << s << std::endl;
@@ -79,7 +83,8 @@ int main( int argc, char **argv )
     sMatchesFile,
     sOutDir,
     selectionMethod,
-    imgRef));
+    imgRef,
+    static_cast<size_t>(std::max(cacheSizeMB, 0)) << 20));
 
   if ( m_colorHarmonizeEngine->Process() )
   {